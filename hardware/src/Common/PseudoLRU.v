@@ -0,0 +1,58 @@
+`timescale 1ns / 1ps
+/*
+ * File         : PseudoLRU.v
+ * Project      : XUM MIPS32
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Tree pseudo-LRU replacement logic for one set of a 'WAYS'-way
+ *   set-associative cache (WAYS = 1, 2, 4, or 8).
+ *
+ *   The state is a binary tree of WAYS-1 bits stored by the cache for
+ *   each set. Node n has children 2n+1 (lower ways) and 2n+2 (upper ways),
+ *   and a node bit of 1 means the lower half was used least recently.
+ *   For two ways this is true LRU: A state of 1 means way 0 is LRU.
+ *
+ *   'Victim' is the way to replace given 'State', and 'Touched' is the
+ *   new state after an access to 'Way'. Both are combinational.
+ */
+module PseudoLRU #(
+    parameter WAYS     = 2,                                         // 1, 2, 4, or 8
+    parameter WAY_BITS = (WAYS > 4) ? 3 : ((WAYS > 2) ? 2 : 1),     // Derived from WAYS: Do not override
+    parameter LRU_BITS = (WAYS > 1) ? (WAYS - 1) : 1                // Derived from WAYS: Do not override
+    ) (
+    input      [(LRU_BITS-1):0] State,
+    input      [(WAY_BITS-1):0] Way,
+    output reg [(WAY_BITS-1):0] Victim,
+    output reg [(LRU_BITS-1):0] Touched
+    );
+
+    localparam LEVELS = (WAYS > 4) ? 3 : ((WAYS > 2) ? 2 : ((WAYS > 1) ? 1 : 0));
+
+    // Follow the node bits from the root to the least-recently used way
+    integer vl, vn;
+    always @(*) begin
+        Victim = {WAY_BITS{1'b0}};
+        vn     = 0;
+        for (vl = 0; vl < LEVELS; vl = vl + 1) begin
+            Victim[LEVELS-1-vl] = ~State[vn];
+            vn = (2 * vn) + ((State[vn]) ? 1 : 2);
+        end
+    end
+
+    // Point each node on the path to 'Way' away from it
+    integer tl, tn;
+    always @(*) begin
+        Touched = State;
+        tn      = 0;
+        for (tl = 0; tl < LEVELS; tl = tl + 1) begin
+            Touched[tn] = Way[LEVELS-1-tl];
+            tn = (2 * tn) + 1 + Way[LEVELS-1-tl];
+        end
+    end
+
+endmodule
+
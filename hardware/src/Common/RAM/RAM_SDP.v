@@ -0,0 +1,59 @@
+`timescale 1ns / 1ps
+/*
+ * File         : RAM_SDP.v
+ * Project      : XUM MIPS32
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A read-first memory of configurable width and depth with one
+ *   write port and one read port, made to be inferred as a Xilinx
+ *   Block RAM (BRAM).
+ *
+ *   SDP-> Simple dual-port (one write port, one read port)
+ *
+ *   Read data is available at the next clock edge.
+ *   Reset will zero the read output on the next clock edge.
+ */
+module RAM_SDP(clk, rst, addra, wea, dina, addrb, doutb);
+    parameter  DATA_WIDTH = 32;
+    parameter  ADDR_WIDTH = 10;
+    localparam RAM_DEPTH  = 1 << ADDR_WIDTH;
+    input  clk;
+    input  rst;
+    input  [(ADDR_WIDTH-1):0] addra;
+    input  wea;
+    input  [(DATA_WIDTH-1):0] dina;
+    input  [(ADDR_WIDTH-1):0] addrb;
+    output [(DATA_WIDTH-1):0] doutb;
+
+    reg [(DATA_WIDTH-1):0] doutb;
+
+    // Hint for {AUTO, BLOCK, DISTRIBUTED}
+    (* RAM_STYLE="BLOCK" *)
+    reg [(DATA_WIDTH-1):0] ram [0:(RAM_DEPTH-1)];
+
+    integer i;
+    initial begin
+        for (i = 0; i < RAM_DEPTH; i = i + 1) begin
+            ram[i] <= {DATA_WIDTH{1'b0}};
+        end
+    end
+
+    always @(posedge clk) begin
+        if (wea) begin
+            ram[addra] <= dina;
+        end
+    end
+
+    always @(posedge clk) begin
+        doutb <= ram[addrb];
+        if (rst) begin
+            doutb <= {DATA_WIDTH{1'b0}};
+        end
+    end
+
+endmodule
+
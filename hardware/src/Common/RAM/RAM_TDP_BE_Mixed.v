@@ -0,0 +1,88 @@
+`timescale 1ns / 1ps
+/*
+ * File         : RAM_TDP_BE_Mixed.v
+ * Project      : XUM MIPS32
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A write-first memory with a 32-bit port and a 128-bit port,
+ *   each with byte write enables, made to be inferred as a Xilinx
+ *   Block RAM (BRAM) with mixed port widths.
+ *
+ *   TDP-> True dual-port (two read and two write ports)
+ *   BE -> Byte write enables
+ *
+ *   'ADDR_WIDTH' is the address width of the 128-bit port B. As with a
+ *   Xilinx BRAM of mixed port widths, the mapping is little-endian: 32-bit
+ *   word 'addra' occupies bits [(addra[1:0]*32)+31 : addra[1:0]*32] of the
+ *   128-bit word 'addra[(ADDR_WIDTH+1):2]'.
+ *
+ *   Read data is available at the next clock edge. Writes are also seen by
+ *   a read of the same word on the other port in the same cycle, which the
+ *   data cache relies on when it reads a word as its last fill beat arrives.
+ *   Reset will zero the outputs on the next clock edge.
+ */
+module RAM_TDP_BE_Mixed(clk, rst, addra, wea, dina, douta, addrb, web, dinb, doutb);
+    parameter  ADDR_WIDTH = 6;
+    localparam RAM_DEPTH  = 1 << (ADDR_WIDTH + 2);
+    input  clk;
+    input  rst;
+    input  [(ADDR_WIDTH+1):0] addra;
+    input  [3:0]   wea;
+    input  [31:0]  dina;
+    output [31:0]  douta;
+    input  [(ADDR_WIDTH-1):0] addrb;
+    input  [15:0]  web;
+    input  [127:0] dinb;
+    output [127:0] doutb;
+
+    reg [31:0]  douta;
+    reg [127:0] doutb;
+
+    // Hint for {AUTO, BLOCK, DISTRIBUTED}
+    (* RAM_STYLE="BLOCK" *)
+    reg [31:0] ram [0:(RAM_DEPTH-1)];
+
+    integer i;
+    initial begin
+        for (i = 0; i < RAM_DEPTH; i = i + 1) begin
+            ram[i] <= {32{1'b0}};
+        end
+    end
+
+    // Both ports share one process so that the array has a single writer.
+    integer b;
+    always @(posedge clk) begin
+        douta <= ram[addra];
+        for (b = 0; b < 4; b = b + 1) begin
+            if (wea[b]) begin
+                ram[addra][(b*8)+:8] <= dina[(b*8)+:8];
+                douta[(b*8)+:8]      <= dina[(b*8)+:8];
+            end
+        end
+        for (i = 0; i < 4; i = i + 1) begin
+            doutb[(i*32)+:32] <= ram[{addrb, i[1:0]}];
+            for (b = 0; b < 4; b = b + 1) begin
+                if (wea[b] & ({addrb, i[1:0]} == addra)) begin
+                    doutb[((i*32)+(b*8))+:8] <= dina[(b*8)+:8];
+                end
+                if (web[(i*4)+b]) begin
+                    ram[{addrb, i[1:0]}][(b*8)+:8] <= dinb[((i*32)+(b*8))+:8];
+                    doutb[((i*32)+(b*8))+:8]       <= dinb[((i*32)+(b*8))+:8];
+                    if ({addrb, i[1:0]} == addra) begin
+                        douta[(b*8)+:8] <= dinb[((i*32)+(b*8))+:8];
+                    end
+                end
+            end
+        end
+        if (rst) begin
+            douta <= {32{1'b0}};
+            doutb <= {128{1'b0}};
+        end
+    end
+
+endmodule
+
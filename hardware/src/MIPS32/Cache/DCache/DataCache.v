@@ -0,0 +1,1236 @@
+`timescale 1ns / 1ps
+/*
+ * File         : DataCache.v
+ * Project      : XUM MIPS32 cache enhancement
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Modification History:
+ *   Rev   Date         Initials  Description of Change
+ *   1.0   5-Sep-2014   GEA       Initial design.
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A data cache for the MIPS32 Release 1 processor core.
+ *
+ *   The cache has 'WAYS' ways (1, 2, 4, or 8) of 2^INDEX_BITS sets each
+ *   (INDEX_BITS = 6, 7, or 8) with 16-byte lines. The index must lie within
+ *   the 4 KiB page offset, so each way is at most 4 KiB. The default is
+ *   2 KiB, 2-way.
+ *
+ *   By default the cache is blocking: A miss holds the processor until the
+ *   line fill completes. If 'BG_FILL' is set, misses are recorded in a
+ *   small file of miss status holding registers (MSHRs) and line fills are
+ *   performed in the background. A store miss then completes at once, and
+ *   later hits proceed while its fill is outstanding. A load miss still holds
+ *   the processor until its own fill provides the word, so this is not a
+ *   non-blocking (hit-under-miss) cache for loads. See the description of the
+ *   background fill mode below.
+ *
+ *   If 'EARLY_RESTART' is set, a load miss completes as soon as its word
+ *   arrives from memory instead of after the whole line has been filled.
+ *   This is most effective with a memory that returns the requested word
+ *   first. See the description of early restart below.
+ *
+ *   If 'PREFETCH' is set (blocking mode only), a stride prefetcher indexed by the
+ *   PC of the load or store reads the next line of a strided access stream into
+ *   a one-line prefetch buffer. See the description of prefetching below.
+ */
+module DataCache #(parameter PABITS=36, parameter INDEX_BITS=6, parameter WAYS=2, parameter BG_FILL=0, parameter EARLY_RESTART=0, parameter PREFETCH=0) (
+    input                  clock,
+    input                  reset,
+    // Processor Interface
+    input  [9:0]           VAddressIn_C,    // Bits [11:2]  of the 32-bit virtual address, i.e. the offset of the vpage/pframe.
+    input  [(PABITS-13):0] PAddressIn_C,    // Bits [35:12] of the 36-bit physical address, i.e. the TLB-translated physical tag.
+    input                  PAddressValid_C, // The physical address is valid (TLB hit).
+    input  [2:0]           CacheAttr_C,     // Cache attributes for the requested address.
+    input                  Stall_C,
+    input  [31:0]          DataIn_C,
+    input                  Read_C,
+    input  [3:0]           Write_C,
+    output [31:0]          DataOut_C,
+    output                 Ready_C,
+    output                 Miss_C,          // 1-cycle pulse indicating a cacheable miss (for the performance counters).
+    input                  DoCacheOp_C,     // Synchronous pulse indicating a CACHE operation (i.e. from WB when not stalled).
+    input  [2:0]           CacheOp_C,       // Cache operation, encoded in CACHE instruction.
+    input  [(PABITS-9):0]  CacheOpData_C,   // Store Tag data (PABITS-9:2->Bits [35:10] of the tag, 1:0->Valid/Dirty).
+    input  [31:0]          PC_C,            // Program counter of the load or store being serviced (for the prefetcher).
+    // Memory Interface
+    output [(PABITS-3):0]  Address_M,       // Physical line (35:4) or word (35:2) address for memory requests.
+    output                 ReadLine_M,      // Initiates a cacheline (128-bit) read sequence from memory starting at a word address.
+    output                 ReadWord_M,      // Initiates a read for a single 32-bit uncacheable word.
+    input  [31:0]          DataIn_M,        // Inbound data from memory.
+    input  [1:0]           DataInOffset_M,  // Cacheline word offset (0, 1, 2, or 3) of the incoming data from memory following 'ReadLine_M'.
+    output                 LineOutReady_M,  // The cache write buffer is non-empty and 'DataOut_M[127:0]' is valid.
+    output                 WordOutReady_M,  // The cache write buffer is non-empty and 'DataOut_M[31:0]' is valid.
+    output [3:0]           WordOutBE_M,     // Byte enable bits for single-word memory writes (using 'WordOutReady_M').
+    output [127:0]         DataOut_M,       // Writeback data from the cache to memory. Full cacheline ([127:0]) or uncacheable word ([31:0]).
+    input                  Ready_M          // 1-cycle pulse indicating one word of valid read data or capture of write data
+    );
+
+    `include "../../Core/MIPS_Defines.v"
+
+    /* Cache parameters:
+     *   Size: WAYS * 2^INDEX_BITS * 16 bytes (default 2 KiB)
+     *   Block size: 16 bytes
+     *   Associativity: WAYS-way, tree pseudo-LRU replacement (true LRU for 2 ways)
+     */
+
+    /* Supported cache operations:
+     *   - CacheOpD_Idx_WbInv:  Index writeback invalidate (000)
+     *   - CacheOpD_Idx_STag:   Index store tag (010)
+     *   - CacheOpD_Adr_HInv:   Address hit invalidate (100) (TODO)
+     *   - CacheOpD_Adr_HWbInv: Address hit writeback invalidate (101)
+     *   - CacheOpD_Adr_HWb:    Address hit writeback (110)
+     *
+     *   Index operations select the way with the address bits above the index,
+     *   inverted (i.e., with two ways a set bit selects way 0).
+     */
+
+    /* Background fill mode:
+     *   A cacheable miss allocates one of two MSHRs, which holds the line address,
+     *   the way it will be filled into, and a byte mask of processor stores to the
+     *   line. The victim line is invalidated (after being queued in the write
+     *   buffer if dirty) and a fill engine reads the line from memory using the
+     *   second port of the set data memory while the request state machine keeps
+     *   servicing the processor:
+     *
+     *   - Hits proceed as usual.
+     *   - Store misses complete immediately. The store is merged into the set data
+     *     memory and recorded in the MSHR mask so that the fill does not overwrite it.
+     *   - Load misses wait for their own fill, as the in-order pipeline cannot
+     *     proceed without the loaded word. A miss (load or store) behind a store
+     *     miss can allocate the other MSHR while the first fill is outstanding.
+     *
+     *   A completed fill is validated ('retired') when the tag memory port is free,
+     *   i.e., while the cache is idle or waiting on an MSHR. Fills are issued in
+     *   order and only when the write buffer is empty, so writebacks always reach
+     *   memory first. Uncacheable accesses and cache operations wait until all
+     *   MSHRs have retired.
+     */
+
+    /* Early restart:
+     *   Blocking mode: The requested word of a load miss is captured as it arrives
+     *   and returned to the processor while the rest of the line is filled. The fill
+     *   uses its own copy of the line address and way, so the cache can accept the
+     *   next request. That request waits until the fill is done and is then looked
+     *   up again (FILL_RESTART), as the set memory index was used for the fill.
+     *
+     *   Background fill mode: A load waiting on an MSHR is served from the set data
+     *   memory once the fill has written its word (and any merged store bytes are
+     *   already there), without waiting for the line to be retired.
+     */
+
+    /* Prefetching (blocking mode):
+     *   A small reference prediction table, indexed by the PC of the load or store,
+     *   holds the last word address and stride of each memory instruction. It is
+     *   updated when a cacheable access is first serviced. When an access misses and
+     *   its last two strides were equal, the line of its next access is requested
+     *   (the next line in the stride direction if the stride is within a line), as
+     *   long as it is in the same 4 KiB page.
+     *
+     *   The prefetch reads the line into a one-line buffer whenever the memory
+     *   interface and the write buffer are idle. A miss to the buffered line fills the
+     *   set from the buffer instead of from memory: It takes the usual FILL_WAIT_[1-4]
+     *   path with one word per cycle, starting with the requested word. A miss waits
+     *   for a prefetch in progress, and the buffer is discarded if its line is written
+     *   to memory (i.e., enters the write buffer).
+     *
+     *   Counters (simulation only; unused in synthesis):
+     *     pf_issued: Prefetches started.
+     *     pf_useful: Line fills from the prefetch buffer.
+     *     pf_misses: Line fills from memory.
+     *   Accuracy is pf_useful / pf_issued, and coverage is pf_useful / (pf_useful + pf_misses).
+     */
+
+    // State encodings
+    localparam [3:0] IDLE=0, TAG_CHECK=1, WRITEBACK=2, FILL=3, FILL_WAIT_1=4, FILL_WAIT_2=5,
+                     FILL_WAIT_3=6, FILL_WAIT_4=7, FILL_WAIT_WORD=8, WRITE_RECOVER=9, READ_WAIT=10, MSHR_WAIT=11,
+                     FILL_RESTART=12;
+
+    // Geometry
+    localparam SETS     = 1 << INDEX_BITS;
+    localparam TAG_BITS = PABITS - INDEX_BITS - 4;
+    localparam WAY_BITS = (WAYS > 4) ? 3 : ((WAYS > 2) ? 2 : 1);
+    localparam LRU_BITS = (WAYS > 1) ? (WAYS - 1) : 1;
+
+    // Prefetcher: Reference prediction table of 2^RPT_BITS entries with partial PC tags
+    localparam PF_ON       = ((PREFETCH != 0) && (BG_FILL == 0)) ? 1 : 0;
+    localparam RPT_BITS    = 3;
+    localparam RPT_ENTRIES = 1 << RPT_BITS;
+    localparam RPT_TAG     = 8;
+
+    // Local signals
+    wire [9:0]  r_vaddr;               // Request virtual address (page/frame offset bits only)
+    wire        r_doCacheOp;           // A cache operation request from the processor
+    wire [2:0]  r_cacheOp;             // A specific cache operation
+    wire [(PABITS-9):0] r_cacheOpData; // Data for the store tag cache operation
+    wire        r_read;                // A read request from the processor
+    wire [3:0]  r_write;               // A write request from the processor for one or more bytes
+    wire        r_write_any;           // A write request from the processor
+    wire [31:0] r_write_data;          // Data to be written from the processor to the cache
+    wire [(INDEX_BITS-1):0] r_index;   // Request index
+    wire [1:0]  r_offset;              // Request offset
+    wire [(PABITS-3):0] s_paddr;       // Physical word address of the data currently being serviced
+    wire [(TAG_BITS-1):0] s_tag;       // TLB-translated physical tag (plus virtual index bits above the cache index)
+    wire [(TAG_BITS-1):0] s_index_tag; // Tag from a given index used for writebacks to memory.
+    wire [9:0]  s_vaddr;               // V/P address of the data currently being serviced (page/frame offset bits only)
+    wire [(INDEX_BITS-1):0] s_index;   // Service index
+    wire        s_uncacheable;         // The service address is in the uncacheable range
+    wire [31:0] s_uncacheable_data;    // Uncacheable read data that needs to be retained during a stall
+    wire        s_read;                // Service stage read command
+    wire [3:0]  s_write;               // Service stage write enable/command
+    wire        s_write_any;           // Service stage write command
+    wire [31:0] s_write_data;          // Service stage write data
+    wire        s_doCacheOp;           // Cache instruction
+    wire [2:0]  s_cacheOp;             // Cache instruction function
+    wire [(PABITS-9):0] s_cacheOpData; // Cache instruction store tag data
+    wire [(WAY_BITS-1):0] s_cacheOp_way; // The way selected by the cache instruction index address
+    wire [(WAYS-1):0] s_cacheOp_sel;   // The way selected by the cache instruction index address (one-hot)
+    wire [(WAYS-1):0] s_valid_e;       // The ways which are valid for the prior request (ephemeral)
+    wire [(WAYS-1):0] s_hits_e;        // The ways which hit for the prior request (ephemeral)
+    reg  [(WAY_BITS-1):0] s_hit_way_e; // The way which hit for the prior request (ephemeral)
+    wire        s_hit_e;               // Cache hit for prior request (ephemeral)
+    wire        s_hit_d;               // Cache hit for prior request (delay)
+    wire        s_hit;                 // Authoritative hit signal for a prior request
+    reg  [31:0] s_hit_data_e;          // Cache read data (ephemeral)
+    wire [(WAYS-1):0] s_dirty_e;       // The ways which are dirty for the prior request (ephemeral)
+    wire        s_evict_e;             // The requested address must first evict a cacheline (ephemeral)
+    wire        s_dirty_evict_e;       // The requested address must first writeback then evict a cacheline (ephemeral)
+    reg  [(WAY_BITS-1):0] s_fill_way_e; // The way selected for a fill or evict-then-fill
+    wire [31:0] s_hit_data_d;          // Cache read data (delay)
+    wire [(WAYS-1):0] s_valid_d;       // The ways which are valid for the prior request (delay)
+    wire [(WAYS-1):0] s_hits_d;        // The ways which hit for the prior request (delay)
+    wire [(WAY_BITS-1):0] s_hit_way_d; // The way which hit for the prior request (delay)
+    wire        s_evict_d;             // The requested address must first evict a cacheline (delay)
+    wire [(WAY_BITS-1):0] s_fill_way_d; // TODO: Basically a fill select (evict, fill)
+    wire        using_delay_data;      // The service stage has stalled and requires latched data from the request stage
+    wire        delay_update;          // Indicates that the service data delay registers should capture
+    wire        cond_wb_idx_wbinv;     // Shorthand signal for an index writeback invalidate condition
+    wire        cond_wb_adr_hwb;       // Shorthand signal for an address hit writeback condition
+    wire        cond_tagcheck_remain;  // Shorthand signal for remaining in the TAG_CHECK state or idling
+    reg  [(LRU_BITS-1):0] lru [0:(SETS-1)]; // Pseudo-LRU state of each set (see PseudoLRU.v)
+    wire [(WAY_BITS-1):0] lru_victim;  // Least-recently used way at the service index
+    reg  [(WAY_BITS-1):0] lru_way;     // The way which is accessed (or filled) for an LRU update
+    wire [(LRU_BITS-1):0] lru_touched; // The LRU state after an access to 'lru_way'
+    reg         new_request;           // The cache is beginning a new request (non-cacheop)
+    reg         new_request_r;         // A one-clock delay signal of a new pipeline request
+    reg         pseudo_new_request_r;  // An 're-request' delay signal following a fill
+    reg         bg_retry_r;            // A 're-request' delay signal following an MSHR wait
+    wire        new_reqs_r;            // The OR of new_requests and restarted requests
+    wire        new_lookup_r;          // The OR of new_requests and requests retried after an MSHR wait or a fill
+    reg         ready;                 // Ready signal to the processor; the request is complete
+    reg  [3:0]  state;                 // Cache state
+
+    // Background fill mode signals
+    reg  [1:0]            mshr_valid;           // The MSHR holds an outstanding or completed line fill
+    reg  [1:0]            mshr_filled;          // The line fill of the MSHR is complete but not yet retired
+    reg  [(WAY_BITS-1):0] mshr_way    [0:1];    // The way the line is filled into
+    reg  [(TAG_BITS-1):0] mshr_tag    [0:1];    // Tag of the line
+    reg  [(INDEX_BITS-1):0] mshr_index [0:1];   // Index of the line
+    reg  [1:0]            mshr_offset [0:1];    // Word offset of the first miss to the line
+    reg  [15:0]           mshr_mask   [0:1];    // Bytes of the line written by the processor during the fill
+    reg                   mshr_older;           // The MSHR which was allocated first
+    wire [1:0]            mshr_match;           // The service address matches the MSHR
+    wire [1:0]            mshr_at_index;        // The MSHR is at the service index
+    wire                  mshr_match_sel;       // The matching MSHR
+    wire                  mshr_alloc_sel;       // The MSHR to allocate (the first free one)
+    wire                  mshr_fill_sel;        // The MSHR being filled or to be filled next
+    wire                  mshr_retire_sel;      // The next MSHR to be retired
+    reg                   fill_busy;            // A line fill is in progress on the memory interface
+    reg                   fill_entry;           // The MSHR being filled
+    reg  [1:0]            fill_count;           // Number of fill words received
+    wire [15:0]           fill_mask;            // Store mask of the MSHR being filled
+    reg                   lineout_ok;           // The set line outputs are valid for the service index (no fill in the prior cycle)
+    wire                  bg_fill_next;         // The next MSHR to be filled
+    wire                  bg_fill_issue;        // Start a line fill
+    wire                  bg_fill_beat;         // One word of fill data from memory
+    wire                  bg_fill_done;         // The last word of fill data from memory
+    wire                  bg_retire;            // Validate a filled line in the tag memory
+    wire                  bg_fence;             // Uncacheable access or cache operation with outstanding MSHRs
+    wire                  bg_miss;              // Cacheable miss
+    reg  [(WAYS-1):0]     bg_busy;              // The ways at the service index which are being filled
+    reg  [(WAY_BITS-1):0] bg_way;               // The way selected for an MSHR allocation (or its writeback)
+    wire [(WAY_BITS-1):0] bg_way_d;             // The way selected for an MSHR allocation (delay)
+    wire                  bg_victim_valid;      // The line to be replaced is valid
+    wire                  bg_victim_dirty;      // The line to be replaced is dirty
+    wire                  bg_merge_conflict;    // A store would write the same word as the current fill word
+    wire                  bg_merge;             // Store miss to a line with an outstanding fill
+    wire                  bg_can_alloc;         // Miss which can allocate an MSHR
+    wire                  bg_alloc;             // Miss which allocates an MSHR (the replaced line is clean or invalid)
+    wire                  bg_evict;             // Miss which must write back the replaced line before allocating an MSHR
+    wire                  bg_tag_check;         // The background fill decisions apply in this cycle
+    wire [(WAY_BITS-1):0] bg_store_way;         // The way a merged store is written into
+    wire [15:0]           bg_merge_mask;        // Byte mask of a merged store
+    wire [(WAY_BITS-1):0] s_victim_way_d;       // The way which is written back for a fill
+    reg  [3:0]            mshr_words  [0:1];    // Words of the line written by the fill (one cycle after the write)
+    reg                   fill_beat_r;          // A fill word was written in the prior cycle
+    reg  [1:0]            fill_offset_r;        // The offset of the fill word written in the prior cycle
+    reg                   fill_entry_r;         // The MSHR of the fill word written in the prior cycle
+    wire                  bg_early;             // Load miss whose word has been written by an outstanding fill
+
+    // Blocking mode line fill and early restart signals
+    reg  [(PABITS-3):0]   f_addr;               // Word address of the line fill
+    reg  [(WAY_BITS-1):0] f_way;                // The way being filled
+    wire [(TAG_BITS-1):0] f_tag;                // Tag of the line fill
+    wire [(INDEX_BITS-1):0] f_index;            // Index of the line fill
+    wire                  f_wait;               // The cache is in one of the FILL_WAIT_[1-4] states
+    wire                  f_line;               // The fill is for a cacheable line
+    wire                  f_validate;           // The last word of the line fill; write the tag
+    wire                  er_capture;           // The requested word of a load miss arrives before the end of the fill
+    reg                   er_ready;             // The requested word is available to the processor
+    reg                   er_done;              // The load completed early; the fill continues in the background
+    reg                   er_pending;           // A new request was accepted during the fill
+    reg  [31:0]           er_data;              // The requested word of the load miss
+    reg                   restart_r;            // A 're-request' delay signal following a fill restart
+    wire                  f_start;              // A line fill or uncacheable read starts (leaving FILL)
+    reg                   f_pf;                 // The line fill is from the prefetch buffer
+    wire [3:0]            f_step;               // Number of fill words written before this cycle
+    wire                  f_ready;              // One word of fill data (from memory or the prefetch buffer)
+    wire [1:0]            f_offset;             // Cacheline offset of the fill word
+    wire [31:0]           f_data;               // The fill word
+
+    // Prefetch signals (blocking mode)
+    reg                   rpt_valid  [0:(RPT_ENTRIES-1)]; // The table entry is in use
+    reg  [(RPT_TAG-1):0]  rpt_tag    [0:(RPT_ENTRIES-1)]; // PC bits above the table index
+    reg  [(PABITS-3):0]   rpt_last   [0:(RPT_ENTRIES-1)]; // Word address of the last access
+    reg  [11:0]           rpt_stride [0:(RPT_ENTRIES-1)]; // Stride (in words) between the last two accesses
+    reg                   rpt_steady [0:(RPT_ENTRIES-1)]; // The last two strides were equal and non-zero
+    wire [(RPT_BITS-1):0] rpt_index;            // Table index of the service PC
+    wire [(RPT_TAG-1):0]  rpt_pc_tag;           // Table tag of the service PC
+    wire                  rpt_hit;              // The table has an entry for the service PC
+    wire [(PABITS-3):0]   rpt_delta;            // Word address difference from the last access
+    wire                  rpt_fits;             // The difference fits in a table stride
+    wire [11:0]           pf_stride;            // Stride of the service PC
+    wire                  pf_small;             // The stride is within a line
+    wire [(PABITS-5):0]   pf_target;            // The line of the next access of the stride
+    wire                  pf_train;             // A cacheable access is first serviced; update the table
+    wire                  pf_trigger;           // A line fill for an access with a steady stride
+    reg                   pf_req;               // A prefetch of 'pf_next' is pending
+    reg  [(PABITS-5):0]   pf_next;              // Line address of the pending prefetch
+    reg  [(PABITS-5):0]   pf_line;              // Line address of the prefetch in progress or in the buffer
+    reg                   pf_busy;              // A prefetch is in progress on the memory interface
+    reg  [1:0]            pf_count;             // Number of prefetch words received
+    reg  [127:0]          pf_buf;               // The prefetch buffer
+    reg                   pf_valid;             // The prefetch buffer holds a complete line
+    reg                   pf_killed;            // The line was written to memory during the prefetch
+    wire                  pf_issue;             // Start a prefetch
+    wire                  pf_beat;              // One word of prefetch data from memory
+    wire                  pf_done;              // The last word of prefetch data from memory
+    wire                  pf_stale;             // The buffered line enters the write buffer
+    wire                  pf_use;               // A line fill from the prefetch buffer starts
+    reg  [31:0]           pf_issued;            // Prefetch counters (see above)
+    reg  [31:0]           pf_useful;
+    reg  [31:0]           pf_misses;
+
+    // Set signals (shared by all ways, except for the per-way commands and outputs)
+    wire [(TAG_BITS-1):0]      Set_Tag;
+    wire [(INDEX_BITS-1):0]    Set_Index;
+    wire [1:0]                 Set_Offset;
+    wire [(INDEX_BITS-1):0]    Set_LineIndex;
+    wire [3:0]                 Set_FillSkip;
+    wire [(TAG_BITS+1):0]      Set_StoreTagData;
+    wire [(32*WAYS-1):0]       Set_WordOut;
+    wire [(WAYS-1):0]          Set_Hit;
+    wire [(WAYS-1):0]          Set_Valid;
+    wire [(WAYS-1):0]          Set_Dirty;
+    wire [(TAG_BITS*WAYS-1):0] Set_IndexTag;
+    wire [(128*WAYS-1):0]      Set_LineOut;
+    wire [(4*WAYS-1):0]        Set_WriteWord;
+    wire [(4*WAYS-1):0]        Set_MergeWord;
+    wire [(WAYS-1):0]          Set_ValidateLine;
+    reg  [(WAYS-1):0]          Set_InvalidateLine;
+    wire [(WAYS-1):0]          Set_FillLine;
+    wire [(WAYS-1):0]          Set_StoreTag;
+
+    // Write buffer signals
+    wire WB_EnQ;
+    wire WB_DeQ;
+    wire WB_Empty;
+    wire WB_Full;
+    reg  [((PABITS-5)+129):0] WB_DataIn;    // {32-bit line addr, 128-bit line, 1-bit cacheable} OR
+    wire [((PABITS-5)+129):0] WB_DataOut;   // {34-bit word addr, 90-bit X, 4-bit write-enable, 32-bit word, 1-bit uncacheable}
+
+    /**** Assignments ****/
+
+    // Top-level assignments
+    assign DataOut_C      = (state == FILL_WAIT_WORD) ? s_uncacheable_data : ((er_ready) ? er_data : ((using_delay_data) ? s_hit_data_d : s_hit_data_e));
+    assign Ready_C        = ready;
+    assign Miss_C         = (f_start & ~s_uncacheable) | bg_fill_issue;
+    assign Address_M      = (bg_fill_issue | fill_busy) ? {mshr_tag[mshr_fill_sel], mshr_index[mshr_fill_sel], mshr_offset[mshr_fill_sel]} :
+                            ((pf_busy) ? {pf_line, 2'b00} : ((pf_issue) ? {pf_next, 2'b00} :
+                            ((f_wait) ? f_addr : ((WB_Empty) ? s_paddr : WB_DataOut[((PABITS-5)+129):127]))));
+    assign ReadLine_M     = (f_start & ~s_uncacheable & ~pf_use) | bg_fill_issue | pf_issue;
+    assign ReadWord_M     = f_start & s_uncacheable;
+    assign LineOutReady_M = ~WB_Empty &  WB_DataOut[0] & ~fill_busy & ~pf_busy;
+    assign WordOutReady_M = ~WB_Empty & ~WB_DataOut[0] & ~fill_busy & ~pf_busy;
+    assign WordOutBE_M    = WB_DataOut[36:33];
+    assign DataOut_M      = WB_DataOut[128:1];
+
+    // Set assignments (the per-way commands are assigned with the set instances below)
+    assign Set_Tag            = (f_validate) ? f_tag : s_tag;
+    assign Set_Index          = (bg_retire) ? mshr_index[mshr_retire_sel] : ((f_validate) ? f_index : r_index);
+    assign Set_Offset         = r_offset;
+    assign Set_LineIndex      = (bg_fill_beat) ? mshr_index[fill_entry] : ((f_wait) ? f_index : r_index);
+    assign Set_FillSkip       = (BG_FILL != 0) ? fill_mask[{DataInOffset_M, 2'b00} +: 4] : 4'h0;
+    assign Set_StoreTagData   = (bg_retire) ? {mshr_tag[mshr_retire_sel], (mshr_mask[mshr_retire_sel] != 16'h0000), 1'b1} :
+                                              {s_cacheOpData[(PABITS-9):(INDEX_BITS-4)], s_cacheOpData[1:0]};
+
+    // Set line invalidation
+    always @(*) begin
+        if (~PAddressValid_C) begin
+            Set_InvalidateLine <= {WAYS{1'b0}};
+        end
+        else if (s_doCacheOp) begin
+            case (state)
+                TAG_CHECK:
+                    begin
+                        if (s_doCacheOp) begin
+                            case (s_cacheOp)
+                                // XXX TODO: Do these need delayed hit inputs too?
+                                `CacheOpD_Idx_WbInv:    Set_InvalidateLine <= s_cacheOp_sel & s_valid_e & ~s_dirty_e;
+                                `CacheOpD_Adr_HInv:     Set_InvalidateLine <= s_hits_e;
+                                `CacheOpD_Adr_HWbInv:   Set_InvalidateLine <= s_hits_e & ~s_dirty_e;
+                                default:                Set_InvalidateLine <= {WAYS{1'b0}};
+                            endcase
+                        end
+                        else begin
+                            Set_InvalidateLine <= {WAYS{1'b0}};
+                        end
+                    end
+                WRITEBACK:
+                    begin
+                        case (s_cacheOp)
+                            `CacheOpD_Idx_WbInv:    Set_InvalidateLine <= s_cacheOp_sel & s_valid_d;
+                            `CacheOpD_Adr_HWbInv:   Set_InvalidateLine <= s_hits_d;
+                            default:                Set_InvalidateLine <= {WAYS{1'b0}};
+                        endcase
+                    end
+                default:
+                    begin
+                        Set_InvalidateLine <= {WAYS{1'b0}};
+                    end
+            endcase
+        end
+        else if (BG_FILL != 0) begin
+            // Replaced lines are invalidated when an MSHR is allocated or when they are written back
+            Set_InvalidateLine <= ({WAYS{bg_tag_check & bg_alloc & bg_victim_valid}} & (1 << bg_way)) |
+                                  ({WAYS{(state == WRITEBACK) & WB_EnQ & ~s_uncacheable}} & (1 << bg_way_d));
+        end
+        else begin
+            Set_InvalidateLine <= {WAYS{1'b0}};
+        end
+    end
+
+    // Write buffer assignments
+    assign WB_EnQ    = (state == WRITEBACK) & ~WB_Full & lineout_ok;
+    assign WB_DeQ    = ~WB_Empty & Ready_M & ~fill_busy & ~pf_busy;
+
+    // All writebacks from the cache use the cache's tag instead of the processor-supplied tag. The
+    // only exception to this is uncacheable writes where the processor has the only tag information.
+    always @(*) begin
+        // {la[160:129], line[128:1], cached[0]} OR
+        // {wa[160:127], X[126:37], we[36:33], data[32:1], cached[0]}
+        WB_DataIn[((PABITS-5)+129):129] <= (s_uncacheable & ~s_doCacheOp) ? {s_tag, s_index} : {s_index_tag, s_index};
+        if (s_doCacheOp) begin
+            case (s_cacheOp)
+                `CacheOpD_Idx_WbInv:    WB_DataIn[128:1] <= Set_LineOut[(s_cacheOp_way*128)+:128];
+                `CacheOpD_Adr_HWbInv:   WB_DataIn[128:1] <= Set_LineOut[(s_hit_way_d*128)+:128];
+                `CacheOpD_Adr_HWb:      WB_DataIn[128:1] <= Set_LineOut[(s_hit_way_d*128)+:128];
+                default:                WB_DataIn[128:1] <= {128{1'bx}};
+            endcase
+            WB_DataIn[0] <= 1'b1;
+        end
+        else if (s_uncacheable) begin
+            WB_DataIn[128:127] <= s_vaddr[1:0];
+            WB_DataIn[126:37]  <= {90{1'bx}};
+            WB_DataIn[36:33]   <= s_write;
+            WB_DataIn[32:1]    <= s_write_data;
+            WB_DataIn[0]       <= 1'b0;
+        end
+        else begin
+            WB_DataIn[128:1] <= Set_LineOut[(s_victim_way_d*128)+:128];
+            WB_DataIn[0]     <= 1'b1;
+        end
+    end
+
+    // Local assignments
+    assign r_vaddr          = VAddressIn_C;
+    assign r_doCacheOp      = DoCacheOp_C;
+    assign r_cacheOp        = CacheOp_C;
+    assign r_cacheOpData    = CacheOpData_C;
+    assign r_read           = Read_C;
+    assign r_write          = Write_C;
+    assign r_write_any      = (r_write != 4'b0000);
+    assign r_write_data     = DataIn_C;
+    assign r_index          = (new_request) ? r_vaddr[(INDEX_BITS+1):2] : s_index;
+    assign r_offset         = (new_request) ? r_vaddr[1:0] : s_vaddr[1:0];
+    assign s_paddr          = {PAddressIn_C, s_vaddr};
+    assign s_tag            = s_paddr[(PABITS-3):(INDEX_BITS+2)];   // Uses part of the virtual index for small caches.
+    assign s_index          = s_vaddr[(INDEX_BITS+1):2];
+    assign s_uncacheable    = (CacheAttr_C == 3'b010);
+    assign s_write_any      = (s_write != 4'b0000);
+    assign s_cacheOp_way    = ~s_tag[(WAY_BITS-1):0] & (WAYS - 1); // Address bits above the index bits
+    assign s_cacheOp_sel    = 1 << s_cacheOp_way;
+    assign s_valid_e        = Set_Valid;
+    assign s_hits_e         = Set_Hit;
+    assign s_hit_e          = |Set_Hit;
+    assign s_hit_d          = |s_hits_d;
+    assign s_hit            = (using_delay_data) ? s_hit_d : s_hit_e;
+    assign s_dirty_e        = Set_Dirty;
+    assign s_evict_e        = (&Set_Valid) & ~s_hit_e;
+    assign s_dirty_evict_e  = s_evict_e & Set_Dirty[lru_victim];
+    assign delay_update     = ~new_request & (state == TAG_CHECK);
+    assign new_reqs_r       = new_request_r | pseudo_new_request_r | bg_retry_r | restart_r;
+    assign new_lookup_r     = new_request_r | bg_retry_r | restart_r;
+    assign s_victim_way_d   = (BG_FILL != 0) ? bg_way_d : s_fill_way_d;
+
+    // The hit way and its data, and the way to fill on a miss (the first invalid way, otherwise the LRU way)
+    integer w;
+    always @(*) begin
+        s_hit_way_e  = {WAY_BITS{1'b0}};
+        s_hit_data_e = Set_WordOut[31:0];
+        s_fill_way_e = lru_victim;
+        for (w = WAYS - 1; w >= 0; w = w - 1) begin
+            if (Set_Hit[w]) begin
+                s_hit_way_e  = w;
+                s_hit_data_e = Set_WordOut[(w*32)+:32];
+            end
+            if (~Set_Valid[w]) begin
+                s_fill_way_e = w;
+            end
+        end
+        if (bg_early) begin
+            s_hit_data_e = Set_WordOut[(mshr_way[mshr_match_sel]*32)+:32];
+        end
+    end
+
+    // The pipeline registers between request (r) and service (s) stages
+    DFF_SRE #(.WIDTH(1)) ff_s_read      (.clock(clock), .reset(reset), .enable(new_request), .D(r_read),      .Q(s_read));
+    DFF_SRE #(.WIDTH(4)) ff_s_write     (.clock(clock), .reset(reset), .enable(new_request), .D(r_write),     .Q(s_write));
+    DFF_SRE #(.WIDTH(1)) ff_s_DoCacheOp (.clock(clock), .reset(reset), .enable(new_request), .D(r_doCacheOp), .Q(s_doCacheOp));
+    DFF_E #(.WIDTH(10))       ff_s_vaddr          (.clock(clock), .enable(new_request),   .D(r_vaddr),          .Q(s_vaddr));
+    DFF_E #(.WIDTH(32))       ff_s_write_data     (.clock(clock), .enable(new_request),   .D(r_write_data),     .Q(s_write_data));
+    DFF_E #(.WIDTH(3))        ff_s_cacheOp        (.clock(clock), .enable(new_request),   .D(r_cacheOp),        .Q(s_cacheOp));
+    DFF_E #(.WIDTH(PABITS-8)) ff_s_cacheOpData    (.clock(clock), .enable(new_request),   .D(r_cacheOpData),    .Q(s_cacheOpData));
+    DFF_E #(.WIDTH(WAYS))     ff_s_valid_d        (.clock(clock), .enable(new_lookup_r),  .D(s_valid_e),        .Q(s_valid_d));
+    DFF_E #(.WIDTH(WAYS))     ff_s_hits_d         (.clock(clock), .enable(new_lookup_r),  .D(s_hits_e),         .Q(s_hits_d));
+    DFF_E #(.WIDTH(WAY_BITS)) ff_s_hit_way_d      (.clock(clock), .enable(new_lookup_r),  .D(s_hit_way_e),      .Q(s_hit_way_d));
+    DFF_E #(.WIDTH(1))        ff_s_evict_d        (.clock(clock), .enable(new_lookup_r),  .D(s_evict_e),        .Q(s_evict_d));
+    DFF_E #(.WIDTH(WAY_BITS)) ff_s_fill_way_d     (.clock(clock), .enable(new_lookup_r),  .D(s_fill_way_e),     .Q(s_fill_way_d));
+    DFF_E #(.WIDTH(32))       ff_s_hit_data_d     (.clock(clock), .enable(new_reqs_r),    .D(s_hit_data_e),     .Q(s_hit_data_d));
+    DFF_E #(.WIDTH(1))        ff_using_delay_data (.clock(clock), .enable(1'b1),          .D(delay_update),     .Q(using_delay_data));
+
+    // Uncacheable read data capture
+    DFF_E #(.WIDTH(32)) ff_s_uncacheable_data (.clock(clock), .enable((state == FILL_WAIT_1)), .D(DataIn_M), .Q(s_uncacheable_data));
+
+    // Writeback tag capture
+    reg [(TAG_BITS-1):0] s_index_tag_in;
+    always @(*) begin
+        if (state == TAG_CHECK) begin
+            if (s_doCacheOp) begin
+                case (s_cacheOp)
+                    `CacheOpD_Idx_WbInv:    s_index_tag_in <= Set_IndexTag[(s_cacheOp_way*TAG_BITS)+:TAG_BITS];
+                    default:                s_index_tag_in <= Set_IndexTag[(s_hit_way_e*TAG_BITS)+:TAG_BITS];
+                endcase
+            end
+            else begin
+                s_index_tag_in <= Set_IndexTag[(((BG_FILL != 0) ? bg_way : s_fill_way_e)*TAG_BITS)+:TAG_BITS];
+            end
+        end
+        else begin
+            s_index_tag_in <= {TAG_BITS{1'bx}};
+        end
+    end
+    DFF_E #(.WIDTH(TAG_BITS)) ff_s_index_tag (.clock(clock), .enable((state == TAG_CHECK)), .D(s_index_tag_in), .Q(s_index_tag));
+
+    // Shorthand signal aliases
+    assign cond_wb_idx_wbinv    = |(s_cacheOp_sel & s_valid_e & s_dirty_e);
+    assign cond_wb_adr_hwb      = |(s_hits_e & s_dirty_e);
+    assign cond_tagcheck_remain = Stall_C | r_read | r_write_any | r_doCacheOp;
+
+    // The signal 'new_request' indicates when the pipeline advances for a new request
+    always @(*) begin
+        if (~Stall_C & (r_read | r_write_any | r_doCacheOp)) begin
+            case (state)
+                IDLE:           new_request <= 1'b1;
+                TAG_CHECK:
+                    begin
+                        if (~PAddressValid_C) begin
+                            new_request <= 1'b1;
+                        end
+                        else if ((BG_FILL != 0) & bg_fence) begin
+                            new_request <= 1'b0;
+                        end
+                        else if (s_doCacheOp) begin
+                            case (s_cacheOp)
+                                `CacheOpD_Idx_WbInv:    new_request <= 1'b0;
+                                `CacheOpD_Adr_HInv:     new_request <= 1'b0;
+                                `CacheOpD_Adr_HWbInv:   new_request <= 1'b0;
+                                `CacheOpD_Adr_HWb:      new_request <= 1'b0;
+                                default:                new_request <= 1'b0;
+                            endcase
+                        end
+                        else begin
+                            new_request <= (s_hit | bg_early) & ~s_write_any;
+                        end
+                    end
+                WRITE_RECOVER:  new_request <= 1'b1;
+                WRITEBACK:      new_request <= ~WB_Full & ~s_doCacheOp & s_uncacheable;
+                FILL_WAIT_1:    new_request <= er_ready | (er_done & ~er_pending);
+                FILL_WAIT_2:    new_request <= er_ready | (er_done & ~er_pending);
+                FILL_WAIT_3:    new_request <= er_ready | (er_done & ~er_pending);
+                FILL_WAIT_4:    new_request <= er_ready | (er_done & ~er_pending);
+                FILL_WAIT_WORD: new_request <= 1'b1;
+                READ_WAIT:      new_request <= 1'b1;
+                default:        new_request <= 1'b0;
+            endcase
+        end
+        else begin
+            new_request <= 1'b0;
+        end
+    end
+
+    // One cycle delay of a new request
+    always @(posedge clock) begin
+        new_request_r <= (reset) ? 1'b0 : new_request;
+    end
+
+    // A re-request after a fill
+    always @(posedge clock) begin
+        pseudo_new_request_r <= (reset) ? 1'b0 : ((state == FILL_WAIT_4) & f_ready);
+    end
+
+    // A re-request after waiting on an MSHR (see the MSHR_WAIT state)
+    always @(posedge clock) begin
+        bg_retry_r <= (reset) ? 1'b0 : ((state == MSHR_WAIT) & ~(bg_retire & (mshr_index[mshr_retire_sel] != s_index)));
+    end
+
+    // A re-request of a request accepted during a fill (see the FILL_RESTART state)
+    always @(posedge clock) begin
+        restart_r <= (reset) ? 1'b0 : (state == FILL_RESTART);
+    end
+
+    // Ready signal to the processor
+    always @(*) begin
+        case (state)
+            TAG_CHECK:
+                begin
+                    if (~PAddressValid_C) begin
+                        ready <= 1'b1;
+                    end
+                    else if (s_doCacheOp) begin
+                        case (s_cacheOp)
+                            `CacheOpD_Idx_WbInv:    ready <= 1'b0;
+                            `CacheOpD_Adr_HInv:     ready <= 1'b0;
+                            `CacheOpD_Adr_HWbInv:   ready <= 1'b0;
+                            `CacheOpD_Adr_HWb:      ready <= 1'b0;
+                            default:                ready <= 1'b0;
+                        endcase
+                    end
+                    else begin
+                        ready <= (s_hit | bg_early) & ~s_uncacheable & ~s_write_any; // Assumes stalls hold CacheAttr_C
+                    end
+                end
+            WRITE_RECOVER:  ready <= 1'b1;
+            WRITEBACK:      ready <= ~WB_Full & ~s_doCacheOp & s_uncacheable;
+            FILL_WAIT_1:    ready <= er_ready;
+            FILL_WAIT_2:    ready <= er_ready;
+            FILL_WAIT_3:    ready <= er_ready;
+            FILL_WAIT_4:    ready <= er_ready;
+            FILL_WAIT_WORD: ready <= 1'b1;
+            READ_WAIT:      ready <= 1'b1;
+            default:        ready <= 1'b0;
+        endcase
+    end
+
+    // Cache state machine
+    always @(posedge clock) begin
+        if (reset) begin
+            state <= IDLE;
+        end
+        else begin
+            case (state)
+                IDLE:
+                    begin
+                        state <= (Stall_C | ~(r_read | r_write_any | r_doCacheOp)) ? IDLE : TAG_CHECK;
+                    end
+                TAG_CHECK:
+                    begin
+                        if (~PAddressValid_C) begin
+                            // TLB miss, flush; do nothing
+                            state <= (cond_tagcheck_remain) ? TAG_CHECK : IDLE;
+                        end
+                        else if ((BG_FILL != 0) & bg_fence) begin
+                            // Uncacheable access or cache operation; wait for all MSHRs to retire
+                            state <= MSHR_WAIT;
+                        end
+                        else if (s_doCacheOp) begin
+                            case (s_cacheOp)
+                                `CacheOpD_Idx_WbInv:
+                                    begin
+                                        state <= (cond_wb_idx_wbinv) ? WRITEBACK : WRITE_RECOVER;
+                                    end
+                                `CacheOpD_Idx_STag:
+                                    begin
+                                        state <= WRITE_RECOVER;
+                                    end
+                                `CacheOpD_Adr_HInv:
+                                    begin
+                                        state <= WRITE_RECOVER;
+                                    end
+                                `CacheOpD_Adr_HWbInv:
+                                    begin
+                                        state <= (cond_wb_adr_hwb) ? WRITEBACK : WRITE_RECOVER;
+                                    end
+                                `CacheOpD_Adr_HWb:
+                                    begin
+                                        state <= (cond_wb_adr_hwb) ? WRITEBACK : WRITE_RECOVER;
+                                    end
+                                default:
+                                    begin
+                                        state <= WRITE_RECOVER;
+                                    end
+                            endcase
+                        end
+                        else begin
+                            if (s_uncacheable) begin
+                                // Uncacheable Read/Write
+                                state <= (s_read) ? FILL : WRITEBACK;
+                            end
+                            else if (s_hit | bg_early) begin
+                                // Read/Write hit, or a load served early from a line being filled
+                                state <= (s_write_any) ? WRITE_RECOVER : ((cond_tagcheck_remain) ? TAG_CHECK : IDLE);
+                            end
+                            else if (BG_FILL != 0) begin
+                                if (bg_merge) begin
+                                    // Store miss to a line being filled; merge
+                                    state <= WRITE_RECOVER;
+                                end
+                                else if (bg_alloc) begin
+                                    // Read/Write miss; allocate an MSHR. Writes complete now, reads wait for the fill
+                                    state <= (s_write_any) ? WRITE_RECOVER : MSHR_WAIT;
+                                end
+                                else if (bg_evict) begin
+                                    // Read/Write miss; dirty data. Write back, then allocate
+                                    state <= WRITEBACK;
+                                end
+                                else begin
+                                    // Read miss to a line being filled, or no MSHR or way is available
+                                    state <= MSHR_WAIT;
+                                end
+                            end
+                            else if (s_dirty_evict_e) begin
+                                // Read/Write miss; dirty data
+                                state <= WRITEBACK;
+                            end
+                            else begin
+                                // Read/Write miss; clean/invalid data
+                                state <= FILL;
+                            end
+                        end
+                    end
+                WRITE_RECOVER:
+                    begin
+                        state <= (Stall_C) ? WRITE_RECOVER : ((r_read | r_write_any | r_doCacheOp) ? TAG_CHECK : IDLE);
+                    end
+                WRITEBACK:
+                    begin
+                        if (WB_Full) begin
+                            // Wait if the write buffer is full
+                            state <= WRITEBACK;
+                        end
+                        else if (s_doCacheOp) begin
+                            // CacheOp writeback-then-invalidate or standalone writeback
+                            state <= WRITE_RECOVER;
+                        end
+                        else if (s_uncacheable) begin
+                            // Uncacheable write
+                            state <= (Stall_C) ? WRITEBACK : ((r_read | r_write_any | r_doCacheOp) ? TAG_CHECK : IDLE);
+                        end
+                        else if (BG_FILL != 0) begin
+                            // Writeback before an MSHR allocation (waits if a fill word used the line port)
+                            state <= (lineout_ok) ? MSHR_WAIT : WRITEBACK;
+                        end
+                        else begin
+                            // Cacheable writeback-then-fill (assumed s_read | s_write_any)
+                            state <= FILL;
+                        end
+                    end
+                FILL:
+                    begin
+                        // Wait for the write buffer to drain and for any prefetch to finish
+                        state <= (f_start) ? FILL_WAIT_1 : FILL;
+                    end
+                FILL_WAIT_1:
+                    begin
+                        state <= (f_ready) ? ((s_uncacheable) ? FILL_WAIT_WORD : FILL_WAIT_2) : FILL_WAIT_1;
+                    end
+                FILL_WAIT_2:
+                    begin
+                        state <= (f_ready) ? FILL_WAIT_3 : FILL_WAIT_2;
+                    end
+                FILL_WAIT_3:
+                    begin
+                        state <= (f_ready) ? FILL_WAIT_4 : FILL_WAIT_3;
+                    end
+                FILL_WAIT_4:
+                    // TODO this state can be optimized for writes
+                    begin
+                        if (~f_ready) begin
+                            state <= FILL_WAIT_4;
+                        end
+                        else if (er_pending | new_request) begin
+                            // The load completed early and a new request was accepted; look it up again
+                            state <= FILL_RESTART;
+                        end
+                        else if (er_done | (er_ready & ~Stall_C)) begin
+                            // The load completed early and there is no new request
+                            state <= IDLE;
+                        end
+                        else begin
+                            // We can't go directly to TAG_CHECK if the core is stalled since it will initiate a new read
+                            state <= (Stall_C) ? READ_WAIT : TAG_CHECK;
+                        end
+                    end
+                FILL_RESTART:
+                    begin
+                        // The set memory is read at the request index; the lookup follows
+                        state <= TAG_CHECK;
+                    end
+                READ_WAIT:
+                    begin
+                        // A holding state when fills are done but the core is stalled. Prevents extra fills
+                        state <= (Stall_C) ? READ_WAIT : ((r_read | r_write_any | r_doCacheOp) ? TAG_CHECK : IDLE);
+                    end
+                FILL_WAIT_WORD:
+                    begin
+                        state <= (Stall_C) ? FILL_WAIT_WORD : ((r_read | r_write_any | r_doCacheOp) ? TAG_CHECK : IDLE);
+                    end
+                MSHR_WAIT:
+                    begin
+                        // Retry the request. A retirement uses the tag memory port, so the lookup must
+                        // be repeated unless the retired line is at the same index.
+                        state <= (bg_retire & (mshr_index[mshr_retire_sel] != s_index)) ? MSHR_WAIT : TAG_CHECK;
+                    end
+                default:
+                    begin
+                        state <= IDLE;
+                    end
+            endcase
+        end
+    end
+
+    // LRU Logic : Update the specified line's replacement state when accessed
+    always @(*) begin
+        if ((BG_FILL != 0) & bg_miss) begin
+            lru_way = bg_way;
+        end
+        else if ((using_delay_data & s_evict_d) | (~using_delay_data & s_evict_e)) begin
+            lru_way = (using_delay_data) ? s_fill_way_d : s_fill_way_e;
+        end
+        else begin
+            lru_way = (using_delay_data) ? s_hit_way_d : s_hit_way_e;
+        end
+    end
+
+    integer i;
+    initial begin
+        // Initialize all to zero
+        for (i=0; i<SETS; i=i+1) begin
+            lru[i] <= {LRU_BITS{1'b0}};
+        end
+    end
+    always @(posedge clock) begin
+        if (reset) begin
+            // Reset state doesn't matter in synthesis but helps with simulation
+            for (i=0; i<SETS; i=i+1) begin
+                lru[i] <= {LRU_BITS{1'b0}};
+            end
+        end
+        else if ((state == TAG_CHECK) & ~Stall_C & PAddressValid_C) begin
+            if (s_doCacheOp & (s_cacheOp == `CacheOpD_Idx_STag)) begin
+                // Cache instruction: Store tag
+                lru[s_index] <= {LRU_BITS{1'b0}}; // not implemented
+            end
+            else if ((BG_FILL != 0) & bg_miss) begin
+                // Background fill miss: Only an MSHR allocation uses the line (other misses are retried)
+                lru[s_index] <= (bg_alloc) ? lru_touched : lru[s_index];
+            end
+            else if ((using_delay_data & (s_evict_d | s_hit_d)) | (~using_delay_data & (s_evict_e | s_hit_e))) begin
+                // Evict, or read or write hit
+                lru[s_index] <= lru_touched;
+            end
+            else begin
+                lru[s_index] <= lru[s_index];
+            end
+        end
+        else begin
+            lru[s_index] <= lru[s_index];
+        end
+    end
+
+    PseudoLRU #(
+        .WAYS     (WAYS))
+        LRU (
+        .State    (lru[s_index]),
+        .Way      (lru_way),
+        .Victim   (lru_victim),
+        .Touched  (lru_touched)
+    );
+
+    // Background fill mode: MSHR lookup and allocation (all decisions are for the TAG_CHECK state)
+    assign mshr_at_index[0]  = mshr_valid[0] & (mshr_index[0] == s_index);
+    assign mshr_at_index[1]  = mshr_valid[1] & (mshr_index[1] == s_index);
+    assign mshr_match[0]     = mshr_at_index[0] & (mshr_tag[0] == s_tag);
+    assign mshr_match[1]     = mshr_at_index[1] & (mshr_tag[1] == s_tag);
+    assign mshr_match_sel    = mshr_match[1];
+    assign mshr_alloc_sel    = mshr_valid[0];
+    assign bg_victim_valid   = Set_Valid[bg_way];
+    assign bg_victim_dirty   = bg_victim_valid & Set_Dirty[bg_way];
+    assign bg_fence          = (s_uncacheable | s_doCacheOp) & (mshr_valid != 2'b00);
+    assign bg_miss           = ~s_uncacheable & ~s_doCacheOp & ~s_hit;
+    assign bg_merge_conflict = bg_fill_beat & (fill_entry == mshr_match_sel) & (DataInOffset_M == s_vaddr[1:0]);
+    assign bg_merge          = bg_miss & (mshr_match != 2'b00) & s_write_any & ~bg_merge_conflict;
+    assign bg_can_alloc      = bg_miss & (mshr_match == 2'b00) & (mshr_valid != 2'b11) & ~(&bg_busy);
+    assign bg_alloc          = bg_can_alloc & ~bg_victim_dirty;
+    assign bg_evict          = bg_can_alloc &  bg_victim_dirty;
+    assign bg_tag_check      = (BG_FILL != 0) & (state == TAG_CHECK) & PAddressValid_C;
+    assign bg_store_way      = (bg_merge) ? mshr_way[mshr_match_sel] : bg_way;
+    assign bg_early          = (BG_FILL != 0) & (EARLY_RESTART != 0) & bg_miss & s_read & ~s_write_any & ~using_delay_data &
+                               (mshr_match != 2'b00) & mshr_words[mshr_match_sel][s_vaddr[1:0]];
+    assign bg_merge_mask     = {12'h000, s_write} << {s_vaddr[1:0], 2'b00};
+
+    // Ways with a fill in progress at this index are not replaced; the normal victim is used if it is free
+    integer k;
+    always @(*) begin
+        bg_busy = {WAYS{1'b0}};
+        for (k = 0; k < 2; k = k + 1) begin
+            if (mshr_at_index[k]) begin
+                bg_busy = bg_busy | (1 << mshr_way[k]);
+            end
+        end
+        bg_way = s_fill_way_e;
+        if (bg_busy[s_fill_way_e]) begin
+            for (k = WAYS - 1; k >= 0; k = k - 1) begin
+                if (~bg_busy[k]) begin
+                    bg_way = k;
+                end
+            end
+        end
+    end
+
+    DFF_E #(.WIDTH(WAY_BITS)) ff_bg_way_d (.clock(clock), .enable((state == TAG_CHECK)), .D(bg_way), .Q(bg_way_d));
+
+    // Background fill mode: Line fills (oldest first) and retirement
+    assign bg_fill_next    = (mshr_valid[mshr_older] & ~mshr_filled[mshr_older]) ? mshr_older : ~mshr_older;
+    assign mshr_fill_sel   = (fill_busy) ? fill_entry : bg_fill_next;
+    assign mshr_retire_sel = (mshr_valid[mshr_older] & mshr_filled[mshr_older]) ? mshr_older : ~mshr_older;
+    assign fill_mask       = mshr_mask[fill_entry];
+    assign bg_fill_issue   = (BG_FILL != 0) & mshr_valid[bg_fill_next] & ~mshr_filled[bg_fill_next] & ~fill_busy & WB_Empty;
+    assign bg_fill_beat    = fill_busy & Ready_M;
+    assign bg_fill_done    = bg_fill_beat & (fill_count == 2'b11);
+    assign bg_retire       = ((mshr_valid & mshr_filled) != 2'b00) & ((state == MSHR_WAIT) | ((state == IDLE) & ~new_request));
+
+    integer j;
+    always @(posedge clock) begin
+        if (reset) begin
+            mshr_valid  <= 2'b00;
+            mshr_filled <= 2'b00;
+        end
+        else begin
+            for (j=0; j<2; j=j+1) begin
+                if (bg_tag_check & bg_alloc & (mshr_alloc_sel == j)) begin
+                    mshr_valid[j]  <= 1'b1;
+                    mshr_filled[j] <= 1'b0;
+                end
+                else if (bg_retire & (mshr_retire_sel == j)) begin
+                    mshr_valid[j]  <= 1'b0;
+                    mshr_filled[j] <= 1'b0;
+                end
+                else if (bg_fill_done & (fill_entry == j)) begin
+                    mshr_filled[j] <= 1'b1;
+                end
+            end
+        end
+    end
+
+    always @(posedge clock) begin
+        if (bg_tag_check & bg_alloc) begin
+            mshr_way[mshr_alloc_sel]    <= bg_way;
+            mshr_tag[mshr_alloc_sel]    <= s_tag;
+            mshr_index[mshr_alloc_sel]  <= s_index;
+            mshr_offset[mshr_alloc_sel] <= s_vaddr[1:0];
+            mshr_mask[mshr_alloc_sel]   <= bg_merge_mask;
+        end
+        else if (bg_tag_check & bg_merge) begin
+            mshr_mask[mshr_match_sel]   <= mshr_mask[mshr_match_sel] | bg_merge_mask;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset) begin
+            mshr_older <= 1'b0;
+        end
+        else if (bg_tag_check & bg_alloc) begin
+            mshr_older <= (mshr_valid[~mshr_alloc_sel]) ? ~mshr_alloc_sel : mshr_alloc_sel;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset) begin
+            fill_busy  <= 1'b0;
+            fill_count <= 2'b00;
+        end
+        else if (bg_fill_issue) begin
+            fill_busy  <= 1'b1;
+            fill_entry <= bg_fill_next;
+            fill_count <= 2'b00;
+        end
+        else if (bg_fill_beat) begin
+            fill_busy  <= ~bg_fill_done;
+            fill_count <= fill_count + 1'b1;
+        end
+    end
+
+    always @(posedge clock) begin
+        lineout_ok <= (reset) ? 1'b1 : ~bg_fill_beat;
+    end
+
+    // Background fill mode: Fill words which can be read from the set data memory (for early restart)
+    always @(posedge clock) begin
+        fill_beat_r   <= (reset) ? 1'b0 : bg_fill_beat;
+        fill_offset_r <= DataInOffset_M;
+        fill_entry_r  <= fill_entry;
+    end
+
+    always @(posedge clock) begin
+        for (j=0; j<2; j=j+1) begin
+            if (bg_tag_check & bg_alloc & (mshr_alloc_sel == j)) begin
+                mshr_words[j] <= 4'b0000;
+            end
+            else if (fill_beat_r & (fill_entry_r == j)) begin
+                mshr_words[j] <= mshr_words[j] | (4'b0001 << fill_offset_r);
+            end
+        end
+    end
+
+    // Blocking mode: Line fill address and way, and early restart
+    assign f_tag      = f_addr[(PABITS-3):(INDEX_BITS+2)];
+    assign f_index    = f_addr[(INDEX_BITS+1):2];
+    assign f_wait     = (state == FILL_WAIT_1) | (state == FILL_WAIT_2) | (state == FILL_WAIT_3) | (state == FILL_WAIT_4);
+    assign f_line     = f_wait & ~((state == FILL_WAIT_1) & s_uncacheable);
+    assign f_validate = (state == FILL_WAIT_4) & f_ready;
+    assign er_capture = (EARLY_RESTART != 0) & f_ready & s_read & ~s_write_any & ~s_uncacheable & ~er_ready & ~er_done &
+                        (f_offset == s_vaddr[1:0]) & ((state == FILL_WAIT_1) | (state == FILL_WAIT_2) | (state == FILL_WAIT_3));
+    assign f_start    = (state == FILL) & WB_Empty & ~pf_busy;
+    assign f_step     = state - FILL_WAIT_1;
+    assign f_ready    = (f_pf) ? 1'b1 : Ready_M;
+    assign f_offset   = (f_pf) ? (f_addr[1:0] + f_step[1:0]) : DataInOffset_M;
+    assign f_data     = (f_pf) ? pf_buf[(f_offset*32)+:32] : DataIn_M;
+
+    always @(posedge clock) begin
+        if (state == FILL) begin
+            f_addr <= s_paddr;
+            f_way  <= s_fill_way_d;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset) begin
+            f_pf <= 1'b0;
+        end
+        else if (state == FILL) begin
+            f_pf <= pf_use;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset | f_validate) begin
+            er_ready   <= 1'b0;
+            er_done    <= 1'b0;
+            er_pending <= 1'b0;
+        end
+        else begin
+            if (er_capture) begin
+                er_ready <= 1'b1;
+            end
+            else if (er_ready & ~Stall_C) begin
+                er_ready <= 1'b0;
+                er_done  <= 1'b1;
+            end
+            if (f_wait & new_request) begin
+                er_pending <= 1'b1;
+            end
+        end
+    end
+
+    always @(posedge clock) begin
+        if (er_capture) begin
+            er_data <= f_data;
+        end
+    end
+
+    // Prefetcher: Reference prediction table. An entry is replaced by any PC which maps to it.
+    assign rpt_index  = PC_C[(RPT_BITS+1):2];
+    assign rpt_pc_tag = PC_C[(RPT_BITS+RPT_TAG+1):(RPT_BITS+2)];
+    assign rpt_hit    = rpt_valid[rpt_index] & (rpt_tag[rpt_index] == rpt_pc_tag);
+    assign rpt_delta  = s_paddr - rpt_last[rpt_index];
+    assign rpt_fits   = (&rpt_delta[(PABITS-3):11]) | ~(|rpt_delta[(PABITS-3):11]);
+    assign pf_train   = (PF_ON != 0) & new_request_r & PAddressValid_C & ~s_uncacheable & ~s_doCacheOp & (s_read | s_write_any);
+
+    always @(posedge clock) begin
+        if (reset) begin
+            for (i=0; i<RPT_ENTRIES; i=i+1) begin
+                rpt_valid[i] <= 1'b0;
+            end
+        end
+        else if (pf_train) begin
+            rpt_valid[rpt_index]  <= 1'b1;
+            rpt_tag[rpt_index]    <= rpt_pc_tag;
+            rpt_last[rpt_index]   <= s_paddr;
+            rpt_stride[rpt_index] <= (rpt_hit & rpt_fits) ? rpt_delta[11:0] : 12'h000;
+            rpt_steady[rpt_index] <= rpt_hit & rpt_fits & (rpt_delta[11:0] == rpt_stride[rpt_index]) & (rpt_delta[11:0] != 12'h000);
+        end
+    end
+
+    // Prefetcher: On a line fill for a steady stride, request the line of the next access (the table was
+    // updated when the access was first serviced). Small strides request the adjacent line.
+    assign pf_stride  = rpt_stride[rpt_index];
+    assign pf_small   = (pf_stride[11:2] == 10'h000) | (pf_stride[11:2] == 10'h3ff);
+    assign pf_target  = (pf_small) ? (s_paddr[(PABITS-3):2] + ((pf_stride[11]) ? {(PABITS-4){1'b1}} : {{(PABITS-5){1'b0}}, 1'b1})) :
+                                     ((s_paddr + {{(PABITS-14){pf_stride[11]}}, pf_stride}) >> 2);
+    assign pf_trigger = (PF_ON != 0) & f_start & ~s_uncacheable & rpt_hit & rpt_steady[rpt_index];
+    assign pf_issue   = (PF_ON != 0) & pf_req & ~pf_busy & WB_Empty & (state != FILL) & (state != WRITEBACK) & ~f_wait;
+    assign pf_beat    = pf_busy & Ready_M;
+    assign pf_done    = pf_beat & (pf_count == 2'b11);
+    assign pf_stale   = WB_EnQ & (WB_DataIn[((PABITS-5)+129):129] == pf_line);
+    assign pf_use     = (PF_ON != 0) & f_start & ~s_uncacheable & pf_valid & (pf_line == s_paddr[(PABITS-3):2]);
+
+    always @(posedge clock) begin
+        if (reset | pf_issue) begin
+            pf_req  <= 1'b0;
+        end
+        else if (pf_trigger) begin
+            // Only within the page, and not if the line is already buffered
+            pf_req  <= (pf_target[(PABITS-5):8] == s_paddr[(PABITS-3):10]) & ~(pf_valid & ~pf_use & (pf_line == pf_target));
+            pf_next <= pf_target;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset) begin
+            pf_busy  <= 1'b0;
+            pf_count <= 2'b00;
+        end
+        else if (pf_issue) begin
+            pf_busy  <= 1'b1;
+            pf_count <= 2'b00;
+        end
+        else if (pf_beat) begin
+            pf_busy  <= ~pf_done;
+            pf_count <= pf_count + 1'b1;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (pf_issue) begin
+            pf_line <= pf_next;
+        end
+        if (pf_beat) begin
+            pf_buf[(DataInOffset_M*32)+:32] <= DataIn_M;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset | pf_issue | pf_use | pf_stale) begin
+            pf_valid <= 1'b0;
+        end
+        else if (pf_done & ~pf_killed) begin
+            pf_valid <= 1'b1;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset | pf_issue) begin
+            pf_killed <= 1'b0;
+        end
+        else if (pf_busy & pf_stale) begin
+            pf_killed <= 1'b1;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset) begin
+            pf_issued <= {32{1'b0}};
+            pf_useful <= {32{1'b0}};
+            pf_misses <= {32{1'b0}};
+        end
+        else begin
+            pf_issued <= (pf_issue) ? (pf_issued + 1'b1) : pf_issued;
+            pf_useful <= (pf_use)   ? (pf_useful + 1'b1) : pf_useful;
+            pf_misses <= ((f_start & ~s_uncacheable & ~pf_use) | bg_fill_issue) ? (pf_misses + 1'b1) : pf_misses;
+        end
+    end
+
+    // One set module per way, with its commands
+    genvar g;
+    generate
+        for (g = 0; g < WAYS; g = g + 1) begin : way
+            assign Set_WriteWord[(g*4)+:4] = (PAddressValid_C & s_hits_e[g] & ((state == TAG_CHECK) | (f_validate & s_write_any & ~er_done))) ? s_write : 4'h0;
+            assign Set_MergeWord[(g*4)+:4] = (bg_tag_check & (bg_merge | bg_alloc) & (bg_store_way == g)) ? s_write : 4'h0;
+            assign Set_ValidateLine[g]     = f_validate & (f_way == g);
+            assign Set_FillLine[g]         = (BG_FILL != 0) ? (bg_fill_beat & (mshr_way[fill_entry] == g)) : &{f_ready, WB_Empty, (f_way == g), f_line};
+            assign Set_StoreTag[g]         = ((state == TAG_CHECK) & PAddressValid_C & s_doCacheOp & (s_cacheOp == `CacheOpD_Idx_STag) & s_cacheOp_sel[g]) | (bg_retire & (mshr_way[mshr_retire_sel] == g));
+
+            Set_RW #(
+                .PABITS          (PABITS),
+                .INDEX_BITS      (INDEX_BITS))
+                Set (
+                .clock           (clock),
+                .reset           (reset),
+                .Tag             (Set_Tag),
+                .Index           (Set_Index),
+                .Offset          (Set_Offset),
+                .LineIndex       (Set_LineIndex),
+                .LineOffset      (f_offset),
+                .WordIn          (s_write_data),
+                .WordOut         (Set_WordOut[(g*32)+:32]),
+                .Hit             (Set_Hit[g]),
+                .Valid           (Set_Valid[g]),
+                .Dirty           (Set_Dirty[g]),
+                .IndexTag        (Set_IndexTag[(g*TAG_BITS)+:TAG_BITS]),
+                .LineIn          (f_data),
+                .LineOut         (Set_LineOut[(g*128)+:128]),
+                .WriteWord       (Set_WriteWord[(g*4)+:4]),
+                .MergeWord       (Set_MergeWord[(g*4)+:4]),
+                .ValidateLine    (Set_ValidateLine[g]),
+                .InvalidateLine  (Set_InvalidateLine[g]),
+                .FillLine        (Set_FillLine[g]),
+                .FillSkip        (Set_FillSkip),
+                .StoreTag        (Set_StoreTag[g]),
+                .StoreTagData    (Set_StoreTagData)
+            );
+        end
+    endgenerate
+
+    // The FIFO normally holds the line address and line data.
+    // However, uncacheable writes form a word address,
+    // byte-enable bits, and word data.
+    FIFO #(
+        .DATA_WIDTH  (((PABITS-5)+129+1)),
+        .ADDR_WIDTH  (2))
+        WriteBuffer (
+        .clock     (clock),
+        .reset     (reset),
+        .enQ       (WB_EnQ),
+        .deQ       (WB_DeQ),
+        .data_in   (WB_DataIn),
+        .data_out  (WB_DataOut),
+        .empty     (WB_Empty),
+        .full      (WB_Full)
+    );
+
+endmodule
+
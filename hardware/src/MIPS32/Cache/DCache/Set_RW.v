@@ -1,6 +1,6 @@
 `timescale 1ns / 1ps
 /*
- * File         : Set_RW_128x64.v
+ * File         : Set_RW.v
  * Project      : XUM MIPS32 cache enhancement
  * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
  *
@@ -16,33 +16,38 @@
  *   Each set behaves as a direct-mapped cache and is controlled by
  *   an encapsulating cache module through a simple command interface.
  *   See in-source documentation below for more details.
+ *
+ *   A set holds 2^INDEX_BITS lines of 16 bytes. The default (64 lines, 1 KiB)
+ *   uses the Xilinx BRAM core; other sizes use an inferred memory.
  */
-module Set_RW_128x64 #(parameter PABITS=36) (
+module Set_RW #(parameter PABITS=36, parameter INDEX_BITS=6) (
     input clock,
     input reset,
     // Indexing Signals
-    input  [(PABITS-11):0] Tag,             // Bits [35:10] of the 36-bit physical address.
-    input  [5:0]           Index,           // Bits [9:4] of the 32-bit virtual / 36-bit physical address.
-    input  [1:0]           Offset,          // Bits [3:2] of the 32-bit virtual / 36-bit physical address.
-    input  [5:0]           LineIndex,       // Fill and Writeback index.
-    input  [1:0]           LineOffset,      // Bits [3:2] of 32-bit byte address during a fill.
+    input  [(PABITS-INDEX_BITS-5):0]  Tag,             // Bits [35:(INDEX_BITS+4)] of the 36-bit physical address.
+    input  [(INDEX_BITS-1):0]         Index,           // Bits [(INDEX_BITS+3):4] of the 32-bit virtual / 36-bit physical address.
+    input  [1:0]                      Offset,          // Bits [3:2] of the 32-bit virtual / 36-bit physical address.
+    input  [(INDEX_BITS-1):0]         LineIndex,       // Fill and Writeback index.
+    input  [1:0]                      LineOffset,      // Bits [3:2] of 32-bit byte address during a fill.
     // Word Data (Processor)
-    input  [31:0]          WordIn,          // Store data from processor.
-    output [31:0]          WordOut,         // Load data for processor.
-    output                 Hit,             // Cacheline was a hit (one-cycle delay).
-    output                 Valid,           // Cacheline was valid (one-cycle delay).
-    output                 Dirty,           // Cacheline was dirty (one-cycle delay).
-    output [(PABITS-11):0] IndexTag,        // Tag at 'Index' used for writebacks (one-cycle delay).
+    input  [31:0]                     WordIn,          // Store data from processor.
+    output [31:0]                     WordOut,         // Load data for processor.
+    output                            Hit,             // Cacheline was a hit (one-cycle delay).
+    output                            Valid,           // Cacheline was valid (one-cycle delay).
+    output                            Dirty,           // Cacheline was dirty (one-cycle delay).
+    output [(PABITS-INDEX_BITS-5):0]  IndexTag,        // Tag at 'Index' used for writebacks (one-cycle delay).
     // Line Data (Memory)
-    input  [31:0]          LineIn,          // One word of memory data to fill the cache. Occurs in groups of four.
-    output [127:0]         LineOut,         // A cacheline of data to be written to memory.
+    input  [31:0]                     LineIn,          // One word of memory data to fill the cache. Occurs in groups of four.
+    output [127:0]                    LineOut,         // A cacheline of data to be written to memory.
     // Commands
-    input  [3:0]           WriteWord,       // Writes a subset of a 32-bit word from the processor to the cache.
-    input                  ValidateLine,    // Writes the tag entry and sets 'Valid' (no actual loading).
-    input                  InvalidateLine,  // Clears 'Valid' bit of the cacheline.
-    input                  FillLine,        // Pulse indicating the line word 'LineIn' at 'LineOffset' should be written.
-    input                  StoreTag,        // Writes 'StoreTagData' to the index specified by 'Index'
-    input  [(PABITS-9):0]  StoreTagData     // Data for StoreTag operation (PABITS-9:2->Tag, 1:0->Valid/Dirty)
+    input  [3:0]                      WriteWord,       // Writes a subset of a 32-bit word from the processor to the cache.
+    input  [3:0]                      MergeWord,       // Writes a subset of a 32-bit word from the processor without touching the tag entry.
+    input                             ValidateLine,    // Writes the tag entry and sets 'Valid' (no actual loading).
+    input                             InvalidateLine,  // Clears 'Valid' bit of the cacheline.
+    input                             FillLine,        // Pulse indicating the line word 'LineIn' at 'LineOffset' should be written.
+    input  [3:0]                      FillSkip,        // Bytes of the fill word 'LineIn' which are not written (already merged).
+    input                             StoreTag,        // Writes 'StoreTagData' to the index specified by 'Index'
+    input  [(PABITS-INDEX_BITS-3):0]  StoreTagData     // Data for StoreTag operation (PABITS-INDEX_BITS-3:2->Tag, 1:0->Valid/Dirty)
     );
 
     /* Operational Description
@@ -78,6 +83,11 @@ module Set_RW_128x64 #(parameter PABITS=36) (
      *     the line is valid before using this command. The write will be visible
      *     after one clock cycle.
      *
+     *   MergeWord:
+     *     Like WriteWord, but only the data memory is written. This is used to
+     *     merge processor stores into a line whose fill is still outstanding,
+     *     i.e., whose tag entry is not yet valid.
+     *
      *   ValidateLine:
      *     Write the tag specified by 'Tag' to the index specified by 'Index' and
      *     set the valid bit.
@@ -87,38 +97,42 @@ module Set_RW_128x64 #(parameter PABITS=36) (
      *
      *   FillLine:
      *     Write the 32-bit word 'LineIn' to the index specified by 'LineIndex' at
-     *     the offset specified by 'LineOffset'.
+     *     the offset specified by 'LineOffset'. Bytes set in 'FillSkip' are
+     *     not written.
      *
      *   StoreTag:
      *     Write the valid bit and tag from 'StoreTagData[22]' and 'StoreTagData[21:0]'
      *     (respectively) to the index specified by 'Index'.
      */
 
+    localparam TAG_BITS = PABITS - INDEX_BITS - 4;
+
     // Tag & Flag RAM signals
-    wire [5:0] TR_Index;
-    wire [(PABITS-11):0] TR_Tag_Cmp;
-    wire [(PABITS-11):0] TR_Tag_Set;
+    wire [(INDEX_BITS-1):0] TR_Index;
+    wire [(TAG_BITS-1):0] TR_Tag_Cmp;
+    wire [(TAG_BITS-1):0] TR_Tag_Set;
     wire TR_Write;
     wire TR_SetValid;
     wire TR_SetDirty;
-    wire [(PABITS-11):0] TR_MatchTag;
+    wire [(TAG_BITS-1):0] TR_MatchTag;
     wire TR_MatchHit;
     wire TR_MatchValid;
     wire TR_MatchDirty;
 
     // Data RAM signals
     wire [3:0]   DR_WriteA;
-    wire [7:0]   DR_AddrA;
+    wire [(INDEX_BITS+1):0] DR_AddrA;
     wire [31:0]  DR_DataInA;
     wire [31:0]  DR_DataOutA;
     wire [15:0]  DR_WriteB;
-    wire [5:0]   DR_AddrB;
+    wire [(INDEX_BITS-1):0] DR_AddrB;
     wire [127:0] DR_DataInB;
     wire [127:0] DR_DataOutB;
 
     // Local signals
     reg  [15:0] fill_we;
     reg  [127:0] fill_din;
+    wire [3:0]   fill_word_we;
     wire write_word_any;
     wire tag_write;
     wire tag_valid;
@@ -136,13 +150,13 @@ module Set_RW_128x64 #(parameter PABITS=36) (
     // Tag & Flag RAM assignments
     assign TR_Index    = Index;
     assign TR_Tag_Cmp  = Tag;
-    assign TR_Tag_Set  = (StoreTag) ? StoreTagData[(PABITS-9):2] : Tag;
+    assign TR_Tag_Set  = (StoreTag) ? StoreTagData[(TAG_BITS+1):2] : Tag;
     assign TR_Write    = tag_write;
     assign TR_SetValid = tag_valid;
     assign TR_SetDirty = tag_dirty;
 
     // Data RAM assignments
-    assign DR_WriteA  = WriteWord;
+    assign DR_WriteA  = WriteWord | MergeWord;
     assign DR_AddrA   = {Index, Offset};
     assign DR_DataInA = WordIn;
     assign DR_WriteB  = fill_we;
@@ -156,17 +170,19 @@ module Set_RW_128x64 #(parameter PABITS=36) (
     assign tag_dirty = (StoreTag) ? (StoreTagData[1:0] == 2'b11) : write_word_any;
 
     // 32-bit word addresses are little-endian compared to 128-bit cache addresses in Xilinx BRAM.
+    assign fill_word_we = {4{FillLine}} & ~FillSkip;
     always @(*) begin
         case (LineOffset)
-            2'b00: begin fill_we <= {{12{1'b0}}, {4{FillLine}}};           fill_din <= {{96{1'bx}}, LineIn}; end
-            2'b01: begin fill_we <= {{8{1'b0}}, {4{FillLine}}, {4{1'b0}}}; fill_din <= {{64{1'bx}}, LineIn, {32{1'bx}}}; end
-            2'b10: begin fill_we <= {{4{1'b0}}, {4{FillLine}}, {8{1'b0}}}; fill_din <= {{32{1'bx}}, LineIn, {64{1'bx}}}; end
-            2'b11: begin fill_we <= {{4{FillLine}}, {12{1'b0}}};           fill_din <= {LineIn, {96{1'bx}}}; end
+            2'b00: begin fill_we <= {{12{1'b0}}, fill_word_we};           fill_din <= {{96{1'bx}}, LineIn}; end
+            2'b01: begin fill_we <= {{8{1'b0}}, fill_word_we, {4{1'b0}}}; fill_din <= {{64{1'bx}}, LineIn, {32{1'bx}}}; end
+            2'b10: begin fill_we <= {{4{1'b0}}, fill_word_we, {8{1'b0}}}; fill_din <= {{32{1'bx}}, LineIn, {64{1'bx}}}; end
+            2'b11: begin fill_we <= {fill_word_we, {12{1'b0}}};           fill_din <= {LineIn, {96{1'bx}}}; end
         endcase
     end
 
-    TagFlagRam_RW_64 #(
-        .PABITS      (PABITS))
+    TagFlagRam_RW #(
+        .PABITS      (PABITS),
+        .INDEX_BITS  (INDEX_BITS))
         TagFlagRam (
         .clock       (clock),           // input clock
         .reset       (reset),           // input reset
@@ -182,20 +198,40 @@ module Set_RW_128x64 #(parameter PABITS=36) (
         .MatchDirty  (TR_MatchDirty)    // output MatchDirty
     );
 
-    BRAM_32x256_128x64_TDP_BE DataRam (
-        .clka   (clock),       // input clka
-        .rsta   (reset),       // input rsta
-        .wea    (DR_WriteA),   // input [3 : 0] wea
-        .addra  (DR_AddrA),    // input [7 : 0] addra
-        .dina   (DR_DataInA),  // input [31 : 0] dina
-        .douta  (DR_DataOutA), // output [31 : 0] douta
-        .clkb   (clock),       // input clkb
-        .rstb   (reset),       // input rstb
-        .web    (DR_WriteB),   // input [15 : 0] web
-        .addrb  (DR_AddrB),    // input [5 : 0] addrb
-        .dinb   (DR_DataInB),  // input [127 : 0] dinb
-        .doutb  (DR_DataOutB)  // output [127 : 0] doutb
-    );
+    generate
+        if (INDEX_BITS == 6) begin : xilinx
+            BRAM_32x256_128x64_TDP_BE DataRam (
+                .clka   (clock),       // input clka
+                .rsta   (reset),       // input rsta
+                .wea    (DR_WriteA),   // input [3 : 0] wea
+                .addra  (DR_AddrA),    // input [7 : 0] addra
+                .dina   (DR_DataInA),  // input [31 : 0] dina
+                .douta  (DR_DataOutA), // output [31 : 0] douta
+                .clkb   (clock),       // input clkb
+                .rstb   (reset),       // input rstb
+                .web    (DR_WriteB),   // input [15 : 0] web
+                .addrb  (DR_AddrB),    // input [5 : 0] addrb
+                .dinb   (DR_DataInB),  // input [127 : 0] dinb
+                .doutb  (DR_DataOutB)  // output [127 : 0] doutb
+            );
+        end
+        else begin : inferred
+            RAM_TDP_BE_Mixed #(
+                .ADDR_WIDTH (INDEX_BITS))
+                DataRam (
+                .clk    (clock),       // input clk
+                .rst    (reset),       // input rst
+                .addra  (DR_AddrA),    // input [? : 0] addra
+                .wea    (DR_WriteA),   // input [3 : 0] wea
+                .dina   (DR_DataInA),  // input [31 : 0] dina
+                .douta  (DR_DataOutA), // output [31 : 0] douta
+                .addrb  (DR_AddrB),    // input [? : 0] addrb
+                .web    (DR_WriteB),   // input [15 : 0] web
+                .dinb   (DR_DataInB),  // input [127 : 0] dinb
+                .doutb  (DR_DataOutB)  // output [127 : 0] doutb
+            );
+        end
+    endgenerate
 
 endmodule
 
@@ -0,0 +1,58 @@
+`timescale 1ns / 1ps
+/*
+ * File         : TagFlagRam_RW.v
+ * Project      : XUM MIPS32 cache enhancement
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Modification History:
+ *   Rev   Date         Initials  Description of Change
+ *   1.0   3-Sep-2014   GEA       Initial design.
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Cache tag and meta-data (valid, dirty, etc.) memory.
+ *
+ *   The memory has 2^INDEX_BITS entries. Tags are the physical address bits
+ *   above the index and the 16-byte line offset.
+ */
+module TagFlagRam_RW #(parameter PABITS=36, parameter INDEX_BITS=6) (
+    input                             clock,
+    input                             reset,
+    input  [(INDEX_BITS-1):0]         Index,       // Set index into tag memory
+    input  [(PABITS-INDEX_BITS-5):0]  Tag_Cmp,     // Tag to compare to an index read (follows 'Index' by one cycle)
+    input  [(PABITS-INDEX_BITS-5):0]  Tag_Set,     // Tag to write (enabled by 'Write')
+    input                             Write,       // Enables the writing of 'Tag', 'Valid', and 'Dirty'
+    input                             Valid,       // The value of the valid bit during a write
+    input                             Dirty,       // The value of the dirty bit during a write
+    output [(PABITS-INDEX_BITS-5):0]  MatchTag,    // The tag of the given index (used for writebacks)
+    output                            MatchHit,    // Tag hit (one-clock delay)
+    output                            MatchValid,  // Checked tag was valid (one-cycle delay)
+    output                            MatchDirty   // Checked tag was dirty (one-cycle delay)
+    );
+
+    localparam TAG_BITS = PABITS - INDEX_BITS - 4;
+
+    wire [(TAG_BITS+1):0] dataIn = {Valid, Dirty, Tag_Set};
+    wire [(TAG_BITS+1):0] dataOut;
+
+    assign MatchTag   = dataOut[(TAG_BITS-1):0];
+    assign MatchValid = dataOut[(TAG_BITS+1)];
+    assign MatchDirty = dataOut[TAG_BITS];
+    assign MatchHit   = MatchValid & (Tag_Cmp == MatchTag);
+
+    RAM_SP_ZI #(
+        .DATA_WIDTH (TAG_BITS+2),
+        .ADDR_WIDTH (INDEX_BITS))
+        tag_flag_ram (
+        .clk   (clock),     // input clk
+        .rst   (reset),     // input rst
+        .addr  (Index),     // input [5 : 0] addr
+        .we    (Write),     // input we
+        .din   (dataIn),    // input [27 : 0] din
+        .dout  (dataOut)    // output [27 : 0] dout
+    );
+
+endmodule
+
@@ -0,0 +1,522 @@
+`timescale 1ns / 1ps
+/*
+ * File         : InstructionCache.v
+ * Project      : XUM MIPS32 cache enhancement
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   An instruction cache for the MIPS32 Release 1 processor core.
+ *
+ *   The cache has 'WAYS' ways (1, 2, 4, or 8) of 2^INDEX_BITS sets each
+ *   (INDEX_BITS = 6, 7, or 8) with 16-byte lines. The index must lie within
+ *   the 4 KiB page offset, so each way is at most 4 KiB. The default is
+ *   8 KiB, 2-way.
+ *
+ *   Line fills are performed by a fill engine which captures the line in a
+ *   buffer as it is written to the set. Reads of the line being filled are
+ *   served from the buffer: Once the whole line has arrived or, if
+ *   'EARLY_RESTART' is set, as soon as the requested word has arrived. With a
+ *   memory that returns the requested word first, early restart lets the
+ *   pipeline continue after the first word of a miss while the rest of the
+ *   line is filled in the background.
+ *
+ *   If 'PREFETCH' is set, the fill engine also reads the line after a miss into
+ *   the buffer while the memory interface is otherwise idle (next-line prefetch).
+ */
+module InstructionCache #(parameter PABITS=36, parameter INDEX_BITS=8, parameter WAYS=2, parameter EARLY_RESTART=0, parameter PREFETCH=0) (
+    input                  clock,
+    input                  reset,
+    // Processor Interface
+    input  [9:0]           VAddressIn_C,    // Bits [11:2]  of the 32-bit virtual address, i.e. the offset of the vpage/pframe.
+    input  [(PABITS-13):0] PAddressIn_C,    // Bits [35:12] of the 36-bit physical address, i.e. the TLB-translated physical tag.
+    input                  PAddressValid_C, // The physical address is valid (TLB hit).
+    input  [2:0]           CacheAttr_C,     // Cache attributes for the requested address.
+    input                  Stall_C,
+    input                  Read_C,
+    output [31:0]          DataOut_C,
+    output                 Ready_C,
+    output reg             Blocked_C,       // Similar to ~Ready_C, but high when an invalid PAddress is not enough to abort
+    output                 Miss_C,          // 1-cycle pulse indicating a cacheable read miss (for the performance counters).
+    input                  DoCacheOp_C,     // Synchronous pulse indicating a CACHE operation (i.e. from WB when not stalled).
+    input  [2:0]           CacheOp_C,       // Cache operation, encoded in CACHE instruction.
+    input  [(PABITS-9):0]  CacheOpData_C,   // Store Tag data (PABITS-9:2->Bits [35:10] of the tag, 1:0->Valid, [!0 is valid]).
+    // Memory Interface
+    output [(PABITS-3):0]  Address_M,       // Physical line (33:2) or word (33:0) address for memory requests.
+    output                 ReadLine_M,      // Initiates a cacheline (128-bit) read sequence from memory starting at a word address.
+    output                 ReadWord_M,      // Initiates a read for a single 32-bit uncacheable word.
+    input  [31:0]          DataIn_M,        // Inbound data from memory.
+    input  [1:0]           DataInOffset_M,  // Cacheline word offset (0, 1, 2, or 3) of the incoming data from memory following 'ReadLine_M'.
+    input                  Ready_M          // 1-cycle pulse indicating one word of valid read data or capture of write data.
+    );
+
+    `include "../../Core/MIPS_Defines.v"
+
+    /* Cache parameters:
+     *   Size: WAYS * 2^INDEX_BITS * 16 bytes (default 8 KiB)
+     *   Block size: 16 bytes (4 32-bit words)
+     *   Associativity: WAYS-way, tree pseudo-LRU replacement (true LRU for 2 ways)
+     */
+
+    /* Supported cache operations:
+     *   - CacheOpI_Idx_Inv:  Index invalidate
+     *   - CacheOpI_Idx_STag: Index store tag
+     *   - CacheOpI_Adr_HInv: Address hit invalidate
+     *
+     *   Index operations select the way with the address bits above the index,
+     *   inverted (i.e., with two ways a set bit selects way 0).
+     */
+
+    /* Line fills:
+     *   A read miss writes the tag of the victim way and starts the fill engine,
+     *   then waits in READ_CHECK like any other read. While the fill is in progress
+     *   (and for one cycle after, until the set memory can be read back) a read of
+     *   the line is served from the fill buffer once its word is available. Reads of
+     *   other lines proceed if they hit; misses and uncacheable reads wait until the
+     *   memory interface is free. A cache operation which writes a tag during the
+     *   fill stops the buffer from serving the line, so that the line is looked up
+     *   again after the fill.
+     */
+
+    /* Prefetching:
+     *   A miss (or a copy from the prefetch buffer, below) requests a prefetch of the
+     *   next line if it is in the same 4 KiB page. The fill engine reads the line into
+     *   the fill buffer when the memory interface is free but does not write the set,
+     *   and the buffer keeps the line until the next fill. Reads of the line are served
+     *   from the buffer as during a fill. A read which misses in the set copies the line
+     *   from the buffer into the victim way, which takes the same path as a fill but
+     *   needs no memory access. Demand misses wait for a prefetch in progress, and cache
+     *   operations discard the prefetched line.
+     *
+     *   Counters (simulation only; unused in synthesis):
+     *     pf_issued: Prefetches started.
+     *     pf_useful: Prefetched lines which were read before being replaced.
+     *     pf_misses: Line fills from memory for a miss.
+     *   Accuracy is pf_useful / pf_issued, and coverage is pf_useful / (pf_useful + pf_misses).
+     */
+    localparam [3:0] IDLE=0, READ_CHECK=1, WAIT_WORD_MEM=2, WAIT_WORD_CPU=3, COP_CHECK_IDX_INV=4, COP_CHECK_IDX_STAG=5,
+                     COP_CHECK_ADR_HINV=6, WRITE_RECOVER=7;
+
+    localparam SETS     = 1 << INDEX_BITS;
+    localparam TAG_BITS = PABITS - INDEX_BITS - 4;
+    localparam WAY_BITS = (WAYS > 4) ? 3 : ((WAYS > 2) ? 2 : 1);
+    localparam LRU_BITS = (WAYS > 1) ? (WAYS - 1) : 1;
+
+    // Local signals
+    wire [31:0]             captured_mem_data;
+    wire                    capture_mem;
+    reg  [3:0]              cmd_or_idle;
+    reg  [(WAY_BITS-1):0]   cmd_way;
+    wire [(WAYS-1):0]       cmd_select;
+    wire [(WAY_BITS-1):0]   cop_way;
+    wire                    hit_any;
+    reg  [(WAY_BITS-1):0]   hit_way;
+    wire [(INDEX_BITS-1):0] index, saved_index;
+    reg  [(LRU_BITS-1):0]   lru [0:(SETS-1)];
+    wire [(LRU_BITS-1):0]   lru_touched;
+    wire [(WAY_BITS-1):0]   lru_victim;
+    reg                     new_read;
+    reg  [3:0]              next_state;
+    wire [1:0]              offset, saved_offset;
+    wire [(PABITS-3):0]     paddr;
+    wire                    read_hit;
+    wire                    read_miss;
+    reg                     ready;
+    wire [(PABITS-9):0]     saved_stag_data;
+    wire [9:0]              saved_vaddr;
+    reg  [31:0]             sets_word_out;
+    wire [3:0]              state;
+    wire [(TAG_BITS-1):0]   tag;
+    wire [(WAY_BITS-1):0]   touch_way;
+    wire                    uncacheable;
+    reg  [(WAY_BITS-1):0]   victim_way;
+    // Fill engine signals
+    reg                     fill_active;     // A line fill is in progress on the memory interface
+    reg                     fill_recover;    // The cycle after a fill, when the set memory may not yet be read back
+    wire                    fill_busy;       // The fill buffer holds the line being filled
+    reg  [(PABITS-3):0]     fill_addr;       // Word address of the miss which started the fill
+    reg  [(WAY_BITS-1):0]   fill_way;        // The way being filled
+    reg  [1:0]              fill_count;      // Number of fill words received
+    reg  [3:0]              fill_words;      // The words of the line which have arrived
+    reg  [127:0]            fill_line;       // The fill buffer
+    reg                     fill_killed;     // A cache operation wrote a tag during the fill; don't serve from the buffer
+    wire                    fill_beat;       // One word of fill data from memory
+    wire                    fill_done;       // The last word of fill data from memory
+    wire                    fill_match;      // The request is for the line being filled
+    wire                    fill_word_ok;    // The requested word can be served from the fill buffer
+    wire [1:0]              fill_offset;     // Cacheline offset of the fill word
+    wire [31:0]             fill_data;       // The fill word (from memory or, for a copy, from the fill buffer)
+    wire                    miss_issue;      // Start a line fill from memory for a miss
+    // Prefetch signals
+    reg                     fill_pf;         // The fill (or the buffer after it) is a prefetch which is not in the set
+    reg                     fill_copy;       // The fill copies the prefetched line from the buffer to the set
+    reg                     pf_valid;        // The fill buffer holds a complete prefetched line
+    reg                     pf_req;          // A prefetch of 'pf_line' is pending
+    reg  [(PABITS-5):0]     pf_line;         // Line address of the pending prefetch
+    reg                     pf_used;         // The prefetched line has been read
+    wire                    pf_issue;        // Start a prefetch
+    wire                    pf_install;      // Copy the prefetched line into the victim way for a read miss
+    wire                    pf_first;        // The first read of a prefetched line
+    reg  [31:0]             pf_issued;       // Prefetch counters (see above)
+    reg  [31:0]             pf_useful;
+    reg  [31:0]             pf_misses;
+    // Submodule commands
+    wire                    cmd_fill_line;   // Write a word of data from memory to the cache (uses LineIndex, LineOffset, LineIn)
+    reg                     cmd_inv_line;    // Invalidate a tag (uses Tag, Index)
+    wire                    cmd_val_line;    // Validate and store a tag (uses Tag, Index)
+    wire                    cmd_stag;        // Store a custom tag from software (uses Index, StoreTagData)
+
+    // Set signals (shared by all ways, except for the per-way commands and outputs)
+    wire [(INDEX_BITS-1):0] Set_Index;
+    wire [1:0]              Set_Offset;
+    wire [(INDEX_BITS-1):0] Set_LineIndex;
+    wire [(TAG_BITS+1):0]   Set_StoreTagData;
+    wire [(32*WAYS-1):0]    Set_WordOut;
+    wire [(WAYS-1):0]       Set_Hit;
+    wire [(WAYS-1):0]       Set_Valid;
+    wire [(WAYS-1):0]       Set_ValidateLine;
+    wire [(WAYS-1):0]       Set_InvalidateLine;
+    wire [(WAYS-1):0]       Set_FillLine;
+    wire [(WAYS-1):0]       Set_StoreTag;
+
+    // Top-level assignments
+    //
+    // NOTE: The processor can cancel a request by keeping PAddressValid_C low at the appropriate time (e.g., READ_CHECK, *CHECK*).
+    // This occurs during pipeline flushes when the i-cache is not blocked (via high Blocked_C).
+    // In this case the processor does not wait for Ready_C!
+    assign DataOut_C  = (state == WAIT_WORD_CPU) ? captured_mem_data : ((fill_match) ? fill_line[(saved_offset*32)+:32] : sets_word_out);
+    assign Ready_C = ready;
+    assign Miss_C  = miss_issue | pf_install;
+    always @(*) begin
+        case (state)
+            READ_CHECK:         ready = ~PAddressValid_C | (PAddressValid_C & ~uncacheable & read_hit);
+            COP_CHECK_IDX_INV:  ready = ~PAddressValid_C;
+            COP_CHECK_IDX_STAG: ready = ~PAddressValid_C;
+            COP_CHECK_ADR_HINV: ready = ~PAddressValid_C;
+            WAIT_WORD_CPU:      ready = 1'b1;
+            WRITE_RECOVER:      ready = 1'b1;
+            default:            ready = 1'b0;
+        endcase
+    end
+    always @(*) begin
+        case (state)
+            WAIT_WORD_MEM: Blocked_C = 1'b1;
+            default:       Blocked_C = 1'b0;
+        endcase
+    end
+    assign Address_M  = (fill_active) ? fill_addr : ((pf_issue) ? {pf_line, 2'b00} : paddr);
+    assign ReadLine_M = miss_issue | pf_issue;
+    assign ReadWord_M = (state == READ_CHECK) & PAddressValid_C & uncacheable & ~fill_busy;
+
+    // Local Assignments
+    assign capture_mem   = Ready_M & (state == WAIT_WORD_MEM);
+    assign index         = VAddressIn_C[(INDEX_BITS+1):2];
+    assign offset        = VAddressIn_C[1:0];
+    assign saved_index   = saved_vaddr[(INDEX_BITS+1):2];
+    assign saved_offset  = saved_vaddr[1:0];
+    assign paddr         = {PAddressIn_C, saved_vaddr};
+    assign tag           = paddr[(PABITS-3):(INDEX_BITS+2)];
+    assign cop_way       = ~tag[(WAY_BITS-1):0] & (WAYS - 1);
+    assign hit_any       = |Set_Hit;
+    assign read_hit      = (fill_match) ? (~fill_killed & fill_word_ok & ~pf_install) : hit_any;
+    assign read_miss     = ~fill_match & ~hit_any & ~uncacheable;
+    assign miss_issue    = (state == READ_CHECK) & PAddressValid_C & read_miss & ~fill_busy;
+    assign touch_way     = (miss_issue | pf_install) ? victim_way : hit_way;
+    assign cmd_select    = 1 << cmd_way;
+    assign uncacheable   = (CacheAttr_C == 3'b010);  // Not immediately available: Arrives with the physical tag
+
+    // The hit way and its data, and the way to fill on a miss (the first invalid way, otherwise the LRU way)
+    integer w;
+    always @(*) begin
+        hit_way       = {WAY_BITS{1'b0}};
+        sets_word_out = Set_WordOut[31:0];
+        victim_way    = lru_victim;
+        for (w = WAYS - 1; w >= 0; w = w - 1) begin
+            if (Set_Hit[w]) begin
+                hit_way       = w;
+                sets_word_out = Set_WordOut[(w*32)+:32];
+            end
+            if (~Set_Valid[w]) begin
+                victim_way    = w;
+            end
+        end
+    end
+
+    DFF_E #(.WIDTH(32))        R_Mem     (.clock(clock), .enable(capture_mem), .D(DataIn_M),      .Q(captured_mem_data));
+    DFF_E #(.WIDTH(10))        R_VAddr   (.clock(clock), .enable(new_read),    .D(VAddressIn_C),  .Q(saved_vaddr));
+    DFF_E #(.WIDTH(PABITS-8))  R_STag    (.clock(clock), .enable(new_read),    .D(CacheOpData_C), .Q(saved_stag_data));
+
+    // Common state transition logic to choose the next state when a command is complete.
+    // If the processor is stalled the state will not change.
+    always @(*) begin
+        if (Stall_C) begin
+            cmd_or_idle = state;
+        end
+        else if (DoCacheOp_C) begin
+            case (CacheOp_C)
+                `CacheOpI_Idx_Inv:  cmd_or_idle = COP_CHECK_IDX_INV;
+                `CacheOpI_Idx_STag: cmd_or_idle = COP_CHECK_IDX_STAG;
+                `CacheOpI_Adr_HInv: cmd_or_idle = COP_CHECK_ADR_HINV;
+                default:            cmd_or_idle = IDLE;
+            endcase
+        end
+        else if (Read_C) begin
+            cmd_or_idle = READ_CHECK;
+        end
+        else begin
+            cmd_or_idle = IDLE;
+        end
+    end
+
+    always @(*) begin
+        case (state)
+            COP_CHECK_IDX_INV:  cmd_way = cop_way;
+            COP_CHECK_IDX_STAG: cmd_way = cop_way;
+            COP_CHECK_ADR_HINV: cmd_way = hit_way;
+            default:            cmd_way = {WAY_BITS{1'bx}};
+        endcase
+    end
+    always @(*) begin
+        new_read = 1'b0;
+        if ((Read_C | DoCacheOp_C) & ~Stall_C) begin
+            case (state)
+                IDLE:               new_read = 1'b1;
+                READ_CHECK:         new_read = ~PAddressValid_C | (~uncacheable & read_hit);
+                WAIT_WORD_CPU:      new_read = 1'b1;
+                COP_CHECK_IDX_INV:  new_read = ~PAddressValid_C;
+                COP_CHECK_IDX_STAG: new_read = ~PAddressValid_C;
+                COP_CHECK_ADR_HINV: new_read = ~PAddressValid_C;
+                WRITE_RECOVER:      new_read = 1'b1;
+                default:            new_read = 1'b0;
+            endcase
+        end
+    end
+    always @(*) begin
+        cmd_inv_line = 1'b0;
+        if (PAddressValid_C) begin
+            case (state)
+                COP_CHECK_IDX_INV:  cmd_inv_line = 1'b1;
+                COP_CHECK_ADR_HINV: cmd_inv_line = hit_any;
+                default:            cmd_inv_line = 1'b0;
+            endcase
+        end
+    end
+    assign cmd_fill_line     = fill_beat & ~fill_pf;
+    assign cmd_val_line      = miss_issue | pf_install;
+    assign cmd_stag          = (state == COP_CHECK_IDX_STAG) & PAddressValid_C;
+
+    // Cache state machine
+    always @(*) begin
+        next_state = state;
+        case (state)
+            IDLE:   next_state = cmd_or_idle;
+            READ_CHECK:
+                begin
+                    if (~PAddressValid_C) begin
+                        // TLB miss: Cancel the request / do nothing
+                        next_state = cmd_or_idle;
+                    end
+                    else if (uncacheable) begin
+                        // Uncacheable read: Load from memory even if it's in the cache (once the memory is free)
+                        next_state = (fill_busy) ? READ_CHECK : WAIT_WORD_MEM;
+                    end
+                    else if (read_hit) begin
+                        // Read hit (possibly from the fill buffer)
+                        next_state = cmd_or_idle;
+                    end
+                    else begin
+                        // Read miss: Start a line fill or copy (once the memory is free) and wait for the word
+                        next_state = READ_CHECK;
+                    end
+                end
+            WAIT_WORD_MEM:      next_state = (Ready_M) ? WAIT_WORD_CPU : WAIT_WORD_MEM;
+            WAIT_WORD_CPU:      next_state = cmd_or_idle;
+            COP_CHECK_IDX_INV:  next_state = (PAddressValid_C) ? WRITE_RECOVER : cmd_or_idle;
+            COP_CHECK_IDX_STAG: next_state = (PAddressValid_C) ? WRITE_RECOVER : cmd_or_idle;
+            COP_CHECK_ADR_HINV: next_state = (PAddressValid_C) ? WRITE_RECOVER : cmd_or_idle;
+            WRITE_RECOVER:      next_state = cmd_or_idle;
+            default:            next_state = IDLE;
+        endcase
+    end
+
+    DFF_SRE #(.WIDTH(4), .INIT(IDLE)) R_state (.clock(clock), .reset(reset), .enable(1'b1), .D(next_state), .Q(state));
+
+    // Fill engine: Line address and way, word count, and the fill buffer. A copy writes one word per cycle.
+    assign fill_busy    = fill_active | fill_recover;
+    assign fill_beat    = fill_active & (fill_copy | Ready_M);
+    assign fill_done    = fill_beat & (fill_count == 2'b11);
+    assign fill_offset  = (fill_copy) ? fill_count : DataInOffset_M;
+    assign fill_data    = (fill_copy) ? fill_line[(fill_count*32)+:32] : DataIn_M;
+    assign fill_match   = (fill_busy | pf_valid) & (paddr[(PABITS-3):2] == fill_addr[(PABITS-3):2]);
+    assign fill_word_ok = (EARLY_RESTART) ? fill_words[saved_offset] : (&fill_words);
+
+    always @(posedge clock) begin
+        if (reset) begin
+            fill_active  <= 1'b0;
+            fill_recover <= 1'b0;
+            fill_count   <= 2'b00;
+            fill_words   <= 4'b0000;
+            fill_pf      <= 1'b0;
+            fill_copy    <= 1'b0;
+        end
+        else if (miss_issue | pf_issue | pf_install) begin
+            fill_active  <= 1'b1;
+            fill_recover <= 1'b0;
+            fill_count   <= 2'b00;
+            fill_words   <= (pf_install) ? 4'b1111 : 4'b0000;
+            fill_pf      <= pf_issue;
+            fill_copy    <= pf_install;
+        end
+        else begin
+            fill_active  <= fill_active & ~fill_done;
+            fill_recover <= fill_done;
+            fill_count   <= (fill_beat) ? (fill_count + 1'b1) : fill_count;
+            fill_words   <= (fill_beat) ? (fill_words | (4'b0001 << fill_offset)) : fill_words;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (miss_issue | pf_install) begin
+            fill_addr <= paddr;
+            fill_way  <= victim_way;
+        end
+        else if (pf_issue) begin
+            fill_addr <= {pf_line, 2'b00};
+        end
+        if (fill_beat & ~fill_copy) begin
+            fill_line[(DataInOffset_M*32)+:32] <= DataIn_M;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset | miss_issue | pf_issue | pf_install) begin
+            fill_killed <= 1'b0;
+        end
+        else if ((fill_busy | pf_valid) & (cmd_inv_line | cmd_stag)) begin
+            fill_killed <= 1'b1;
+        end
+    end
+
+    // Next-line prefetch: Request the line after a miss, start it when the memory interface is free,
+    // and keep the line in the buffer until it is copied, replaced, or discarded by a cache operation.
+    assign pf_issue   = (PREFETCH != 0) & pf_req & ~fill_busy & ~miss_issue & ~pf_install & ~ReadWord_M & (state != WAIT_WORD_MEM);
+    assign pf_install = (PREFETCH != 0) & (state == READ_CHECK) & PAddressValid_C & ~uncacheable & pf_valid & ~fill_busy & fill_match & ~hit_any;
+    assign pf_first   = (state == READ_CHECK) & PAddressValid_C & ~uncacheable & fill_pf & fill_match & ~fill_killed & ~pf_used;
+
+    always @(posedge clock) begin
+        if (reset | pf_issue) begin
+            pf_req  <= 1'b0;
+        end
+        else if (miss_issue | pf_install) begin
+            pf_req  <= (PREFETCH != 0) & (paddr[9:2] != 8'hff);  // The next line must be in the same page
+            pf_line <= paddr[(PABITS-3):2] + 1'b1;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset | miss_issue | pf_issue | pf_install | cmd_inv_line | cmd_stag) begin
+            pf_valid <= 1'b0;
+        end
+        else if (fill_done & fill_pf & ~fill_killed) begin
+            pf_valid <= 1'b1;
+        end
+    end
+
+    always @(posedge clock) begin
+        pf_used <= (reset | pf_issue) ? 1'b0 : (pf_used | pf_first);
+    end
+
+    always @(posedge clock) begin
+        if (reset) begin
+            pf_issued <= {32{1'b0}};
+            pf_useful <= {32{1'b0}};
+            pf_misses <= {32{1'b0}};
+        end
+        else begin
+            pf_issued <= (pf_issue)   ? (pf_issued + 1'b1) : pf_issued;
+            pf_useful <= (pf_first)   ? (pf_useful + 1'b1) : pf_useful;
+            pf_misses <= (miss_issue) ? (pf_misses + 1'b1) : pf_misses;
+        end
+    end
+
+    // Submodule Assignments
+    assign Set_Index          = (new_read) ? index : saved_index;
+    assign Set_Offset         = (new_read) ? offset : saved_offset;
+    assign Set_LineIndex      = fill_addr[(INDEX_BITS+1):2];
+    assign Set_StoreTagData   = {saved_stag_data[(PABITS-9):(INDEX_BITS-4)], saved_stag_data[1:0]};
+    assign Set_ValidateLine   = {WAYS{cmd_val_line}}  & (1 << victim_way);
+    assign Set_InvalidateLine = {WAYS{cmd_inv_line}}  & cmd_select;
+    assign Set_FillLine       = {WAYS{cmd_fill_line}} & (1 << fill_way);
+    assign Set_StoreTag       = {WAYS{cmd_stag}}      & cmd_select;
+
+    // LRU Logic: Update the specified line's replacement state when accessed
+    integer i;
+    initial begin
+        // Initialize all to zero (Aids simulation; not necessary for synthesis)
+        for (i = 0; i < SETS; i = i + 1) begin
+            lru[i] = {LRU_BITS{1'b0}};
+        end
+    end
+    always @(posedge clock) begin
+        if (reset) begin
+            // Reset state doesn't matter in synthesis but helps with simulation
+            for (i = 0; i < SETS; i = i + 1) begin
+                lru[i] <= {LRU_BITS{1'b0}};
+            end
+        end
+        else if (miss_issue | pf_install) begin
+            // Read miss which fills the victim way
+            lru[saved_index] <= lru_touched;
+        end
+        else if (~Stall_C & PAddressValid_C) begin
+            if ((state == READ_CHECK) & hit_any & ~fill_match) begin
+                // Read hit
+                lru[saved_index] <= lru_touched;
+            end
+            else if (state == COP_CHECK_IDX_STAG) begin
+                // Cache instruction: Store tag
+                lru[saved_index] <= {LRU_BITS{1'b0}}; // not implemented
+            end
+        end
+    end
+
+    PseudoLRU #(
+        .WAYS     (WAYS))
+        LRU (
+        .State    (lru[saved_index]),
+        .Way      (touch_way),
+        .Victim   (lru_victim),
+        .Touched  (lru_touched)
+    );
+
+    genvar g;
+    generate
+        for (g = 0; g < WAYS; g = g + 1) begin : way
+            Set_RO #(
+                .PABITS          (PABITS),
+                .INDEX_BITS      (INDEX_BITS))
+                Set (
+                .clock           (clock),
+                .reset           (reset),
+                .Tag             (tag),
+                .Index           (Set_Index),
+                .Offset          (Set_Offset),
+                .LineIndex       (Set_LineIndex),
+                .LineOffset      (fill_offset),
+                .WordOut         (Set_WordOut[(g*32)+:32]),
+                .Hit             (Set_Hit[g]),
+                .Valid           (Set_Valid[g]),
+                .LineIn          (fill_data),
+                .ValidateLine    (Set_ValidateLine[g]),
+                .InvalidateLine  (Set_InvalidateLine[g]),
+                .FillLine        (Set_FillLine[g]),
+                .StoreTag        (Set_StoreTag[g]),
+                .StoreTagData    (Set_StoreTagData)
+            );
+        end
+    endgenerate
+
+endmodule
+
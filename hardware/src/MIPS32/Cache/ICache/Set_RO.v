@@ -1,6 +1,6 @@
 `timescale 1ns / 1ps
 /*
- * File         : Set_RO_128x256.v
+ * File         : Set_RO.v
  * Project      : XUM MIPS32 cache enhancement
  * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
  *
@@ -16,28 +16,31 @@
  *   Each set behaves as a direct-mapped cache and is controlled by
  *   an encapsulating cache module through a simple command interface.
  *   See in-source documentation below for more details.
+ *
+ *   A set holds 2^INDEX_BITS lines of 16 bytes. The default (256 lines, 4 KiB)
+ *   uses the Xilinx BRAM core; other sizes use an inferred memory.
  */
-module Set_RO_128x256 #(parameter PABITS=36) (
-    input                  clock,
-    input                  reset,
+module Set_RO #(parameter PABITS=36, parameter INDEX_BITS=8) (
+    input                             clock,
+    input                             reset,
     // Indexing Signals
-    input  [(PABITS-13):0] Tag,            // Bits [35:12] of the 36-bit physical address.
-    input  [7:0]           Index,          // Bits [11:4] of the 32-bit virtual / 36-bit physical address.
-    input  [1:0]           Offset,         // Bits [3:2] of the 32-bit virtual / 36-bit physical address.
-    input  [7:0]           LineIndex,      // Fill index.
-    input  [1:0]           LineOffset,     // Bits [3:2] of an address during a fill.
+    input  [(PABITS-INDEX_BITS-5):0]  Tag,            // Bits [35:(INDEX_BITS+4)] of the 36-bit physical address.
+    input  [(INDEX_BITS-1):0]         Index,          // Bits [(INDEX_BITS+3):4] of the 32-bit virtual / 36-bit physical address.
+    input  [1:0]                      Offset,         // Bits [3:2] of the 32-bit virtual / 36-bit physical address.
+    input  [(INDEX_BITS-1):0]         LineIndex,      // Fill index.
+    input  [1:0]                      LineOffset,     // Bits [3:2] of an address during a fill.
     // Word Data (Processor)
-    output [31:0]          WordOut,        // Load data for processor
-    output                 Hit,            // Cacheline was a hit (one-cycle delay).
-    output                 Valid,          // Cacheline was valid (one-cycle delay).
+    output [31:0]                     WordOut,        // Load data for processor
+    output                            Hit,            // Cacheline was a hit (one-cycle delay).
+    output                            Valid,          // Cacheline was valid (one-cycle delay).
     // Line Data (Memory)
-    input  [31:0]          LineIn,         // One word of memory data to fill the cache. Occurs in groups of four.
+    input  [31:0]                     LineIn,         // One word of memory data to fill the cache. Occurs in groups of four.
     // Commands
-    input                  ValidateLine,   // Writes the tag entry and sets 'Valid' (no actual loading).
-    input                  InvalidateLine, // Clears 'Valid' bit of the cacheline.
-    input                  FillLine,       // Pulse indicating the line word 'LineIn' at 'LineOffset' should be written.
-    input                  StoreTag,       // Writes 'StoreTagData' to the index specified by 'Index'
-    input  [(PABITS-11):0] StoreTagData    // Data for StoreTag operation (PABITS-11:2->Tag, 1:0->Valid)
+    input                             ValidateLine,   // Writes the tag entry and sets 'Valid' (no actual loading).
+    input                             InvalidateLine, // Clears 'Valid' bit of the cacheline.
+    input                             FillLine,       // Pulse indicating the line word 'LineIn' at 'LineOffset' should be written.
+    input                             StoreTag,       // Writes 'StoreTagData' to the index specified by 'Index'
+    input  [(PABITS-INDEX_BITS-3):0]  StoreTagData    // Data for StoreTag operation (PABITS-INDEX_BITS-3:2->Tag, 1:0->Valid)
     );
 
     /* Operational Description
@@ -79,21 +82,23 @@ module Set_RO_128x256 #(parameter PABITS=36) (
      *     Write the valid bit and tag from 'StoreTagData' to the index specified by 'Index'.
      */
 
+    localparam TAG_BITS = PABITS - INDEX_BITS - 4;
+
     // Tag & Flag RAM signals
-    wire [7:0]           TR_Index;
-    wire [(PABITS-13):0] TR_Tag_Cmp;
-    wire [(PABITS-13):0] TR_Tag_Set;
-    wire                 TR_Write;
-    wire                 TR_SetValid;
-    wire                 TR_MatchHit;
-    wire                 TR_MatchValid;
+    wire [(INDEX_BITS-1):0] TR_Index;
+    wire [(TAG_BITS-1):0]   TR_Tag_Cmp;
+    wire [(TAG_BITS-1):0]   TR_Tag_Set;
+    wire                    TR_Write;
+    wire                    TR_SetValid;
+    wire                    TR_MatchHit;
+    wire                    TR_MatchValid;
 
     // Data RAM signals
-    wire        DR_Write;
-    wire [9:0]  DR_AddrW;
-    wire [31:0] DR_DataIn;
-    wire [9:0]  DR_AddrR;
-    wire [31:0] DR_DataOut;
+    wire                    DR_Write;
+    wire [(INDEX_BITS+1):0] DR_AddrW;
+    wire [31:0]             DR_DataIn;
+    wire [(INDEX_BITS+1):0] DR_AddrR;
+    wire [31:0]             DR_DataOut;
 
     // Local signals
     wire tag_write;
@@ -107,7 +112,7 @@ module Set_RO_128x256 #(parameter PABITS=36) (
     // Tag & Flag RAM assignments
     assign TR_Index    = Index;
     assign TR_Tag_Cmp  = Tag;
-    assign TR_Tag_Set  = (StoreTag) ? StoreTagData[(PABITS-11):2] : Tag;
+    assign TR_Tag_Set  = (StoreTag) ? StoreTagData[(TAG_BITS+1):2] : Tag;
     assign TR_Write    = tag_write;
     assign TR_SetValid = tag_valid;
 
@@ -121,8 +126,9 @@ module Set_RO_128x256 #(parameter PABITS=36) (
     assign tag_write = ValidateLine | InvalidateLine | StoreTag;
     assign tag_valid = (StoreTag) ? (StoreTagData[1:0] != 2'b00) : ValidateLine;
 
-    TagFlagRam_RO_256 #(
-        .PABITS      (PABITS))
+    TagFlagRam_RO #(
+        .PABITS      (PABITS),
+        .INDEX_BITS  (INDEX_BITS))
         TagFlagRam (
         .clock       (clock),           // input clock
         .reset       (reset),           // input reset
@@ -135,16 +141,34 @@ module Set_RO_128x256 #(parameter PABITS=36) (
         .MatchValid  (TR_MatchValid)    // output MatchValid
     );
 
-    BRAM_32x1024_SDP DataRam (
-        .clka   (clock),     // input clka
-        .wea    (DR_Write),  // input wea
-        .addra  (DR_AddrW),  // input [9 : 0] addra
-        .dina   (DR_DataIn), // input [31 : 0] dina
-        .clkb   (clock),     // input clkb
-        .rstb   (reset),     // input rstb
-        .addrb  (DR_AddrR),  // input [9 : 0] addrb
-        .doutb  (DR_DataOut) // output [31 : 0] doutb
-    );
+    generate
+        if (INDEX_BITS == 8) begin : xilinx
+            BRAM_32x1024_SDP DataRam (
+                .clka   (clock),     // input clka
+                .wea    (DR_Write),  // input wea
+                .addra  (DR_AddrW),  // input [9 : 0] addra
+                .dina   (DR_DataIn), // input [31 : 0] dina
+                .clkb   (clock),     // input clkb
+                .rstb   (reset),     // input rstb
+                .addrb  (DR_AddrR),  // input [9 : 0] addrb
+                .doutb  (DR_DataOut) // output [31 : 0] doutb
+            );
+        end
+        else begin : inferred
+            RAM_SDP #(
+                .DATA_WIDTH (32),
+                .ADDR_WIDTH (INDEX_BITS+2))
+                DataRam (
+                .clk    (clock),     // input clk
+                .rst    (reset),     // input rst
+                .addra  (DR_AddrW),  // input [? : 0] addra
+                .wea    (DR_Write),  // input wea
+                .dina   (DR_DataIn), // input [31 : 0] dina
+                .addrb  (DR_AddrR),  // input [? : 0] addrb
+                .doutb  (DR_DataOut) // output [31 : 0] doutb
+            );
+        end
+    endgenerate
 
 endmodule
 
@@ -9,8 +9,13 @@
  *
  * Description:
  *   An Arithmetic Logic Unit for a MIPS32 processor.
+ *
+ *   The multiply/fused multiply-add unit is selected by 'MULT_DSP': Either the
+ *   Xilinx-specific DSP48A1 implementation (1) or a portable implementation (0)
+ *   with 'MULT_STAGES' pipeline stages and an optional early-out for small
+ *   operands ('MULT_EARLY_OUT').
  */
-module ALU(
+module ALU #(parameter MULT_DSP=1, parameter MULT_STAGES=3, parameter MULT_EARLY_OUT=1) (
     input             clock,
     input             reset,
     input             X1_Issued,
@@ -208,20 +213,43 @@ module ALU(
     DFF_E #(.WIDTH(32)) HI (.clock(clock), .enable(HiWrite), .D(HiIn), .Q(Hi_out));
     DFF_E #(.WIDTH(32)) LO (.clock(clock), .enable(LoWrite), .D(LoIn), .Q(Lo_out));
 
-    // Xilinx-specific DSP48A-based Muliplier / Fused Multiply-Add/Sub
-    DSP_MAddSub_32x32x64 MultAddSub (
-        .clock    (clock),
-        .reset    (reset),
-        .A        (A),
-        .B        (B),
-        .C        (HiLo),       // need to be held steady?
-        .sign     (sign),
-        .fused    (fused),
-        .subtract (subtract),
-        .start    (mult_start),
-        .busy     (mult_busy),
-        .D        (mult_output)   // XXX figure out MSB that isn't needed
-    );
+    generate
+        if (MULT_DSP) begin : mult_dsp
+            // Xilinx-specific DSP48A-based Muliplier / Fused Multiply-Add/Sub
+            DSP_MAddSub_32x32x64 MultAddSub (
+                .clock    (clock),
+                .reset    (reset),
+                .A        (A),
+                .B        (B),
+                .C        (HiLo),       // need to be held steady?
+                .sign     (sign),
+                .fused    (fused),
+                .subtract (subtract),
+                .start    (mult_start),
+                .busy     (mult_busy),
+                .D        (mult_output)   // XXX figure out MSB that isn't needed
+            );
+        end
+        else begin : mult_generic
+            // Portable Multiplier / Fused Multiply-Add/Sub
+            MAddSub_32x32x64 #(
+                .STAGES     (MULT_STAGES),
+                .EARLY_OUT  (MULT_EARLY_OUT))
+                MultAddSub (
+                .clock    (clock),
+                .reset    (reset),
+                .A        (A),
+                .B        (B),
+                .C        (HiLo),       // Sampled with 'start'
+                .sign     (sign),
+                .fused    (fused),
+                .subtract (subtract),
+                .start    (mult_start),
+                .busy     (mult_busy),
+                .D        (mult_output)
+            );
+        end
+    endgenerate
 
     Divide Divider (
         .clock      (clock),
@@ -0,0 +1,206 @@
+`timescale 1ns / 1ps
+/*
+ * File         : BranchPredictor.v
+ * Project      : XUM MIPS32
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A dynamic branch predictor for the instruction fetch stages: A bimodal
+ *   pattern history table (PHT) of 2-bit saturating counters and a direct-
+ *   mapped branch target buffer (BTB).
+ *
+ *   The instruction in F1 is looked up by its PC. If it hits in the BTB and
+ *   its counter predicts taken, the prediction travels with the instruction
+ *   down the pipeline. Because of the branch delay slot, the redirect takes
+ *   effect one fetch later: When F1 holds the delay slot ('F1_PredNext'),
+ *   the next PC is the predicted target instead of PC+4. Delay slots are
+ *   never predicted themselves.
+ *
+ *   Branches and jumps train the predictor when they resolve in D2. A non-
+ *   branch instruction which hit in the BTB (e.g., after self-modifying code)
+ *   invalidates its entry.
+ *
+ *   A return address stack (RAS) predicts the targets of 'jr $ra'. BTB entries
+ *   remember whether they belong to a call (jal, jalr, bal, etc.) or a return.
+ *   A predicted call pushes its link address (PC+8) in F1 and a predicted
+ *   return pops it. Each instruction carries the stack pointer from before its
+ *   own push/pop ('RasPtr') in the same way as its restart PC, so the pointer
+ *   can be recovered: From D2 when fetch is redirected (also pushing/popping for
+ *   calls and returns that were not predicted), and from W1 on a pipeline flush
+ *   (exceptions, eret, and XOP restarts). The stack is circular and never
+ *   reports empty; a wrong return target is caught in D2 like any other.
+ *
+ *   PHT_BITS and BTB_BITS set the log2 number of entries of each table.
+ *   RAS_BITS sets the log2 depth of the return address stack (0-4); 0 disables
+ *   it, in which case returns are predicted with the BTB target.
+ */
+module BranchPredictor #(parameter PHT_BITS=9, parameter BTB_BITS=5, parameter RAS_BITS=3) (
+    input         clock,
+    input         reset,
+    // Lookup (F1)
+    input  [31:0] F1_PC,
+    input         F1_Lookup,        // F1 holds a real instruction fetch
+    input         F1_Stall,
+    input         F1_Flush,
+    output        F1_PredTaken,     // The instruction in F1 is predicted to be a taken branch/jump
+    output [31:0] F1_PredTarget,    // Predicted target of the instruction in F1
+    output        F1_PredNext,      // F1 holds the delay slot of a predicted-taken branch/jump
+    output [31:0] F1_PredNextPC,    // The PC to fetch after the delay slot
+    output [3:0]  F1_RasPtr,        // Return address stack pointer before the instruction in F1
+    // Update (D2)
+    input         D2_Update,        // A branch/jump resolved in D2
+    input         D2_Invalidate,    // A non-branch instruction in D2 was predicted taken
+    input  [31:0] D2_PC,            // Address of the instruction in D2
+    input         D2_Taken,         // The branch/jump was taken
+    input  [31:0] D2_Target,        // Actual target of the branch/jump
+    input         D2_Call,          // The instruction in D2 is a branch/jump and link
+    input         D2_Return,        // The instruction in D2 is 'jr $ra'
+    input  [31:0] D2_LinkPC,        // The link address of the instruction in D2 (PC+8)
+    input  [3:0]  D2_RasPtr,        // Return address stack pointer before the instruction in D2
+    input         D2_Redirect,      // Instruction fetch is redirected from D2
+    // Recovery (W1)
+    input         W1_Flush,         // Pipeline flush from W1
+    input  [3:0]  W1_RasPtr         // Return address stack pointer before the restart instruction in W1
+    );
+
+    localparam PHT_ENTRIES = 1 << PHT_BITS;
+    localparam BTB_ENTRIES = 1 << BTB_BITS;
+    localparam TAG_BITS    = 30 - BTB_BITS;
+    localparam RAS_DEPTH   = 1 << RAS_BITS;
+    localparam RAS_MASK    = RAS_DEPTH - 1;
+
+    reg  [1:0]            pht        [0:(PHT_ENTRIES-1)];
+    reg  [(TAG_BITS-1):0] btb_tag    [0:(BTB_ENTRIES-1)];
+    reg  [31:0]           btb_target [0:(BTB_ENTRIES-1)];
+    reg                   btb_call   [0:(BTB_ENTRIES-1)];
+    reg                   btb_return [0:(BTB_ENTRIES-1)];
+    reg  [(BTB_ENTRIES-1):0] btb_valid;
+    reg  [31:0]           ras        [0:(RAS_DEPTH-1)];
+    reg  [3:0]            ras_ptr;          // Top of the return address stack
+    reg                   pending;          // F1 holds the delay slot of a predicted-taken branch
+    reg  [31:0]           pending_target;
+
+    // Lookup
+    wire [(PHT_BITS-1):0] f1_pht_index = F1_PC[(PHT_BITS+1):2];
+    wire [(BTB_BITS-1):0] f1_btb_index = F1_PC[(BTB_BITS+1):2];
+    wire [(TAG_BITS-1):0] f1_btb_tag   = F1_PC[31:(BTB_BITS+2)];
+    wire                  f1_btb_hit   = btb_valid[f1_btb_index] & (btb_tag[f1_btb_index] == f1_btb_tag);
+    wire [1:0]            f1_counter   = pht[f1_pht_index];
+    wire                  f1_call      = btb_call[f1_btb_index];
+    wire                  f1_return    = btb_return[f1_btb_index] & (RAS_BITS != 0);
+    wire [31:0]           f1_link_pc   = F1_PC + 32'd8;
+
+    assign F1_PredTaken  = F1_Lookup & ~pending & f1_btb_hit & (f1_counter[1] | f1_return);
+    assign F1_PredTarget = (f1_return) ? ras[ras_ptr & RAS_MASK] : btb_target[f1_btb_index];
+    assign F1_PredNext   = pending;
+    assign F1_PredNextPC = pending_target;
+    assign F1_RasPtr     = ras_ptr;
+
+    // Update
+    wire [(PHT_BITS-1):0] d2_pht_index = D2_PC[(PHT_BITS+1):2];
+    wire [(BTB_BITS-1):0] d2_btb_index = D2_PC[(BTB_BITS+1):2];
+    wire [(TAG_BITS-1):0] d2_btb_tag   = D2_PC[31:(BTB_BITS+2)];
+    wire [1:0]            d2_counter   = pht[d2_pht_index];
+
+    integer i;
+    initial begin
+        for (i = 0; i < PHT_ENTRIES; i = i + 1) begin
+            pht[i] = 2'b01;     // Weakly not taken
+        end
+        for (i = 0; i < RAS_DEPTH; i = i + 1) begin
+            ras[i] = 32'h00000000;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (D2_Update) begin
+            if (D2_Taken & (d2_counter != 2'b11)) begin
+                pht[d2_pht_index] <= d2_counter + 1'b1;
+            end
+            else if (~D2_Taken & (d2_counter != 2'b00)) begin
+                pht[d2_pht_index] <= d2_counter - 1'b1;
+            end
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset) begin
+            btb_valid <= {BTB_ENTRIES{1'b0}};
+        end
+        else if (D2_Update & D2_Taken) begin
+            btb_valid[d2_btb_index] <= 1'b1;
+        end
+        else if (D2_Invalidate) begin
+            btb_valid[d2_btb_index] <= 1'b0;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (D2_Update & D2_Taken) begin
+            btb_tag[d2_btb_index]    <= d2_btb_tag;
+            btb_target[d2_btb_index] <= D2_Target;
+            btb_call[d2_btb_index]   <= D2_Call;
+            btb_return[d2_btb_index] <= D2_Return;
+        end
+    end
+
+    // Return address stack: W1 recovery, then D2 recovery, then F1 prediction
+    wire [3:0] d2_ras_push = D2_RasPtr + 1'b1;
+    wire [3:0] f1_ras_push = ras_ptr + 1'b1;
+
+    always @(posedge clock) begin
+        if (reset) begin
+            ras_ptr <= 4'd0;
+        end
+        else if (W1_Flush) begin
+            ras_ptr <= W1_RasPtr;
+        end
+        else if (D2_Redirect) begin
+            if (D2_Taken & D2_Call) begin
+                ras_ptr <= d2_ras_push;
+            end
+            else if (D2_Taken & D2_Return) begin
+                ras_ptr <= D2_RasPtr - 1'b1;
+            end
+            else begin
+                ras_ptr <= D2_RasPtr;
+            end
+        end
+        else if (~F1_Stall & F1_PredTaken & f1_call) begin
+            ras_ptr <= f1_ras_push;
+        end
+        else if (~F1_Stall & F1_PredTaken & f1_return) begin
+            ras_ptr <= ras_ptr - 1'b1;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (~W1_Flush & D2_Redirect & D2_Taken & D2_Call) begin
+            ras[d2_ras_push & RAS_MASK] <= D2_LinkPC;
+        end
+        else if (~W1_Flush & ~D2_Redirect & ~F1_Stall & F1_PredTaken & f1_call) begin
+            ras[f1_ras_push & RAS_MASK] <= f1_link_pc;
+        end
+    end
+
+    // The delay slot is fetched normally after a predicted-taken branch; the target follows it.
+    always @(posedge clock) begin
+        if (reset | F1_Flush) begin
+            pending <= 1'b0;
+        end
+        else if (~F1_Stall) begin
+            pending <= F1_PredTaken;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (~F1_Stall & F1_PredTaken) begin
+            pending_target <= F1_PredTarget;
+        end
+    end
+
+endmodule
+
@@ -13,8 +13,24 @@
  *
  * Description:
  *   MIPS32r1 Coprocessor 0 Registers
+ *
+ *   The cache fields of Config1 are derived from the cache geometry parameters:
+ *   2^*_INDEX_BITS sets (6-8) of 16-byte lines in *_WAYS ways (1-8).
+ *
+ *   Two performance counter pairs are implemented in Register 25: PerfCtl0/PerfCnt0
+ *   (Select 0/1) and PerfCtl1/PerfCnt1 (Select 2/3). A counter increments in each cycle
+ *   in which its selected event occurs and the mode enables (EXL, K, U) allow counting.
+ *   Either counter may select any event:
+ *      0: Cycles                           6: D-cache misses (line fills)
+ *      1: Instructions completed           7: D-cache stall cycles
+ *      2: Taken jumps/branches             8: Issue (D2) stall cycles
+ *      3: Branch flushes (fetch redirects) 9: Instruction TLB refills
+ *      4: I-cache misses (line fills)     10: Data TLB refills
+ *      5: I-cache stall cycles         11-63: (Nothing)
+ *   An enabled overflow interrupt (IE) is raised while bit 31 of the counter is set
+ *   and shares IP7 with the timer interrupt.
  */
-module CP0_Registers #(parameter PABITS=36) (
+module CP0_Registers #(parameter PABITS=36, parameter ICACHE_INDEX_BITS=8, parameter ICACHE_WAYS=2, parameter DCACHE_INDEX_BITS=6, parameter DCACHE_WAYS=2) (
     input                  clock,
     input                  reset,
     input                  W1_Issued,      // W1 was not previously stalled/flushed (it's active)
@@ -50,6 +66,7 @@ module CP0_Registers #(parameter PABITS=36) (
     input  [31:0]          RestartPC,      // Restart PC of an exception (from W1)
     input                  IsBDS,          // Exception is a branch delay slot (from W1)
     input                  Eret,           // A current ERET instruction in W1
+    input  [15:0]          PerfEvents,     // Performance counter events, indexed by PerfCtl 'Event'
     //-- Output data --//
     output [(PABITS-8):0]  CacheTag_Out,   // Tag data for 'Store Tag' {PTag[28:2], PState[1:0]}
     output                 ReverseEndian,
@@ -213,15 +230,15 @@ module CP0_Registers #(parameter PABITS=36) (
     // Configuration 1 (Register 16, Select 1)
     wire Config1_M = 0;
     wire [5:0] Config1_MMU = 6'b001111; // 16-entry TLB
-    wire [2:0] Config1_IS = 3'b010;     // 256 i-cache sets per way (8KB 2-way 16-byte line)
-    wire [2:0] Config1_IL = 3'b011;     // 16-byte i-cache line size
-    wire [2:0] Config1_IA = 3'b001;     // 2-way i-cache associativity
-    wire [2:0] Config1_DS = 3'b000;     // 64 d-cache sets per way (2KB 2-way 16-byte line)
-    wire [2:0] Config1_DL = 3'b011;     // 16-byte d-cache line size
-    wire [2:0] Config1_DA = 3'b001;     // 2-way d-cache associativity
+    wire [2:0] Config1_IS = ICACHE_INDEX_BITS - 6;  // i-cache sets per way (64 << IS)
+    wire [2:0] Config1_IL = 3'b011;                 // 16-byte i-cache line size
+    wire [2:0] Config1_IA = ICACHE_WAYS - 1;        // i-cache associativity (IA+1 ways)
+    wire [2:0] Config1_DS = DCACHE_INDEX_BITS - 6;  // d-cache sets per way (64 << DS)
+    wire [2:0] Config1_DL = 3'b011;                 // 16-byte d-cache line size
+    wire [2:0] Config1_DA = DCACHE_WAYS - 1;        // d-cache associativity (DA+1 ways)
     wire Config1_C2 = 0;
     wire Config1_MD = 0;
-    wire Config1_PC = 0;    // XXX Performance Counters
+    wire Config1_PC = 1;    // Performance Counters
     wire Config1_WR = 0;    // XXX Watch Registers
     wire Config1_CA = 0;
     wire Config1_EP = 0;
@@ -231,6 +248,27 @@ module CP0_Registers #(parameter PABITS=36) (
                                   Config1_MD, Config1_PC, Config1_WR, Config1_CA,
                                   Config1_EP, Config1_FP};
 
+    // Performance Counter Control (Register 25, Select 0,2)
+    wire PerfCtl0_M = 1'b1;         // PerfCtl1/PerfCnt1 are implemented
+    wire PerfCtl1_M = 1'b0;
+    wire [5:0] PerfCtl0_Event;      // Event to count
+    wire [5:0] PerfCtl1_Event;
+    wire PerfCtl0_IE;               // Overflow interrupt enable
+    wire PerfCtl1_IE;
+    wire PerfCtl0_U;                // Count in User mode
+    wire PerfCtl1_U;
+    wire PerfCtl_S = 1'b0;          // No Supervisor mode
+    wire PerfCtl0_K;                // Count in Kernel mode (EXL=0, ERL=0)
+    wire PerfCtl1_K;
+    wire PerfCtl0_EXL;              // Count when EXL=1 (ERL=0)
+    wire PerfCtl1_EXL;
+    wire [31:0] PerfCtl0 = {PerfCtl0_M, {20{1'b0}}, PerfCtl0_Event, PerfCtl0_IE, PerfCtl0_U, PerfCtl_S, PerfCtl0_K, PerfCtl0_EXL};
+    wire [31:0] PerfCtl1 = {PerfCtl1_M, {20{1'b0}}, PerfCtl1_Event, PerfCtl1_IE, PerfCtl1_U, PerfCtl_S, PerfCtl1_K, PerfCtl1_EXL};
+
+    // Performance Counter Count (Register 25, Select 1,3)
+    wire [31:0] PerfCnt0;
+    wire [31:0] PerfCnt1;
+
     // TagLo Registers (Register 28, Select 0,2)
     wire [22:0] TagLo0_PTag;        // Bits [31:9] of a 36-bit physical address. Low bits ignored when applicable.
     wire [1:0]  TagLo0_PState;      // 00->Invalid, 01->Valid, 10->Valid, 11->Valid+Dirty
@@ -261,6 +299,8 @@ module CP0_Registers #(parameter PABITS=36) (
     wire       EXC_TLB;         // TLB refill/invalid/modified exception (instruction / data)
     wire       EXC_EXL;         // Exceptions that are not reset, soft reset, NMI, or CacheErr
     wire       Int5;            // Timer interrupt
+    wire       Cause_TI;        // Pending timer interrupt (IP7)
+    wire       Perf_Int;        // Performance counter overflow interrupt (IP7)
 
     // *** Top-level assignments *** //
     assign DataOut        = reg_out;
@@ -320,6 +360,7 @@ module CP0_Registers #(parameter PABITS=36) (
             5'd14   : reg_out <= EPC;
             5'd15   : reg_out <= PRId;
             5'd16   : reg_out <= (Sel == 3'd0) ? Config : Config1;
+            5'd25   : reg_out <= (Sel[1]) ? ((Sel[0]) ? PerfCnt1 : PerfCtl1) : ((Sel[0]) ? PerfCnt0 : PerfCtl0);
             5'd28   : reg_out <= (Sel == 3'd0) ? TagLo0 : TagLo2;
             5'd29   : reg_out <= (Sel == 3'd0) ? TagHi0 : TagHi2;
             5'd30   : reg_out <= ErrorEPC;
@@ -443,10 +484,11 @@ module CP0_Registers #(parameter PABITS=36) (
     wire Cause_IP7_d      = (Cause_IP71_en) ? 1'b0 : 1'b1;
     wire Cause_ExcCode_en = WriteEnExcStd;
     reg  [4:0] Cause_ExcCode_d;
+    assign Cause_IP[7]    = Cause_TI | Perf_Int;
     DFF_E #(.WIDTH(1)) CauseBD      (.clock(clock), .enable(Cause_BD_en),      .D(IsBDS),           .Q(Cause_BD));
     DFF_E #(.WIDTH(2)) CauseCE      (.clock(clock), .enable(Cause_CE_en),      .D(Cause_CE_d),      .Q(Cause_CE));
     DFF_E #(.WIDTH(1)) CauseIV      (.clock(clock), .enable(CauseGen_en),      .D(DataIn[23]),      .Q(Cause_IV));
-    DFF_E #(.WIDTH(1)) CauseIP7     (.clock(clock), .enable(Cause_IP7_en),     .D(Cause_IP7_d),     .Q(Cause_IP[7]));
+    DFF_E #(.WIDTH(1)) CauseIP7     (.clock(clock), .enable(Cause_IP7_en),     .D(Cause_IP7_d),     .Q(Cause_TI));
     DFF_E #(.WIDTH(5)) CauseIP62    (.clock(clock), .enable(1'b1),             .D(Int),             .Q(Cause_IP[6:2]));
     DFF_E #(.WIDTH(2)) CauseIP10    (.clock(clock), .enable(CauseGen_en),      .D(DataIn[9:8]),     .Q(Cause_IP[1:0]));
     DFF_E #(.WIDTH(5)) CauseExcCode (.clock(clock), .enable(Cause_ExcCode_en), .D(Cause_ExcCode_d), .Q(Cause_ExcCode));
@@ -493,6 +535,36 @@ module CP0_Registers #(parameter PABITS=36) (
     wire Config_K0_en = WriteEnGen & Mtc0 & (Rd == 5'd16) & (Sel == 3'd0);
     DFF_E #(.WIDTH(3)) CONFIGK0 (.clock(clock), .enable(Config_K0_en), .D(DataIn[2:0]), .Q(Config_K0));
 
+    // Performance Counters (Register 25, Select 0-3)
+    wire Perf_KernelLvl = ~Status_UM & ~Status_EXL & ~Status_ERL;
+    wire Perf_UserLvl   =  Status_UM & ~Status_EXL & ~Status_ERL;
+    wire Perf_ExcLvl    =  Status_EXL & ~Status_ERL;
+    wire PerfCtl0_en    = WriteEnGen & Mtc0 & (Rd == 5'd25) & (Sel == 3'd0);
+    wire PerfCnt0_wr    = WriteEnGen & Mtc0 & (Rd == 5'd25) & (Sel == 3'd1);
+    wire PerfCtl1_en    = WriteEnGen & Mtc0 & (Rd == 5'd25) & (Sel == 3'd2);
+    wire PerfCnt1_wr    = WriteEnGen & Mtc0 & (Rd == 5'd25) & (Sel == 3'd3);
+    wire PerfCnt0_inc   = (PerfCtl0_Event[5:4] == 2'b00) & PerfEvents[PerfCtl0_Event[3:0]] &
+                          |{PerfCtl0_K & Perf_KernelLvl, PerfCtl0_U & Perf_UserLvl, PerfCtl0_EXL & Perf_ExcLvl};
+    wire PerfCnt1_inc   = (PerfCtl1_Event[5:4] == 2'b00) & PerfEvents[PerfCtl1_Event[3:0]] &
+                          |{PerfCtl1_K & Perf_KernelLvl, PerfCtl1_U & Perf_UserLvl, PerfCtl1_EXL & Perf_ExcLvl};
+    wire PerfCnt0_en    = |{PerfCnt0_wr, PerfCnt0_inc};
+    wire PerfCnt1_en    = |{PerfCnt1_wr, PerfCnt1_inc};
+    wire [31:0] PerfCnt0_d = (PerfCnt0_wr) ? DataIn : PerfCnt0 + 1;
+    wire [31:0] PerfCnt1_d = (PerfCnt1_wr) ? DataIn : PerfCnt1 + 1;
+    assign Perf_Int        = (PerfCtl0_IE & PerfCnt0[31]) | (PerfCtl1_IE & PerfCnt1[31]);
+    DFF_SRE #(.WIDTH(6))  PerfCtl0Event (.clock(clock), .reset(reset), .enable(PerfCtl0_en), .D(DataIn[10:5]), .Q(PerfCtl0_Event));
+    DFF_SRE #(.WIDTH(1))  PerfCtl0IE    (.clock(clock), .reset(reset), .enable(PerfCtl0_en), .D(DataIn[4]),    .Q(PerfCtl0_IE));
+    DFF_SRE #(.WIDTH(1))  PerfCtl0U     (.clock(clock), .reset(reset), .enable(PerfCtl0_en), .D(DataIn[3]),    .Q(PerfCtl0_U));
+    DFF_SRE #(.WIDTH(1))  PerfCtl0K     (.clock(clock), .reset(reset), .enable(PerfCtl0_en), .D(DataIn[1]),    .Q(PerfCtl0_K));
+    DFF_SRE #(.WIDTH(1))  PerfCtl0EXL   (.clock(clock), .reset(reset), .enable(PerfCtl0_en), .D(DataIn[0]),    .Q(PerfCtl0_EXL));
+    DFF_SRE #(.WIDTH(6))  PerfCtl1Event (.clock(clock), .reset(reset), .enable(PerfCtl1_en), .D(DataIn[10:5]), .Q(PerfCtl1_Event));
+    DFF_SRE #(.WIDTH(1))  PerfCtl1IE    (.clock(clock), .reset(reset), .enable(PerfCtl1_en), .D(DataIn[4]),    .Q(PerfCtl1_IE));
+    DFF_SRE #(.WIDTH(1))  PerfCtl1U     (.clock(clock), .reset(reset), .enable(PerfCtl1_en), .D(DataIn[3]),    .Q(PerfCtl1_U));
+    DFF_SRE #(.WIDTH(1))  PerfCtl1K     (.clock(clock), .reset(reset), .enable(PerfCtl1_en), .D(DataIn[1]),    .Q(PerfCtl1_K));
+    DFF_SRE #(.WIDTH(1))  PerfCtl1EXL   (.clock(clock), .reset(reset), .enable(PerfCtl1_en), .D(DataIn[0]),    .Q(PerfCtl1_EXL));
+    DFF_SRE #(.WIDTH(32)) PerfCnt0R     (.clock(clock), .reset(reset), .enable(PerfCnt0_en), .D(PerfCnt0_d),   .Q(PerfCnt0));
+    DFF_SRE #(.WIDTH(32)) PerfCnt1R     (.clock(clock), .reset(reset), .enable(PerfCnt1_en), .D(PerfCnt1_d),   .Q(PerfCnt1));
+
     // TagLo Registers (Register 28, Select 0,2)
     wire TagLo_en = WriteEnGen & Mtc0 & (Rd == 5'd28) & (Sel == 3'd0);
     DFF_E #(.WIDTH(23)) TagLoPTag   (.clock(clock), .enable(TagLo_en), .D(DataIn[30:8]), .Q(TagLo0_PTag));
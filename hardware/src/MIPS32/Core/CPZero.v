@@ -12,7 +12,7 @@
  *   interrupts, traps, system calls, and other exceptions. It distinguishes
  *   user and kernel modes, provides status information, and can override program flow.
  */
-module CPZero #(parameter PABITS=36) (
+module CPZero #(parameter PABITS=36, parameter ICACHE_INDEX_BITS=8, parameter ICACHE_WAYS=2, parameter DCACHE_INDEX_BITS=6, parameter DCACHE_WAYS=2) (
     input         clock,
     input         reset,
     input         reset_r,            // Clock-registered reset
@@ -81,6 +81,14 @@ module CPZero #(parameter PABITS=36) (
     input         W1_Eret,            // Eret instruction in W1
     output        D2_Exc_PC_Sel,      // Mux selector for exception PC override
     output [31:0] D2_Exc_PC_Out,      // Address for PC at the beginning of / return from an exception
+    //-- Performance counter events --//
+    input         Perf_ICacheMiss,    // I-cache line fill for a miss
+    input         Perf_ICacheStall,   // F2 waiting on the i-cache
+    input         Perf_DCacheMiss,    // D-cache line fill for a miss
+    input         Perf_DCacheStall,   // M2 waiting on the d-cache
+    input         Perf_Branch,        // Taken jump/branch in D2
+    input         Perf_Redirect,      // Fetch redirect (branch flush) from D2
+    input         Perf_IssueStall,    // D2 stalled by the hazard unit
     //-- Misc --//
     output [(PABITS-8):0] Cache_Out,  // Currently used for 'Store Tag' cache subinstruction (TagLo/Hi)
     output [3:0]  Index_Out,          // Index register (TLB)
@@ -140,6 +148,7 @@ module CPZero #(parameter PABITS=36) (
     wire [31:0]               Reg_RestartPC;
     wire                      Reg_IsBDS;
     wire                      Reg_Eret;
+    wire [15:0]               Reg_PerfEvents;
     wire [(PABITS-8):0]       Reg_CacheTag_Out;
     wire                      Reg_ReverseEndian;
     wire [3:0]                Reg_Index_Out;
@@ -325,6 +334,21 @@ module CPZero #(parameter PABITS=36) (
     assign Reg_IsBDS        = W1_ExcIsBDS;
     assign Reg_Eret         = W1_Eret;
 
+    // Performance counter events, indexed by the PerfCtl 'Event' field (see CP0_Registers).
+    // TLB misses are counted when their refill exceptions are taken in W1.
+    assign Reg_PerfEvents[0]     = 1'b1;
+    assign Reg_PerfEvents[1]     = W1_Issued;
+    assign Reg_PerfEvents[2]     = Perf_Branch;
+    assign Reg_PerfEvents[3]     = Perf_Redirect;
+    assign Reg_PerfEvents[4]     = Perf_ICacheMiss;
+    assign Reg_PerfEvents[5]     = Perf_ICacheStall;
+    assign Reg_PerfEvents[6]     = Perf_DCacheMiss;
+    assign Reg_PerfEvents[7]     = Perf_DCacheStall;
+    assign Reg_PerfEvents[8]     = Perf_IssueStall;
+    assign Reg_PerfEvents[9]     = W1_ExcActive & (W1_ExcCode == `Exc_TlbRi);
+    assign Reg_PerfEvents[10]    = W1_ExcActive & ((W1_ExcCode == `Exc_TlbRLd) | (W1_ExcCode == `Exc_TlbRSd));
+    assign Reg_PerfEvents[15:11] = {5{1'b0}};
+
     // TLB assignments
     assign TLB_VPN_I    = F1_VPN;
     assign TLB_ASID_I   = Reg_EntryHi_Out[7:0];
@@ -351,7 +375,13 @@ module CPZero #(parameter PABITS=36) (
     assign TLB_Kseg0_C  = Reg_K0;
 
     // CP0 Registers
-    CP0_Registers #(.PABITS(PABITS)) Registers (
+    CP0_Registers #(
+        .PABITS             (PABITS),
+        .ICACHE_INDEX_BITS  (ICACHE_INDEX_BITS),
+        .ICACHE_WAYS        (ICACHE_WAYS),
+        .DCACHE_INDEX_BITS  (DCACHE_INDEX_BITS),
+        .DCACHE_WAYS        (DCACHE_WAYS))
+        Registers (
         .clock           (clock),               // input clock
         .reset           (reset),               // input reset
         .W1_Issued       (Reg_W1_Issued),       // input W1_Issued
@@ -384,6 +414,7 @@ module CPZero #(parameter PABITS=36) (
         .RestartPC       (Reg_RestartPC),       // input [31 : 0] RestartPC
         .IsBDS           (Reg_IsBDS),           // input IsBDS
         .Eret            (Reg_Eret),            // input Eret
+        .PerfEvents      (Reg_PerfEvents),      // input [15 : 0] PerfEvents
         .CacheTag_Out    (Reg_CacheTag_Out),    // output [ : ] CacheTag_Out
         .ReverseEndian   (Reg_ReverseEndian),   // output ReverseEndian
         .Index_Out       (Reg_Index_Out),       // output [3 : 0] Index_Out
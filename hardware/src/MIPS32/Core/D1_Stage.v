@@ -22,16 +22,23 @@ module D1_Stage(
     input         F2_IsBDS,
     input  [31:0] F2_Instruction,
     input  [31:0] F2_FetchPC,
+    input  [3:0]  F2_RasPtr,
     input  [31:0] F2_PCAdd4,
     input         F2_XOP_Restart,
+    input         F2_PredTaken,
+    input  [31:0] F2_PredTarget,
+    input         D2_Redirect,
     output        D1_F2Issued,
     output [31:0] D1_Instruction,
     output [31:0] D1_FetchPC,   // Will be the final restart PC if F2_IsBDS is high
+    output [3:0]  D1_RasPtr,
     output        D1_F2IsBDS,
     output [31:0] D1_PCAdd4,
     output        D1_F2Exception,
     output [4:0]  D1_F2ExcCode,
-    output        D1_XOP_Restart
+    output        D1_XOP_Restart,
+    output        D1_PredTaken,
+    output [31:0] D1_PredTarget
     );
 
     wire en = ~D1_Stall | D1_Flush;
@@ -40,11 +47,14 @@ module D1_Stage(
     DFF_SRE #(.WIDTH(1))  Issued      (.clock(clock), .reset(reset), .enable(en),         .D(F2_Issued),      .Q(D1_F2Issued));
     DFF_E   #(.WIDTH(32)) Instruction (.clock(clock),                .enable(en),         .D(F2_Instruction), .Q(D1_Instruction));
     DFF_E   #(.WIDTH(32)) FetchPC     (.clock(clock),                .enable(restart_en), .D(F2_FetchPC),     .Q(D1_FetchPC));
+    DFF_E   #(.WIDTH(4))  RasPtr      (.clock(clock),                .enable(restart_en), .D(F2_RasPtr),      .Q(D1_RasPtr));
     DFF_E   #(.WIDTH(1))  IsBDS       (.clock(clock),                .enable(en),         .D(F2_IsBDS),       .Q(D1_F2IsBDS));
     DFF_E   #(.WIDTH(32)) PCAdd4      (.clock(clock),                .enable(en),         .D(F2_PCAdd4),      .Q(D1_PCAdd4));
     DFF_SRE #(.WIDTH(1))  Exception   (.clock(clock), .reset(reset), .enable(en),         .D(F2_Exception),   .Q(D1_F2Exception));
     DFF_E   #(.WIDTH(5))  ExcCode     (.clock(clock),                .enable(en),         .D(F2_ExcCode),     .Q(D1_F2ExcCode));
     DFF_E   #(.WIDTH(1))  XOP_Restart (.clock(clock),                .enable(en),         .D(F2_XOP_Restart), .Q(D1_XOP_Restart));
+    DFF_SRE #(.WIDTH(1))  PredTaken   (.clock(clock), .reset(reset | D2_Redirect), .enable(en), .D(F2_PredTaken), .Q(D1_PredTaken));
+    DFF_E   #(.WIDTH(32)) PredTarget  (.clock(clock),                .enable(en),         .D(F2_PredTarget),  .Q(D1_PredTarget));
 
 endmodule
 
@@ -23,6 +23,7 @@ module D2_Stage(
     input         D1_F2IsBDS,
     input  [31:0] D1_Instruction,
     input  [31:0] D1_FetchPC,
+    input  [3:0]  D1_RasPtr,
     input  [31:0] D1_ReadData1,
     input  [31:0] D1_ReadData2,
     input  [31:0] D2_ReadData1_Fwd,
@@ -30,9 +31,14 @@ module D2_Stage(
     input  [31:0] D1_Cp0_ReadData,
     input         D1_XOP_Restart,
     input  [31:0] D1_JumpIBrAddr,
+    input  [31:0] D1_PCAdd4,
+    input         D1_PredTaken,
+    input  [31:0] D1_PredTarget,
+    input         D2_Redirect,
     output        D2_D1Issued,
     output [31:0] D2_Instruction,
     output [31:0] D2_RestartPC,
+    output [3:0]  D2_RasPtr,
     output        D2_IsBDS,
     output [31:0] D2_ReadData1,
     output [31:0] D2_ReadData2,
@@ -41,7 +47,10 @@ module D2_Stage(
     output [4:0]  D2_D1ExcCode,
     output [31:0] D2_BadVAddr,
     output        D2_XOP_Restart,
-    output [31:0] D2_JumpIBrAddr
+    output [31:0] D2_JumpIBrAddr,
+    output [31:0] D2_PCAdd4,
+    output        D2_PredTaken,
+    output [31:0] D2_PredTarget
     );
 
     wire en = ~D2_Stall | D2_Flush;
@@ -53,6 +62,7 @@ module D2_Stage(
     DFF_SRE #(.WIDTH(1))  Issued       (.clock(clock), .reset(reset), .enable(en),         .D(D1_Issued),        .Q(D2_D1Issued));
     DFF_E   #(.WIDTH(32)) Instruction  (.clock(clock),                .enable(en),         .D(D1_Instruction),   .Q(D2_Instruction));
     DFF_E   #(.WIDTH(32)) RestartPC    (.clock(clock),                .enable(restart_en), .D(D1_FetchPC),       .Q(D2_RestartPC));
+    DFF_E   #(.WIDTH(4))  RasPtr       (.clock(clock),                .enable(restart_en), .D(D1_RasPtr),        .Q(D2_RasPtr));
     DFF_E   #(.WIDTH(1))  IsBDS        (.clock(clock),                .enable(en),         .D(BDS),              .Q(D2_IsBDS));
     DFF_E   #(.WIDTH(32)) ReadData1    (.clock(clock),                .enable(1'b1),       .D(Data1),            .Q(D2_ReadData1));
     DFF_E   #(.WIDTH(32)) ReadData2    (.clock(clock),                .enable(1'b1),       .D(Data2),            .Q(D2_ReadData2));
@@ -62,6 +72,9 @@ module D2_Stage(
     DFF_E   #(.WIDTH(32)) BadVAddr     (.clock(clock),                .enable(en),         .D(D1_FetchPC),       .Q(D2_BadVAddr));
     DFF_E   #(.WIDTH(1))  XOP_Restart  (.clock(clock),                .enable(en),         .D(D1_XOP_Restart),   .Q(D2_XOP_Restart));
     DFF_E   #(.WIDTH(32)) JumpIBrAddr  (.clock(clock),                .enable(en),         .D(D1_JumpIBrAddr),   .Q(D2_JumpIBrAddr));
+    DFF_E   #(.WIDTH(32)) PCAdd4       (.clock(clock),                .enable(en),         .D(D1_PCAdd4),        .Q(D2_PCAdd4));
+    DFF_SRE #(.WIDTH(1))  PredTaken    (.clock(clock), .reset(reset | D2_Redirect), .enable(en), .D(D1_PredTaken), .Q(D2_PredTaken));
+    DFF_E   #(.WIDTH(32)) PredTarget   (.clock(clock),                .enable(en),         .D(D1_PredTarget),    .Q(D2_PredTarget));
 
 endmodule
 
@@ -9,14 +9,20 @@
  *  1.0   6-Nov-2012   NJR       Initial design.
  *
  * Description:
- *  A multi-cycle 32-bit divider.
+ *  A multi-cycle 32-bit radix-4 divider with early-out.
  *
  *  On any cycle that one of OP_div or OP_divu are true, the Dividend and
  *  Divisor will be captured and a multi-cycle divide operation initiated.
- *  Stall will go true on the next cycle and the first cycle of the divide
- *  operation completed.  After some time (about 32 cycles), Stall will go
- *  false on the same cycle that the result becomes valid.  OP_div or OP_divu
- *  will abort any currently running divide operation and initiate a new one.
+ *  Stall will go true on the next cycle.  The first cycle of the divide
+ *  skips the leading quotient bits which must be zero (based on the leading
+ *  zeros of the dividend and divisor), and each following cycle produces two
+ *  quotient bits.  Stall will go false on the same cycle that the result
+ *  becomes valid: After 1 cycle if |Dividend| has fewer significant bits than
+ *  |Divisor|, otherwise after 17 - (skipped bits / 2) cycles, i.e., 2 to 17.
+ *  OP_div or OP_divu will abort any currently running divide operation and
+ *  initiate a new one.
+ *
+ *  As with MIPS 'div', the remainder takes the sign of the dividend.
  */
 module Divide(
     input           clock,
@@ -32,67 +38,124 @@ module Divide(
 
 
     reg             active;     // True if the divider is running
-    reg             neg;        // True if the result will be negative
-    reg [4:0]       cycle;      // Number of cycles to go
+    reg             first;      // True on the first (skip) cycle
+    reg             neg;        // True if the quotient will be negative
+    reg             neg_rem;    // True if the remainder will be negative
+    reg [3:0]       cycle;      // Number of cycles to go
 
     reg [31:0]      result;     // Begin with dividend, end with quotient
     reg [31:0]      denom;      // Divisor
+    reg [33:0]      denom3;     // Divisor * 3
     reg [31:0]      work;       // Running remainder
 
+    // Count leading zeros
+    function [5:0] clz;
+        input [31:0] value;
+        integer i;
+        begin
+            clz = 6'd32;
+            for (i = 0; i < 32; i = i + 1) begin
+                if (value[i]) begin
+                    clz = 6'd31 - i;
+                end
+            end
+        end
+    endfunction
+
+    // Quotient bits above (32 - skip) are known to be zero.  Only an even
+    // number of bits is skipped so the remaining bits pair up into digits.
+    wire [5:0]      result_lz = clz(result);
+    wire [5:0]      denom_lz  = clz(denom);
+    wire            trivial   = (denom != 32'b0) & (result_lz > denom_lz);
+    wire [5:0]      skip_bits = (denom == 32'b0) ? 6'd0 : (6'd31 + result_lz - denom_lz);
+    wire [5:0]      skip      = {skip_bits[5:1], 1'b0};
+    wire [63:0]     skipped   = {32'b0, result} << skip;
+
     // Calculate the current digit
-    wire [32:0]     sub = { work[30:0], result[31] } - denom;
+    wire [33:0]     rem4 = {work, result[31:30]};
+    wire [34:0]     sub1 = {1'b0, rem4} - {3'b0, denom};
+    wire [34:0]     sub2 = {1'b0, rem4} - {2'b0, denom, 1'b0};
+    wire [34:0]     sub3 = {1'b0, rem4} - {1'b0, denom3};
 
     // Send the results to our master
     assign Quotient = !neg ? result : -result;
-    assign Remainder = !neg ? work : -work;
+    assign Remainder = !neg_rem ? work : -work;
     assign Stall = active;
 
     // The state machine
     always @(posedge clock) begin
         if (reset) begin
             active <= 0;
+            first <= 0;
             neg <= 0;
+            neg_rem <= 0;
             cycle <= 0;
             result <= 0;
             denom <= 0;
+            denom3 <= 0;
             work <= 0;
         end
         else begin
             if (OP_div) begin
-                // Set up for a signed divide.  Remember the resulting sign,
+                // Set up for a signed divide.  Remember the resulting signs,
                 // and make the operands positive.
-                cycle <= 5'd31;
                 result <= (Dividend[31] == 0) ? Dividend : -Dividend;
                 denom <= (Divisor[31] == 0) ? Divisor : -Divisor;
                 work <= 32'b0;
                 neg <= Dividend[31] ^ Divisor[31];
+                neg_rem <= Dividend[31];
+                first <= 1;
                 active <= 1;
             end
             else if (OP_divu) begin
                 // Set up for an unsigned divide.
-                cycle <= 5'd31;
                 result <= Dividend;
                 denom <= Divisor;
                 work <= 32'b0;
                 neg <= 0;
+                neg_rem <= 0;
+                first <= 1;
                 active <= 1;
             end
+            else if (active & first) begin
+                // Skip the leading zero quotient bits.
+                first <= 0;
+                denom3 <= {2'b0, denom} + {1'b0, denom, 1'b0};
+                if (trivial) begin
+                    work <= result;
+                    result <= 32'b0;
+                    active <= 0;
+                end
+                else begin
+                    work <= skipped[63:32];
+                    result <= skipped[31:0];
+                    cycle <= 4'd15 - skip[4:1];
+                end
+            end
             else if (active) begin
                 // Run an iteration of the divide.
-                if (sub[32] == 0) begin
-                    work <= sub[31:0];
-                    result <= {result[30:0], 1'b1};
+                if (sub3[34] == 0) begin
+                    work <= sub3[31:0];
+                    result <= {result[29:0], 2'b11};
+                end
+                else if (sub2[34] == 0) begin
+                    work <= sub2[31:0];
+                    result <= {result[29:0], 2'b10};
+                end
+                else if (sub1[34] == 0) begin
+                    work <= sub1[31:0];
+                    result <= {result[29:0], 2'b01};
                 end
                 else begin
-                    work <= {work[30:0], result[31]};
-                    result <= {result[30:0], 1'b0};
+                    work <= rem4[31:0];
+                    result <= {result[29:0], 2'b00};
                 end
 
                 if (cycle == 0) begin
                     active <= 0;
                 end
 
-                cycle <= cycle - 5'd1;
+                cycle <= cycle - 4'd1;
             end
         end
     end
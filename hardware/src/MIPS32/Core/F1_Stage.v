@@ -19,12 +19,12 @@ module F1_Stage #(parameter PABITS=36) (
     input  [31:0]          D2_PC,
     input                  W1_DoICacheOp,
     input  [2:0]           W1_ICacheOp,
-    input  [(PABITS-11):0] W1_ICacheOpData,
+    input  [(PABITS-9):0]  W1_ICacheOpData,
     input                  W1_XOP_Restart,
     output [31:0]          F1_PC,
     output                 F1_DoICacheOp,
     output [2:0]           F1_ICacheOp,
-    output [(PABITS-11):0] F1_ICacheOpData,
+    output [(PABITS-9):0]  F1_ICacheOpData,
     output                 F1_XOP_Restart
     );
 
@@ -34,7 +34,7 @@ module F1_Stage #(parameter PABITS=36) (
     DFF_E   #(.WIDTH(32))        PC           (.clock(clock),                .enable(en), .D(D2_PC),            .Q(F1_PC));
     DFF_SRE #(.WIDTH(1))         DoICacheOp   (.clock(clock), .reset(reset), .enable(en), .D(W1_DoICacheOp),    .Q(F1_DoICacheOp));
     DFF_E   #(.WIDTH(3))         ICacheOp     (.clock(clock),                .enable(en), .D(W1_ICacheOp),      .Q(F1_ICacheOp));
-    DFF_E   #(.WIDTH(PABITS-10)) ICacheOpData (.clock(clock),                .enable(en), .D(W1_ICacheOpData),  .Q(F1_ICacheOpData));
+    DFF_E   #(.WIDTH(PABITS-8))  ICacheOpData (.clock(clock),                .enable(en), .D(W1_ICacheOpData),  .Q(F1_ICacheOpData));
     DFF_E   #(.WIDTH(1))         XOP_Restart  (.clock(clock),                .enable(en), .D(xop_restart_2cyc), .Q(F1_XOP_Restart));
 
 endmodule
@@ -21,15 +21,22 @@ module F2_Stage(
     input         F2_Flush,
     input  [31:0] F1_PC,
     input  [31:0] F1_PCAdd4,
+    input  [3:0]  F1_RasPtr,
     input         F1_DoICacheOp,
     input         F1_XOP_Restart,
+    input         F1_PredTaken,
+    input  [31:0] F1_PredTarget,
+    input         D2_Redirect,
     output        F2_F1Issued,
     output [31:0] F2_FetchPC,
     output [31:0] F2_PCAdd4,
+    output [3:0]  F2_RasPtr,
     output        F2_F1Exception,
     output [4:0]  F2_F1ExcCode,
     output        F2_F1DoICacheOp,
-    output        F2_XOP_Restart
+    output        F2_XOP_Restart,
+    output        F2_PredTaken,
+    output [31:0] F2_PredTarget
     );
 
     wire en = ~F2_Stall | F2_Flush;
@@ -37,10 +44,13 @@ module F2_Stage(
     DFF_SRE #(.WIDTH(1))  Issued      (.clock(clock), .reset(reset), .enable(en), .D(F1_Issued),      .Q(F2_F1Issued));
     DFF_E   #(.WIDTH(32)) FetchPC     (.clock(clock),                .enable(en), .D(F1_PC),          .Q(F2_FetchPC));
     DFF_E   #(.WIDTH(32)) PCAdd4      (.clock(clock),                .enable(en), .D(F1_PCAdd4),      .Q(F2_PCAdd4));
+    DFF_E   #(.WIDTH(4))  RasPtr      (.clock(clock),                .enable(en), .D(F1_RasPtr),      .Q(F2_RasPtr));
     DFF_SRE #(.WIDTH(1))  Exception   (.clock(clock), .reset(reset), .enable(en), .D(F1_Exception),   .Q(F2_F1Exception));
     DFF_E   #(.WIDTH(5))  ExcCode     (.clock(clock),                .enable(en), .D(F1_ExcCode),     .Q(F2_F1ExcCode));
     DFF_SRE #(.WIDTH(1))  DoICacheOp  (.clock(clock), .reset(reset), .enable(en), .D(F1_DoICacheOp),  .Q(F2_F1DoICacheOp));
     DFF_E   #(.WIDTH(1))  XOP_Restart (.clock(clock),                .enable(en), .D(F1_XOP_Restart), .Q(F2_XOP_Restart));
+    DFF_SRE #(.WIDTH(1))  PredTaken   (.clock(clock), .reset(reset | D2_Redirect), .enable(en), .D(F1_PredTaken), .Q(F2_PredTaken));
+    DFF_E   #(.WIDTH(32)) PredTarget  (.clock(clock),                .enable(en), .D(F1_PredTarget),  .Q(F2_PredTarget));
 
 endmodule
 
@@ -51,7 +51,7 @@ module Hazard_Detection(
     input         F2_Cache_Blocked, // Instruction cache busy and not cancellable
     input         M2_Cache_Stall,   // Data cache miss
     input         D2_NextIsBDS,     // A jump or branch is in D2
-    input         D2_Branch,        // A jump or branch is in D2 and will be taken
+    input         D2_Redirect,      // A jump or branch in D2 redirects instruction fetch (taken or mispredicted)
     input         ALU_MulBusy,      // The multicycle multiply/addsub unit is busy
     input         ALU_DivBusy,      // The multicycle divide unit is busy
     input         W1_ExcDetected,   // An exception/NMI in W1 which is not yet active
@@ -361,8 +361,8 @@ module Hazard_Detection(
     assign X1_Flush = W1_Flush;
     assign D2_Flush = W1_Flush;
     assign D1_Flush = W1_Flush;
-    assign F2_Flush = W1_Flush | (D2_Branch & D1_F2Issued);
-    assign F1_Flush = W1_Flush | D2_Branch;
+    assign F2_Flush = W1_Flush | (D2_Redirect & D1_F2Issued);
+    assign F1_Flush = W1_Flush | D2_Redirect;
 
 endmodule
 
@@ -20,6 +20,7 @@ module M1_Stage(
     input         M1_Stall,
     input         M1_Flush,
     input  [31:0] X1_RestartPC,
+    input  [3:0]  X1_RasPtr,
     input         X1_IsBDS,
     input  [1:0]  X1_M1_DP_Hazards,
     input  [4:0]  X1_Rt,
@@ -60,6 +61,7 @@ module M1_Stage(
     output        M1_X1Exception,
     output [4:0]  M1_X1ExcCode,
     output [31:0] M1_RestartPC,
+    output [3:0]  M1_RasPtr,
     output        M1_IsBDS,
     output [1:0]  M1_DP_Hazards,
     output [4:0]  M1_Rt,
@@ -102,6 +104,7 @@ module M1_Stage(
     DFF_SRE #(.WIDTH(1))  Exception     (.clock(clock), .reset(reset), .enable(en),   .D(X1_Exception),     .Q(M1_X1Exception));
     DFF_E   #(.WIDTH(5))  ExcCode       (.clock(clock),                .enable(en),   .D(X1_ExcCode),       .Q(M1_X1ExcCode));
     DFF_E   #(.WIDTH(32)) RestartPC     (.clock(clock),                .enable(en),   .D(X1_RestartPC),     .Q(M1_RestartPC));
+    DFF_E   #(.WIDTH(4))  RasPtr        (.clock(clock),                .enable(en),   .D(X1_RasPtr),        .Q(M1_RasPtr));
     DFF_E   #(.WIDTH(1))  IsBDS         (.clock(clock),                .enable(en),   .D(X1_IsBDS),         .Q(M1_IsBDS));
     DFF_E   #(.WIDTH(2))  DPHazards     (.clock(clock),                .enable(en),   .D(X1_M1_DP_Hazards), .Q(M1_DP_Hazards));
     DFF_E   #(.WIDTH(5))  Rt            (.clock(clock),                .enable(en),   .D(X1_Rt),            .Q(M1_Rt));
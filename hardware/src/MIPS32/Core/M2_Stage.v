@@ -20,6 +20,7 @@ module M2_Stage(
     input         M2_Stall,
     input         M2_Flush,
     input  [31:0] M1_RestartPC,
+    input  [3:0]  M1_RasPtr,
     input         M1_IsBDS,
     input  [4:0]  M1_RtRd,
     input  [2:0]  M1_CP0Sel,
@@ -54,6 +55,7 @@ module M2_Stage(
     output        M2_M1Exception,
     output [4:0]  M2_M1ExcCode,
     output [31:0] M2_RestartPC,
+    output [3:0]  M2_RasPtr,
     output        M2_IsBDS,
     output [4:0]  M2_RtRd,
     output [2:0]  M2_CP0Sel,
@@ -92,6 +94,7 @@ module M2_Stage(
     DFF_SRE #(.WIDTH(1))  Exception      (.clock(clock), .reset(reset), .enable(en), .D(M1_Exception),      .Q(M2_M1Exception));
     DFF_E   #(.WIDTH(5))  ExcCode        (.clock(clock),                .enable(en), .D(M1_ExcCode),        .Q(M2_M1ExcCode));
     DFF_E   #(.WIDTH(32)) RestartPC      (.clock(clock),                .enable(en), .D(M1_RestartPC),      .Q(M2_RestartPC));
+    DFF_E   #(.WIDTH(4))  RasPtr         (.clock(clock),                .enable(en), .D(M1_RasPtr),         .Q(M2_RasPtr));
     DFF_E   #(.WIDTH(1))  IsBDS          (.clock(clock),                .enable(en), .D(M1_IsBDS),          .Q(M2_IsBDS));
     DFF_E   #(.WIDTH(5))  RtRd           (.clock(clock),                .enable(en), .D(M1_RtRd),           .Q(M2_RtRd));
     DFF_E   #(.WIDTH(3))  CP0Sel         (.clock(clock),                .enable(en), .D(M1_CP0Sel),         .Q(M2_CP0Sel));
@@ -0,0 +1,117 @@
+`timescale 1ns / 1ps
+/*
+ * File         : MAddSub_32x32x64.v
+ * Project      : XUM MIPS32
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A portable multi-cycle 64-bit hardware multiply-adder/multiply-subtractor.
+ *
+ *   This is a drop-in replacement for the Xilinx-specific DSP_MAddSub_32x32x64
+ *   with the same interface. The multiplier is written behaviorally and followed
+ *   by 'STAGES' pipeline registers, which synthesis tools can retime into the
+ *   multiplier (register balancing) to reach a given clock frequency.
+ *
+ *   Multiply results are available on the (STAGES+1)th rising clock edge after
+ *   the 'start' signal is asserted, and fused multiply/add or multiply/subtract
+ *   results one edge later. At this time 'busy' will be low.
+ *
+ *   If 'EARLY_OUT' is set, operations where either multiplicand fits in 16 bits
+ *   (signed or unsigned, as selected by 'sign') use a narrower 33x17 multiplier
+ *   with half of the pipeline registers and finish early.
+ *
+ *   Operations can be interrupted by asserting the 'start' signal at
+ *   any time.
+ */
+module MAddSub_32x32x64 #(parameter STAGES=3, parameter EARLY_OUT=1) (
+    input         clock,
+    input         reset,
+    input  [31:0] A,        // First multiplicand
+    input  [31:0] B,        // Second multiplicand
+    input  [63:0] C,        // Addend (C + (A*B)) or minuend (C - (A*B))
+    input         sign,     // Treat inputs as signed (1) or unsigned (0)
+    input         fused,    // Perform a fused multiply/add or multiply/subtract
+    input         subtract, // Select between addition or subtraction for fused computations
+    input         start,    // Begin a computation
+    output        busy,     // A computation is in progress
+    output [64:0] D         // Result
+    );
+
+    localparam SHORT_STAGES = (STAGES + 1) / 2;
+
+    // Operand registers
+    reg  signed [32:0] a_r;         // Sign- or zero-extended multiplicand
+    reg  signed [32:0] b_r;         // Sign- or zero-extended multiplier (the small operand for early-out)
+    reg         [63:0] c_r;
+    reg                fused_r;
+    reg                subtract_r;
+    reg                short_r;     // The operation uses the narrow multiplier
+    reg         [4:0]  remaining;   // Cycles until the result is valid
+
+    // Local signals
+    wire        [32:0] a_ext = {(sign & A[31]), A};
+    wire        [32:0] b_ext = {(sign & B[31]), B};
+    wire               a_small = (sign) ? ((&A[31:15]) | ~(|A[31:15])) : ~(|A[31:16]);
+    wire               b_small = (sign) ? ((&B[31:15]) | ~(|B[31:15])) : ~(|B[31:16]);
+    wire               short   = (EARLY_OUT != 0) & (a_small | b_small);
+    wire signed [65:0] full_product  = a_r * b_r;
+    wire signed [49:0] short_product = a_r * $signed(b_r[16:0]);
+    wire        [63:0] product;
+    reg         [64:0] sum;
+
+    // Product pipelines
+    reg [63:0] full_pipe  [0:(STAGES-1)];
+    reg [63:0] short_pipe [0:(SHORT_STAGES-1)];
+
+    always @(posedge clock) begin
+        if (start) begin
+            // Place the small operand in 'b_r' for the narrow multiplier
+            a_r        <= (b_small | ~short) ? a_ext : b_ext;
+            b_r        <= (b_small | ~short) ? b_ext : a_ext;
+            c_r        <= C;
+            fused_r    <= fused;
+            subtract_r <= subtract;
+            short_r    <= short;
+        end
+    end
+
+    integer i;
+    always @(posedge clock) begin
+        full_pipe[0]  <= full_product[63:0];
+        short_pipe[0] <= {{14{short_product[49]}}, short_product};
+        for (i = 1; i < STAGES; i = i + 1) begin
+            full_pipe[i] <= full_pipe[i-1];
+        end
+        for (i = 1; i < SHORT_STAGES; i = i + 1) begin
+            short_pipe[i] <= short_pipe[i-1];
+        end
+    end
+
+    assign product = (short_r) ? short_pipe[SHORT_STAGES-1] : full_pipe[STAGES-1];
+
+    // Fused add/subtract stage (64-bit result; the carry bit is unused)
+    always @(posedge clock) begin
+        sum <= (subtract_r) ? ({1'b0, c_r} - {1'b0, product}) : ({1'b0, c_r} + {1'b0, product});
+    end
+
+    // Latency counter
+    always @(posedge clock) begin
+        if (reset) begin
+            remaining <= 5'd0;
+        end
+        else if (start) begin
+            remaining <= ((short) ? SHORT_STAGES : STAGES) + fused;
+        end
+        else if (remaining != 5'd0) begin
+            remaining <= remaining - 1'b1;
+        end
+    end
+
+    assign busy = (remaining != 5'd0);
+    assign D    = (fused_r) ? sum : {1'b0, product};
+
+endmodule
+
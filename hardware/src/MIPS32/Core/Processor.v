@@ -15,8 +15,17 @@
  * Description:
  *   The top-level MIPS32 Release 1 processor core.
  *   This unit is designed to integrate with an instruction and data cache.
+ *
+ *   The parameter 'BRANCH_PREDICT' enables a dynamic branch predictor in the
+ *   fetch stages (see BranchPredictor.v). Otherwise every taken branch/jump
+ *   redirects instruction fetch from D2. 'RAS_BITS' sets the log2 depth of its
+ *   return address stack (0-4, where 0 disables it).
+ *
+ *   The cache geometry parameters ('ICACHE_INDEX_BITS', 'ICACHE_WAYS', etc.)
+ *   do not change the core; they are reported to software in CP0 Config1.
  */
-module Processor #(parameter PABITS=36) (
+module Processor #(parameter PABITS=36, parameter MULT_DSP=1, parameter MULT_STAGES=3, parameter MULT_EARLY_OUT=1, parameter BRANCH_PREDICT=0, parameter RAS_BITS=3,
+                   parameter ICACHE_INDEX_BITS=8, parameter ICACHE_WAYS=2, parameter DCACHE_INDEX_BITS=6, parameter DCACHE_WAYS=2) (
     input                   clock,
     input                   reset,
     // Instruction Memory Interface
@@ -28,10 +37,11 @@ module Processor #(parameter PABITS=36) (
     output                  InstMem_Stall,         // Inform the i-cache to hold its data due to a processor stall
     output                  InstMem_DoCacheOp,     // Perform an administrative operation on the i-cache
     output [2:0]            InstMem_CacheOp,       // Operation to perform on the i-cache
-    output [(PABITS-11):0]  InstMem_CacheOpData,   // Tag data for an i-cache operation (12-bit index)
+    output [(PABITS-9):0]   InstMem_CacheOpData,   // Tag data for an i-cache operation (10-bit index)
     input  [31:0]           InstMem_In,            // Inbound instruction
     input                   InstMem_Ready,         // The instruction at 'InstMem_In' is valid
     input                   InstMem_Blocked,       // The instruction cache cannot be cancelled/interrupted
+    input                   InstMem_Miss,          // The instruction cache started a line fill for a miss (performance counters)
     // Data Memory Interface
     output [9:0]            DataMem_VAddress,      // Bits [11:2] of the 32-bit virtual / 36-bit physical data memory address
     output [(PABITS-13):0]  DataMem_PAddress,      // Bits [35:12] of the 36-bit physical data memory address
@@ -44,8 +54,10 @@ module Processor #(parameter PABITS=36) (
     output                  DataMem_DoCacheOp,     // Perform an administrative operation on the d-cache
     output [2:0]            DataMem_CacheOp,       // Operation to perform on the d-cache
     output [(PABITS-9):0]   DataMem_CacheOpData,   // Tag data for a d-cache operation (10-bit index)
+    output [31:0]           DataMem_PC,            // Program counter of the data memory access (for the d-cache prefetcher)
     input  [31:0]           DataMem_In,            // Inbound data (load)
     input                   DataMem_Ready,         // The data at 'DataMem_In' is valid
+    input                   DataMem_Miss,          // The data cache started a line fill for a miss (performance counters)
     // External interrupts
     input  [4:0]            Interrupts,            // 5 general-purpose hardware interrupts
     input                   NMI                    // Non-maskable interrupt
@@ -111,6 +123,15 @@ module Processor #(parameter PABITS=36) (
      * So, how to tell? Check if D1 is Issued (D1_F2Issued). If yes, it's the BDS. Otherwise it's F2.
      *
      * Summary: F1 Flush: "D2_Branch", F2 Flush: "D2_Branch & D1_F2Issued"
+     *
+     * Branch prediction (BRANCH_PREDICT=1):
+     *
+     * - F1 looks up its PC in the predictor. A predicted-taken instruction carries 'PredTaken' and
+     *   'PredTarget' through F2 and D1 to D2. The delay slot is fetched next, and then the target.
+     * - D2 compares the prediction with the actual outcome. Only a mismatch ('D2_Redirect') flushes
+     *   F1/F2 as above, using the actual target or the fall-through PC (PC+8) of the instruction.
+     * - A redirect clears the predictions still held by younger, unflushed stages (the delay slot).
+     * - Without the predictor 'PredTaken' is always zero and 'D2_Redirect' is equal to 'D2_Branch'.
      */
 
     //*** Instruction Fetch 1 (F1) Signals ***//
@@ -125,10 +146,16 @@ module Processor #(parameter PABITS=36) (
     wire [31:0] F1_PC;                  // Authoritative program counter for instruction memory
     wire [31:0] F1_PCAdd4;              // PC+4 for non-branch, non-exception
     wire [31:0] F1_PCAdd4_XOP;          // PC+4 for non-branch, non-exception after XOP restart PC mux
+    wire [31:0] F1_PCNext;              // Next PC for non-branch, non-exception after prediction and mispredict fall-through
+    wire        F1_PredTaken;           // The instruction in F1 is predicted to be a taken branch/jump
+    wire [31:0] F1_PredTarget;          // Predicted target of the instruction in F1
+    wire        F1_PredNext;            // F1 holds the delay slot of a predicted-taken branch/jump
+    wire [31:0] F1_PredNextPC;          // Predicted PC to follow the delay slot
+    wire [3:0]  F1_RasPtr;              // Return address stack pointer before the instruction (restored on a redirect/flush)
     wire        F1_EXC_AdIF;            // Address fetch exception
     wire        F1_DoICacheOp;
     wire [2:0]  F1_ICacheOp;
-    wire [(PABITS-11):0] F1_ICacheOpData; // Store tag data for i-cache operation
+    wire [(PABITS-9):0]  F1_ICacheOpData; // Store tag data for i-cache operation
 
     //*** Instruction Fetch 2 (F2) Signals ***//
     wire        F2_Stall;               // Pipeline stall
@@ -154,6 +181,9 @@ module Processor #(parameter PABITS=36) (
     wire [31:0] F2_Instruction;         // Instruction incoming from the cache
     wire [31:0] F2_FetchPC;             // Program counter for exceptions, will become 'RestartPC' by D2.
     wire [31:0] F2_PCAdd4;              // Address of next instruction for future branch calculation
+    wire        F2_PredTaken;
+    wire [31:0] F2_PredTarget;
+    wire [3:0]  F2_RasPtr;
     wire        F2_EXC_TlbRi;           // Instruction memory TLB refill exception
     wire        F2_EXC_TlbIi;           // Instruction memory TLB invalid exception
 
@@ -171,6 +201,9 @@ module Processor #(parameter PABITS=36) (
     wire [4:0]  D1_ExcCode;             // Exception code occuring in D1
     wire [31:0] D1_FetchPC;             // Program counter for exceptions (RestartPC after D2)
     wire [31:0] D1_PCAdd4;              // Address of the next instruction for branch calculation
+    wire        D1_PredTaken;
+    wire [31:0] D1_PredTarget;
+    wire [3:0]  D1_RasPtr;
     wire        D1_IsBDS;               // D1 is a branch delay slot
     wire        D1_JumpIInst;           // D1 is a jump immediate instruction (j / jal)
     wire [31:0] D1_JumpIAddress;        // 4-bit region with 26-bit instruction index all multiplied by four (jump immediate)
@@ -213,6 +246,15 @@ module Processor #(parameter PABITS=36) (
     wire [4:0]  D2_Rt;                  // Rt register index
     wire [5:0]  D2_Funct;               // MIPS instruction function code
     wire        D2_Branch;              // A jump/branch being taken
+    wire        D2_Redirect;            // Instruction fetch must be redirected: A taken jump/branch which was not (correctly) predicted, or a wrong prediction
+    wire        D2_PredValid;           // D2 holds an instruction whose prediction is checked this cycle
+    wire        D2_PredTaken;           // The instruction in D2 was predicted to be a taken branch/jump
+    wire [31:0] D2_PredTarget;          // Predicted target of the instruction in D2
+    wire [31:0] D2_BranchTarget;        // Actual target of a taken jump/branch in D2
+    wire [31:0] D2_PCAdd4;              // Address of the instruction after D2
+    wire [31:0] D2_PCAdd8;              // Address of the instruction after the delay slot of D2 (mispredict fall-through)
+    wire [3:0]  D2_RasPtr;
+    wire        D2_Return;              // D2 has a 'jr $ra' instruction
     wire [31:0] D2_SZExtImm;            // Sign- or zero-extended immediate field of the instruction
     wire [31:0] D2_RestartPC;           // Restart program counter for exceptions
     wire        D2_IsBDS;
@@ -295,6 +337,7 @@ module Processor #(parameter PABITS=36) (
     wire [4:0]  X1_D2ExcCode;
     reg  [4:0]  X1_ExcCode;
     wire [31:0] X1_RestartPC;
+    wire [3:0]  X1_RasPtr;
     wire        X1_IsBDS;
     wire [5:0]  X1_DP_Hazards;
     wire [1:0]  X1_M1_DP_Hazards;
@@ -366,6 +409,7 @@ module Processor #(parameter PABITS=36) (
     wire [4:0]  M1_X1ExcCode;
     reg  [4:0]  M1_ExcCode;
     wire [31:0] M1_RestartPC;
+    wire [3:0]  M1_RasPtr;
     wire        M1_IsBDS;
     wire [1:0]  M1_DP_Hazards;
     wire [4:0]  M1_Rt;
@@ -423,6 +467,7 @@ module Processor #(parameter PABITS=36) (
     wire [4:0]  M2_M1ExcCode;
     reg  [4:0]  M2_ExcCode;
     wire [31:0] M2_RestartPC;
+    wire [3:0]  M2_RasPtr;
     wire        M2_IsBDS;
     wire [(PABITS-13):0] M2_PFN;        // Data memory physical address translation
     wire        M2_PFN_Valid;           // Data memory translation is valid
@@ -487,6 +532,7 @@ module Processor #(parameter PABITS=36) (
     wire [4:0]  W1_M2ExcCode;
     reg  [4:0]  W1_ExcCode;
     wire [31:0] W1_RestartPC;
+    wire [3:0]  W1_RasPtr;
     wire        W1_IsBDS;
     wire        W1_M2MemRWIssued;       // A memory read/write of any type occured in M2 (used to mask interrupts in W1)
     wire [4:0]  W1_RtRd;                // Write register index
@@ -509,7 +555,7 @@ module Processor #(parameter PABITS=36) (
     wire        W1_ICacheOp;
     wire        W1_ICacheOpEn;
     wire [2:0]  W1_ICacheOpCode;
-    wire [(PABITS-11):0] W1_ICacheOpData;
+    wire [(PABITS-9):0]  W1_ICacheOpData;
     wire        W1_Eret;
     wire        W1_XOP;
     wire        W1_XOP_Restart;         // Indicator that the upcoming 2nd fetch of an XOP should be skipped
@@ -553,6 +599,7 @@ module Processor #(parameter PABITS=36) (
     assign DataMem_Stall         = M2_NonMem_Stall;
     assign DataMem_CacheOp       = M1_RtRd[4:2];
     assign DataMem_CacheOpData   = {W1_CacheOut[(PABITS-8):3], W1_CacheOut[1:0]};
+    assign DataMem_PC            = M2_RestartPC;
 
     //*** Pipeline Assignments ***//
     assign F1_Mask_Haz        = reset_r | F1_Stall | F1_Flush;
@@ -607,6 +654,10 @@ module Processor #(parameter PABITS=36) (
     assign D2_Funct           = D2_Instruction[5:0];
     assign D2_SZExtImm        = {{16{D2_SignExtend & D2_Instruction[15]}}, D2_Instruction[15:0]};
     assign D2_Branch          = |{D2_PCSrc_Br} & D2_Issued;
+    assign D2_PredValid       = D2_D1Issued & ~(D2_Mask_Haz | D2_Mask_Exc);
+    assign D2_BranchTarget    = (D2_PCSrc_Br == 2'b11) ? D2_JumpRAddress : D2_JumpIBrAddr;
+    assign D2_Redirect        = D2_PredValid & ((D2_Branch ^ D2_PredTaken) | (D2_Branch & (D2_BranchTarget != D2_PredTarget)));
+    assign D2_Return          = (D2_PCSrc_Br == 2'b11) & ~D2_Link & (D2_Rs == 5'd31);
     assign D2_JumpRAddress    = D2_ReadData1_End;
     assign D2_CP0             = |{D2_Mfc0, D2_Mtc0, D2_Eret, D2_TLBp, D2_TLBr, D2_TLBwi, D2_TLBwr, D2_ICacheOp, D2_DCacheOp}; // XXX Are cacheops really considered CP0? Maybe user is fine
     assign X1_Mask_Haz        = X1_Stall | X1_Flush;
@@ -642,7 +693,7 @@ module Processor #(parameter PABITS=36) (
     assign W1_WriteDataSel    = {(W1_LoWrite & W1_RegWrite), W1_MemToReg}; // Bit 1 selects 'mul' instruction
     assign W1_ICacheOpEn      = W1_ICacheOp & W1_Issued;
     assign W1_ICacheOpCode    = W1_RtRd[4:2];
-    assign W1_ICacheOpData    = {W1_CacheOut[(PABITS-8):5], W1_CacheOut[1:0]};
+    assign W1_ICacheOpData    = {W1_CacheOut[(PABITS-8):3], W1_CacheOut[1:0]};
     assign W1_XOP_Restart     = W1_XOP & W1_Issued & ~W1_Eret;  // Eret already jumps to the next PC
 
 
@@ -786,6 +837,57 @@ module Processor #(parameter PABITS=36) (
         .out (F1_PCAdd4_XOP)
     );
 
+    //*** Branch Predictor ***//
+    generate
+        if (BRANCH_PREDICT) begin : branch_predict
+            BranchPredictor #(
+                .RAS_BITS       (RAS_BITS))
+                BranchPredictor (
+                .clock          (clock),
+                .reset          (reset),
+                .F1_PC          (F1_PC),
+                .F1_Lookup      (F1_Issued & ~F1_DoICacheOp),
+                .F1_Stall       (F1_Stall),
+                .F1_Flush       (F1_Flush),
+                .F1_PredTaken   (F1_PredTaken),
+                .F1_PredTarget  (F1_PredTarget),
+                .F1_PredNext    (F1_PredNext),
+                .F1_PredNextPC  (F1_PredNextPC),
+                .F1_RasPtr      (F1_RasPtr),
+                .D2_Update      (D2_PredValid & D2_Issued & D2_NextIsBDS),
+                .D2_Invalidate  (D2_PredValid & D2_PredTaken & ~(D2_Issued & D2_NextIsBDS)),
+                .D2_PC          (D2_PCAdd4 - 32'd4),
+                .D2_Taken       (D2_Branch),
+                .D2_Target      (D2_BranchTarget),
+                .D2_Call        (D2_Link),
+                .D2_Return      (D2_Return),
+                .D2_LinkPC      (D2_PCAdd8),
+                .D2_RasPtr      (D2_RasPtr),
+                .D2_Redirect    (D2_Redirect),
+                .W1_Flush       (W1_Flush),
+                .W1_RasPtr      (W1_RasPtr)
+            );
+        end
+        else begin : no_branch_predict
+            assign F1_PredTaken  = 1'b0;
+            assign F1_PredTarget = 32'h00000000;
+            assign F1_PredNext   = 1'b0;
+            assign F1_PredNextPC = 32'h00000000;
+            assign F1_RasPtr     = 4'h0;
+        end
+    endgenerate
+
+    //*** D2 Fall-through Adder ***//
+    Add #(.WIDTH(32)) PC_Add8 (
+        .A  (D2_PCAdd4),
+        .B  (32'd4),
+        .C  (D2_PCAdd8)
+    );
+
+    // Next sequential PC: XOP restarts have priority, then a wrong prediction in D2 resumes at its
+    // fall-through PC, and a predicted branch/jump whose delay slot is in F1 continues at its target.
+    assign F1_PCNext = (W1_XOP_Restart | F1_DoICacheOp) ? F1_PCAdd4_XOP : (D2_Redirect & ~D2_Branch) ? D2_PCAdd8 : (F1_PredNext) ? F1_PredNextPC : F1_PCAdd4_XOP;
+
     //*** Instruction Fetch Stage 2 Register ***//
     F2_Stage F2 (
         .clock           (clock),
@@ -798,14 +900,21 @@ module Processor #(parameter PABITS=36) (
         .F1_PC           ((F1_DoICacheOp) ? W1_RestartPC : F1_PC),  // Allow i-cache op exceptions
         .F1_DoICacheOp   (F1_DoICacheOp),
         .F1_PCAdd4       (F1_PCAdd4_XOP),
+        .F1_RasPtr       (F1_RasPtr),
         .F1_XOP_Restart  (F1_XOP_Restart),
+        .F1_PredTaken    (F1_PredTaken),
+        .F1_PredTarget   (F1_PredTarget),
+        .D2_Redirect     (D2_Redirect),
         .F2_F1Issued     (F2_F1Issued),
         .F2_FetchPC      (F2_FetchPC),
         .F2_PCAdd4       (F2_PCAdd4),
+        .F2_RasPtr       (F2_RasPtr),
         .F2_F1Exception  (F2_F1Exception),
         .F2_F1ExcCode    (F2_F1ExcCode),
         .F2_F1DoICacheOp (F2_F1DoICacheOp),
-        .F2_XOP_Restart  (F2_XOP_Restart)
+        .F2_XOP_Restart  (F2_XOP_Restart),
+        .F2_PredTaken    (F2_PredTaken),
+        .F2_PredTarget   (F2_PredTarget)
     );
 
     //*** Instruction Decode Stage 1 Register ***//
@@ -820,16 +929,23 @@ module Processor #(parameter PABITS=36) (
         .F2_IsBDS        (F2_IsBDS),
         .F2_Instruction  (F2_Instruction),
         .F2_FetchPC      (F2_FetchPC),
+        .F2_RasPtr       (F2_RasPtr),
         .F2_PCAdd4       (F2_PCAdd4),
         .F2_XOP_Restart  (F2_XOP_Restart),
+        .F2_PredTaken    (F2_PredTaken),
+        .F2_PredTarget   (F2_PredTarget),
+        .D2_Redirect     (D2_Redirect),
         .D1_F2Issued     (D1_F2Issued),
         .D1_Instruction  (D1_Instruction),
         .D1_FetchPC      (D1_FetchPC),
+        .D1_RasPtr       (D1_RasPtr),
         .D1_F2IsBDS      (D1_F2IsBDS),
         .D1_PCAdd4       (D1_PCAdd4),
         .D1_F2Exception  (D1_F2Exception),
         .D1_F2ExcCode    (D1_F2ExcCode),
-        .D1_XOP_Restart  (D1_XOP_Restart)
+        .D1_XOP_Restart  (D1_XOP_Restart),
+        .D1_PredTaken    (D1_PredTaken),
+        .D1_PredTarget   (D1_PredTarget)
     );
 
     //*** Branch Address Adder ***//
@@ -880,6 +996,7 @@ module Processor #(parameter PABITS=36) (
         .D1_F2IsBDS        (D1_F2IsBDS),
         .D1_Instruction    (D1_Instruction),
         .D1_FetchPC        (D1_FetchPC),
+        .D1_RasPtr         (D1_RasPtr),
         .D1_ReadData1      (D1_ReadData1_End),
         .D1_ReadData2      (D1_ReadData2_End),
         .D2_ReadData1_Fwd  (D2_ReadData1_End),
@@ -887,9 +1004,14 @@ module Processor #(parameter PABITS=36) (
         .D1_Cp0_ReadData   (D1_Cp0_ReadData),
         .D1_XOP_Restart    (D1_XOP_Restart),
         .D1_JumpIBrAddr    (D1_JumpIBrAddr),
+        .D1_PCAdd4         (D1_PCAdd4),
+        .D1_PredTaken      (D1_PredTaken),
+        .D1_PredTarget     (D1_PredTarget),
+        .D2_Redirect       (D2_Redirect),
         .D2_D1Issued       (D2_D1Issued),
         .D2_Instruction    (D2_Instruction),
         .D2_RestartPC      (D2_RestartPC),
+        .D2_RasPtr         (D2_RasPtr),
         .D2_IsBDS          (D2_IsBDS),
         .D2_ReadData1      (D2_ReadData1),
         .D2_ReadData2      (D2_ReadData2),
@@ -898,20 +1020,24 @@ module Processor #(parameter PABITS=36) (
         .D2_D1ExcCode      (D2_D1ExcCode),
         .D2_BadVAddr       (D2_BadVAddr),
         .D2_XOP_Restart    (D2_XOP_Restart),
-        .D2_JumpIBrAddr    (D2_JumpIBrAddr)
+        .D2_JumpIBrAddr    (D2_JumpIBrAddr),
+        .D2_PCAdd4         (D2_PCAdd4),
+        .D2_PredTaken      (D2_PredTaken),
+        .D2_PredTarget     (D2_PredTarget)
     );
 
     // PC Source: Exceptions have priority. After that, non-branch/jumps and flushes get
-    // PC+4 / XOP RestartPC, branches and immediate jumps get JumpIBrAddr, and register jumps
-    // get the post-forwarded register data. An i-cache operation is a special serialized (XOP)
-    // case that always gets an effective address from the W1 ALU result.
-    assign D2_PCSrc_Sel[1] = D2_PCSrc_Exc | (D2_Issued & (D2_PCSrc_Br[1] & D2_PCSrc_Br[0])) | W1_ICacheOpEn;
-    assign D2_PCSrc_Sel[0] = D2_PCSrc_Exc | (D2_Issued & (D2_PCSrc_Br[1] ^ D2_PCSrc_Br[0])) & ~W1_ICacheOpEn;
+    // PC+4 / XOP RestartPC (or the predicted/fall-through PC), redirecting branches and immediate
+    // jumps get JumpIBrAddr, and redirecting register jumps get the post-forwarded register data.
+    // An i-cache operation is a special serialized (XOP) case that always gets an effective address
+    // from the W1 ALU result.
+    assign D2_PCSrc_Sel[1] = D2_PCSrc_Exc | (D2_Redirect & D2_Issued & (D2_PCSrc_Br[1] & D2_PCSrc_Br[0])) | W1_ICacheOpEn;
+    assign D2_PCSrc_Sel[0] = D2_PCSrc_Exc | (D2_Redirect & D2_Issued & (D2_PCSrc_Br[1] ^ D2_PCSrc_Br[0])) & ~W1_ICacheOpEn;
 
     // *** PC Source Final Mux *** //
     Mux4 #(.WIDTH(32)) PCSrc_Mux (
         .sel  (D2_PCSrc_Sel),
-        .in0  (F1_PCAdd4_XOP),
+        .in0  (F1_PCNext),
         .in1  (D2_JumpIBrAddr),
         .in2  (D2_JumpRAddress),
         .in3  (D2_ExceptionPC),
@@ -1045,7 +1171,7 @@ module Processor #(parameter PABITS=36) (
         .F2_Cache_Blocked  (InstMem_Blocked),
         .M2_Cache_Stall    (M2_Cache_Stall),
         .D2_NextIsBDS      (D2_NextIsBDS),
-        .D2_Branch         (D2_Branch),
+        .D2_Redirect       (D2_Redirect),
         .ALU_MulBusy       (ALU_MulBusy),
         .ALU_DivBusy       (ALU_DivBusy),
         .W1_ExcDetected    (W1_ExcDetected),
@@ -1080,7 +1206,13 @@ module Processor #(parameter PABITS=36) (
     );
 
     //*** Coprocessor 0 ***//
-    CPZero #(.PABITS(PABITS)) CP0 (
+    CPZero #(
+        .PABITS             (PABITS),
+        .ICACHE_INDEX_BITS  (ICACHE_INDEX_BITS),
+        .ICACHE_WAYS        (ICACHE_WAYS),
+        .DCACHE_INDEX_BITS  (DCACHE_INDEX_BITS),
+        .DCACHE_WAYS        (DCACHE_WAYS))
+        CP0 (
         .clock              (clock),
         .reset              (reset),
         .reset_r            (reset_r),
@@ -1144,6 +1276,13 @@ module Processor #(parameter PABITS=36) (
         .W1_Eret            (W1_Eret),
         .D2_Exc_PC_Sel      (D2_PCSrc_Exc),
         .D2_Exc_PC_Out      (D2_ExceptionPC),
+        .Perf_ICacheMiss    (InstMem_Miss),
+        .Perf_ICacheStall   (F2_Cache_Stall),
+        .Perf_DCacheMiss    (DataMem_Miss),
+        .Perf_DCacheStall   (M2_Cache_Stall),
+        .Perf_Branch        (D2_Branch),
+        .Perf_Redirect      (D2_Redirect & D2_Issued),
+        .Perf_IssueStall    (D2_Stall),
         .Cache_Out          (W1_CacheOut),
         .Index_Out          (M2_Index_Out),
         .Random_Out         (M2_Random_Out),
@@ -1161,6 +1300,7 @@ module Processor #(parameter PABITS=36) (
         .X1_Stall          (X1_Stall),
         .X1_Flush          (X1_Flush),
         .D2_RestartPC      (D2_RestartPC),
+        .D2_RasPtr         (D2_RasPtr),
         .D2_IsBDS          (D2_IsBDS),
         .D2_X1_DP_Hazards  (D2_X1_DP_Hazards),
         .D2_Rs             (D2_Rs),
@@ -1207,6 +1347,7 @@ module Processor #(parameter PABITS=36) (
         .X1_D2Exception    (X1_D2Exception),
         .X1_D2ExcCode      (X1_D2ExcCode),
         .X1_RestartPC      (X1_RestartPC),
+        .X1_RasPtr         (X1_RasPtr),
         .X1_IsBDS          (X1_IsBDS),
         .X1_DP_Hazards     (X1_DP_Hazards),
         .X1_Rs             (X1_Rs),
@@ -1294,7 +1435,11 @@ module Processor #(parameter PABITS=36) (
     );
 
     //*** Arithmetic Logic Unit (ALU) ***//
-    ALU ALU (
+    ALU #(
+        .MULT_DSP        (MULT_DSP),
+        .MULT_STAGES     (MULT_STAGES),
+        .MULT_EARLY_OUT  (MULT_EARLY_OUT))
+        ALU (
         .clock         (clock),
         .reset         (reset),
         .X1_Issued     (X1_Issued),
@@ -1326,6 +1471,7 @@ module Processor #(parameter PABITS=36) (
         .M1_Stall          (M1_Stall),
         .M1_Flush          (M1_Flush),
         .X1_RestartPC      (X1_RestartPC),
+        .X1_RasPtr         (X1_RasPtr),
         .X1_IsBDS          (X1_IsBDS),
         .X1_M1_DP_Hazards  (X1_M1_DP_Hazards),
         .X1_Rt             (X1_Rt),
@@ -1366,6 +1512,7 @@ module Processor #(parameter PABITS=36) (
         .M1_X1Exception    (M1_X1Exception),
         .M1_X1ExcCode      (M1_X1ExcCode),
         .M1_RestartPC      (M1_RestartPC),
+        .M1_RasPtr         (M1_RasPtr),
         .M1_IsBDS          (M1_IsBDS),
         .M1_DP_Hazards     (M1_DP_Hazards),
         .M1_Rt             (M1_Rt),
@@ -1457,6 +1604,7 @@ module Processor #(parameter PABITS=36) (
         .M2_Stall          (M2_Stall),
         .M2_Flush          (M2_Flush),
         .M1_RestartPC      (M1_RestartPC),
+        .M1_RasPtr         (M1_RasPtr),
         .M1_IsBDS          (M1_IsBDS),
         .M1_RtRd           (M1_RtRd),
         .M1_CP0Sel         (M1_CP0Sel),
@@ -1491,6 +1639,7 @@ module Processor #(parameter PABITS=36) (
         .M2_M1Exception    (M2_M1Exception),
         .M2_M1ExcCode      (M2_M1ExcCode),
         .M2_RestartPC      (M2_RestartPC),
+        .M2_RasPtr         (M2_RasPtr),
         .M2_IsBDS          (M2_IsBDS),
         .M2_RtRd           (M2_RtRd),
         .M2_CP0Sel         (M2_CP0Sel),
@@ -1550,6 +1699,7 @@ module Processor #(parameter PABITS=36) (
         .W1_Flush             (W1_Flush),
         .W1_Issued            (W1_Issued),
         .M2_RestartPC         (M2_RestartPC),
+        .M2_RasPtr            (M2_RasPtr),
         .M2_IsBDS             (M2_IsBDS),
         .M2_MemRWIssued       (M2_MemWriteIssued | M2_MemReadIssued),
         .M2_RtRd              (M2_RtRd),
@@ -1578,6 +1728,7 @@ module Processor #(parameter PABITS=36) (
         .W1_M2Exception       (W1_M2Exception),
         .W1_M2ExcCode         (W1_M2ExcCode),
         .W1_RestartPC         (W1_RestartPC),
+        .W1_RasPtr            (W1_RasPtr),
         .W1_IsBDS             (W1_IsBDS),
         .W1_M2MemRWIssued     (W1_M2MemRWIssued),
         .W1_RtRd              (W1_RtRd),
@@ -21,6 +21,7 @@ module W1_Stage #(parameter PABITS=36) (
     input         W1_Flush,
     input         W1_Issued,
     input  [31:0] M2_RestartPC,
+    input  [3:0]  M2_RasPtr,
     input         M2_IsBDS,
     input         M2_MemRWIssued,
     input  [4:0]  M2_RtRd,
@@ -49,6 +50,7 @@ module W1_Stage #(parameter PABITS=36) (
     output        W1_M2Exception,
     output [4:0]  W1_M2ExcCode,
     output [31:0] W1_RestartPC,
+    output [3:0]  W1_RasPtr,
     output        W1_IsBDS,
     output        W1_M2MemRWIssued,
     output [4:0]  W1_RtRd,
@@ -82,6 +84,7 @@ module W1_Stage #(parameter PABITS=36) (
     DFF_SRE #(.WIDTH(1))  Exception    (.clock(clock), .reset(reset), .enable(en),     .D(M2_Exception),      .Q(W1_M2Exception));
     DFF_E   #(.WIDTH(5))  ExcCode      (.clock(clock),                .enable(en),     .D(M2_ExcCode),        .Q(W1_M2ExcCode));
     DFF_E   #(.WIDTH(32)) RestartPC    (.clock(clock),                .enable(rpc_en), .D(M2_RestartPC),      .Q(W1_RestartPC));
+    DFF_E   #(.WIDTH(4))  RasPtr       (.clock(clock),                .enable(rpc_en), .D(M2_RasPtr),         .Q(W1_RasPtr));
     DFF_E   #(.WIDTH(1))  IsBDS        (.clock(clock),                .enable(en),     .D(M2_IsBDS),          .Q(W1_IsBDS));
     DFF_E   #(.WIDTH(1))  MemRWIssued  (.clock(clock),                .enable(en),     .D(M2_MemRWIssued), .Q(W1_M2MemRWIssued));
     DFF_E   #(.WIDTH(5))  RtRd         (.clock(clock),                .enable(en),     .D(M2_RtRd),           .Q(W1_RtRd));
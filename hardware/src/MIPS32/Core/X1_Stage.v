@@ -20,6 +20,7 @@ module X1_Stage(
     input         X1_Stall,
     input         X1_Flush,
     input  [31:0] D2_RestartPC,
+    input  [3:0]  D2_RasPtr,
     input         D2_IsBDS,
     input  [5:0]  D2_X1_DP_Hazards,
     input  [4:0]  D2_Rs,
@@ -66,6 +67,7 @@ module X1_Stage(
     output        X1_D2Exception,
     output [4:0]  X1_D2ExcCode,
     output [31:0] X1_RestartPC,
+    output [3:0]  X1_RasPtr,
     output        X1_IsBDS,
     output [5:0]  X1_DP_Hazards,
     output [4:0]  X1_Rs,
@@ -124,6 +126,7 @@ module X1_Stage(
     DFF_SRE #(.WIDTH(1))  Exception     (.clock(clock), .reset(reset), .enable(en),   .D(D2_Exception),     .Q(X1_D2Exception));
     DFF_E   #(.WIDTH(5))  ExcCode       (.clock(clock),                .enable(en),   .D(D2_ExcCode),       .Q(X1_D2ExcCode));
     DFF_E   #(.WIDTH(32)) RestartPC     (.clock(clock),                .enable(en),   .D(D2_RestartPC),     .Q(X1_RestartPC));
+    DFF_E   #(.WIDTH(4))  RasPtr        (.clock(clock),                .enable(en),   .D(D2_RasPtr),        .Q(X1_RasPtr));
     DFF_E   #(.WIDTH(1))  IsBDS         (.clock(clock),                .enable(en),   .D(D2_IsBDS),         .Q(X1_IsBDS));
     DFF_E   #(.WIDTH(6))  DPHazards     (.clock(clock),                .enable(en),   .D(D2_X1_DP_Hazards), .Q(X1_DP_Hazards));
     DFF_E   #(.WIDTH(5))  Rs            (.clock(clock),                .enable(en),   .D(D2_Rs),            .Q(X1_Rs));
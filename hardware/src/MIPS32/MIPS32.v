@@ -21,8 +21,33 @@
  *
  *   The parameter 'PABITS' specifies the size of physical memory (12 < PABITS < 37).
  *   For example, For 64 MB of RAM, PABITS=26.
+ *
+ *   The parameter 'MULT_DSP' selects the Xilinx DSP48A1 multiplier (1) or the portable
+ *   multiplier (0), which has 'MULT_STAGES' pipeline stages and an optional early-out
+ *   for small operands ('MULT_EARLY_OUT'). See ALU.v.
+ *
+ *   The parameter 'BRANCH_PREDICT' enables the dynamic branch predictor, and 'RAS_BITS' sets
+ *   the depth of its return address stack. See Processor.v.
+ *
+ *   The parameter 'DCACHE_BG_FILL' makes data cache store misses complete at once and fill
+ *   their lines in the background, while hits and one further miss proceed. Load misses
+ *   still stall until their word arrives. See DataCache.v.
+ *
+ *   The parameter 'EARLY_RESTART' lets both caches return the requested word of a miss as
+ *   soon as it arrives, while the rest of the line is filled. It is most useful when memory
+ *   returns the requested word first (e.g., MainMemory with 'CRIT_WORD_FIRST').
+ *
+ *   The parameter 'PREFETCH' adds a next-line prefetcher to the instruction cache and a
+ *   stride prefetcher (indexed by the PC of the load or store) to the blocking data cache.
+ *   Each prefetches one line into a buffer beside the cache. See the cache modules.
+ *
+ *   The cache geometry is set by '*CACHE_INDEX_BITS' (log2 sets per way, 6-8) and
+ *   '*CACHE_WAYS' (1, 2, 4, or 8) with 16-byte lines. The defaults are an 8 KiB 2-way
+ *   instruction cache and a 2 KiB 2-way data cache. CP0 Config1 reports the geometry.
  */
-module MIPS32 #(parameter PABITS=32) (
+module MIPS32 #(parameter PABITS=32, parameter MULT_DSP=1, parameter MULT_STAGES=3, parameter MULT_EARLY_OUT=1, parameter BRANCH_PREDICT=0, parameter RAS_BITS=3, parameter DCACHE_BG_FILL=0,
+                parameter ICACHE_INDEX_BITS=8, parameter ICACHE_WAYS=2, parameter DCACHE_INDEX_BITS=6, parameter DCACHE_WAYS=2, parameter EARLY_RESTART=0,
+                parameter PREFETCH=0) (
     input                 clock,
     input                 reset,
     input                 Core_Reset,              // Processor-local reset
@@ -56,9 +81,10 @@ module MIPS32 #(parameter PABITS=32) (
     wire [31:0]          ICache_DataOut_C;
     wire                 ICache_Ready_C;
     wire                 ICache_Blocked_C;
+    wire                 ICache_Miss_C;
     wire                 ICache_DoCacheOp_C;
     wire [2:0]           ICache_CacheOp_C;
-    wire [(PABITS-11):0] ICache_CacheOpData_C;
+    wire [(PABITS-9):0]  ICache_CacheOpData_C;
     wire [(PABITS-3):0]  ICache_Address_M;
     wire                 ICache_ReadLine_M;
     wire                 ICache_ReadWord_M;
@@ -77,9 +103,11 @@ module MIPS32 #(parameter PABITS=32) (
     wire [3:0]           DCache_Write_C;
     wire [31:0]          DCache_DataOut_C;
     wire                 DCache_Ready_C;
+    wire                 DCache_Miss_C;
     wire                 DCache_DoCacheOp_C;
     wire [2:0]           DCache_CacheOp_C;
     wire [(PABITS-9):0]  DCache_CacheOpData_C;
+    wire [31:0]          DCache_PC_C;
     wire [(PABITS-3):0]  DCache_Address_M;
     wire                 DCache_ReadLine_M;
     wire                 DCache_ReadWord_M;
@@ -100,10 +128,11 @@ module MIPS32 #(parameter PABITS=32) (
     wire                 Core_InstMem_Stall;
     wire                 Core_InstMem_DoCacheOp;
     wire [2:0]           Core_InstMem_CacheOp;
-    wire [(PABITS-11):0] Core_InstMem_CacheOpData;
+    wire [(PABITS-9):0]  Core_InstMem_CacheOpData;
     wire [31:0]          Core_InstMem_In;
     wire                 Core_InstMem_Ready;
     wire                 Core_InstMem_Blocked;
+    wire                 Core_InstMem_Miss;
     wire [9:0]           Core_DataMem_VAddress;
     wire [(PABITS-13):0] Core_DataMem_PAddress;
     wire                 Core_DataMem_PAddressValid;
@@ -115,8 +144,10 @@ module MIPS32 #(parameter PABITS=32) (
     wire                 Core_DataMem_DoCacheOp;
     wire [2:0]           Core_DataMem_CacheOp;
     wire [(PABITS-9):0]  Core_DataMem_CacheOpData;
+    wire [31:0]          Core_DataMem_PC;
     wire [31:0]          Core_DataMem_In;
     wire                 Core_DataMem_Ready;
+    wire                 Core_DataMem_Miss;
     wire [4:0]           Core_Interrupts;
     wire                 Core_NMI;
 
@@ -158,6 +189,7 @@ module MIPS32 #(parameter PABITS=32) (
     assign DCache_DoCacheOp_C     = Core_DataMem_DoCacheOp;
     assign DCache_CacheOp_C       = Core_DataMem_CacheOp;
     assign DCache_CacheOpData_C   = Core_DataMem_CacheOpData;
+    assign DCache_PC_C            = Core_DataMem_PC;
     assign DCache_DataIn_M        = DataMem_In;
     assign DCache_DataInOffset_M  = DataMem_Offset;
     assign DCache_Ready_M         = DataMem_Ready;
@@ -166,14 +198,20 @@ module MIPS32 #(parameter PABITS=32) (
     assign Core_InstMem_In          = ICache_DataOut_C;
     assign Core_InstMem_Ready       = ICache_Ready_C;
     assign Core_InstMem_Blocked     = ICache_Blocked_C;
+    assign Core_InstMem_Miss        = ICache_Miss_C;
     assign Core_DataMem_In          = DCache_DataOut_C;
     assign Core_DataMem_Ready       = DCache_Ready_C;
+    assign Core_DataMem_Miss        = DCache_Miss_C;
     assign Core_Interrupts          = Interrupts;
     assign Core_NMI                 = NMI;
 
     // Instruction Memory Cache
-    InstructionCache_8KB #(
-        .PABITS          (PABITS))
+    InstructionCache #(
+        .PABITS          (PABITS),
+        .INDEX_BITS      (ICACHE_INDEX_BITS),
+        .WAYS            (ICACHE_WAYS),
+        .EARLY_RESTART   (EARLY_RESTART),
+        .PREFETCH        (PREFETCH))
         ICache (
         .clock           (clock),
         .reset           (reset),
@@ -186,6 +224,7 @@ module MIPS32 #(parameter PABITS=32) (
         .DataOut_C       (ICache_DataOut_C),        // output [31 : 0] DataOut_C
         .Ready_C         (ICache_Ready_C),          // output Ready_C
         .Blocked_C       (ICache_Blocked_C),        // output Blocked_C
+        .Miss_C          (ICache_Miss_C),           // output Miss_C
         .DoCacheOp_C     (ICache_DoCacheOp_C),      // input DoCacheOp_C
         .CacheOp_C       (ICache_CacheOp_C),        // input [2:0] CacheOp_C
         .CacheOpData_C   (ICache_CacheOpData_C),    // input [? : 0] CacheOpData_C
@@ -198,8 +237,13 @@ module MIPS32 #(parameter PABITS=32) (
     );
 
     // Data Memory Cache
-    DataCache_2KB #(
-        .PABITS          (PABITS))
+    DataCache #(
+        .PABITS          (PABITS),
+        .INDEX_BITS      (DCACHE_INDEX_BITS),
+        .WAYS            (DCACHE_WAYS),
+        .BG_FILL         (DCACHE_BG_FILL),
+        .EARLY_RESTART   (EARLY_RESTART),
+        .PREFETCH        (PREFETCH))
         DCache (
         .clock           (clock),
         .reset           (reset),
@@ -213,9 +257,11 @@ module MIPS32 #(parameter PABITS=32) (
         .Write_C         (DCache_Write_C),          // input [3 : 0] Write_C
         .DataOut_C       (DCache_DataOut_C),        // output [31 : 0] DataOut_C
         .Ready_C         (DCache_Ready_C),          // output Ready_C
+        .Miss_C          (DCache_Miss_C),           // output Miss_C
         .DoCacheOp_C     (DCache_DoCacheOp_C),      // input DoCacheOp_C
         .CacheOp_C       (DCache_CacheOp_C),        // input [2 : 0] CacheOp_C
         .CacheOpData_C   (DCache_CacheOpData_C),    // input [? : 0] CacheOpData_C
+        .PC_C            (DCache_PC_C),             // input [31 : 0] PC_C
         .Address_M       (DCache_Address_M),        // output [? : 0] Address_M
         .ReadLine_M      (DCache_ReadLine_M),       // output ReadLine_M
         .ReadWord_M      (DCache_ReadWord_M),       // output ReadWord_M
@@ -230,7 +276,16 @@ module MIPS32 #(parameter PABITS=32) (
 
     // MIPS32r1 Core
     Processor #(
-        .PABITS               (PABITS))
+        .PABITS               (PABITS),
+        .MULT_DSP             (MULT_DSP),
+        .MULT_STAGES          (MULT_STAGES),
+        .MULT_EARLY_OUT       (MULT_EARLY_OUT),
+        .BRANCH_PREDICT       (BRANCH_PREDICT),
+        .RAS_BITS             (RAS_BITS),
+        .ICACHE_INDEX_BITS    (ICACHE_INDEX_BITS),
+        .ICACHE_WAYS          (ICACHE_WAYS),
+        .DCACHE_INDEX_BITS    (DCACHE_INDEX_BITS),
+        .DCACHE_WAYS          (DCACHE_WAYS))
         Core (
         .clock                (clock),                       // input clock
         .reset                (Core_Reset),                  // input reset
@@ -246,6 +301,7 @@ module MIPS32 #(parameter PABITS=32) (
         .InstMem_In           (Core_InstMem_In),             // input [31 : 0] InstMem_In
         .InstMem_Ready        (Core_InstMem_Ready),          // input InstMem_Ready
         .InstMem_Blocked      (Core_InstMem_Blocked),        // input InstMem_Blocked
+        .InstMem_Miss         (Core_InstMem_Miss),           // input InstMem_Miss
         .DataMem_VAddress     (Core_DataMem_VAddress),       // output [9 : 0] DataMem_VAddress
         .DataMem_PAddress     (Core_DataMem_PAddress),       // output [23 : 0] DataMem_PAddress
         .DataMem_PAddressValid (Core_DataMem_PAddressValid), // output DataMem_PAddressValid
@@ -257,8 +313,10 @@ module MIPS32 #(parameter PABITS=32) (
         .DataMem_DoCacheOp    (Core_DataMem_DoCacheOp),      // output DataMem_DoCacheOp
         .DataMem_CacheOp      (Core_DataMem_CacheOp),        // output [2 : 0] DataMem_CacheOp
         .DataMem_CacheOpData  (Core_DataMem_CacheOpData),    // output [? : 0] DataMem_CacheOpData
+        .DataMem_PC           (Core_DataMem_PC),             // output [31 : 0] DataMem_PC
         .DataMem_In           (Core_DataMem_In),             // input [31 : 0] DataMem_In
         .DataMem_Ready        (Core_DataMem_Ready),          // input DataMem_Ready
+        .DataMem_Miss         (Core_DataMem_Miss),           // input DataMem_Miss
         .Interrupts           (Core_Interrupts),             // input [4 : 0] Interrupts
         .NMI                  (Core_NMI)                     // input NMI
     );
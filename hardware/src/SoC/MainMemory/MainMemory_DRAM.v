@@ -0,0 +1,368 @@
+`timescale 1ns / 1ps
+/*
+ * File         : MainMemory_DRAM.v
+ * Project      : XUM MIPS32 cache enhancement
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A main memory with the ports of 'MainMemory' and the timing of a DRAM,
+ *   for simulation.
+ *
+ *   The data is held in a block RAM as in 'MainMemory', but each access is
+ *   timed as if by a DRAM controller with one channel:
+ *
+ *     - The instruction and data ports share the channel. A request waits
+ *       until the channel is free, and the ports take turns when both wait.
+ *     - A line address is split into {row, bank, column}. Each bank keeps its
+ *       last row open. An access to the open row (a hit) takes T_CAS cycles,
+ *       to a bank with no open row T_RCD + T_CAS, and to a bank with another
+ *       open row (a conflict) T_RP + T_RCD + T_CAS.
+ *     - Every access also takes T_CTRL cycles for the controller and PHY.
+ *     - Data moves at one 32-bit word every T_BURST cycles. The words of a
+ *       line read are returned as they arrive, and a write takes the time
+ *       to move all of its words before it completes.
+ *     - Every T_REFI cycles (0: never) the channel is refreshed for T_RFC
+ *       cycles once it is free, which closes all rows.
+ *
+ *   A request is answered T_CTRL + (access cycles) + 3 cycles after it is
+ *   made, not counting any wait for the channel. The counters 'row_hits',
+ *   'row_empty', 'row_conflicts', 'queue_cycles' (cycles of each request
+ *   waiting for the channel), and 'refreshes' describe the accesses so far.
+ */
+module MainMemory_DRAM #(
+    parameter ADDR_WIDTH=12,        // Line address bits (16-byte lines): More than COL_BITS + BANK_BITS
+    parameter CRIT_WORD_FIRST=0,    // Return the requested word of a line first
+    parameter T_CTRL=10,            // Controller and PHY cycles of every access
+    parameter T_RCD=3,              // Row activation cycles
+    parameter T_CAS=3,              // Column access cycles (at least 1)
+    parameter T_RP=3,               // Precharge cycles (closing a row)
+    parameter T_BURST=1,            // Cycles per 32-bit data word (at least 1)
+    parameter BANK_BITS=3,          // Number of banks (2^BANK_BITS)
+    parameter COL_BITS=7,           // Lines per row (2^COL_BITS): 2 KiB rows
+    parameter T_REFI=780,           // Cycles between refreshes (0: no refresh)
+    parameter T_RFC=11              // Refresh cycles
+    ) (
+    input  clock,
+    input  reset,
+    // Instruction memory interface
+    input  [(ADDR_WIDTH+1):0] I_Address, // Word address
+    input  [127:0]    I_DataIn,
+    output reg [31:0] I_DataOut,
+    output            I_Ready,
+    output reg [1:0]  I_DataOutOffset,
+    input             I_BootWrite,     // Manual writes from boot loader (uses I_DataIn and I_Address)
+    input             I_ReadLine,
+    input             I_ReadWord,
+    // Data memory interface
+    input  [(ADDR_WIDTH+1):0] D_Address, // Word address
+    input  [127:0]    D_DataIn,
+    input             D_LineInReady,
+    input             D_WordInReady,
+    input  [3:0]      D_WordInBE,
+    output reg [31:0] D_DataOut,
+    output reg [1:0]  D_DataOutOffset,
+    input             D_ReadLine,
+    input             D_ReadWord,
+    output            D_Ready
+    );
+
+    // QUEUE: Waiting for the channel. WAIT: The access. ACCESS: The last cycle of the access.
+    localparam [3:0] IDLE=0, QUEUE=1, WAIT=2, ACCESS=3, RW_1=4, RL=5, WW_1=6, WW_2=7, WL_1=8;
+    localparam ROW_BITS = ADDR_WIDTH - COL_BITS - BANK_BITS;
+    localparam BANKS    = 1 << BANK_BITS;
+
+    // RAM signals
+    wire [(ADDR_WIDTH-1):0] RAM_addra, RAM_addrb;  // Line address (4 words or 16 bytes)
+    wire         RAM_wea,   RAM_web;
+    wire [127:0] RAM_dina,  RAM_dinb;
+    wire [127:0] RAM_douta, RAM_doutb;
+
+    // Local signals
+    reg [127:0] d_mask;
+    reg [3:0]   state_a, state_b;
+    reg I_ReadWord_r, I_ReadLine_r;
+    reg D_ReadWord_r, D_ReadLine_r;
+    reg [1:0]   beat_a, beat_b;         // Word of a line read
+    reg [31:0]  gap_a, gap_b;           // Cycles until the next word of a line read
+    reg [31:0]  wait_count;             // Cycles left in the access (one port at a time)
+    reg         turn_b;                 // The data port goes first if both ports wait
+    reg [31:0]  refi_count;
+    reg [31:0]  rfc_count;
+    reg         refresh_due;
+    reg [(BANKS-1):0]    open_valid;
+    reg [(ROW_BITS-1):0] open_row [0:(BANKS-1)];
+
+    // Counters
+    reg [31:0]  row_hits;
+    reg [31:0]  row_empty;
+    reg [31:0]  row_conflicts;
+    reg [31:0]  queue_cycles;
+    reg [31:0]  refreshes;
+
+    // Assignments
+    assign RAM_addra = I_Address[(ADDR_WIDTH+1):2];
+    assign RAM_wea   = I_BootWrite;
+    assign RAM_dina  = I_DataIn;
+    assign RAM_addrb = D_Address[(ADDR_WIDTH+1):2];
+    assign RAM_web   = (state_b == WW_2) | (state_b == WL_1);
+    assign RAM_dinb  = d_mask;
+
+    // Channel arbitration. A refresh goes before any waiting request.
+    wire active_a = (state_a != IDLE) & (state_a != QUEUE);
+    wire active_b = (state_b != IDLE) & (state_b != QUEUE);
+    wire busy     = active_a | active_b | (rfc_count != 0);
+    wire grant_a  = (state_a == QUEUE) & ~busy & ~refresh_due & (~turn_b | (state_b != QUEUE));
+    wire grant_b  = (state_b == QUEUE) & ~busy & ~refresh_due & (turn_b | (state_a != QUEUE));
+    wire refresh  = refresh_due & ~busy;
+    wire refi_due = (T_REFI != 0) && (refi_count == T_REFI - 1);
+
+    // Bank timing of the granted request
+    wire [(ADDR_WIDTH-1):0] g_line = (grant_a) ? RAM_addra : RAM_addrb;
+    wire [(BANK_BITS-1):0]  g_bank = g_line[COL_BITS +: BANK_BITS];
+    wire [(ROW_BITS-1):0]   g_row  = g_line[(ADDR_WIDTH-1):(COL_BITS+BANK_BITS)];
+    wire g_hit      = open_valid[g_bank] & (open_row[g_bank] == g_row);
+    wire g_conflict = open_valid[g_bank] & ~g_hit;
+    wire g_write    = grant_b & ~D_ReadWord_r & ~D_ReadLine_r;
+    wire [31:0] g_data_cycles   = (g_write) ? (((D_LineInReady & ~D_WordInReady) ? 4 : 1) * T_BURST) : 0;
+    wire [31:0] g_access_cycles = T_CTRL + T_CAS + ((g_hit) ? 0 : T_RCD) + ((g_conflict) ? T_RP : 0) + g_data_cycles;
+
+    // Beats of line reads
+    wire ready_rl_a = (state_a == RL) & (gap_a == 0);
+    wire ready_rl_b = (state_b == RL) & (gap_b == 0);
+
+    // Command retention for A and B ports (currently read commands are pulses)
+    always @(posedge clock) begin
+        I_ReadWord_r <= (state_a == IDLE) ? I_ReadWord : I_ReadWord_r;
+        I_ReadLine_r <= (state_a == IDLE) ? I_ReadLine : I_ReadLine_r;
+        D_ReadWord_r <= (state_b == IDLE) ? D_ReadWord : D_ReadWord_r;
+        D_ReadLine_r <= (state_b == IDLE) ? D_ReadLine : D_ReadLine_r;
+    end
+
+    // Channel state: Access timing, open rows, refresh, and the turn of the ports
+    always @(posedge clock) begin
+        if (reset) begin
+            wait_count  <= 0;
+            turn_b      <= 1'b0;
+            refi_count  <= 0;
+            rfc_count   <= 0;
+            refresh_due <= 1'b0;
+            open_valid  <= {BANKS{1'b0}};
+        end
+        else begin
+            if (grant_a | grant_b) begin
+                wait_count <= g_access_cycles - 1;
+                turn_b     <= grant_a;
+                open_valid[g_bank] <= 1'b1;
+                open_row[g_bank]   <= g_row;
+            end
+            else if (wait_count != 0) begin
+                wait_count <= wait_count - 1;
+            end
+            refi_count  <= (refi_due) ? 0 : (refi_count + 1);
+            refresh_due <= refi_due | (refresh_due & ~refresh);
+            if (refresh) begin
+                rfc_count  <= T_RFC;
+                open_valid <= {BANKS{1'b0}};
+            end
+            else if (rfc_count != 0) begin
+                rfc_count  <= rfc_count - 1;
+            end
+        end
+    end
+
+    always @(posedge clock) begin
+        if (reset) begin
+            row_hits      <= 0;
+            row_empty     <= 0;
+            row_conflicts <= 0;
+            queue_cycles  <= 0;
+            refreshes     <= 0;
+        end
+        else begin
+            row_hits      <= row_hits      + ((grant_a | grant_b) & g_hit);
+            row_empty     <= row_empty     + ((grant_a | grant_b) & ~open_valid[g_bank]);
+            row_conflicts <= row_conflicts + ((grant_a | grant_b) & g_conflict);
+            queue_cycles  <= queue_cycles  + ((state_a == QUEUE) & ~grant_a) + ((state_b == QUEUE) & ~grant_b);
+            refreshes     <= refreshes     + refresh;
+        end
+    end
+
+    // Port A state machine
+    always @(posedge clock) begin
+        if (reset) begin
+            state_a <= IDLE;
+        end
+        else begin
+            case (state_a)
+                IDLE:   state_a <= (I_ReadWord | I_ReadLine) ? QUEUE : IDLE;
+                QUEUE:  state_a <= (grant_a) ? WAIT : QUEUE;
+                WAIT:   state_a <= (wait_count == 0) ? ACCESS : WAIT;
+                ACCESS:
+                    begin
+                        if (I_ReadWord_r) state_a <= RW_1;
+                        else if (I_ReadLine_r) state_a <= RL;
+                        else state_a <= IDLE;
+                    end
+                RW_1:   state_a <= IDLE;
+                RL:     state_a <= (ready_rl_a & (beat_a == 2'b11)) ? IDLE : RL;
+                default: state_a <= IDLE;
+            endcase
+        end
+    end
+
+    // Port B state machine
+    always @(posedge clock) begin
+        if (reset) begin
+            state_b <= IDLE;
+        end
+        else begin
+            case (state_b)
+                IDLE:   state_b <= (D_ReadWord | D_ReadLine | D_WordInReady | D_LineInReady) ? QUEUE : IDLE;
+                QUEUE:  state_b <= (grant_b) ? WAIT : QUEUE;
+                WAIT:   state_b <= (wait_count == 0) ? ACCESS : WAIT;
+                ACCESS:
+                    begin
+                        if (D_ReadWord_r) state_b <= RW_1;
+                        else if (D_ReadLine_r) state_b <= RL;
+                        else if (D_WordInReady) state_b <= WW_1;
+                        else if (D_LineInReady) state_b <= WL_1;
+                        else state_b <= IDLE;
+                    end
+                RW_1:   state_b <= IDLE;
+                RL:     state_b <= (ready_rl_b & (beat_b == 2'b11)) ? IDLE : RL;
+                WW_1:   state_b <= WW_2;
+                WW_2:   state_b <= IDLE;
+                WL_1:   state_b <= IDLE;
+                default: state_b <= IDLE;
+            endcase
+        end
+    end
+
+    // Line read beats: One word every T_BURST cycles
+    always @(posedge clock) begin
+        if (state_a == ACCESS) begin
+            beat_a <= 2'b00;
+            gap_a  <= 0;
+        end
+        else if (ready_rl_a) begin
+            beat_a <= beat_a + 1'b1;
+            gap_a  <= T_BURST - 1;
+        end
+        else if (gap_a != 0) begin
+            gap_a  <= gap_a - 1;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (state_b == ACCESS) begin
+            beat_b <= 2'b00;
+            gap_b  <= 0;
+        end
+        else if (ready_rl_b) begin
+            beat_b <= beat_b + 1'b1;
+            gap_b  <= T_BURST - 1;
+        end
+        else if (gap_b != 0) begin
+            gap_b  <= gap_b - 1;
+        end
+    end
+
+    // Port A offset
+    always @(posedge clock) begin
+        case (state_a)
+            ACCESS:  I_DataOutOffset <= ((CRIT_WORD_FIRST != 0) | I_ReadWord_r) ? I_Address[1:0] : 2'b00;
+            RL:      I_DataOutOffset <= (ready_rl_a) ? (I_DataOutOffset + 1'b1) : I_DataOutOffset;
+            default: I_DataOutOffset <= 2'b00;
+        endcase
+    end
+
+    // Port B offset
+    always @(posedge clock) begin
+        case (state_b)
+            ACCESS:  D_DataOutOffset <= ((CRIT_WORD_FIRST != 0) | D_ReadWord_r) ? D_Address[1:0] : 2'b00;
+            RL:      D_DataOutOffset <= (ready_rl_b) ? (D_DataOutOffset + 1'b1) : D_DataOutOffset;
+            default: D_DataOutOffset <= 2'b00;
+        endcase
+    end
+
+    // Port ready
+    assign I_Ready = (state_a == RW_1) | ready_rl_a;
+    assign D_Ready = (state_b == RW_1) | ready_rl_b | (state_b == WW_2) | (state_b == WL_1);
+
+    // Port A data out
+    always @(*) begin
+        case (I_DataOutOffset)
+            2'b00: I_DataOut <= RAM_douta[127:96];
+            2'b01: I_DataOut <= RAM_douta[95:64];
+            2'b10: I_DataOut <= RAM_douta[63:32];
+            2'b11: I_DataOut <= RAM_douta[31:0];
+        endcase
+    end
+
+    // Port B data out
+    always @(*) begin
+        case (D_DataOutOffset)
+            2'b00: D_DataOut <= RAM_doutb[127:96];
+            2'b01: D_DataOut <= RAM_doutb[95:64];
+            2'b10: D_DataOut <= RAM_doutb[63:32];
+            2'b11: D_DataOut <= RAM_doutb[31:0];
+        endcase
+    end
+
+    always @(posedge clock) begin
+        case (state_b)
+            ACCESS:
+                begin
+                    d_mask <= (D_LineInReady) ? D_DataIn : RAM_doutb;
+                end
+            WW_1:
+                begin
+                    d_mask[127:120] <= ((D_Address[1:0] == 2'b00) & D_WordInBE[3]) ? D_DataIn[31:24] : d_mask[127:120];
+                    d_mask[119:112] <= ((D_Address[1:0] == 2'b00) & D_WordInBE[2]) ? D_DataIn[23:16] : d_mask[119:112];
+                    d_mask[111:104] <= ((D_Address[1:0] == 2'b00) & D_WordInBE[1]) ? D_DataIn[15:8]  : d_mask[111:104];
+                    d_mask[103:96]  <= ((D_Address[1:0] == 2'b00) & D_WordInBE[0]) ? D_DataIn[7:0]   : d_mask[103:96];
+                    d_mask[95:88]   <= ((D_Address[1:0] == 2'b01) & D_WordInBE[3]) ? D_DataIn[31:24] : d_mask[95:88];
+                    d_mask[87:80]   <= ((D_Address[1:0] == 2'b01) & D_WordInBE[2]) ? D_DataIn[23:16] : d_mask[87:80];
+                    d_mask[79:72]   <= ((D_Address[1:0] == 2'b01) & D_WordInBE[1]) ? D_DataIn[15:8]  : d_mask[79:72];
+                    d_mask[71:64]   <= ((D_Address[1:0] == 2'b01) & D_WordInBE[0]) ? D_DataIn[7:0]   : d_mask[71:64];
+                    d_mask[63:56]   <= ((D_Address[1:0] == 2'b10) & D_WordInBE[3]) ? D_DataIn[31:24] : d_mask[63:56];
+                    d_mask[55:48]   <= ((D_Address[1:0] == 2'b10) & D_WordInBE[2]) ? D_DataIn[23:16] : d_mask[55:48];
+                    d_mask[47:40]   <= ((D_Address[1:0] == 2'b10) & D_WordInBE[1]) ? D_DataIn[15:8]  : d_mask[47:40];
+                    d_mask[39:32]   <= ((D_Address[1:0] == 2'b10) & D_WordInBE[0]) ? D_DataIn[7:0]   : d_mask[39:32];
+                    d_mask[31:24]   <= ((D_Address[1:0] == 2'b11) & D_WordInBE[3]) ? D_DataIn[31:24] : d_mask[31:24];
+                    d_mask[23:16]   <= ((D_Address[1:0] == 2'b11) & D_WordInBE[2]) ? D_DataIn[23:16] : d_mask[23:16];
+                    d_mask[15:8]    <= ((D_Address[1:0] == 2'b11) & D_WordInBE[1]) ? D_DataIn[15:8]  : d_mask[15:8];
+                    d_mask[7:0]     <= ((D_Address[1:0] == 2'b11) & D_WordInBE[0]) ? D_DataIn[7:0]   : d_mask[7:0];
+                end
+            WW_2:
+                begin
+                    d_mask <= d_mask;
+                end
+            default:
+                begin
+                    d_mask <= RAM_doutb;
+                end
+        endcase
+    end
+
+    // Dual-port generic RAM
+    RAM_TDP #(
+        .DATA_WIDTH (128),
+        .ADDR_WIDTH (ADDR_WIDTH))
+        MainRAM (
+        .clk    (clock),     // input clk
+        .rst    (reset),     // input rst
+        .addra  (RAM_addra), // input [11 : 0] addra
+        .wea    (RAM_wea),   // input wea
+        .dina   (RAM_dina),  // input [127 : 0] dina
+        .douta  (RAM_douta), // output [127 : 0] douta
+        .addrb  (RAM_addrb), // input [11 : 0] addrb
+        .web    (RAM_web),   // input web
+        .dinb   (RAM_dinb),  // input [127 : 0] dinb
+        .doutb  (RAM_doutb)  // output [127 : 0] doutb
+    );
+
+endmodule
@@ -0,0 +1,321 @@
+// iprof.cc:
+//
+// A profiler of the instruction traces of the macro testsuite.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// This reads an instruction trace ('make itrace_<test>', one '<pc>    (<time>)'
+// line per retired instruction) in a single pass and reports where the cycles
+// went: per function, per PC, and per basic block, each with its CPI.
+//
+// An instruction is charged the cycles from the retirement of the previous
+// instruction to its own, so every stall (a cache miss, a load-use hazard,
+// the divider) lands on the instruction which waited for it, and the cycles
+// above one per instruction are its stall cycles. The times of the trace are
+// simulation times, which are divided by the clock period ('-p', 10 ns in the
+// RTL harnesses, and 1 for the ISS which counts steps). Traces without times
+// count one cycle per instruction.
+//
+// Function names and disassembly come from the test's listings, which are
+// found next to the trace ('<dir>/build/{app,khi,klo}.lst') unless given with
+// '-l'. Linker maps ('-l build/app.map') only give function names.
+//
+// Basic blocks are found as they execute: A block starts at a function entry,
+// a branch target, after the delay slot of a branch or jump, after an
+// exception return or trap, and wherever the trace jumps (e.g., to an
+// exception vector). Without a listing, only the jumps of the trace split
+// blocks, so blocks extend through branches which were not taken.
+//
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "program.h"
+
+using std::string;
+using std::vector;
+
+static constexpr uint8_t LEADER = 1;   // Starts a basic block
+static constexpr uint8_t CONTROL = 2;  // Branch or jump: The block ends after its delay slot
+static constexpr uint8_t TRAP = 4;     // The block ends after it
+
+struct PcStats {
+  uint64_t count;
+  uint64_t cycles;
+  uint8_t flags;
+};
+
+struct BlockStats {
+  uint64_t count;
+  uint64_t instructions;
+  uint64_t cycles;
+  uint32_t last;             // Highest PC executed in the block
+};
+
+struct FunctionStats {
+  uint64_t instructions;
+  uint64_t cycles;
+};
+
+struct Profile {
+  uint64_t instructions = 0;
+  uint64_t cycles = 0;
+  std::unordered_map<uint32_t, PcStats> pcs;
+  std::unordered_map<uint32_t, BlockStats> blocks;
+};
+
+// Parse '<8 hex digits>' and an optional '    (<decimal time>)', returning false if the line is not one
+static bool parseLine(const char *_line, uint32_t &_pc, uint64_t &_time, bool &_timed) {
+  _pc = 0;
+  for (int i = 0; i < 8; i++) {
+    char c = _line[i];
+    char lower = static_cast<char>(c | 0x20);
+    int digit = ((c >= '0') && (c <= '9')) ? (c - '0') : (((lower >= 'a') && (lower <= 'f')) ? (lower - 'a' + 10) : -1);
+    if (digit < 0) {
+      return false;
+    }
+    _pc = (_pc << 4) | static_cast<uint32_t>(digit);
+  }
+  const char *time = _line + 8;
+  while (*time == ' ') {
+    time++;
+  }
+  _timed = (*time == '(');
+  _time = (_timed) ? strtoull(time + 1, nullptr, 10) : 0;
+  return true;
+}
+
+static uint8_t flagsFor(const Program &_program, uint32_t _pc) {
+  const Instruction *instruction = _program.instruction(_pc);
+  uint8_t flags = (_program.leader(_pc)) ? LEADER : 0;
+  if (instruction != nullptr) {
+    flags |= (instruction->control) ? CONTROL : 0;
+    flags |= (instruction->trap) ? TRAP : 0;
+  }
+  return flags;
+}
+
+static bool profile(FILE *_handle, const Program &_program, uint64_t _period, Profile &_profile) {
+  char line[256];
+  uint64_t line_number = 0;
+  uint32_t previous_pc = 0;
+  uint64_t previous_time = 0;
+  bool end_block = true;     // The next instruction starts a block
+  bool end_after_next = false;
+  BlockStats *block = nullptr;
+  while (fgets(line, sizeof(line), _handle) != nullptr) {
+    line_number++;
+    uint32_t pc;
+    uint64_t time;
+    bool timed;
+    if (!parseLine(line, pc, time, timed)) {
+      printf("Could not parse line %llu: '%s'\n", static_cast<unsigned long long>(line_number), line);
+      return false;
+    }
+    uint64_t cycles = (timed && (_profile.instructions > 0) && (time >= previous_time)) ? ((time - previous_time) / _period) : 1;
+    auto inserted = _profile.pcs.emplace(pc, PcStats{0, 0, 0});
+    PcStats &stats = inserted.first->second;
+    if (inserted.second) {
+      stats.flags = flagsFor(_program, pc);
+    }
+    stats.count++;
+    stats.cycles += cycles;
+    if (end_block || (pc != previous_pc + 4) || (stats.flags & LEADER)) {
+      block = &_profile.blocks.emplace(pc, BlockStats{0, 0, 0, pc}).first->second;
+      block->count++;
+    }
+    block->instructions++;
+    block->cycles += cycles;
+    block->last = std::max(block->last, pc);
+    end_block = end_after_next || (stats.flags & TRAP);
+    end_after_next = (stats.flags & CONTROL) != 0;
+    _profile.instructions++;
+    _profile.cycles += cycles;
+    previous_pc = pc;
+    previous_time = time;
+  }
+  return true;
+}
+
+static double percent(uint64_t _part, uint64_t _whole) {
+  return (_whole == 0) ? 0.0 : ((100.0 * _part) / _whole);
+}
+
+static double cpi(uint64_t _cycles, uint64_t _instructions) {
+  return (_instructions == 0) ? 0.0 : (static_cast<double>(_cycles) / _instructions);
+}
+
+// Instructions which retire in the same cycle as the previous one have no stall cycles to offset this
+static uint64_t stalls(uint64_t _cycles, uint64_t _instructions) {
+  return (_cycles > _instructions) ? (_cycles - _instructions) : 0;
+}
+
+static string location(const Program &_program, uint32_t _pc) {
+  uint32_t offset;
+  const string &function = _program.function(_pc, offset);
+  char text[16];
+  snprintf(text, sizeof(text), "+0x%x", offset);
+  return (offset == 0) ? function : (function + text);
+}
+
+// Sort by cycles (then by key, for a stable report) and keep the first '_rows' (all if 0)
+template <typename T, typename K>
+static void sortByCycles(vector<T> &_items, size_t _rows, K _key) {
+  std::sort(_items.begin(), _items.end(), [&](const T &_a, const T &_b) {
+    return (_a.second.cycles != _b.second.cycles) ? (_a.second.cycles > _b.second.cycles) : (_key(_a) < _key(_b));
+  });
+  if ((_rows > 0) && (_items.size() > _rows)) {
+    _items.resize(_rows);
+  }
+}
+
+static void printFunctions(const Profile &_profile, const Program &_program, size_t _rows) {
+  std::unordered_map<string, FunctionStats> totals;
+  for (const auto &pc : _profile.pcs) {
+    uint32_t offset;
+    const string &name = _program.function(pc.first, offset);
+    FunctionStats &function = totals.emplace(name, FunctionStats{0, 0}).first->second;
+    function.instructions += pc.second.count;
+    function.cycles += pc.second.cycles;
+  }
+  vector<std::pair<string, FunctionStats>> functions(totals.begin(), totals.end());
+  size_t count = functions.size();
+  sortByCycles(functions, _rows, [](const std::pair<string, FunctionStats> &_f) { return _f.first; });
+  printf("\nFunctions (%zu of %zu, by cycles):\n", functions.size(), count);
+  printf("  %14s %7s %14s %7s %14s  %s\n", "Cycles", "%", "Instructions", "CPI", "Stall cycles", "Function");
+  for (const auto &function : functions) {
+    const FunctionStats &stats = function.second;
+    printf("  %14llu %6.2f%% %14llu %7.2f %14llu  %s\n", static_cast<unsigned long long>(stats.cycles),
+           percent(stats.cycles, _profile.cycles), static_cast<unsigned long long>(stats.instructions),
+           cpi(stats.cycles, stats.instructions),
+           static_cast<unsigned long long>(stalls(stats.cycles, stats.instructions)), function.first.c_str());
+  }
+}
+
+static void printPcs(const Profile &_profile, const Program &_program, size_t _rows) {
+  vector<std::pair<uint32_t, PcStats>> pcs(_profile.pcs.begin(), _profile.pcs.end());
+  sortByCycles(pcs, _rows, [](const std::pair<uint32_t, PcStats> &_p) { return _p.first; });
+  printf("\nPCs (%zu of %zu, by cycles):\n", pcs.size(), _profile.pcs.size());
+  printf("  %8s %14s %7s %14s %7s  %s\n", "PC", "Cycles", "%", "Executions", "CPI", "Location");
+  for (const auto &pc : pcs) {
+    const Instruction *instruction = _program.instruction(pc.first);
+    printf("  %08x %14llu %6.2f%% %14llu %7.2f  %s%s%s\n", pc.first,
+           static_cast<unsigned long long>(pc.second.cycles), percent(pc.second.cycles, _profile.cycles),
+           static_cast<unsigned long long>(pc.second.count), cpi(pc.second.cycles, pc.second.count),
+           location(_program, pc.first).c_str(), (instruction != nullptr) ? ": " : "",
+           (instruction != nullptr) ? instruction->text.c_str() : "");
+  }
+}
+
+static void printBlocks(const Profile &_profile, const Program &_program, size_t _rows) {
+  vector<std::pair<uint32_t, BlockStats>> blocks(_profile.blocks.begin(), _profile.blocks.end());
+  sortByCycles(blocks, _rows, [](const std::pair<uint32_t, BlockStats> &_b) { return _b.first; });
+  printf("\nBasic blocks (%zu of %zu, by cycles):\n", blocks.size(), _profile.blocks.size());
+  printf("  %8s %8s %14s %7s %14s %7s %7s  %s\n", "Start", "End", "Cycles", "%", "Executions", "Length", "CPI",
+         "Location");
+  for (const auto &block : blocks) {
+    const BlockStats &stats = block.second;
+    printf("  %08x %08x %14llu %6.2f%% %14llu %7.1f %7.2f  %s\n", block.first, stats.last,
+           static_cast<unsigned long long>(stats.cycles), percent(stats.cycles, _profile.cycles),
+           static_cast<unsigned long long>(stats.count), static_cast<double>(stats.instructions) / stats.count,
+           cpi(stats.cycles, stats.instructions), location(_program, block.first).c_str());
+  }
+}
+
+static void usage() {
+  const char *msg =
+    "\nUsage: iprof [options] <instruction trace>\n"
+    "    -l   Listing ('app.lst') or linker map ('app.map') of the program. May be\n"
+    "         repeated. Default: '{app,khi,klo}.lst' in 'build' next to the trace.\n"
+    "    -n   Rows of each report (default 20, 0: all)\n"
+    "    -p   Clock period in trace time units (default 10, i.e., ns at 100 MHz)\n"
+    "    -h   Print this help message\n"
+    "\n"
+    "The trace may be '-' for stdin.\n"
+    "\n";
+  printf("%s", msg);
+  exit(1);
+}
+
+int main(int argc, char *argv[]) {
+  vector<string> symbol_files;
+  size_t rows = 20;
+  uint64_t period = 10;
+  int ch;
+
+  while ((ch = getopt(argc, argv, "hl:n:p:")) != -1) {
+    switch (ch) {
+      case 'l':
+        symbol_files.push_back(optarg);
+        break;
+      case 'n':
+        rows = strtoul(optarg, nullptr, 0);
+        break;
+      case 'p':
+        period = strtoull(optarg, nullptr, 0);
+        if (period == 0) {
+          usage();
+        }
+        break;
+      default:
+        usage();
+        break;
+    }
+  }
+  argc -= optind;
+  argv += optind;
+
+  if (argc != 1) {
+    usage();
+  }
+  string trace(argv[0]);
+
+  Program program;
+  if (symbol_files.empty() && (trace != "-")) {
+    size_t slash = trace.rfind('/');
+    string build = ((slash == string::npos) ? string() : trace.substr(0, slash + 1)) + "build/";
+    for (const char *name : {"app.lst", "khi.lst", "klo.lst"}) {
+      if (access((build + name).c_str(), R_OK) == 0) {
+        symbol_files.push_back(build + name);
+      }
+    }
+  }
+  for (const string &file : symbol_files) {
+    if (!program.load(file)) {
+      return 1;
+    }
+  }
+
+  FILE *handle = (trace == "-") ? stdin : fopen(trace.c_str(), "r");
+  if (handle == nullptr) {
+    printf("Could not open instruction trace '%s'\n", trace.c_str());
+    return 1;
+  }
+  Profile result;
+  bool parsed = profile(handle, program, period, result);
+  if (handle != stdin) {
+    fclose(handle);
+  }
+  if (!parsed) {
+    return 1;
+  }
+
+  printf("Instructions: %llu  Cycles: %llu  CPI: %.3f  Stall cycles: %llu\n",
+         static_cast<unsigned long long>(result.instructions), static_cast<unsigned long long>(result.cycles),
+         cpi(result.cycles, result.instructions),
+         static_cast<unsigned long long>(stalls(result.cycles, result.instructions)));
+  if (symbol_files.empty()) {
+    printf("No listings found: Functions are unknown and blocks only end at jumps\n");
+  }
+  printFunctions(result, program, rows);
+  printPcs(result, program, rows);
+  printBlocks(result, program, rows);
+  return 0;
+}
@@ -0,0 +1,157 @@
+// program.cc:
+//
+// The symbols and disassembly of a macro test program, from its objdump
+// listings ('build/app.lst') or linker maps ('build/app.map').
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// Listings are the output of 'objdump -d -S' (see 'harness/Makefile_MIPS' of
+// the macro testsuite). Only two kinds of lines matter, and everything else
+// (source lines, section headers) is skipped:
+//
+//   80000040 <main>:
+//   80000044:	27bdffe8 	addiu	sp,sp,-24
+//
+// Linker maps only give symbols, from lines of an address and a name.
+//
+#include "program.h"
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using std::cout;
+using std::endl;
+using std::string;
+
+static bool parseHex(const string &_text, uint32_t &_value) {
+  if (_text.empty() || (_text.size() > 8)) {
+    return false;
+  }
+  _value = 0;
+  for (char c : _text) {
+    int digit = isxdigit(static_cast<unsigned char>(c)) ? ((c <= '9') ? (c - '0') : ((c | 0x20) - 'a' + 10)) : -1;
+    if (digit < 0) {
+      return false;
+    }
+    _value = (_value << 4) | static_cast<uint32_t>(digit);
+  }
+  return true;
+}
+
+static bool isTrap(const string &_mnemonic) {
+  static const char *const traps[] = {"eret", "deret", "syscall", "break", "teq", "teqi", "tge", "tgei",
+                                      "tgeiu", "tgeu", "tlt", "tlti", "tltiu", "tltu", "tne", "tnei"};
+  for (const char *trap : traps) {
+    if (_mnemonic == trap) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Program::load(const string &_filename) {
+  bool map = (_filename.size() >= 4) && (_filename.compare(_filename.size() - 4, 4, ".map") == 0);
+  return (map) ? loadMap(_filename) : loadListing(_filename);
+}
+
+bool Program::loadListing(const string &_filename) {
+  std::ifstream file(_filename);
+  if (!file.good()) {
+    cout << "Could not open listing '" << _filename << "'" << endl;
+    return false;
+  }
+  string line;
+  while (std::getline(file, line)) {
+    size_t colon = line.find(':');
+    if (colon == string::npos) {
+      continue;
+    }
+    uint32_t address, word;
+    size_t start = line.find_first_not_of(' ');
+
+    // A symbol: '80000040 <main>:'
+    size_t space = line.find(" <");
+    if ((start == 0) && (space != string::npos) && (colon == line.size() - 1) && (line[colon - 1] == '>') &&
+        parseHex(line.substr(0, space), address)) {
+      symbols_.emplace(address, line.substr(space + 2, colon - space - 3));
+      leaders_.insert(address);
+      continue;
+    }
+
+    // An instruction: '80000044:<tab>27bdffe8 <tab>addiu<tab>sp,sp,-24'
+    if ((start == string::npos) || !parseHex(line.substr(start, colon - start), address) ||
+        (line.compare(colon + 1, 1, "\t") != 0) || !parseHex(line.substr(colon + 2, 8), word)) {
+      continue;
+    }
+    std::istringstream fields(line.substr(colon + 10));
+    string mnemonic, operands;
+    fields >> mnemonic;
+    std::getline(fields >> std::ws, operands);
+    Instruction &instruction = instructions_[address];
+    instruction.text = (operands.empty()) ? mnemonic : (mnemonic + " " + operands);
+    instruction.control = ((mnemonic[0] == 'b') && (mnemonic != "break")) || (mnemonic[0] == 'j');
+    instruction.trap = isTrap(mnemonic);
+
+    // Branches and direct jumps end with their target: '80000080 <main+0x40>'
+    if (instruction.control && (mnemonic.compare(0, 2, "jr") != 0) && (mnemonic.compare(0, 4, "jalr") != 0)) {
+      string target = operands.substr(0, operands.find(" <"));
+      size_t comma = target.rfind(',');
+      if (parseHex(target.substr((comma == string::npos) ? 0 : (comma + 1)), address)) {
+        leaders_.insert(address);
+      }
+    }
+  }
+  return true;
+}
+
+bool Program::loadMap(const string &_filename) {
+  std::ifstream file(_filename);
+  if (!file.good()) {
+    cout << "Could not open map '" << _filename << "'" << endl;
+    return false;
+  }
+  string line;
+  while (std::getline(file, line)) {
+    // A symbol: '                0x80000040                main'
+    // (64-bit linkers print 16 digits)
+    std::istringstream fields(line);
+    string address_text, name, extra;
+    if (line.empty() || !isspace(static_cast<unsigned char>(line[0])) || !(fields >> address_text >> name) ||
+        (fields >> extra) || (address_text.compare(0, 2, "0x") != 0) ||
+        !(isalpha(static_cast<unsigned char>(name[0])) || (name[0] == '_'))) {
+      continue;
+    }
+    // Programs are linked at 0, so 0 is a valid address ('startup')
+    const char *digits = address_text.c_str() + 2;
+    char *end;
+    unsigned long long value = strtoull(digits, &end, 16);
+    uint32_t address = static_cast<uint32_t>(value);
+    if ((end == digits) || (*end != '\0') || (value > UINT32_MAX)) {
+      continue;
+    }
+    symbols_.emplace(address, name);
+    leaders_.insert(address);
+  }
+  return true;
+}
+
+const string &Program::function(uint32_t _pc, uint32_t &_offset) const {
+  static const string unknown("??");
+  auto after = symbols_.upper_bound(_pc);
+  if (after == symbols_.begin()) {
+    _offset = 0;
+    return unknown;
+  }
+  --after;
+  _offset = _pc - after->first;
+  return after->second;
+}
+
+const Instruction *Program::instruction(uint32_t _pc) const {
+  auto instruction = instructions_.find(_pc);
+  return (instruction == instructions_.end()) ? nullptr : &instruction->second;
+}
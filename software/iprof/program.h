@@ -0,0 +1,49 @@
+// program.h:
+//
+// The symbols and disassembly of a macro test program, from its objdump
+// listings ('build/app.lst') or linker maps ('build/app.map').
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+#ifndef IPROF_PROGRAM_H
+#define IPROF_PROGRAM_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+struct Instruction {
+  std::string text;          // Disassembly, e.g., 'addiu sp,sp,-24'
+  bool control;              // Branch or jump: A basic block ends after its delay slot
+  bool trap;                 // eret, syscall, break, or a trap: A basic block ends after it
+};
+
+class Program {
+ public:
+  // Add the symbols (and instructions) of a listing, or of a map if the name
+  // ends in '.map'. Returns false with a message on stdout if it can't be read.
+  bool load(const std::string &_filename);
+
+  // Return the function containing a PC and the PC's offset in it, or "??"
+  const std::string &function(uint32_t _pc, uint32_t &_offset) const;
+
+  // Return the instruction at a PC, or nullptr if no listing has it
+  const Instruction *instruction(uint32_t _pc) const;
+
+  // Return whether a PC starts a basic block: It is a function or a branch target
+  bool leader(uint32_t _pc) const { return leaders_.count(_pc) > 0; }
+
+ private:
+  bool loadListing(const std::string &_filename);
+  bool loadMap(const std::string &_filename);
+
+  std::map<uint32_t, std::string> symbols_;  // The first definition of an address wins
+  std::unordered_map<uint32_t, Instruction> instructions_;
+  std::unordered_set<uint32_t> leaders_;
+};
+
+#endif  // IPROF_PROGRAM_H
@@ -0,0 +1,147 @@
+// cache.cc:
+//
+// A functional model of the L1 instruction and data caches.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+#include "cache.h"
+#include <algorithm>
+#include <cstring>
+
+Cache::Cache(Memory &_memory, int _index_bits, int _ways, bool _write_back)
+    : memory_(_memory),
+      index_bits_(_index_bits),
+      ways_(_ways),
+      levels_((_ways > 4) ? 3 : ((_ways > 2) ? 2 : ((_ways > 1) ? 1 : 0))),
+      write_back_(_write_back),
+      set_mask_((1u << _index_bits) - 1),
+      lines_((1u << _index_bits) * _ways),
+      lru_(1u << _index_bits),
+      generation_(0),
+      misses_(0) {
+  reset();
+}
+
+void Cache::reset() {
+  for (Line &line : lines_) {
+    line.base = 0;
+    line.valid = false;
+    line.dirty = false;
+    memset(line.data, 0, LINE_BYTES);
+  }
+  std::fill(lru_.begin(), lru_.end(), 0);
+  generation_++;
+  misses_ = 0;
+}
+
+// Fill the first invalid way, otherwise the least-recently used way
+uint8_t *Cache::fill(uint32_t _base, uint32_t _set, bool _write) {
+  int way = victim(_set);
+  for (int w = ways_ - 1; w >= 0; w--) {
+    if (!lines_[(_set * ways_) + w].valid) {
+      way = w;
+    }
+  }
+  Line &line = lines_[(_set * ways_) + way];
+  writeBack(line);
+  const uint8_t *source = memory_.ram(_base);
+  if (source != nullptr) {
+    memcpy(line.data, source, LINE_BYTES);
+  } else {
+    memset(line.data, 0, LINE_BYTES);
+  }
+  line.base = _base;
+  line.valid = true;
+  line.dirty = (_write && write_back_);
+  touch(_set, way);
+  generation_++;
+  misses_++;
+  return line.data;
+}
+
+void Cache::writeBack(Line &_line) {
+  if (_line.valid && _line.dirty) {
+    uint8_t *dest = memory_.ram(_line.base);
+    if (dest != nullptr) {
+      memcpy(dest, _line.data, LINE_BYTES);
+    }
+  }
+  _line.dirty = false;
+}
+
+// Point each node on the path to the way away from it
+void Cache::touch(uint32_t _set, int _way) {
+  uint8_t state = lru_[_set];
+  int node = 0;
+  for (int level = 0; level < levels_; level++) {
+    int bit = (_way >> (levels_ - 1 - level)) & 1;
+    state = static_cast<uint8_t>((state & ~(1 << node)) | (bit << node));
+    node = (2 * node) + 1 + bit;
+  }
+  lru_[_set] = state;
+}
+
+// Follow the node bits from the root to the least-recently used way
+int Cache::victim(uint32_t _set) const {
+  uint8_t state = lru_[_set];
+  int way = 0;
+  int node = 0;
+  for (int level = 0; level < levels_; level++) {
+    int bit = (state >> node) & 1;
+    way = (way << 1) | (bit ^ 1);
+    node = (2 * node) + ((bit) ? 1 : 2);
+  }
+  return way;
+}
+
+Cache::Line &Cache::indexLine(uint32_t _vaddr) {
+  uint32_t set = (_vaddr >> 4) & set_mask_;
+  int way = static_cast<int>(~(_vaddr >> (4 + index_bits_))) & (ways_ - 1);
+  return lines_[(set * ways_) + way];
+}
+
+void Cache::indexInvalidate(uint32_t _vaddr) {
+  Line &line = indexLine(_vaddr);
+  writeBack(line);
+  line.valid = false;
+  generation_++;
+}
+
+// The tag address keeps only the bits above the way size; the rest is the index
+void Cache::indexStoreTag(uint32_t _vaddr, uint32_t _tag_paddr, bool _valid, bool _dirty) {
+  Line &line = indexLine(_vaddr);
+  uint32_t way_mask = (1u << (4 + index_bits_)) - 1;
+  line.base = (_tag_paddr & ~way_mask) | (_vaddr & way_mask & ~(LINE_BYTES - 1));
+  line.valid = _valid;
+  line.dirty = _valid && _dirty && write_back_;
+  generation_++;
+}
+
+void Cache::hitInvalidate(uint32_t _paddr, bool _write_back) {
+  uint32_t base = _paddr & ~(LINE_BYTES - 1);
+  uint32_t set = (_paddr >> 4) & set_mask_;
+  for (int w = 0; w < ways_; w++) {
+    Line &line = lines_[(set * ways_) + w];
+    if (line.valid && (line.base == base)) {
+      if (_write_back) {
+        writeBack(line);
+      }
+      line.valid = false;
+      line.dirty = false;
+    }
+  }
+  generation_++;
+}
+
+void Cache::hitWriteBack(uint32_t _paddr) {
+  uint32_t base = _paddr & ~(LINE_BYTES - 1);
+  uint32_t set = (_paddr >> 4) & set_mask_;
+  for (int w = 0; w < ways_; w++) {
+    Line &line = lines_[(set * ways_) + w];
+    if (line.valid && (line.base == base)) {
+      writeBack(line);
+    }
+  }
+}
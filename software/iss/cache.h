@@ -0,0 +1,84 @@
+// cache.h:
+//
+// A functional model of the L1 instruction and data caches.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// The model keeps the contents of each line, not its timing, so that software
+// which relies on cache state behaves as on the hardware: Dirty data stays in
+// the write-back data cache until it is evicted or written back by a CACHE
+// instruction, uncacheable accesses bypass the cache, and the instruction cache
+// is not coherent with stores. The geometry follows the RTL parameters: 'WAYS'
+// ways (1, 2, 4, or 8) of 2^INDEX_BITS sets with 16-byte lines and tree
+// pseudo-LRU replacement ('hardware/src/Common/PseudoLRU.v').
+//
+#ifndef ISS_CACHE_H
+#define ISS_CACHE_H
+
+#include <cstdint>
+#include <vector>
+#include "memory.h"
+
+class Cache {
+ public:
+  static constexpr uint32_t LINE_BYTES = 16;
+
+  Cache(Memory &_memory, int _index_bits, int _ways, bool _write_back);
+
+  // Return the line holding a physical address, filling it on a miss
+  uint8_t *line(uint32_t _paddr, bool _write) {
+    uint32_t base = _paddr & ~(LINE_BYTES - 1);
+    uint32_t set = (_paddr >> 4) & set_mask_;
+    Line *lines = &lines_[set * ways_];
+    for (int w = 0; w < ways_; w++) {
+      if (lines[w].valid && (lines[w].base == base)) {
+        touch(set, w);
+        lines[w].dirty |= (_write && write_back_);
+        return lines[w].data;
+      }
+    }
+    return fill(base, set, _write);
+  }
+
+  // CACHE instruction operations. Index operations select the way with the
+  // address bits above the index, inverted as in the RTL.
+  void indexInvalidate(uint32_t _vaddr);
+  void indexStoreTag(uint32_t _vaddr, uint32_t _tag_paddr, bool _valid, bool _dirty);
+  void hitInvalidate(uint32_t _paddr, bool _write_back);
+  void hitWriteBack(uint32_t _paddr);
+
+  void reset();
+
+  // Incremented on every change of a line, so that users can cache line pointers
+  uint64_t generation() const { return generation_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  struct Line {
+    uint32_t base;
+    bool valid;
+    bool dirty;
+    uint8_t data[LINE_BYTES];
+  };
+
+  uint8_t *fill(uint32_t _base, uint32_t _set, bool _write);
+  void writeBack(Line &_line);
+  void touch(uint32_t _set, int _way);
+  int victim(uint32_t _set) const;
+  Line &indexLine(uint32_t _vaddr);
+
+  Memory &memory_;
+  int index_bits_;
+  int ways_;
+  int levels_;
+  bool write_back_;
+  uint32_t set_mask_;
+  std::vector<Line> lines_;
+  std::vector<uint8_t> lru_;  // Tree pseudo-LRU node bits per set (WAYS-1 bits)
+  uint64_t generation_;
+  uint64_t misses_;
+};
+
+#endif  // ISS_CACHE_H
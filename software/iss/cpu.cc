@@ -0,0 +1,1241 @@
+// cpu.cc:
+//
+// An instruction-set model of the MIPS32r1 processor core.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+#include "cpu.h"
+#include <cstring>
+
+// Exception codes (Cause.ExcCode)
+static constexpr uint32_t EXC_INT = 0;
+static constexpr uint32_t EXC_MOD = 1;
+static constexpr uint32_t EXC_TLBL = 2;
+static constexpr uint32_t EXC_TLBS = 3;
+static constexpr uint32_t EXC_ADEL = 4;
+static constexpr uint32_t EXC_ADES = 5;
+static constexpr uint32_t EXC_SYS = 8;
+static constexpr uint32_t EXC_BP = 9;
+static constexpr uint32_t EXC_CPU = 11;
+static constexpr uint32_t EXC_OV = 12;
+static constexpr uint32_t EXC_TR = 13;
+
+// Exception vectors
+static constexpr uint32_t VECTOR_RESET = 0xbfc00000;
+static constexpr uint32_t VECTOR_BASE_BOOT = 0xbfc00200;
+static constexpr uint32_t VECTOR_BASE_NOBOOT = 0x80000000;
+static constexpr uint32_t VECTOR_OFFSET_GENERAL = 0x180;
+static constexpr uint32_t VECTOR_OFFSET_INTERRUPT = 0x200;
+
+// Status register fields and writable bits
+static constexpr uint32_t ST_CU0 = 1u << 28;
+static constexpr uint32_t ST_RE = 1u << 25;
+static constexpr uint32_t ST_BEV = 1u << 22;
+static constexpr uint32_t ST_NMI = 1u << 19;
+static constexpr uint32_t ST_IM = 0xff00;
+static constexpr uint32_t ST_UM = 1u << 4;
+static constexpr uint32_t ST_ERL = 1u << 2;
+static constexpr uint32_t ST_EXL = 1u << 1;
+static constexpr uint32_t ST_IE = 1u << 0;
+static constexpr uint32_t ST_WRITE_MASK = ST_CU0 | ST_RE | ST_BEV | ST_NMI | ST_IM | ST_UM | ST_ERL | ST_EXL | ST_IE;
+
+// Writable bits of the other CP0 registers (32-bit physical addresses as in the harness)
+static constexpr uint32_t ENTRYLO_MASK = 0x03ffffff;
+static constexpr uint32_t ENTRYHI_MASK = 0xffffe0ff;
+static constexpr uint32_t PAGEMASK_MASK = 0x1fffe000;
+static constexpr uint32_t PERFCTL_MASK = 0x000007fb;
+static constexpr uint32_t TAGLO_MASK = 0x7fffffc0;
+static constexpr uint32_t PRID = 0x58000002;
+
+// Performance counter control fields and events (see 'CP0_Registers.v')
+static constexpr uint32_t PERF_EXL = 1u << 0;
+static constexpr uint32_t PERF_K = 1u << 1;
+static constexpr uint32_t PERF_U = 1u << 3;
+static constexpr uint32_t PERF_IE = 1u << 4;
+static constexpr int PERF_EVENT_CYCLES = 0;
+static constexpr int PERF_EVENT_INSTRUCTIONS = 1;
+static constexpr int PERF_EVENT_BRANCHES = 2;
+static constexpr int PERF_EVENT_REDIRECTS = 3;
+static constexpr int PERF_EVENT_ICACHE_MISSES = 4;
+static constexpr int PERF_EVENT_DCACHE_MISSES = 6;
+static constexpr int PERF_EVENT_ITLB_REFILLS = 9;
+static constexpr int PERF_EVENT_DTLB_REFILLS = 10;
+
+// Loads and stores, which are not replaced by interrupts (indexed by opcode)
+static constexpr uint64_t MEMORY_OPS = 0x0101cf7f00000000ull;
+
+static inline uint32_t getWord(const uint8_t *_p, bool _big) {
+  return (_big) ? ((_p[0] << 24) | (_p[1] << 16) | (_p[2] << 8) | _p[3])
+                : ((_p[3] << 24) | (_p[2] << 16) | (_p[1] << 8) | _p[0]);
+}
+
+static inline void putWord(uint8_t *_p, uint32_t _value, bool _big) {
+  for (int i = 0; i < 4; i++) {
+    _p[i] = static_cast<uint8_t>(_value >> ((_big) ? (24 - (8 * i)) : (8 * i)));
+  }
+}
+
+static inline uint32_t signExtend16(uint32_t _value) {
+  return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(_value)));
+}
+
+Cpu::Cpu(Memory &_memory, const CpuConfig &_config)
+    : memory_(_memory),
+      config_(_config),
+      icache_(_memory, _config.icache_index_bits, _config.icache_ways, false),
+      dcache_(_memory, _config.dcache_index_bits, _config.dcache_ways, true),
+      exceptions_(0) {
+  // State without a reset value in the RTL starts as zero
+  memset(gpr_, 0, sizeof(gpr_));
+  memset(tlb_, 0, sizeof(tlb_));
+  hi_ = lo_ = 0;
+  index_p_ = false;
+  index_ = 0;
+  entrylo_[0] = entrylo_[1] = 0;
+  context_ = pagemask_ = badvaddr_ = count_ = entryhi_ = compare_ = 0;
+  status_ = 0;
+  cause_bd_ = cause_iv_ = cause_ti_ = false;
+  cause_ce_ = cause_ip10_ = cause_exccode_ = 0;
+  epc_ = errorepc_ = 0;
+  config_k0_ = 2;
+  taglo_ = taghi_ = 0;
+  atomic_addr_ = 0;
+  interrupt_request_ = false;
+  reset();
+}
+
+void Cpu::reset() {
+  pc_ = VECTOR_RESET;
+  next_pc_ = pc_ + 4;
+  delay_slot_ = false;
+  branch_pc_ = 0;
+  atomic_ = false;
+  status_ = (status_ & ~(ST_BEV | ST_NMI | ST_ERL)) | ST_BEV | ST_ERL;
+  random_ = 15;
+  wired_ = 0;
+  perf_ctl_[0] = perf_ctl_[1] = 0;
+  perf_cnt_[0] = perf_cnt_[1] = 0;
+  restart_pc_ = pc_;
+  icache_.reset();
+  dcache_.reset();
+  flushTranslation();
+}
+
+void Cpu::flushTranslation() {
+  fetch_tlb_.vpage = 1;  // Never a page address
+  data_tlb_.vpage = 1;
+  fetch_line_va_ = 1;
+  fetch_line_ = nullptr;
+}
+
+bool Cpu::kernelMode() const {
+  return ((status_ & (ST_UM | ST_EXL | ST_ERL)) != ST_UM);
+}
+
+bool Cpu::interruptEnabled() const {
+  if (config_.external_interrupts) {
+    return interrupt_request_;
+  }
+  if ((status_ & (ST_ERL | ST_EXL | ST_IE)) != ST_IE) {
+    return false;
+  }
+  uint32_t pending = ((cause_ti_ || (((perf_ctl_[0] & PERF_IE) != 0) && (perf_cnt_[0] >> 31)) ||
+                       (((perf_ctl_[1] & PERF_IE) != 0) && (perf_cnt_[1] >> 31))) ? 0x8000 : 0) |
+                     (cause_ip10_ << 8);
+  return ((pending & status_ & ST_IM) != 0);
+}
+
+bool Cpu::step() {
+  uint32_t pc = pc_;
+  uint32_t status = status_;
+  uint64_t imisses = icache_.misses();
+  uint64_t dmisses = dcache_.misses();
+  in_delay_slot_ = delay_slot_;
+  restart_pc_ = (delay_slot_) ? branch_pc_ : pc;
+  retired_ = false;
+  count_written_ = compare_written_ = random_written_ = false;
+  perf_written_[0] = perf_written_[1] = false;
+  branch_event_ = redirect_event_ = false;
+  itlb_refill_ = dtlb_refill_ = false;
+  volatile_reg_ = 0;
+
+  uint32_t inst;
+  if (fetch(pc, inst)) {
+    if (!((MEMORY_OPS >> (inst >> 26)) & 1) && interruptEnabled()) {
+      exception(EXC_INT);
+    } else {
+      // Sequential flow unless the instruction redirects it
+      pc_ = next_pc_;
+      next_pc_ += 4;
+      delay_slot_ = false;
+      retired_ = true;
+      execute(inst);
+      gpr_[0] = 0;
+    }
+  }
+
+  // Free-running state advances once per step
+  if (compare_written_) {
+    cause_ti_ = false;
+  } else if (count_ == compare_) {
+    cause_ti_ = true;
+  }
+  if (!count_written_) {
+    count_++;
+  }
+  if ((random_ == wired_) || random_written_) {
+    random_ = 15;
+  } else if (retired_) {
+    random_ = (random_ - 1) & 0xf;
+  }
+  if ((perf_ctl_[0] | perf_ctl_[1]) & (PERF_EXL | PERF_K | PERF_U)) {
+    countPerfEvents(status, retired_, icache_.misses() - imisses, dcache_.misses() - dmisses);
+  }
+  if (!retired_) {
+    exceptions_++;
+  }
+  interrupt_request_ = false;
+  return retired_;
+}
+
+void Cpu::countPerfEvents(uint32_t _status, bool _retired, uint64_t _imisses, uint64_t _dmisses) {
+  uint32_t level = (_status & ST_ERL) ? 0 : ((_status & ST_EXL) ? PERF_EXL : ((_status & ST_UM) ? PERF_U : PERF_K));
+  for (int i = 0; i < 2; i++) {
+    uint32_t ctl = perf_ctl_[i];
+    if (perf_written_[i] || !(ctl & level)) {
+      continue;
+    }
+    bool event = false;
+    switch ((ctl >> 5) & 0x3f) {
+      case PERF_EVENT_CYCLES:
+        event = true;
+        break;
+      case PERF_EVENT_INSTRUCTIONS:
+        event = _retired;
+        break;
+      case PERF_EVENT_BRANCHES:
+        event = branch_event_;
+        break;
+      case PERF_EVENT_REDIRECTS:
+        event = redirect_event_;
+        break;
+      case PERF_EVENT_ICACHE_MISSES:
+        event = (_imisses != 0);
+        break;
+      case PERF_EVENT_DCACHE_MISSES:
+        event = (_dmisses != 0);
+        break;
+      case PERF_EVENT_ITLB_REFILLS:
+        event = itlb_refill_;
+        break;
+      case PERF_EVENT_DTLB_REFILLS:
+        event = dtlb_refill_;
+        break;
+      default:
+        break;  // Stall events are zero without timing
+    }
+    perf_cnt_[i] += (event) ? 1 : 0;
+  }
+}
+
+// Raise an exception for the current instruction. An enabled interrupt takes its place.
+void Cpu::exception(uint32_t _code, bool _refill) {
+  if (interruptEnabled()) {
+    _code = EXC_INT;
+    _refill = false;
+  }
+  retired_ = false;
+  uint32_t base = (status_ & ST_BEV) ? VECTOR_BASE_BOOT : VECTOR_BASE_NOBOOT;
+  uint32_t vector;
+  if (_refill && !(status_ & ST_EXL)) {
+    vector = base;
+  } else if ((_code == EXC_INT) && cause_iv_) {
+    vector = base + VECTOR_OFFSET_INTERRUPT;
+  } else {
+    vector = base + VECTOR_OFFSET_GENERAL;
+  }
+  if (!(status_ & ST_EXL)) {
+    epc_ = restart_pc_;
+    cause_bd_ = in_delay_slot_;
+  }
+  cause_exccode_ = _code;
+  status_ |= ST_EXL;
+  pc_ = vector;
+  next_pc_ = vector + 4;
+  delay_slot_ = false;
+  flushTranslation();
+}
+
+void Cpu::addressException(uint32_t _code, uint32_t _vaddr, bool _refill) {
+  if (!interruptEnabled()) {
+    badvaddr_ = _vaddr;
+  }
+  exception(_code, _refill);
+}
+
+void Cpu::eret() {
+  if (status_ & ST_ERL) {
+    pc_ = errorepc_;
+    status_ &= ~ST_ERL;
+  } else {
+    pc_ = epc_;
+    status_ &= ~ST_EXL;
+  }
+  next_pc_ = pc_ + 4;
+  atomic_ = false;
+  flushTranslation();
+}
+
+bool Cpu::fetch(uint32_t _pc, uint32_t &_inst) {
+  if (((_pc & ~15u) == fetch_line_va_) && (fetch_generation_ == icache_.generation())) {
+    _inst = getWord(fetch_line_ + (_pc & 12), config_.big_endian);
+    return true;
+  }
+  if (_pc & 3) {
+    addressException(EXC_ADEL, _pc);
+    return false;
+  }
+  uint32_t paddr;
+  bool cached;
+  if (!translate(_pc, FETCH, paddr, cached)) {
+    return false;
+  }
+  const uint8_t *line;
+  if (cached) {
+    line = icache_.line(paddr, false);
+  } else {
+    line = memory_.ram(paddr & ~15u);
+  }
+  if (line == nullptr) {
+    _inst = 0;  // No memory: Execute a 'nop'
+    return true;
+  }
+  fetch_line_va_ = _pc & ~15u;
+  fetch_line_ = line;
+  fetch_generation_ = icache_.generation();
+  _inst = getWord(line + (_pc & 12), config_.big_endian);
+  return true;
+}
+
+bool Cpu::translate(uint32_t _vaddr, Access _access, uint32_t &_paddr, bool &_cached) {
+  if ((_vaddr >> 30) == 2) {
+    // kseg0 and kseg1 are unmapped
+    _paddr = _vaddr & 0x1fffffff;
+    _cached = (_vaddr < 0xa0000000) && (config_k0_ != 2);
+    return true;
+  }
+  if (!(_vaddr >> 31) && (status_ & ST_ERL)) {
+    // useg is unmapped and uncached in error mode
+    _paddr = _vaddr;
+    _cached = false;
+    return true;
+  }
+  MicroTlb &utlb = (_access == FETCH) ? fetch_tlb_ : data_tlb_;
+  uint32_t vpage = _vaddr & ~0xfffu;
+  if ((utlb.vpage != vpage) || ((_access == STORE) && !utlb.dirty)) {
+    MicroTlb entry;
+    if (!tlbLookup(_vaddr, _access, entry)) {
+      return false;
+    }
+    utlb = entry;
+  }
+  _paddr = utlb.ppage | (_vaddr & 0xfff);
+  _cached = utlb.cached;
+  return true;
+}
+
+bool Cpu::tlbLookup(uint32_t _vaddr, Access _access, MicroTlb &_entry) {
+  uint32_t vpn2 = _vaddr >> 13;
+  uint32_t asid = entryhi_ & 0xff;
+  for (const TlbEntry &e : tlb_) {
+    if ((((e.vpn2 ^ vpn2) & ~e.mask) != 0) || (!e.g && (e.asid != asid))) {
+      continue;
+    }
+    // The even/odd page is selected by the address bit above the page offset
+    uint32_t offset_mask = ((e.mask + 1) << 12) - 1;
+    int odd = (_vaddr & (offset_mask + 1)) ? 1 : 0;
+    if (!e.v[odd]) {
+      addressException((_access == STORE) ? EXC_TLBS : EXC_TLBL, _vaddr);
+      return false;
+    }
+    if ((_access == STORE) && !e.d[odd]) {
+      addressException(EXC_MOD, _vaddr);
+      return false;
+    }
+    uint32_t paddr = ((e.pfn[odd] << 12) & ~offset_mask) | (_vaddr & offset_mask);
+    _entry.vpage = _vaddr & ~0xfffu;
+    _entry.ppage = paddr & ~0xfffu;
+    _entry.cached = (e.c[odd] != 2);
+    _entry.dirty = e.d[odd];
+    return true;
+  }
+  if (_access == FETCH) {
+    itlb_refill_ = true;
+  } else {
+    dtlb_refill_ = true;
+  }
+  addressException((_access == STORE) ? EXC_TLBS : EXC_TLBL, _vaddr, true);
+  return false;
+}
+
+// Translate a data address and return its aligned word, or nullptr after an exception
+uint8_t *Cpu::dataWord(uint32_t _vaddr, Access _access) {
+  uint32_t paddr;
+  bool cached;
+  if (!translate(_vaddr, _access, paddr, cached)) {
+    return nullptr;
+  }
+  io_write_ = false;
+  if (_vaddr >= 0xe0000000) {
+    // Accesses to kseg3 are masked in the RTL ('MemControl.v')
+    memset(io_word_, 0, 4);
+    return io_word_;
+  }
+  if (cached) {
+    return dcache_.line(paddr, _access == STORE) + (paddr & 12);
+  }
+  uint8_t *word = memory_.ram(paddr & ~3u);
+  if (word != nullptr) {
+    return word;
+  }
+  io_paddr_ = paddr & ~3u;
+  if (Memory::isRegister(paddr)) {
+    memory_.readRegister(io_paddr_, io_word_);
+    io_write_ = (_access == STORE);
+  } else {
+    memset(io_word_, 0, 4);
+  }
+  return io_word_;
+}
+
+void Cpu::commitWord() {
+  if (io_write_) {
+    memory_.writeRegister(io_paddr_, io_word_);
+  }
+}
+
+void Cpu::branch(bool _taken, bool _likely, uint32_t _target) {
+  branch_event_ = true;
+  branch_pc_ = pc_ - 4;
+  if (_taken) {
+    next_pc_ = _target;
+    delay_slot_ = true;
+    redirect_event_ = true;
+  } else if (_likely) {
+    // Nullify the delay slot
+    pc_ += 4;
+    next_pc_ = pc_ + 4;
+  } else {
+    delay_slot_ = true;
+  }
+}
+
+void Cpu::jump(uint32_t _target) {
+  branch_event_ = true;
+  redirect_event_ = true;
+  branch_pc_ = pc_ - 4;
+  next_pc_ = _target;
+  delay_slot_ = true;
+}
+
+void Cpu::execute(uint32_t _inst) {
+  uint32_t op = _inst >> 26;
+  uint32_t rs = (_inst >> 21) & 0x1f;
+  uint32_t rt = (_inst >> 16) & 0x1f;
+  uint32_t imm = _inst & 0xffff;
+  uint32_t simm = signExtend16(imm);
+  uint32_t pc = pc_ - 4;  // 'pc_' already points to the next instruction
+  uint32_t target = pc_ + (simm << 2);
+  int32_t s = static_cast<int32_t>(gpr_[rs]);
+  int32_t t = static_cast<int32_t>(gpr_[rt]);
+
+  switch (op) {
+    case 0x00:
+      special(_inst);
+      break;
+    case 0x01:
+      regimm(_inst);
+      break;
+    case 0x02:  // j
+      jump((pc_ & 0xf0000000) | ((_inst & 0x03ffffff) << 2));
+      break;
+    case 0x03:  // jal
+      gpr_[31] = pc + 8;
+      jump((pc_ & 0xf0000000) | ((_inst & 0x03ffffff) << 2));
+      break;
+    case 0x04:  // beq
+      branch(s == t, false, target);
+      break;
+    case 0x05:  // bne
+      branch(s != t, false, target);
+      break;
+    case 0x06:  // blez
+      branch(s <= 0, false, target);
+      break;
+    case 0x07:  // bgtz
+      branch(s > 0, false, target);
+      break;
+    case 0x08: {  // addi
+      uint32_t result = gpr_[rs] + simm;
+      if (~(gpr_[rs] ^ simm) & (gpr_[rs] ^ result) & 0x80000000) {
+        exception(EXC_OV);
+      } else {
+        gpr_[rt] = result;
+      }
+      break;
+    }
+    case 0x09:  // addiu
+      gpr_[rt] = gpr_[rs] + simm;
+      break;
+    case 0x0a:  // slti
+      gpr_[rt] = (s < static_cast<int32_t>(simm)) ? 1 : 0;
+      break;
+    case 0x0b:  // sltiu
+      gpr_[rt] = (gpr_[rs] < simm) ? 1 : 0;
+      break;
+    case 0x0c:  // andi
+      gpr_[rt] = gpr_[rs] & imm;
+      break;
+    case 0x0d:  // ori
+      gpr_[rt] = gpr_[rs] | imm;
+      break;
+    case 0x0e:  // xori
+      gpr_[rt] = gpr_[rs] ^ imm;
+      break;
+    case 0x0f:  // lui
+      gpr_[rt] = imm << 16;
+      break;
+    case 0x10:
+      cop0(_inst);
+      break;
+    case 0x11:  // Coprocessors 1-3 are not implemented
+    case 0x12:
+    case 0x13:
+      cause_ce_ = op & 3;
+      exception(EXC_CPU);
+      break;
+    case 0x14:  // beql
+      branch(s == t, true, target);
+      break;
+    case 0x15:  // bnel
+      branch(s != t, true, target);
+      break;
+    case 0x16:  // blezl
+      branch(s <= 0, true, target);
+      break;
+    case 0x17:  // bgtzl
+      branch(s > 0, true, target);
+      break;
+    case 0x1c:
+      special2(_inst);
+      break;
+    case 0x2f:
+      cacheOp(_inst);
+      break;
+    case 0x20:
+    case 0x21:
+    case 0x22:
+    case 0x23:
+    case 0x24:
+    case 0x25:
+    case 0x26:
+    case 0x28:
+    case 0x29:
+    case 0x2a:
+    case 0x2b:
+    case 0x2e:
+    case 0x30:
+    case 0x38:
+      loadStore(_inst);
+      break;
+    default:
+      break;  // pref, and reserved instructions execute as no-ops
+  }
+}
+
+void Cpu::special(uint32_t _inst) {
+  uint32_t rs = (_inst >> 21) & 0x1f;
+  uint32_t rt = (_inst >> 16) & 0x1f;
+  uint32_t rd = (_inst >> 11) & 0x1f;
+  uint32_t sa = (_inst >> 6) & 0x1f;
+  uint32_t a = gpr_[rs];
+  uint32_t b = gpr_[rt];
+  int32_t as = static_cast<int32_t>(a);
+  int32_t bs = static_cast<int32_t>(b);
+
+  switch (_inst & 0x3f) {
+    case 0x00:  // sll
+      gpr_[rd] = b << sa;
+      break;
+    case 0x02:  // srl
+      gpr_[rd] = b >> sa;
+      break;
+    case 0x03:  // sra
+      gpr_[rd] = static_cast<uint32_t>(bs >> sa);
+      break;
+    case 0x04:  // sllv
+      gpr_[rd] = b << (a & 0x1f);
+      break;
+    case 0x06:  // srlv
+      gpr_[rd] = b >> (a & 0x1f);
+      break;
+    case 0x07:  // srav
+      gpr_[rd] = static_cast<uint32_t>(bs >> (a & 0x1f));
+      break;
+    case 0x08:  // jr
+      jump(a);
+      break;
+    case 0x09:  // jalr
+      gpr_[rd] = pc_ + 4;
+      jump(a);
+      break;
+    case 0x0a:  // movz
+      if (b == 0) {
+        gpr_[rd] = a;
+      }
+      break;
+    case 0x0b:  // movn
+      if (b != 0) {
+        gpr_[rd] = a;
+      }
+      break;
+    case 0x0c:  // syscall
+      exception(EXC_SYS);
+      break;
+    case 0x0d:  // break
+      exception(EXC_BP);
+      break;
+    case 0x10:  // mfhi
+      gpr_[rd] = hi_;
+      break;
+    case 0x11:  // mthi
+      hi_ = a;
+      break;
+    case 0x12:  // mflo
+      gpr_[rd] = lo_;
+      break;
+    case 0x13:  // mtlo
+      lo_ = a;
+      break;
+    case 0x18: {  // mult
+      uint64_t product = static_cast<uint64_t>(static_cast<int64_t>(as) * static_cast<int64_t>(bs));
+      hi_ = static_cast<uint32_t>(product >> 32);
+      lo_ = static_cast<uint32_t>(product);
+      break;
+    }
+    case 0x19: {  // multu
+      uint64_t product = static_cast<uint64_t>(a) * static_cast<uint64_t>(b);
+      hi_ = static_cast<uint32_t>(product >> 32);
+      lo_ = static_cast<uint32_t>(product);
+      break;
+    }
+    case 0x1a:  // div
+      if (b == 0) {
+        // As the radix-4 divider: All quotient bits set, the dividend remains
+        lo_ = (as < 0) ? 1 : 0xffffffff;
+        hi_ = a;
+      } else if ((a == 0x80000000) && (bs == -1)) {
+        lo_ = a;
+        hi_ = 0;
+      } else {
+        lo_ = static_cast<uint32_t>(as / bs);
+        hi_ = static_cast<uint32_t>(as % bs);
+      }
+      break;
+    case 0x1b:  // divu
+      if (b == 0) {
+        lo_ = 0xffffffff;
+        hi_ = a;
+      } else {
+        lo_ = a / b;
+        hi_ = a % b;
+      }
+      break;
+    case 0x20: {  // add
+      uint32_t result = a + b;
+      if (~(a ^ b) & (a ^ result) & 0x80000000) {
+        exception(EXC_OV);
+      } else {
+        gpr_[rd] = result;
+      }
+      break;
+    }
+    case 0x21:  // addu
+      gpr_[rd] = a + b;
+      break;
+    case 0x22: {  // sub
+      uint32_t result = a - b;
+      if ((a ^ b) & (a ^ result) & 0x80000000) {
+        exception(EXC_OV);
+      } else {
+        gpr_[rd] = result;
+      }
+      break;
+    }
+    case 0x23:  // subu
+      gpr_[rd] = a - b;
+      break;
+    case 0x24:  // and
+      gpr_[rd] = a & b;
+      break;
+    case 0x25:  // or
+      gpr_[rd] = a | b;
+      break;
+    case 0x26:  // xor
+      gpr_[rd] = a ^ b;
+      break;
+    case 0x27:  // nor
+      gpr_[rd] = ~(a | b);
+      break;
+    case 0x2a:  // slt
+      gpr_[rd] = (as < bs) ? 1 : 0;
+      break;
+    case 0x2b:  // sltu
+      gpr_[rd] = (a < b) ? 1 : 0;
+      break;
+    case 0x30:  // tge
+      if (as >= bs) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x31:  // tgeu
+      if (a >= b) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x32:  // tlt
+      if (as < bs) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x33:  // tltu
+      if (a < b) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x34:  // teq
+      if (a == b) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x36:  // tne
+      if (a != b) {
+        exception(EXC_TR);
+      }
+      break;
+    default:
+      break;  // sync, and reserved instructions execute as no-ops
+  }
+}
+
+void Cpu::regimm(uint32_t _inst) {
+  uint32_t rs = (_inst >> 21) & 0x1f;
+  uint32_t rt = (_inst >> 16) & 0x1f;
+  uint32_t simm = signExtend16(_inst & 0xffff);
+  uint32_t target = pc_ + (simm << 2);
+  uint32_t a = gpr_[rs];
+  int32_t as = static_cast<int32_t>(a);
+
+  switch (rt) {
+    case 0x00:  // bltz
+      branch(as < 0, false, target);
+      break;
+    case 0x01:  // bgez
+      branch(as >= 0, false, target);
+      break;
+    case 0x02:  // bltzl
+      branch(as < 0, true, target);
+      break;
+    case 0x03:  // bgezl
+      branch(as >= 0, true, target);
+      break;
+    case 0x08:  // tgei
+      if (as >= static_cast<int32_t>(simm)) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x09:  // tgeiu
+      if (a >= simm) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x0a:  // tlti
+      if (as < static_cast<int32_t>(simm)) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x0b:  // tltiu
+      if (a < simm) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x0c:  // teqi
+      if (a == simm) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x0e:  // tnei
+      if (a != simm) {
+        exception(EXC_TR);
+      }
+      break;
+    case 0x10:  // bltzal
+      gpr_[31] = pc_ + 4;
+      branch(as < 0, false, target);
+      break;
+    case 0x11:  // bgezal
+      gpr_[31] = pc_ + 4;
+      branch(as >= 0, false, target);
+      break;
+    case 0x12:  // bltzall
+      gpr_[31] = pc_ + 4;
+      branch(as < 0, true, target);
+      break;
+    case 0x13:  // bgezall
+      gpr_[31] = pc_ + 4;
+      branch(as >= 0, true, target);
+      break;
+    default:
+      break;
+  }
+}
+
+void Cpu::special2(uint32_t _inst) {
+  uint32_t rs = (_inst >> 21) & 0x1f;
+  uint32_t rt = (_inst >> 16) & 0x1f;
+  uint32_t rd = (_inst >> 11) & 0x1f;
+  uint32_t a = gpr_[rs];
+  uint32_t b = gpr_[rt];
+  uint64_t hilo = (static_cast<uint64_t>(hi_) << 32) | lo_;
+  uint64_t sproduct = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(a)) *
+                                            static_cast<int64_t>(static_cast<int32_t>(b)));
+  uint64_t uproduct = static_cast<uint64_t>(a) * static_cast<uint64_t>(b);
+
+  switch (_inst & 0x3f) {
+    case 0x00:  // madd
+      hilo += sproduct;
+      break;
+    case 0x01:  // maddu
+      hilo += uproduct;
+      break;
+    case 0x02:  // mul (also writes HI/LO in the RTL)
+      hilo = sproduct;
+      gpr_[rd] = static_cast<uint32_t>(sproduct);
+      break;
+    case 0x04:  // msub
+      hilo -= sproduct;
+      break;
+    case 0x05:  // msubu
+      hilo -= uproduct;
+      break;
+    case 0x20:  // clz
+      gpr_[rd] = (a == 0) ? 32 : __builtin_clz(a);
+      return;
+    case 0x21:  // clo
+      gpr_[rd] = (~a == 0) ? 32 : __builtin_clz(~a);
+      return;
+    default:
+      return;
+  }
+  hi_ = static_cast<uint32_t>(hilo >> 32);
+  lo_ = static_cast<uint32_t>(hilo);
+}
+
+void Cpu::cop0(uint32_t _inst) {
+  uint32_t rs = (_inst >> 21) & 0x1f;
+  uint32_t rt = (_inst >> 16) & 0x1f;
+  uint32_t rd = (_inst >> 11) & 0x1f;
+  uint32_t sel = _inst & 0x7;
+  uint32_t funct = _inst & 0x3f;
+
+  // Decode first: Only implemented CP0 instructions check for permission
+  bool known = (rs == 0x00) || (rs == 0x04) ||
+               ((rs & 0x10) && ((funct == 0x18) || (funct == 0x08) || (funct == 0x01) || (funct == 0x02) || (funct == 0x06)));
+  if (!known) {
+    return;
+  }
+  if (!kernelMode() && !(status_ & ST_CU0)) {
+    cause_ce_ = 0;
+    exception(EXC_CPU);
+    return;
+  }
+  if (rs == 0x00) {
+    gpr_[rt] = readCp0(rd, sel);
+    if ((rd == 1) || (rd == 9) || (rd == 13) || (rd == 25)) {
+      volatile_reg_ = static_cast<int>(rt);  // Random, Count, Cause, PerfCnt
+    }
+  } else if (rs == 0x04) {
+    writeCp0(rd, sel, gpr_[rt]);
+  } else {
+    switch (funct) {
+      case 0x18:
+        eret();
+        break;
+      case 0x08:
+        tlbProbe();
+        break;
+      case 0x01:
+        tlbRead();
+        break;
+      case 0x02:
+        tlbWrite(index_);
+        break;
+      case 0x06:
+        tlbWrite(random_);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+uint32_t Cpu::readCp0(uint32_t _reg, uint32_t _sel) const {
+  switch (_reg) {
+    case 0:
+      return ((index_p_) ? 0x80000000 : 0) | index_;
+    case 1:
+      return random_;
+    case 2:
+      return entrylo_[0];
+    case 3:
+      return entrylo_[1];
+    case 4:
+      return (context_ & 0xff800000) | ((badvaddr_ >> 13) << 4);
+    case 5:
+      return pagemask_;
+    case 6:
+      return wired_;
+    case 8:
+      return badvaddr_;
+    case 9:
+      return count_;
+    case 10:
+      return entryhi_;
+    case 11:
+      return compare_;
+    case 12:
+      return status_;
+    case 13: {
+      bool perf_int = (((perf_ctl_[0] & PERF_IE) != 0) && (perf_cnt_[0] >> 31)) ||
+                      (((perf_ctl_[1] & PERF_IE) != 0) && (perf_cnt_[1] >> 31));
+      return ((cause_bd_) ? 0x80000000 : 0) | (cause_ce_ << 28) | ((cause_iv_) ? 0x00800000 : 0) |
+             ((cause_ti_ || perf_int) ? 0x8000 : 0) | (cause_ip10_ << 8) | (cause_exccode_ << 2);
+    }
+    case 14:
+      return epc_;
+    case 15:
+      return PRID;
+    case 16:
+      if (_sel == 0) {
+        return 0x80000000 | ((config_.big_endian) ? 0x8000 : 0) | (1 << 7) | config_k0_;
+      }
+      return (15u << 25) | ((config_.icache_index_bits - 6) << 22) | (3 << 19) | ((config_.icache_ways - 1) << 16) |
+             ((config_.dcache_index_bits - 6) << 13) | (3 << 10) | ((config_.dcache_ways - 1) << 7) | (1 << 4);
+    case 25:
+      if (_sel & 1) {
+        return perf_cnt_[(_sel >> 1) & 1];
+      }
+      return ((_sel & 2) ? 0 : 0x80000000) | perf_ctl_[(_sel >> 1) & 1];
+    case 28:
+      return (_sel == 0) ? taglo_ : 0;
+    case 29:
+      return (_sel == 0) ? taghi_ : 0;
+    case 30:
+      return errorepc_;
+    default:
+      return 0;
+  }
+}
+
+void Cpu::writeCp0(uint32_t _reg, uint32_t _sel, uint32_t _data) {
+  if ((_reg == 25) && (_sel < 4)) {
+    int counter = (_sel >> 1) & 1;
+    if (_sel & 1) {
+      perf_cnt_[counter] = _data;
+      perf_written_[counter] = true;
+    } else {
+      perf_ctl_[counter] = _data & PERFCTL_MASK;
+    }
+    return;
+  }
+  if (_sel != 0) {
+    return;
+  }
+  switch (_reg) {
+    case 0:
+      index_ = _data & 0xf;
+      break;
+    case 2:
+      entrylo_[0] = _data & ENTRYLO_MASK;
+      break;
+    case 3:
+      entrylo_[1] = _data & ENTRYLO_MASK;
+      break;
+    case 4:
+      context_ = _data & 0xff800000;
+      break;
+    case 5:
+      pagemask_ = _data & PAGEMASK_MASK;
+      break;
+    case 6:
+      wired_ = _data & 0xf;
+      random_written_ = true;
+      break;
+    case 9:
+      count_ = _data;
+      count_written_ = true;
+      break;
+    case 10:
+      entryhi_ = _data & ENTRYHI_MASK;
+      flushTranslation();
+      break;
+    case 11:
+      compare_ = _data;
+      compare_written_ = true;
+      break;
+    case 12:
+      status_ = _data & ST_WRITE_MASK;
+      flushTranslation();
+      break;
+    case 13:
+      cause_iv_ = (_data >> 23) & 1;
+      cause_ip10_ = (_data >> 8) & 3;
+      break;
+    case 14:
+      epc_ = _data;
+      break;
+    case 16:
+      config_k0_ = _data & 7;
+      flushTranslation();
+      break;
+    case 28:
+      taglo_ = _data & TAGLO_MASK;
+      break;
+    case 29:
+      taghi_ = _data & 0xf;
+      break;
+    case 30:
+      errorepc_ = _data;
+      break;
+    default:
+      break;
+  }
+}
+
+void Cpu::tlbProbe() {
+  uint32_t vpn2 = entryhi_ >> 13;
+  uint32_t asid = entryhi_ & 0xff;
+  index_p_ = true;
+  for (uint32_t i = 0; i < 16; i++) {
+    const TlbEntry &e = tlb_[i];
+    if ((((e.vpn2 ^ vpn2) & ~e.mask) == 0) && (e.g || (e.asid == asid))) {
+      index_p_ = false;
+      index_ = i;
+      break;
+    }
+  }
+}
+
+void Cpu::tlbRead() {
+  const TlbEntry &e = tlb_[index_];
+  entryhi_ = (e.vpn2 << 13) | e.asid;
+  pagemask_ = e.mask << 13;
+  for (int i = 0; i < 2; i++) {
+    entrylo_[i] = (e.pfn[i] << 6) | (e.c[i] << 3) | ((e.d[i]) ? 4 : 0) | ((e.v[i]) ? 2 : 0) | ((e.g) ? 1 : 0);
+  }
+  flushTranslation();
+}
+
+// The PFNs are stored with the page mask applied
+void Cpu::tlbWrite(uint32_t _index) {
+  TlbEntry &e = tlb_[_index & 0xf];
+  e.vpn2 = entryhi_ >> 13;
+  e.mask = pagemask_ >> 13;
+  e.asid = entryhi_ & 0xff;
+  e.g = (entrylo_[0] & entrylo_[1] & 1) != 0;
+  for (int i = 0; i < 2; i++) {
+    e.pfn[i] = (entrylo_[i] >> 6) & ~e.mask;
+    e.c[i] = (entrylo_[i] >> 3) & 7;
+    e.d[i] = (entrylo_[i] >> 2) & 1;
+    e.v[i] = (entrylo_[i] >> 1) & 1;
+  }
+  flushTranslation();
+}
+
+void Cpu::cacheOp(uint32_t _inst) {
+  uint32_t rs = (_inst >> 21) & 0x1f;
+  uint32_t cache = (_inst >> 16) & 0x3;
+  uint32_t operation = (_inst >> 18) & 0x7;
+  uint32_t vaddr = gpr_[rs] + signExtend16(_inst & 0xffff);
+
+  // Only primary cache operations are implemented (and privileged)
+  if (cache > 1) {
+    return;
+  }
+  if (!kernelMode() && !(status_ & ST_CU0)) {
+    cause_ce_ = 0;
+    exception(EXC_CPU);
+    return;
+  }
+  if (!kernelMode() && (vaddr >> 31)) {
+    addressException(EXC_ADEL, vaddr);
+    return;
+  }
+  uint32_t paddr;
+  bool cached;
+  if (!translate(vaddr, (cache == 0) ? FETCH : LOAD, paddr, cached)) {
+    return;
+  }
+  uint32_t tag_paddr = ((taglo_ >> 8) & 0x7fffff) << 9;
+  uint32_t pstate = (taglo_ >> 6) & 3;
+  Cache &target = (cache == 0) ? icache_ : dcache_;
+  switch (operation) {
+    case 0:  // Index (writeback) invalidate
+      target.indexInvalidate(vaddr);
+      break;
+    case 2:  // Index store tag
+      target.indexStoreTag(vaddr, tag_paddr, pstate != 0, pstate == 3);
+      break;
+    case 4:  // Address hit invalidate
+      target.hitInvalidate(paddr, false);
+      break;
+    case 5:  // Address hit writeback invalidate (d-cache)
+      if (cache == 1) {
+        target.hitInvalidate(paddr, true);
+      }
+      break;
+    case 6:  // Address hit writeback (d-cache)
+      if (cache == 1) {
+        target.hitWriteBack(paddr);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void Cpu::loadStore(uint32_t _inst) {
+  uint32_t op = _inst >> 26;
+  uint32_t rs = (_inst >> 21) & 0x1f;
+  uint32_t rt = (_inst >> 16) & 0x1f;
+  uint32_t vaddr = gpr_[rs] + signExtend16(_inst & 0xffff);
+  bool store = (op & 0x08) != 0;
+  bool kernel = kernelMode();
+  bool big = config_.big_endian ^ (((status_ & ST_RE) != 0) && !kernel);
+
+  // Address errors
+  bool misaligned = false;
+  switch (op) {
+    case 0x21:  // lh
+    case 0x25:  // lhu
+    case 0x29:  // sh
+      misaligned = (vaddr & 1) != 0;
+      break;
+    case 0x23:  // lw
+    case 0x2b:  // sw
+    case 0x30:  // ll
+    case 0x38:  // sc
+      misaligned = (vaddr & 3) != 0;
+      break;
+    default:
+      break;
+  }
+  if (misaligned || (!kernel && (vaddr >> 31))) {
+    addressException((store) ? EXC_ADES : EXC_ADEL, vaddr);
+    return;
+  }
+
+  // LL/SC: A normal load or store to the linked word clears the LL bit
+  bool atomic = atomic_;
+  if ((op == 0x30) || (op == 0x38)) {
+    if ((op == 0x38) && !atomic) {
+      // A failed SC still translates its address
+      uint32_t paddr;
+      bool cached;
+      if (translate(vaddr, STORE, paddr, cached)) {
+        gpr_[rt] = 0;
+      }
+      return;
+    }
+  }
+  uint8_t *word = dataWord(vaddr, (store) ? STORE : LOAD);
+  if (word == nullptr) {
+    return;
+  }
+  if (op == 0x30) {
+    atomic_ = true;
+    atomic_addr_ = vaddr >> 2;
+  } else if ((op != 0x38) && (atomic_addr_ == (vaddr >> 2))) {
+    atomic_ = false;
+  }
+
+  uint32_t k = vaddr & 3;
+  uint32_t byte = (big) ? (3 - k) : k;  // Byte lane in the word value
+  switch (op) {
+    case 0x20:  // lb
+      gpr_[rt] = static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(word[k])));
+      break;
+    case 0x24:  // lbu
+      gpr_[rt] = word[k];
+      break;
+    case 0x21:  // lh
+      gpr_[rt] = signExtend16(getWord(word, big) >> (8 * (byte & 2)));
+      break;
+    case 0x25:  // lhu
+      gpr_[rt] = (getWord(word, big) >> (8 * (byte & 2))) & 0xffff;
+      break;
+    case 0x23:  // lw
+    case 0x30:  // ll
+      gpr_[rt] = getWord(word, big);
+      break;
+    case 0x22: {  // lwl
+      uint32_t shift = 8 * (3 - byte);
+      uint32_t mask = (shift == 0) ? 0 : ((1u << shift) - 1);
+      gpr_[rt] = (gpr_[rt] & mask) | (getWord(word, big) << shift);
+      break;
+    }
+    case 0x26: {  // lwr
+      uint32_t shift = 8 * byte;
+      uint32_t mask = (shift == 0) ? 0 : ~(0xffffffffu >> shift);
+      gpr_[rt] = (gpr_[rt] & mask) | (getWord(word, big) >> shift);
+      break;
+    }
+    case 0x28:  // sb
+      word[k] = static_cast<uint8_t>(gpr_[rt]);
+      commitWord();
+      break;
+    case 0x29: {  // sh
+      uint32_t shift = 8 * (byte & 2);
+      putWord(word, (getWord(word, big) & ~(0xffffu << shift)) | ((gpr_[rt] & 0xffff) << shift), big);
+      commitWord();
+      break;
+    }
+    case 0x2b:  // sw
+      putWord(word, gpr_[rt], big);
+      commitWord();
+      break;
+    case 0x38:  // sc
+      putWord(word, gpr_[rt], big);
+      commitWord();
+      gpr_[rt] = 1;
+      break;
+    case 0x2a: {  // swl
+      uint32_t shift = 8 * (3 - byte);
+      uint32_t mask = (shift == 0) ? 0 : ~(0xffffffffu >> shift);
+      putWord(word, (getWord(word, big) & mask) | (gpr_[rt] >> shift), big);
+      commitWord();
+      break;
+    }
+    case 0x2e: {  // swr
+      uint32_t shift = 8 * byte;
+      uint32_t mask = (shift == 0) ? 0 : ((1u << shift) - 1);
+      putWord(word, (getWord(word, big) & mask) | (gpr_[rt] << shift), big);
+      commitWord();
+      break;
+    }
+    default:
+      break;
+  }
+}
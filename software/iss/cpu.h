@@ -0,0 +1,196 @@
+// cpu.h:
+//
+// An instruction-set model of the MIPS32r1 processor core.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// The model executes one instruction per step and follows the RTL where the
+// architecture leaves a choice:
+//
+//   - The CP0 registers and their writable fields match 'CP0_Registers.v',
+//     including the performance counters. A TLB exception does not update
+//     EntryHi, and Config1 reports the modeled cache geometry.
+//   - Reserved instructions execute as no-ops (the RTL never raises RI).
+//   - Interrupts are taken in place of an instruction that is not a load or
+//     store, and replace any exception raised while one is enabled.
+//   - An instruction fetch only checks the alignment of the PC.
+//   - SC does not clear the LL bit; a load or store to the same word or ERET does.
+//   - Accesses to kseg3 are translated but then read zero and drop writes.
+//
+// Timing is not modeled: Count, Random, the reset register, and the 'cycles'
+// performance counter event advance once per step, i.e., as if CPI were 1.
+// When the model runs alongside the RTL (co-simulation), interrupts can be
+// delivered externally instead, and 'volatileRegister' names the register of
+// a timing-dependent read so that the caller can copy the RTL value into it.
+//
+#ifndef ISS_CPU_H
+#define ISS_CPU_H
+
+#include <cstdint>
+#include "cache.h"
+#include "memory.h"
+
+struct CpuConfig {
+  bool big_endian = false;
+  int icache_index_bits = 8;  // 8 KiB, 2-way
+  int icache_ways = 2;
+  int dcache_index_bits = 6;  // 2 KiB, 2-way
+  int dcache_ways = 2;
+  bool external_interrupts = false;  // Take interrupts only when requested
+};
+
+class Cpu {
+ public:
+  Cpu(Memory &_memory, const CpuConfig &_config);
+
+  void reset();
+
+  // Execute one instruction. Returns true if it completed, or false if it
+  // took an exception or interrupt instead (i.e., the RTL 'W1_Issued').
+  bool step();
+
+  // Take an interrupt in place of the next step (with 'external_interrupts')
+  void requestInterrupt() { interrupt_request_ = true; }
+
+  // The register written by the last step if its value depends on timing
+  // (e.g., 'mfc0' of Count), otherwise 0
+  int volatileRegister() const { return volatile_reg_; }
+  void setGpr(int _index, uint32_t _value) { gpr_[_index] = (_index != 0) ? _value : 0; }
+
+  // The restart PC of the last step, which is the PC of the branch for an
+  // instruction in a delay slot (as the RTL 'W1_RestartPC').
+  uint32_t restartPC() const { return restart_pc_; }
+  uint32_t pc() const { return pc_; }
+  uint32_t gpr(int _index) const { return gpr_[_index]; }
+  uint32_t hi() const { return hi_; }
+  uint32_t lo() const { return lo_; }
+  uint64_t exceptions() const { return exceptions_; }
+  const Cache &icache() const { return icache_; }
+  const Cache &dcache() const { return dcache_; }
+
+ private:
+  enum Access { FETCH, LOAD, STORE };
+
+  struct TlbEntry {
+    uint32_t vpn2;  // VA[31:13]
+    uint32_t mask;  // PageMask[28:13]
+    uint32_t asid;
+    bool g;
+    uint32_t pfn[2];
+    uint32_t c[2];
+    bool d[2];
+    bool v[2];
+  };
+
+  // A one-page translation cache in front of the TLB
+  struct MicroTlb {
+    uint32_t vpage;
+    uint32_t ppage;
+    bool cached;
+    bool dirty;
+  };
+
+  void execute(uint32_t _inst);
+  void special(uint32_t _inst);
+  void regimm(uint32_t _inst);
+  void special2(uint32_t _inst);
+  void cop0(uint32_t _inst);
+  void loadStore(uint32_t _inst);
+  void cacheOp(uint32_t _inst);
+  void branch(bool _taken, bool _likely, uint32_t _target);
+  void jump(uint32_t _target);
+
+  bool fetch(uint32_t _pc, uint32_t &_inst);
+  bool translate(uint32_t _vaddr, Access _access, uint32_t &_paddr, bool &_cached);
+  bool tlbLookup(uint32_t _vaddr, Access _access, MicroTlb &_entry);
+  uint8_t *dataWord(uint32_t _vaddr, Access _access);
+  void commitWord();
+  void flushTranslation();
+
+  void exception(uint32_t _code, bool _refill = false);
+  void addressException(uint32_t _code, uint32_t _vaddr, bool _refill = false);
+  bool interruptEnabled() const;
+  bool kernelMode() const;
+  void eret();
+
+  uint32_t readCp0(uint32_t _reg, uint32_t _sel) const;
+  void writeCp0(uint32_t _reg, uint32_t _sel, uint32_t _data);
+  void tlbProbe();
+  void tlbRead();
+  void tlbWrite(uint32_t _index);
+  void countPerfEvents(uint32_t _status, bool _retired, uint64_t _imisses, uint64_t _dmisses);
+
+  Memory &memory_;
+  CpuConfig config_;
+  Cache icache_;
+  Cache dcache_;
+
+  // Architectural state
+  uint32_t gpr_[32];
+  uint32_t hi_;
+  uint32_t lo_;
+  uint32_t pc_;
+  uint32_t next_pc_;
+  bool delay_slot_;      // 'pc_' is in the delay slot of the branch at 'branch_pc_'
+  uint32_t branch_pc_;
+  bool atomic_;
+  uint32_t atomic_addr_;
+
+  // CP0
+  bool index_p_;
+  uint32_t index_;
+  uint32_t random_;
+  uint32_t entrylo_[2];
+  uint32_t context_;
+  uint32_t pagemask_;
+  uint32_t wired_;
+  uint32_t badvaddr_;
+  uint32_t count_;
+  uint32_t entryhi_;
+  uint32_t compare_;
+  uint32_t status_;
+  bool cause_bd_;
+  uint32_t cause_ce_;
+  bool cause_iv_;
+  bool cause_ti_;
+  uint32_t cause_ip10_;
+  uint32_t cause_exccode_;
+  uint32_t epc_;
+  uint32_t config_k0_;
+  uint32_t perf_ctl_[2];
+  uint32_t perf_cnt_[2];
+  uint32_t taglo_;
+  uint32_t taghi_;
+  uint32_t errorepc_;
+  TlbEntry tlb_[16];
+
+  // Per-step state
+  uint32_t restart_pc_;
+  bool in_delay_slot_;     // The current instruction is in a delay slot
+  bool retired_;
+  bool count_written_;
+  bool compare_written_;
+  bool random_written_;
+  bool perf_written_[2];
+  bool branch_event_;
+  bool redirect_event_;
+  bool itlb_refill_;
+  bool dtlb_refill_;
+  int volatile_reg_;
+  bool interrupt_request_;
+
+  // Simulator state
+  MicroTlb fetch_tlb_;
+  MicroTlb data_tlb_;
+  uint32_t fetch_line_va_;      // Virtual address of the line at 'fetch_line_'
+  const uint8_t *fetch_line_;
+  uint64_t fetch_generation_;   // I-cache generation of 'fetch_line_'
+  uint8_t io_word_[4];          // Uncached word outside of RAM (harness registers)
+  uint32_t io_paddr_;
+  bool io_write_;
+  uint64_t exceptions_;
+};
+
+#endif  // ISS_CPU_H
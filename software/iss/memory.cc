@@ -0,0 +1,176 @@
+// memory.cc:
+//
+// The physical memory map of the macro test harness.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+#include "memory.h"
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+using std::ifstream;
+using std::string;
+using std::vector;
+
+static constexpr uint32_t ELF_PT_LOAD = 1;
+
+Memory::Memory(bool _big_endian, uint32_t _vm_base, uint32_t _vm_size)
+    : big_endian_(_big_endian),
+      vm_base_(_vm_base),
+      vm_size_(_vm_size),
+      klo_(KLO_SIZE, 0),
+      khi_(KHI_SIZE, 0),
+      vm_(_vm_size, 0) {
+  resetRegisters();
+}
+
+bool Memory::load(const string &_filename, uint32_t _base) {
+  vector<uint8_t> &region = (_base == KLO_BASE) ? klo_ : ((_base == KHI_BASE) ? khi_ : vm_);
+  ifstream input(_filename, std::ios::binary);
+  if (!input) {
+    cout << "Error opening '" << _filename << "'" << endl;
+    return false;
+  }
+  char magic[4] = {0, 0, 0, 0};
+  input.read(magic, 4);
+  input.clear();
+  input.seekg(0);
+  bool ok = (memcmp(magic, "\177ELF", 4) == 0) ? loadElf(input, region) : loadHex(input, region);
+  if (!ok) {
+    cout << "Could not load '" << _filename << "'" << endl;
+  }
+  return ok;
+}
+
+// Each line holds one or more bytes as hex pairs in address order
+bool Memory::loadHex(ifstream &_input, vector<uint8_t> &_region) {
+  string line;
+  uint64_t addr = 0;
+  while (std::getline(_input, line)) {
+    string digits;
+    for (char c : line) {
+      if (isxdigit(c)) {
+        digits += c;
+      }
+    }
+    for (uint64_t i = 0; (i + 1) < digits.size(); i += 2) {
+      if (addr >= _region.size()) {
+        cout << "Image is larger than its memory region" << endl;
+        return false;
+      }
+      _region[addr++] = static_cast<uint8_t>(std::stoul(digits.substr(i, 2), nullptr, 16));
+    }
+  }
+  return true;
+}
+
+bool Memory::loadElf(ifstream &_input, vector<uint8_t> &_region) {
+  uint8_t ehdr[52];
+  if (!_input.read(reinterpret_cast<char *>(ehdr), sizeof(ehdr)) || (ehdr[4] != 1)) {
+    cout << "Not a 32-bit ELF file" << endl;
+    return false;
+  }
+  bool big = (ehdr[5] == 2);
+  auto half = [big](const uint8_t *_p) -> uint32_t {
+    return (big) ? ((_p[0] << 8) | _p[1]) : ((_p[1] << 8) | _p[0]);
+  };
+  auto word = [big, half](const uint8_t *_p) -> uint32_t {
+    return (big) ? ((half(_p) << 16) | half(_p + 2)) : ((half(_p + 2) << 16) | half(_p));
+  };
+  uint32_t phoff = word(&ehdr[28]);
+  uint32_t phentsize = half(&ehdr[42]);
+  uint32_t phnum = half(&ehdr[44]);
+  for (uint32_t i = 0; i < phnum; i++) {
+    uint8_t phdr[32];
+    _input.seekg(phoff + (i * phentsize));
+    if (!_input.read(reinterpret_cast<char *>(phdr), sizeof(phdr))) {
+      return false;
+    }
+    uint32_t offset = word(&phdr[4]);
+    uint32_t paddr = word(&phdr[12]);
+    uint32_t filesz = word(&phdr[16]);
+    if ((word(&phdr[0]) != ELF_PT_LOAD) || (filesz == 0)) {
+      continue;
+    }
+    uint32_t base = paddr % _region.size();
+    if (base + filesz > _region.size()) {
+      cout << "ELF segment at 0x" << std::hex << paddr << std::dec << " does not fit its memory region" << endl;
+      return false;
+    }
+    _input.seekg(offset);
+    if (!_input.read(reinterpret_cast<char *>(&_region[base]), filesz)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Memory::readRegister(uint32_t _paddr, uint8_t *_bytes) const {
+  uint32_t value = 0;
+  switch (_paddr & ~3u) {
+    case RESET_REG:
+      value = reset_reg_;
+      break;
+    case COMMAND_REG:
+      value = command_reg_;
+      break;
+    case STATUS_REG:
+      value = status_reg_;
+      break;
+    case TEST_REG:
+      value = test_reg_;
+      break;
+    case SCRATCH_REG:
+      value = scratch_reg_;
+      break;
+    default:
+      break;
+  }
+  for (int i = 0; i < 4; i++) {
+    _bytes[i] = static_cast<uint8_t>(value >> ((big_endian_) ? (24 - (8 * i)) : (8 * i)));
+  }
+}
+
+// The command register is read-only
+void Memory::writeRegister(uint32_t _paddr, const uint8_t *_bytes) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value |= static_cast<uint32_t>(_bytes[i]) << ((big_endian_) ? (24 - (8 * i)) : (8 * i));
+  }
+  switch (_paddr & ~3u) {
+    case RESET_REG:
+      reset_reg_ = value;
+      break;
+    case STATUS_REG:
+      status_reg_ = value;
+      break;
+    case TEST_REG:
+      test_reg_ = value;
+      break;
+    case SCRATCH_REG:
+      scratch_reg_ = value;
+      break;
+    default:
+      break;
+  }
+}
+
+void Memory::resetRegisters() {
+  reset_reg_ = 0;
+  command_reg_ = 1;
+  status_reg_ = 0;
+  test_reg_ = 0;
+  scratch_reg_ = 0;
+}
+
+// The 1 KiB buffer as a C-string
+string Memory::stdoutBuffer() const {
+  const char *buffer = reinterpret_cast<const char *>(&khi_[STDOUT_BASE - KHI_BASE]);
+  return string(buffer, strnlen(buffer, STDOUT_SIZE));
+}
@@ -0,0 +1,112 @@
+// memory.h:
+//
+// The physical memory map of the macro test harness ('harness/mips_test.v').
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// Three RAM regions hold the test images and five 32-bit registers at the top
+// of kseg1 communicate with the harness:
+//
+//   klo  [0x00000000 - 0x00004000)  16 KiB   Exception vectors
+//   khi  [0x1fc00000 - 0x1fc04000)  16 KiB   Boot code (last 1 KiB: stdout buffer)
+//   vm   [0x80000000 - 0x80400000)  4 MiB    User program (mapped at virtual 0)
+//
+//   0x1fffffec  Reset register    Reset the processor when it counts down to 1
+//   0x1ffffff0  Command register  Bit 0 is set while the test runs
+//   0x1ffffff4  Status register   Bit 0 ends the test, bit 1 dumps the stdout buffer
+//   0x1ffffff8  Test register     1 (pass) or 0 (fail)
+//   0x1ffffffc  Scratch register  Free for use by the test
+//
+// The base and size of vm are configurable (the harness parameters 'VM_BASE'
+// and 'VM_KB'). Other physical addresses read as zero and ignore writes.
+//
+#ifndef ISS_MEMORY_H
+#define ISS_MEMORY_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class Memory {
+ public:
+  static constexpr uint32_t KLO_BASE = 0x00000000;
+  static constexpr uint32_t KLO_SIZE = 16 * 1024;
+  static constexpr uint32_t KHI_BASE = 0x1fc00000;
+  static constexpr uint32_t KHI_SIZE = 16 * 1024;
+  static constexpr uint32_t VM_BASE = 0x80000000;  // Default vm region
+  static constexpr uint32_t VM_SIZE = 4096 * 1024;
+  static constexpr uint32_t STDOUT_BASE = 0x1fc03c00;
+  static constexpr uint32_t STDOUT_SIZE = 1024;
+  static constexpr uint32_t REG_BASE = 0x1fffffec;
+  static constexpr uint32_t RESET_REG = 0x1fffffec;
+  static constexpr uint32_t COMMAND_REG = 0x1ffffff0;
+  static constexpr uint32_t STATUS_REG = 0x1ffffff4;
+  static constexpr uint32_t TEST_REG = 0x1ffffff8;
+  static constexpr uint32_t SCRATCH_REG = 0x1ffffffc;
+
+  explicit Memory(bool _big_endian, uint32_t _vm_base = VM_BASE, uint32_t _vm_size = VM_SIZE);
+
+  // Load a region from a hex image ('make_hex' output) or an ELF file. ELF
+  // segments are placed at their address modulo the region size, which covers
+  // the kseg0/kseg1 and virtual link addresses of the test images.
+  bool load(const std::string &_filename, uint32_t _base);
+
+  // Host pointer to the RAM byte at a physical address, or nullptr if the
+  // address is not RAM. A 16-byte line never spans two regions.
+  uint8_t *ram(uint32_t _paddr) {
+    if (_paddr < KLO_BASE + KLO_SIZE) {
+      return &klo_[_paddr - KLO_BASE];
+    } else if ((_paddr >= vm_base_) && (_paddr - vm_base_ < vm_size_)) {
+      return &vm_[_paddr - vm_base_];
+    } else if ((_paddr >= KHI_BASE) && (_paddr < KHI_BASE + KHI_SIZE)) {
+      return &khi_[_paddr - KHI_BASE];
+    }
+    return nullptr;
+  }
+
+  static bool isRegister(uint32_t _paddr) {
+    return (_paddr >= REG_BASE);
+  }
+
+  // Word access to the harness registers in memory byte order
+  void readRegister(uint32_t _paddr, uint8_t *_bytes) const;
+  void writeRegister(uint32_t _paddr, const uint8_t *_bytes);
+
+  // One processor step: Returns true if the reset register requests a reset
+  bool tick() {
+    if (reset_reg_ == 0) {
+      return false;
+    }
+    bool reset = (reset_reg_ == 1);
+    reset_reg_--;
+    if (reset) {
+      resetRegisters();
+    }
+    return reset;
+  }
+
+  void resetRegisters();
+  std::string stdoutBuffer() const;
+
+  uint32_t command_reg_;
+  uint32_t status_reg_;
+  uint32_t test_reg_;
+  uint32_t scratch_reg_;
+
+ private:
+  bool loadHex(std::ifstream &_input, std::vector<uint8_t> &_region);
+  bool loadElf(std::ifstream &_input, std::vector<uint8_t> &_region);
+
+  bool big_endian_;
+  uint32_t vm_base_;
+  uint32_t vm_size_;
+  uint32_t reset_reg_;
+  std::vector<uint8_t> klo_;
+  std::vector<uint8_t> khi_;
+  std::vector<uint8_t> vm_;
+};
+
+#endif  // ISS_MEMORY_H
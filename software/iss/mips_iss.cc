@@ -0,0 +1,254 @@
+// mips_iss.cc:
+//
+// An instruction-set simulator for the MIPS32r1 macro test harness.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// This runs the macro test images without the RTL, as a fast functional
+// check before a full simulation. It accepts the plusargs of the Verilator
+// testbench ('harness/verilator/mips_test.cc') and produces the same output
+// files in the same formats:
+//
+//   +khigh_mem=<file>       Kernel high memory image (hex or ELF)
+//   +klow_mem=<file>        Kernel low memory image (hex or ELF)
+//   +vm_mem=<file>          Virtual memory image (hex or ELF)
+//   +test_result=<file>     Test register value at the end of the test
+//   +scratch_result=<file>  Scratch register value at the end of the test
+//   +test_cycles=<file>     Number of steps the test ran
+//   +test_instructions=<file>  Number of instructions the test retired
+//   +cycles=<n>             Maximum number of steps to run
+//   +itrace=<file>          Instruction trace
+//   +regtrace=<file>        Register file trace
+//   +regtrace_format=<fmt>  Register file trace format: text (default), fixed,
+//                           delta, or deflate (see 'software/regdiff/rtrace.h')
+//   +stdout=<file>          Stdout buffer log
+//
+// and optionally the processor configuration:
+//
+//   +big_endian             Big-endian mode (must match the test images)
+//   +icache_index_bits=<n>  I-cache sets (2^n, default 8)
+//   +icache_ways=<n>        I-cache ways (default 2)
+//   +dcache_index_bits=<n>  D-cache sets (2^n, default 6)
+//   +dcache_ways=<n>        D-cache ways (default 2)
+//
+// and the memory map (the harness parameters 'VM_KB' and 'VM_BASE'):
+//
+//   +vm_kb=<n>              Size of the vm region in KiB (a power of two, default 4096)
+//   +vm_base=<addr>         Physical base address of the vm region (default 0x80000000)
+//
+// A step is one instruction, exception, or interrupt, so the 'cycles' of the
+// result files and the trace timestamps count steps instead of clock cycles.
+// Traces still match the RTL instruction for instruction, e.g., for regdiff.
+//
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include "cpu.h"
+#include "memory.h"
+#include "rtrace.h"
+
+using std::string;
+
+// Return the value of a '+name=value' plusarg, or an empty string if it was not given.
+static string plusarg(int _argc, char **_argv, const char *_name) {
+  string match = string("+") + _name + "=";
+  for (int i = 1; i < _argc; i++) {
+    if (string(_argv[i]).compare(0, match.size(), match) == 0) {
+      return string(_argv[i] + match.size());
+    }
+  }
+  return string();
+}
+
+static bool plusflag(int _argc, char **_argv, const char *_name) {
+  string match = string("+") + _name;
+  for (int i = 1; i < _argc; i++) {
+    if (match == _argv[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static FILE *openOutput(const string &_filename) {
+  if (_filename.empty()) {
+    return nullptr;
+  }
+  FILE *handle = fopen(_filename.c_str(), "w");
+  if (handle == nullptr) {
+    fprintf(stderr, "Could not open '%s' for writing\n", _filename.c_str());
+    exit(1);
+  }
+  return handle;
+}
+
+static void writeResult(const string &_filename, const char *_format, uint32_t _value) {
+  FILE *handle = openOutput(_filename);
+  if (handle != nullptr) {
+    fprintf(handle, _format, _value);
+    fclose(handle);
+  }
+}
+
+// The register file before the instruction of this step writes back (as 'RegState')
+static void snapshot(const Cpu &_cpu, uint32_t *_regs) {
+  for (int i = 1; i < 32; i++) {
+    _regs[i - 1] = _cpu.gpr(i);
+  }
+  _regs[31] = _cpu.hi();
+  _regs[32] = _cpu.lo();
+}
+
+static int intArg(int _argc, char **_argv, const char *_name, int _default) {
+  string value = plusarg(_argc, _argv, _name);
+  return (value.empty()) ? _default : std::atoi(value.c_str());
+}
+
+int main(int argc, char **argv) {
+  CpuConfig config;
+  config.big_endian = plusflag(argc, argv, "big_endian");
+  config.icache_index_bits = intArg(argc, argv, "icache_index_bits", config.icache_index_bits);
+  config.icache_ways = intArg(argc, argv, "icache_ways", config.icache_ways);
+  config.dcache_index_bits = intArg(argc, argv, "dcache_index_bits", config.dcache_index_bits);
+  config.dcache_ways = intArg(argc, argv, "dcache_ways", config.dcache_ways);
+  for (int ways : {config.icache_ways, config.dcache_ways}) {
+    if ((ways != 1) && (ways != 2) && (ways != 4) && (ways != 8)) {
+      fprintf(stderr, "Cache ways must be 1, 2, 4, or 8\n");
+      return 1;
+    }
+  }
+  for (int bits : {config.icache_index_bits, config.dcache_index_bits}) {
+    if ((bits < 6) || (bits > 13)) {
+      fprintf(stderr, "Cache index bits must be between 6 and 13\n");
+      return 1;
+    }
+  }
+
+  string vm_base_arg = plusarg(argc, argv, "vm_base");
+  uint32_t vm_size = static_cast<uint32_t>(intArg(argc, argv, "vm_kb", Memory::VM_SIZE / 1024)) * 1024;
+  uint32_t vm_base = (vm_base_arg.empty()) ? Memory::VM_BASE : std::strtoul(vm_base_arg.c_str(), nullptr, 0);
+  if ((vm_size == 0) || ((vm_size & (vm_size - 1)) != 0) || ((vm_base & (vm_size - 1)) != 0) ||
+      (vm_base < 0x20000000)) {
+    fprintf(stderr, "The vm region must be a power of two in size, aligned, and at or above 0x20000000\n");
+    return 1;
+  }
+
+  string test_result_filename = plusarg(argc, argv, "test_result");
+  string test_scratch_filename = plusarg(argc, argv, "scratch_result");
+  string test_cycles_filename = plusarg(argc, argv, "test_cycles");
+  string test_instructions_filename = plusarg(argc, argv, "test_instructions");
+  string itrace_filename = plusarg(argc, argv, "itrace");
+  string regtrace_filename = plusarg(argc, argv, "regtrace");
+  string stdout_filename = plusarg(argc, argv, "stdout");
+  string cycles_arg = plusarg(argc, argv, "cycles");
+  string regtrace_format_arg = plusarg(argc, argv, "regtrace_format");
+  uint32_t num_cycles = 0xffffffff;
+  rtrace::Format regtrace_format = rtrace::TEXT;
+  if (!regtrace_format_arg.empty() && !rtrace::parseFormat(regtrace_format_arg, regtrace_format)) {
+    fprintf(stderr, "Unknown register trace format '%s'\n", regtrace_format_arg.c_str());
+    return 1;
+  }
+
+  Memory memory(config.big_endian, vm_base, vm_size);
+  struct {
+    const char *plusarg;
+    uint32_t base;
+  } images[] = {{"khigh_mem", Memory::KHI_BASE}, {"klow_mem", Memory::KLO_BASE}, {"vm_mem", Memory::VM_BASE}};
+  for (const auto &image : images) {
+    string filename = plusarg(argc, argv, image.plusarg);
+    if (!filename.empty() && !memory.load(filename, image.base)) {
+      return 1;
+    }
+  }
+  Cpu cpu(memory, config);
+
+  if (!itrace_filename.empty()) {
+    printf("Instruction trace enabled: %s\n", itrace_filename.c_str());
+  }
+  if (!regtrace_filename.empty()) {
+    printf("Register file trace enabled: %s\n", regtrace_filename.c_str());
+  }
+  if (!stdout_filename.empty()) {
+    printf("Stdout enabled: %s\n", stdout_filename.c_str());
+  }
+  if (!cycles_arg.empty()) {
+    num_cycles = static_cast<uint32_t>(std::strtoul(cycles_arg.c_str(), nullptr, 10));
+  }
+  printf("Running userlogic for maximum of %u cycles\n", num_cycles);
+
+  FILE *itrace_handle = openOutput(itrace_filename);
+  FILE *regtrace_handle = openOutput(regtrace_filename);
+  FILE *stdout_handle = openOutput(stdout_filename);
+  std::unique_ptr<rtrace::Writer> regtrace_writer;
+  if (regtrace_handle) {
+    regtrace_writer.reset(new rtrace::Writer(regtrace_handle, regtrace_format));
+  }
+
+  // Run
+  auto start = std::chrono::steady_clock::now();
+  uint64_t instructions = 0;
+  uint32_t regs[33];
+  uint32_t cycle_count = num_cycles;
+  while ((cycle_count > 0) && !(memory.status_reg_ & 0x1)) {
+    cycle_count--;
+    if (regtrace_writer) {
+      snapshot(cpu, regs);
+    }
+    if (cpu.step()) {
+      instructions++;
+      uint64_t time = num_cycles - cycle_count;
+      if (itrace_handle) {
+        fprintf(itrace_handle, "%08x    (%llu)\n", cpu.restartPC(), static_cast<unsigned long long>(time));
+      }
+      if (regtrace_writer) {
+        regtrace_writer->write(time, regs);
+      }
+    }
+
+    // Print the output buffer to the stdout file log (bit 1 of the status register)
+    if (memory.status_reg_ & 0x2) {
+      if (stdout_handle) {
+        fputs(memory.stdoutBuffer().c_str(), stdout_handle);
+        fflush(stdout_handle);
+      }
+      memory.status_reg_ &= ~0x2u;
+    }
+    if (memory.tick()) {
+      cpu.reset();
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // Close output files
+  if (itrace_handle) {
+    fclose(itrace_handle);
+  }
+  if (regtrace_handle) {
+    regtrace_writer->finish();
+    fclose(regtrace_handle);
+  }
+  if (stdout_handle) {
+    fclose(stdout_handle);
+  }
+
+  printf("Test ran for %u cycles\n", num_cycles - cycle_count);
+  printf("status register = %u\n", memory.status_reg_);
+  printf("test register = %u\n", memory.test_reg_);
+  printf("scratch register = %u\n", memory.scratch_reg_);
+  printf("%llu instructions, %llu exceptions, %llu/%llu I/D-cache misses (%.1f MIPS)\n",
+         static_cast<unsigned long long>(instructions), static_cast<unsigned long long>(cpu.exceptions()),
+         static_cast<unsigned long long>(cpu.icache().misses()), static_cast<unsigned long long>(cpu.dcache().misses()),
+         (seconds > 0) ? (instructions / seconds / 1e6) : 0.0);
+
+  // Write the test result, scratch result, and number of test steps and instructions
+  writeResult(test_result_filename, "%u\n", memory.test_reg_);
+  writeResult(test_scratch_filename, "0x%x\n", memory.scratch_reg_);
+  writeResult(test_cycles_filename, "%u\n", num_cycles - cycle_count);
+  writeResult(test_instructions_filename, "%u\n", static_cast<uint32_t>(instructions));
+  return 0;
+}
@@ -0,0 +1,319 @@
+// align.cc:
+//
+// A cycle-insensitive comparison of two register traces which realigns them
+// after instructions that only one of them executed.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// Two runs of an interrupt-driven test on different microarchitectures take
+// their interrupts at different instructions. Each trace then contains handler
+// excursions which the other does not have at that point, and a strict
+// comparison stops at the first of them. Here, records are matched by a hash
+// of the compared registers (and the PC, given the instruction traces of the
+// same runs) while the time is ignored. At a mismatch, the next 'window'
+// records of both traces are searched for the nearest pair of positions where
+// 'run' consecutive records match again, and the skipped records form one
+// divergence region:
+//
+//   only in A / only in B   An excursion of one trace, e.g., an interrupt
+//   different               Records of both traces which do not match
+//
+// The comparison continues after each region, and ends with a summary. If no
+// realignment is found within the window, the traces are considered to have
+// diverged for good.
+//
+#include "align.h"
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::unordered_set;
+
+namespace {
+
+// Program counters from an instruction trace ('%08x    (%d)' per line)
+class PcReader {
+ public:
+  explicit PcReader(FILE *_handle) : handle_(_handle) {}
+  ~PcReader() {
+    if (handle_ != nullptr) {
+      fclose(handle_);
+    }
+  }
+
+  bool valid() const { return handle_ != nullptr; }
+
+  bool next(uint32_t &_pc) {
+    char line[128];
+    if ((handle_ == nullptr) || (fgets(line, sizeof(line), handle_) == nullptr)) {
+      return false;
+    }
+    char *end;
+    _pc = static_cast<uint32_t>(strtoul(line, &end, 16));
+    return end != line;
+  }
+
+ private:
+  FILE *handle_;
+};
+
+struct Entry {
+  rtrace::Record record;
+  uint32_t pc;
+  uint64_t hash;
+};
+
+// The unconsumed records of one trace, read ahead as needed
+class Window {
+ public:
+  Window(rtrace::Reader &_reader, PcReader *_pcs, uint64_t _mask)
+      : reader_(_reader), pcs_(_pcs), mask_(_mask), base_(0), end_(false) {}
+
+  // Make '_count' records available if the trace has them, returning how many are
+  size_t fill(size_t _count) {
+    while ((entries_.size() < _count) && !end_) {
+      Entry entry;
+      entry.pc = 0;
+      if (!reader_.next(entry.record) || (pcs_ && !pcs_->next(entry.pc))) {
+        end_ = true;
+        break;
+      }
+      entry.hash = hash(entry);
+      entries_.push_back(entry);
+    }
+    return entries_.size();
+  }
+
+  const Entry &operator[](size_t _index) const { return entries_[_index]; }
+
+  void drop(size_t _count) {
+    entries_.erase(entries_.begin(), entries_.begin() + _count);
+    base_ += _count;
+  }
+
+  // Consume the rest of the trace, returning how many records it had
+  uint64_t drain() {
+    uint64_t count = entries_.size();
+    base_ += count;
+    entries_.clear();
+    Entry entry;
+    while (!end_ && reader_.next(entry.record) && (!pcs_ || pcs_->next(entry.pc))) {
+      count++;
+      base_++;
+    }
+    end_ = true;
+    return count;
+  }
+
+  // Index of the first unconsumed record in the trace
+  uint64_t base() const { return base_; }
+  bool compared(int _reg) const { return (mask_ >> _reg) & 1; }
+
+ private:
+  uint64_t hash(const Entry &_entry) const {
+    uint64_t hash = 0xcbf29ce484222325ull ^ _entry.pc;  // FNV-1a over 32-bit words
+    for (int i = 0; i < rtrace::REGS; i++) {
+      if (compared(i)) {
+        hash = (hash ^ _entry.record.regs[i]) * 0x100000001b3ull;
+      }
+    }
+    return hash;
+  }
+
+  rtrace::Reader &reader_;
+  PcReader *pcs_;
+  uint64_t mask_;
+  uint64_t base_;
+  bool end_;
+  std::deque<Entry> entries_;
+};
+
+bool same(const Window &_a, size_t _index_a, const Window &_b, size_t _index_b) {
+  const Entry &a = _a[_index_a];
+  const Entry &b = _b[_index_b];
+  if ((a.hash != b.hash) || (a.pc != b.pc)) {
+    return false;
+  }
+  for (int i = 0; i < rtrace::REGS; i++) {
+    if (_a.compared(i) && (a.record.regs[i] != b.record.regs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Find the nearest positions (fewest skipped records) after which 'run' records match
+bool realign(Window &_a, Window &_b, const AlignOptions &_options, size_t &_skip_a, size_t &_skip_b) {
+  size_t size_a = _a.fill(_options.window + _options.run);
+  size_t size_b = _b.fill(_options.window + _options.run);
+  std::unordered_multimap<uint64_t, size_t> positions_b;
+  for (size_t b = 0; b < std::min<size_t>(size_b, _options.window); b++) {
+    positions_b.emplace(_b[b].hash, b);
+  }
+  bool found = false;
+  for (size_t a = 0; (a < std::min<size_t>(size_a, _options.window)) && (!found || (a < _skip_a + _skip_b)); a++) {
+    auto range = positions_b.equal_range(_a[a].hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      size_t b = it->second;
+      if (((a == 0) && (b == 0)) || (found && (a + b >= _skip_a + _skip_b))) {
+        continue;
+      }
+      // A shorter run is enough where one of the traces ends
+      size_t run = std::min<size_t>(_options.run, std::min(size_a - a, size_b - b));
+      size_t matched = 0;
+      while ((matched < run) && same(_a, a + matched, _b, b + matched)) {
+        matched++;
+      }
+      if (matched == run) {
+        found = true;
+        _skip_a = a;
+        _skip_b = b;
+      }
+    }
+  }
+  return found;
+}
+
+void printEntry(const char *_name, const Window &_window, size_t _index, bool _pcs) {
+  const Entry &entry = _window[_index];
+  cout << _name << " " << (_window.base() + _index) << " (cycle " << entry.record.time;
+  if (_pcs) {
+    char pc[16];
+    snprintf(pc, sizeof(pc), "%08x", entry.pc);
+    cout << ", pc " << pc;
+  }
+  cout << ")";
+}
+
+void printRegion(uint64_t _number, const Window &_a, size_t _skip_a, const Window &_b, size_t _skip_b, bool _pcs) {
+  cout << "Divergence " << _number << ": ";
+  if (_skip_b == 0) {
+    cout << _skip_a << " instructions only in A at ";
+    printEntry("A", _a, 0, _pcs);
+    cout << ", before ";
+    printEntry("B", _b, 0, _pcs);
+    cout << endl;
+  } else if (_skip_a == 0) {
+    cout << _skip_b << " instructions only in B at ";
+    printEntry("B", _b, 0, _pcs);
+    cout << ", before ";
+    printEntry("A", _a, 0, _pcs);
+    cout << endl;
+  } else {
+    cout << _skip_a << " / " << _skip_b << " different instructions at ";
+    printEntry("A", _a, 0, _pcs);
+    cout << " / ";
+    printEntry("B", _b, 0, _pcs);
+    cout << ":" << endl;
+    for (int i = 0; i < rtrace::REGS; i++) {
+      uint32_t reg_a = _a[0].record.regs[i];
+      uint32_t reg_b = _b[0].record.regs[i];
+      if (_a.compared(i) && (reg_a != reg_b)) {
+        cout << "  " << rtrace::LABELS[i] << ": 0x" << std::hex << reg_a << " / 0x" << reg_b << std::dec << endl;
+      }
+    }
+    if (_pcs && (_a[0].pc != _b[0].pc)) {
+      cout << "  pc: 0x" << std::hex << _a[0].pc << " / 0x" << _b[0].pc << std::dec << endl;
+    }
+  }
+}
+
+FILE *openItrace(const string &_filename) {
+  FILE *handle = fopen(_filename.c_str(), "r");
+  if (handle == nullptr) {
+    cout << "Error opening '" << _filename << "'" << endl;
+  }
+  return handle;
+}
+
+}  // namespace
+
+bool alignedRegdiff(rtrace::Reader &_input_a, rtrace::Reader &_input_b, uint64_t _offset,
+                    const unordered_set<int> &_excludes, const AlignOptions &_options) {
+  // Exclusions use the indices of regdiff (1: at ... 33: lo)
+  uint64_t mask = 0;
+  for (int i = 0; i < rtrace::REGS; i++) {
+    if (_excludes.count(i + 1) == 0) {
+      mask |= 1ull << i;
+    }
+  }
+  bool pcs = !_options.itrace_a.empty();
+  std::unique_ptr<PcReader> pcs_a, pcs_b;
+  if (pcs) {
+    pcs_a.reset(new PcReader(openItrace(_options.itrace_a)));
+    pcs_b.reset(new PcReader(openItrace(_options.itrace_b)));
+    if (!pcs_a->valid() || !pcs_b->valid()) {
+      return false;
+    }
+  }
+  Window a(_input_a, pcs_a.get(), mask);
+  Window b(_input_b, pcs_b.get(), mask);
+
+  // Skip the offset in both traces
+  for (uint64_t skipped = 0; skipped < _offset; skipped++) {
+    if ((a.fill(1) == 0) || (b.fill(1) == 0)) {
+      break;
+    }
+    a.drop(1);
+    b.drop(1);
+  }
+
+  uint64_t matched = 0;
+  uint64_t regions[3] = {0, 0, 0};  // Only in A, only in B, different
+  uint64_t skipped_a = 0;
+  uint64_t skipped_b = 0;
+  bool unresolved = false;
+  while ((a.fill(1) > 0) && (b.fill(1) > 0)) {
+    if (same(a, 0, b, 0)) {
+      matched++;
+      a.drop(1);
+      b.drop(1);
+      continue;
+    }
+    size_t skip_a = 0;
+    size_t skip_b = 0;
+    uint64_t number = regions[0] + regions[1] + regions[2] + 1;
+    if (!realign(a, b, _options, skip_a, skip_b)) {
+      cout << "Divergence " << number << ": No realignment within " << _options.window << " instructions at ";
+      printEntry("A", a, 0, pcs);
+      cout << " / ";
+      printEntry("B", b, 0, pcs);
+      cout << endl;
+      unresolved = true;
+      break;
+    }
+    if (number <= _options.max_regions) {
+      printRegion(number, a, skip_a, b, skip_b, pcs);
+    }
+    regions[(skip_b == 0) ? 0 : ((skip_a == 0) ? 1 : 2)]++;
+    skipped_a += skip_a;
+    skipped_b += skip_b;
+    a.drop(skip_a);
+    b.drop(skip_b);
+  }
+
+  uint64_t count = regions[0] + regions[1] + regions[2];
+  if (count > _options.max_regions) {
+    cout << "(" << (count - _options.max_regions) << " more divergence regions not shown)" << endl;
+  }
+  cout << "Summary: " << matched << " matching instructions, " << count << " divergence regions ("
+       << regions[0] << " only in A, " << regions[1] << " only in B, " << regions[2] << " different) covering "
+       << skipped_a << " (A) / " << skipped_b << " (B) instructions" << endl;
+  if (unresolved) {
+    cout << "The traces did not realign after instruction " << a.base() << " (A) / " << b.base() << " (B)" << endl;
+  } else {
+    uint64_t rest_a = a.drain();
+    uint64_t rest_b = b.drain();
+    if ((rest_a > 0) || (rest_b > 0)) {
+      cout << "Trailing instructions: " << rest_a << " (A) / " << rest_b << " (B)" << endl;
+    }
+  }
+  return true;
+}
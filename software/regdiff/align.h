@@ -0,0 +1,30 @@
+// align.h:
+//
+// A cycle-insensitive comparison of two register traces which realigns them
+// after instructions that only one of them executed.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+#ifndef REGDIFF_ALIGN_H
+#define REGDIFF_ALIGN_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include "rtrace.h"
+
+struct AlignOptions {
+  uint64_t window = 4096;      // Instructions of each trace searched for a realignment
+  uint64_t run = 8;            // Consecutive matching instructions which realign the traces
+  uint64_t max_regions = 100;  // Regions to print before only counting them
+  std::string itrace_a;        // Optional instruction traces of the same runs (PCs)
+  std::string itrace_b;
+};
+
+// Report every region where the traces diverge and a summary, returning false on an input error
+bool alignedRegdiff(rtrace::Reader &_input_a, rtrace::Reader &_input_b, uint64_t _offset,
+                    const std::unordered_set<int> &_excludes, const AlignOptions &_options);
+
+#endif  // REGDIFF_ALIGN_H
@@ -0,0 +1,112 @@
+// bench.cc:
+//
+// A benchmark of the register trace parsers of regdiff.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// The synthetic trace resembles a real one: Each record changes one or two
+// registers and advances the time by a few cycles. A text trace of 10M
+// records ('regdiff -B 10000000') is about 4 GB.
+//
+#include "bench.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include "rtrace.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::unique_ptr;
+
+static double seconds(std::chrono::steady_clock::time_point _start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+}
+
+static bool generate(int _fd, uint64_t _lines) {
+  FILE *handle = fdopen(_fd, "w");
+  if (handle == nullptr) {
+    return false;
+  }
+  rtrace::Writer writer(handle, rtrace::TEXT);
+  uint32_t regs[rtrace::REGS] = {};
+  uint64_t seed = 1;
+  uint64_t time = 30;
+  for (uint64_t i = 0; i < _lines; i++) {
+    seed = (seed * 6364136223846793005ull) + 1442695040888963407ull;
+    regs[(seed >> 33) % rtrace::REGS] = static_cast<uint32_t>(seed >> 16);
+    if (seed & (1ull << 62)) {
+      regs[(seed >> 40) % rtrace::REGS] += 4;
+    }
+    time += 10 * (1 + ((seed >> 60) & 0x3));
+    writer.write(time, regs);
+  }
+  writer.finish();
+  return fclose(handle) == 0;
+}
+
+// Read the whole trace, returning a checksum of all records
+static uint64_t parse(const string &_filename, bool _map_text, uint64_t &_records) {
+  unique_ptr<rtrace::Reader> reader = rtrace::Reader::open(_filename, _map_text);
+  rtrace::Record record;
+  uint64_t checksum = 0;
+  _records = 0;
+  while (reader && reader->next(record)) {
+    checksum = (checksum * 31) + record.time;
+    for (int i = 0; i < rtrace::REGS; i++) {
+      checksum = (checksum * 31) + record.regs[i];
+    }
+    _records++;
+  }
+  return checksum;
+}
+
+int benchmark(uint64_t _lines) {
+  const char *tmpdir = getenv("TMPDIR");
+  string filename = string((tmpdir != nullptr) ? tmpdir : "/tmp") + "/regdiff_bench_XXXXXX";
+  int fd = mkstemp(&filename[0]);
+  if (fd < 0) {
+    cout << "Could not create '" << filename << "'" << endl;
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  bool written = generate(fd, _lines);
+  double write_time = seconds(start);
+  if (!written) {
+    cout << "Could not write '" << filename << "'" << endl;
+    unlink(filename.c_str());
+    return 1;
+  }
+  double megabytes = _lines * (22 + (rtrace::REGS * 12)) / 1e6;
+  cout << "Wrote " << _lines << " records (~" << static_cast<uint64_t>(megabytes) << " MB) in "
+       << write_time << " s" << endl;
+
+  struct {
+    const char *name;
+    bool map_text;
+    uint64_t checksum;
+    uint64_t records;
+  } parsers[] = {{"stream (getline/stoul)", false, 0, 0}, {"mapped (in place)", true, 0, 0}};
+  for (auto &parser : parsers) {
+    start = std::chrono::steady_clock::now();
+    parser.checksum = parse(filename, parser.map_text, parser.records);
+    double parse_time = seconds(start);
+    cout << "  " << parser.name << ": " << parse_time << " s, "
+         << static_cast<uint64_t>(parser.records / parse_time) << " records/s, "
+         << static_cast<uint64_t>(megabytes / parse_time) << " MB/s" << endl;
+  }
+  unlink(filename.c_str());
+
+  bool match = (parsers[0].records == _lines) && (parsers[1].records == _lines) &&
+               (parsers[0].checksum == parsers[1].checksum);
+  if (!match) {
+    cout << "The parsers disagree" << endl;
+  }
+  return (match) ? 0 : 1;
+}
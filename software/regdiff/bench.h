@@ -0,0 +1,18 @@
+// bench.h:
+//
+// A benchmark of the register trace parsers of regdiff.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+#ifndef REGDIFF_BENCH_H
+#define REGDIFF_BENCH_H
+
+#include <cstdint>
+
+// Write a synthetic text trace of '_lines' records to $TMPDIR (or /tmp), time
+// each parser over it, and check that they agree. Returns the exit status.
+int benchmark(uint64_t _lines);
+
+#endif  // REGDIFF_BENCH_H
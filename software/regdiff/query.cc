@@ -0,0 +1,86 @@
+// query.cc:
+//
+// Random access to the records of a register or instruction trace.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// The trace index ('<trace>.idx', see 'rtrace.h') is built by the first query
+// and reused by the next ones, so that looking at instruction 40,000,000 of a
+// large trace reads at most one index interval instead of the whole file.
+//
+#include "query.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include "rtrace.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::unique_ptr;
+
+// Convert a whole string to a number, returning false if it is not one
+static bool parseNumber(const string &_text, int _base, uint64_t &_value) {
+  char *end;
+  _value = strtoull(_text.c_str(), &end, _base);
+  return !_text.empty() && (*end == '\0');
+}
+
+// Return the record at '_position', records() if there is none, or UINT64_MAX if it is invalid
+static uint64_t find(const rtrace::Trace &_trace, const string &_position) {
+  uint64_t value;
+  if (_position.compare(0, 6, "cycle=") == 0) {
+    return (parseNumber(_position.substr(6), 0, value)) ? _trace.findTime(value) : UINT64_MAX;
+  }
+  if (_position.compare(0, 3, "pc=") == 0) {
+    size_t hash = _position.find('#');
+    uint64_t occurrence = 1;
+    if (!parseNumber(_position.substr(3, hash - 3), 16, value) || (value > UINT32_MAX) ||
+        ((hash != string::npos) && !parseNumber(_position.substr(hash + 1), 0, occurrence))) {
+      return UINT64_MAX;
+    }
+    return _trace.findPc(static_cast<uint32_t>(value), occurrence);
+  }
+  string inst = (_position.compare(0, 5, "inst=") == 0) ? _position.substr(5) : _position;
+  return (parseNumber(inst, 0, value)) ? std::min(value, _trace.records()) : UINT64_MAX;
+}
+
+int query(const string &_filename, const string &_position, uint64_t _count) {
+  unique_ptr<rtrace::Trace> trace = rtrace::Trace::open(_filename);
+  if (!trace) {
+    return 1;
+  }
+  if ((_position.compare(0, 3, "pc=") == 0) && (trace->format() != rtrace::ITRACE)) {
+    cout << "Only instruction traces can be searched for a PC" << endl;
+    return 1;
+  }
+  uint64_t first = find(*trace, _position);
+  if (first == UINT64_MAX) {
+    cout << "Invalid position '" << _position << "'" << endl;
+    return 1;
+  }
+  if (first >= trace->records()) {
+    cout << "No instruction at '" << _position << "' in " << trace->records() << " instructions" << endl;
+    return 1;
+  }
+
+  // Each record is printed in the text format after its instruction number
+  unique_ptr<rtrace::Reader> reader = trace->reader(first);
+  rtrace::Writer writer(stdout, rtrace::TEXT);
+  rtrace::Record record;
+  cout.flush();
+  for (uint64_t inst = first; (inst - first < _count) && reader->next(record); inst++) {
+    printf("%llu: ", static_cast<unsigned long long>(inst));
+    if (trace->format() == rtrace::ITRACE) {
+      printf("%08x    (%llu)\n", record.pc, static_cast<unsigned long long>(record.time));
+    } else {
+      writer.write(record.time, record.regs);
+    }
+  }
+  writer.finish();
+  return 0;
+}
@@ -0,0 +1,21 @@
+// query.h:
+//
+// Random access to the records of a register or instruction trace.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+#ifndef REGDIFF_QUERY_H
+#define REGDIFF_QUERY_H
+
+#include <cstdint>
+#include <string>
+
+// Print '_count' records of a trace starting at '_position', which is an
+// instruction ('N' or 'inst=N'), the first instruction at or after a cycle
+// ('cycle=N'), or the k-th execution of a PC in an instruction trace
+// ('pc=HEX' or 'pc=HEX#k'). Returns the exit status.
+int query(const std::string &_filename, const std::string &_position, uint64_t _count);
+
+#endif  // REGDIFF_QUERY_H
@@ -16,65 +16,41 @@
 // testsuite. To generate register dumps for inputs, use the 'rtrace_' target,
 // e.g., 'make rtrace_mytest1' and 'make rtrace_mytest2'.
 //
+// Inputs may be text traces or any of the binary formats of 'rtrace.h'
+// (e.g., 'make rtrace_mytest1 RTRACE_FORMAT=deflate'), which are detected
+// from the file contents. The two inputs need not have the same format.
+//
+// With '-a', the traces are aligned instead of compared record by record,
+// which finds all divergence regions of runs that took interrupts at
+// different instructions (see 'align.cc').
+//
+// With '-q', one trace is inspected instead: Its records from an instruction,
+// a cycle, or an execution of a PC (of instruction traces) are printed after
+// a seek through the trace index (see 'query.cc').
+//
+#include <algorithm>
+#include <atomic>
 #include <iostream>
-#include <fstream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unistd.h>
 #include <unordered_set>
 #include <vector>
+#include "align.h"
+#include "bench.h"
+#include "query.h"
+#include "rtrace.h"
 
 using std::cout;
 using std::endl;
-using std::ifstream;
-using std::make_unique;
 using std::string;
 using std::unique_ptr;
 using std::unordered_set;
 using std::vector;
 
-static constexpr uint64_t TOKENS = 34;
-
-static unique_ptr<vector<uint64_t>> splitLine(ifstream &_input) {
-  auto list = make_unique<vector<uint64_t>>();
-  string line;
-  if (!std::getline(_input, line)) {
-    return list;
-  }
-  string ss;  // NOTE: Benchmarks with ostringstream were slower: Using string
-  bool first_token = true;
-
-  try {
-    for (uint64_t i = 0; i < line.size(); i++) {
-      char byte = line[i];
-      if (byte == '=') {
-        ss.clear();
-      } else if (byte == ' ') {
-        if (first_token) {
-          list->push_back(std::stoul(ss, nullptr, 10));
-          first_token = false;
-        } else {
-          list->push_back(std::stoul(ss, nullptr, 16));
-        }
-        ss.clear();
-      } else {
-        ss += byte;
-      }
-    }
-    // The last byte has been read but there's no terminating value
-    list->push_back(std::stoul(ss, nullptr, 16));
-  }
-  catch (std::exception e) {
-    cout << "Conversion error: Unexpected string '" << ss << "'" << endl;
-    list->clear();
-  }
-
-  if (list->size() != TOKENS) {
-    cout << "Could not parse line '" << line << "'" << endl;
-    list->clear();
-  }
-  return list;
-}
+static constexpr uint64_t MIN_CHUNK = 65536;         // Instructions per chunk of the parallel mode
+static constexpr uint64_t CANCEL_INTERVAL = 4096;    // Instructions between checks for an earlier difference
 
 static const char *labelForIndex(int _index) {
   switch (_index) {
@@ -246,45 +222,137 @@ static int indexForLabel(const string &_label) {
   return idx;
 }
 
-static bool regdiff(ifstream &_input_a, ifstream &_input_b, uint64_t _offset, const unordered_set<int> &_excludes) {
-  string line;
-  bool found_diff = false;
-  uint64_t inst_count = 0;
-  bool valid = true;
-  while (valid) {
-    auto list_a = splitLine(_input_a);
-    auto list_b = splitLine(_input_b);
-    valid &= (list_a->size() == TOKENS && list_b->size() == TOKENS);
-    if (valid) {
-      if (_offset <= inst_count) {
-        for (uint64_t i = 1; i < list_a->size() - 1; i++) {
-          if (((*list_a)[i] != (*list_b)[i]) && (_excludes.count(static_cast<uint64_t>(i)) == 0)) {
-            if (!found_diff) {
-              cout << "Difference at instruction " << inst_count << " cycle "
-                   << (*list_a)[0] << " (A) / " << (*list_b)[0] << " (B):" << endl;
-              found_diff = true;
-            }
-            cout << "  " << labelForIndex(i) << ": 0x" << std::hex << (*list_a)[i]
-                 << " / 0x" << (*list_b)[i] << std::dec << endl;
-          }
-        }
+static bool differs(const rtrace::Record &_record_a, const rtrace::Record &_record_b,
+                    const unordered_set<int> &_excludes) {
+  for (int i = 1; i <= rtrace::REGS; i++) {
+    if ((_record_a.regs[i - 1] != _record_b.regs[i - 1]) && (_excludes.count(i) == 0)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void printDifference(uint64_t _inst, const rtrace::Record &_record_a, const rtrace::Record &_record_b,
+                            const unordered_set<int> &_excludes) {
+  cout << "Difference at instruction " << _inst << " cycle "
+       << _record_a.time << " (A) / " << _record_b.time << " (B):" << endl;
+  for (int i = 1; i <= rtrace::REGS; i++) {
+    uint32_t reg_a = _record_a.regs[i - 1];
+    uint32_t reg_b = _record_b.regs[i - 1];
+    if ((reg_a != reg_b) && (_excludes.count(i) == 0)) {
+      cout << "  " << labelForIndex(i) << ": 0x" << std::hex << reg_a
+           << " / 0x" << reg_b << std::dec << endl;
+    }
+  }
+}
+
+static void printNoDifference(uint64_t _inst_count, uint64_t _offset) {
+  if (_inst_count > 0) {
+    uint64_t compare_count = (_offset > _inst_count) ? 0 : (_inst_count - _offset);
+    cout << "No difference in " << compare_count << " instructions" << endl;
+  }
+}
+
+// The readers start at instruction '_first', which is at most '_offset'
+static bool regdiff(rtrace::Reader &_input_a, rtrace::Reader &_input_b, uint64_t _first, uint64_t _offset,
+                    const unordered_set<int> &_excludes) {
+  uint64_t inst_count = _first;
+  rtrace::Record record_a, record_b;
+  while (_input_a.next(record_a) && _input_b.next(record_b)) {
+    if ((_offset <= inst_count) && differs(record_a, record_b, _excludes)) {
+      printDifference(inst_count, record_a, record_b, _excludes);
+      return true;
+    }
+    inst_count++;
+  }
+  printNoDifference(inst_count, _offset);
+  return true;
+}
+
+// Lower '_value' to '_candidate' if it is smaller
+static void lowerTo(std::atomic<uint64_t> &_value, uint64_t _candidate) {
+  uint64_t current = _value.load();
+  while ((_candidate < current) && !_value.compare_exchange_weak(current, _candidate)) {
+  }
+}
+
+// Compare both traces in chunks of instructions on a pool of threads. Each
+// thread takes the next chunk in order and stops early once a difference
+// before it has been found, so the result is the globally first difference
+// (or the first unreadable record, which ends the comparison as in the
+// sequential mode).
+static bool parallelRegdiff(const rtrace::Trace &_trace_a, const rtrace::Trace &_trace_b, uint64_t _offset,
+                            const unordered_set<int> &_excludes, int _threads) {
+  uint64_t records = std::min(_trace_a.records(), _trace_b.records());
+  uint64_t first = std::min(_offset, records);
+  uint64_t chunk_size = std::max<uint64_t>(MIN_CHUNK, (records - first) / (static_cast<uint64_t>(_threads) * 8));
+  uint64_t chunks = (records - first + chunk_size - 1) / chunk_size;
+  std::atomic<uint64_t> next_chunk(0);
+  std::atomic<uint64_t> difference(UINT64_MAX);  // First differing instruction
+  std::atomic<uint64_t> end(records);            // First instruction which could not be read
+
+  auto worker = [&]() {
+    rtrace::Record record_a, record_b;
+    for (uint64_t chunk = next_chunk++; chunk < chunks; chunk = next_chunk++) {
+      uint64_t inst = first + (chunk * chunk_size);
+      uint64_t last = std::min(inst + chunk_size, records);
+      if (inst >= std::min(difference.load(), end.load())) {
+        break;
       }
-      inst_count++;
-      if (found_diff) {
-        return true;
+      unique_ptr<rtrace::Reader> reader_a = _trace_a.reader(inst);
+      unique_ptr<rtrace::Reader> reader_b = _trace_b.reader(inst);
+      reader_a->setQuiet(true);
+      reader_b->setQuiet(true);
+      for (; inst < last; inst++) {
+        if (!reader_a->next(record_a) || !reader_b->next(record_b)) {
+          lowerTo(end, inst);
+          break;
+        }
+        if (differs(record_a, record_b, _excludes)) {
+          lowerTo(difference, inst);
+          break;
+        }
+        if (((inst % CANCEL_INTERVAL) == 0) && (inst > difference.load())) {
+          break;
+        }
       }
     }
+  };
+  vector<std::thread> pool;
+  for (int t = 1; t < _threads; t++) {
+    pool.emplace_back(worker);
   }
-  if (!found_diff && inst_count > 0) {
-    uint64_t compare_count = inst_count - _offset;
-    if (_offset > inst_count) {
-      compare_count = 0;
+  worker();
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+
+  if (difference.load() < end.load()) {
+    rtrace::Record record_a, record_b;
+    _trace_a.reader(difference.load())->next(record_a);
+    _trace_b.reader(difference.load())->next(record_b);
+    printDifference(difference.load(), record_a, record_b, _excludes);
+  } else {
+    // Repeat the read which failed (if any) for its message
+    rtrace::Record record;
+    if (_trace_a.reader(end.load())->next(record)) {
+      _trace_b.reader(end.load())->next(record);
     }
-    cout << "No difference in " << compare_count << " instructions" << endl;
+    printNoDifference(end.load(), _offset);
   }
   return true;
 }
 
+// Open a register trace with its index
+static unique_ptr<rtrace::Trace> openTrace(const string &_filename, int _threads) {
+  unique_ptr<rtrace::Trace> trace = rtrace::Trace::open(_filename, _threads);
+  if (trace && (trace->format() == rtrace::ITRACE)) {
+    cout << "'" << _filename << "' is an instruction trace, not a register trace" << endl;
+    return nullptr;
+  }
+  return trace;
+}
+
 static void addExclusion(const string &_exclusions, unordered_set<int> &_list) {
   // Exclusions may be comma-separated
   string s;
@@ -314,8 +382,19 @@ static void addExclusion(const string &_exclusions, unordered_set<int> &_list) {
 static void usage() {
   const char *msg =
     "\nUsage: regdiff [options] <file 1> <file 2>\n"
+    "       regdiff -q <position> [-n count] <file>\n"
     "    -o   Offset instructions (i.e., starting point for comparison)\n"
     "    -x   Exclude registers in comparison, e.g., 'k1', 'K1', 'a0,s4,gp,hi,lo'\n"
+    "    -s   Use the stream parser for text traces instead of mapping them\n"
+    "    -j   Compare in parallel on this many threads (0: one per core)\n"
+    "    -a   Align the traces after instructions which only one executed (e.g.,\n"
+    "         interrupts) and report all divergence regions. Excludes k0 and k1.\n"
+    "    -w   Instructions searched for a realignment with -a (default 4096)\n"
+    "    -p   Instruction traces of both runs for -a, e.g., 'a.itrace,b.itrace'\n"
+    "    -q   Print records of <file> from an instruction ('N' or 'inst=N'), a cycle\n"
+    "         ('cycle=N'), or an execution of a PC ('pc=HEX' or 'pc=HEX#k')\n"
+    "    -n   Records printed with -q (default 1)\n"
+    "    -B   Benchmark the text parsers on a synthetic trace of this many records\n"
     "    -h   Print this help message\n"
     "\n";
   cout << msg;
@@ -326,16 +405,55 @@ int main(int argc, char *argv[]) {
   string input_1, input_2;
   uint64_t offset = 0;
   unordered_set<int> excludes;
+  bool map_text = true;
+  int threads = 1;
+  bool align = false;
+  AlignOptions align_options;
+  string position;
+  uint64_t count = 1;
   int ch;
 
-  while ((ch = getopt(argc, argv, "ho:x:")) != -1) {
+  while ((ch = getopt(argc, argv, "hsaj:n:o:p:q:w:x:B:")) != -1) {
     switch (ch) {
+      case 'B':
+        return benchmark(strtoull(optarg, nullptr, 0));
       case 'h':
         usage();
         break;
+      case 's':
+        map_text = false;
+        break;
+      case 'a':
+        align = true;
+        break;
+      case 'p': {
+        string itraces(optarg);
+        size_t comma = itraces.find(',');
+        if (comma == string::npos) {
+          usage();
+        }
+        align_options.itrace_a = itraces.substr(0, comma);
+        align_options.itrace_b = itraces.substr(comma + 1);
+        break;
+      }
+      case 'w':
+        align_options.window = std::max(1ul, strtoul(optarg, nullptr, 0));
+        break;
+      case 'j':
+        threads = std::atoi(optarg);
+        if (threads <= 0) {
+          threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        break;
       case 'o':
         offset = strtoul(optarg, nullptr, 0);
         break;
+      case 'q':
+        position = optarg;
+        break;
+      case 'n':
+        count = strtoull(optarg, nullptr, 0);
+        break;
       case 'x':
         addExclusion(optarg, excludes);
         break;
@@ -347,22 +465,49 @@ int main(int argc, char *argv[]) {
   argc -= optind;
   argv += optind;
 
+  if (!position.empty() && (argc == 1)) {
+    return query(argv[0], position, count);
+  }
   if (argc != 2) {
     usage();
   }
   input_1 = string(argv[0]);
   input_2 = string(argv[1]);
 
-  ifstream file_1(input_1);
+  if (align) {
+    // Interrupt handlers leave their scratch registers behind
+    addExclusion("k0,k1", excludes);
+    threads = 1;
+  }
+  if ((threads > 1) || ((offset > 0) && map_text && !align)) {
+    // The trace indexes skip the offset instead of reading up to it
+    unique_ptr<rtrace::Trace> trace_1 = openTrace(input_1, threads);
+    if (!trace_1) {
+      return 1;
+    }
+    unique_ptr<rtrace::Trace> trace_2 = openTrace(input_2, threads);
+    if (!trace_2) {
+      return 1;
+    }
+    if (threads > 1) {
+      return (parallelRegdiff(*trace_1, *trace_2, offset, excludes, threads)) ? 0 : 1;
+    }
+    uint64_t first = std::min(offset, std::min(trace_1->records(), trace_2->records()));
+    return (regdiff(*trace_1->reader(first), *trace_2->reader(first), first, offset, excludes)) ? 0 : 1;
+  }
+
+  unique_ptr<rtrace::Reader> file_1 = rtrace::Reader::open(input_1, map_text);
   if (!file_1) {
-    cout << "Error opening '" << input_1 << "'" << endl;
     return 1;
   }
-  ifstream file_2(input_2);
+  unique_ptr<rtrace::Reader> file_2 = rtrace::Reader::open(input_2, map_text);
   if (!file_2) {
-    cout << "Error opening '" << input_2 << "'" << endl;
+    return 1;
+  }
+  if (align) {
+    return (alignedRegdiff(*file_1, *file_2, offset, excludes, align_options)) ? 0 : 1;
   }
-  if (!regdiff(file_1, file_2, offset, excludes)) {
+  if (!regdiff(*file_1, *file_2, 0, offset, excludes)) {
     return 1;
   }
 
@@ -0,0 +1,771 @@
+// rtrace.cc:
+//
+// Readers for the register file trace formats of the macro test harnesses.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+#include "rtrace.h"
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+using std::cout;
+using std::endl;
+using std::ifstream;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace rtrace {
+
+static uint32_t byteSwap(uint32_t _value) {
+  return (_value >> 24) | ((_value >> 8) & 0xff00) | ((_value << 8) & 0xff0000) | (_value << 24);
+}
+
+// The original parser: Kept as a fallback for files which cannot be mapped
+class StreamTextReader : public Reader {
+ public:
+  explicit StreamTextReader(const string &_filename) : input_(_filename) {}
+
+  bool next(Record &_record) override {
+    string line;
+    if (!std::getline(input_, line)) {
+      return false;
+    }
+    string ss;  // NOTE: Benchmarks with ostringstream were slower: Using string
+    int token = 0;
+    _record.pc = 0;
+
+    try {
+      for (uint64_t i = 0; i < line.size(); i++) {
+        char byte = line[i];
+        if (byte == '=') {
+          ss.clear();
+        } else if (byte == ' ') {
+          if (token == 0) {
+            _record.time = std::stoull(ss, nullptr, 10);
+          } else if (token <= REGS) {
+            _record.regs[token - 1] = static_cast<uint32_t>(std::stoul(ss, nullptr, 16));
+          }
+          token++;
+          ss.clear();
+        } else {
+          ss += byte;
+        }
+      }
+      // The last byte has been read but there's no terminating value
+      if ((token > 0) && (token <= REGS)) {
+        _record.regs[token - 1] = static_cast<uint32_t>(std::stoul(ss, nullptr, 16));
+      }
+      token++;
+    }
+    catch (std::exception &e) {
+      error("Conversion error: Unexpected string '" + ss + "'");
+      return false;
+    }
+
+    if (token != REGS + 1) {
+      error("Could not parse line '" + line + "'");
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  ifstream input_;
+};
+
+// Hex digit values, or 0x80 for bytes which are not hex digits
+struct HexTable {
+  HexTable() {
+    memset(values, 0x80, sizeof(values));
+    for (int i = 0; i < 10; i++) {
+      values['0' + i] = static_cast<uint8_t>(i);
+    }
+    for (int i = 0; i < 6; i++) {
+      values['a' + i] = static_cast<uint8_t>(10 + i);
+      values['A' + i] = static_cast<uint8_t>(10 + i);
+    }
+  }
+  uint8_t values[256];
+};
+
+static const HexTable HEX;
+
+// Decode the 8 hex digits of a '%08x' field, 8 bytes at a time (SWAR), returning false if
+// any is not a hex digit. The most-significant digit comes first, i.e., in the lowest byte.
+static inline bool decodeHex8(const char *_src, uint32_t &_value) {
+  static constexpr uint64_t ONES = 0x0101010101010101ull;
+  static constexpr uint64_t HIGH = 0x8080808080808080ull;
+  uint64_t bytes;
+  memcpy(&bytes, _src, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  bytes = __builtin_bswap64(bytes);
+#endif
+
+  // Every byte must be '0'-'9' or (in lower case) 'a'-'f'. Bytes below 0x80 cannot carry.
+  uint64_t lower = bytes | (0x20 * ONES);
+  uint64_t digit = ((lower + ((0x80 - '0') * ONES)) & ~(lower + ((0x80 - '9' - 1) * ONES)));
+  uint64_t letter = ((lower + ((0x80 - 'a') * ONES)) & ~(lower + ((0x80 - 'f' - 1) * ONES)));
+  bool valid = (((digit | letter) & HIGH) == HIGH) && !(bytes & HIGH);
+
+  // Nibble values, then pairs into bytes, bytes into half-words, and half-words into the word
+  uint64_t nibbles = (bytes & (0x0f * ONES)) + (((bytes & (0x40 * ONES)) >> 6) * 9);
+  uint64_t value = ((nibbles << 4) | (nibbles >> 8)) & 0x00ff00ff00ff00ffull;
+  value = ((value << 8) | (value >> 16)) & 0x0000ffff0000ffffull;
+  value = ((value << 16) | (value >> 32)) & 0xffffffffull;
+  _value = static_cast<uint32_t>(value);
+  return valid;
+}
+
+// Decode a hex field of any width up to the next space or the end of the line
+static inline bool decodeHex(const char *&_src, const char *_end, uint32_t &_value) {
+  const char *start = _src;
+  uint64_t value = 0;
+  while ((_src < _end) && (*_src != ' ')) {
+    uint8_t digit = HEX.values[static_cast<uint8_t>(*_src++)];
+    if ((digit & 0x80) || (_src - start > 8)) {
+      return false;
+    }
+    value = (value << 4) | digit;
+  }
+  _value = static_cast<uint32_t>(value);
+  return _src != start;
+}
+
+// A read-only map of a whole file, shared by the trace and all of its readers
+struct Mapping {
+  ~Mapping() {
+    if (size > 0) {
+      munmap(const_cast<uint8_t *>(data), size);
+    }
+  }
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  uint64_t mtime = 0;        // Modification time (ns), which identifies the index of this version
+};
+
+static shared_ptr<const Mapping> mapFile(const string &_filename) {
+  int fd = ::open(_filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    cout << "Error opening '" << _filename << "'" << endl;
+    return nullptr;
+  }
+  auto mapping = std::make_shared<Mapping>();
+  struct stat info;
+  if ((fstat(fd, &info) == 0) && S_ISREG(info.st_mode)) {
+    mapping->mtime = (static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000ull) + info.st_mtim.tv_nsec;
+  }
+  if (S_ISREG(info.st_mode) && (info.st_size > 0)) {
+    void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      cout << "Error mapping '" << _filename << "'" << endl;
+      mapping.reset();
+    } else {
+      madvise(data, info.st_size, MADV_SEQUENTIAL);
+      mapping->data = static_cast<const uint8_t *>(data);
+      mapping->size = info.st_size;
+    }
+  } else if (!S_ISREG(info.st_mode)) {
+    cout << "'" << _filename << "' is not a regular file" << endl;
+    mapping.reset();
+  }
+  close(fd);
+  return mapping;
+}
+
+// Instruction trace lines start with an 8-digit PC, e.g., '9fc00010    (45)'. Register trace
+// lines start with the decimal time followed by ' at='.
+static bool isItrace(const Mapping &_mapping) {
+  uint32_t pc;
+  const char *data = reinterpret_cast<const char *>(_mapping.data);
+  if ((_mapping.size < 8) || !decodeHex8(data, pc)) {
+    return false;
+  }
+  size_t i = 8;
+  while ((i < _mapping.size) && (data[i] == ' ')) {
+    i++;
+  }
+  return (i == _mapping.size) || (data[i] == '(') || (data[i] == '\n') || (data[i] == '\r');
+}
+
+// Determine the format from the header, returning false with a message if it is not supported
+static bool readHeader(const Mapping &_mapping, const string &_filename, Format &_format, bool &_swap) {
+  uint32_t magic = (_mapping.size >= HEADER_BYTES) ? getWord(_mapping.data) : 0;
+  if ((magic != MAGIC) && (magic != byteSwap(MAGIC))) {
+    _format = (isItrace(_mapping)) ? ITRACE : TEXT;
+    _swap = false;
+    return true;
+  }
+  _swap = (magic != MAGIC);
+  uint32_t format = (_swap) ? byteSwap(getWord(_mapping.data + 4)) : getWord(_mapping.data + 4);
+  uint32_t regs = (_swap) ? byteSwap(getWord(_mapping.data + 8)) : getWord(_mapping.data + 8);
+  _format = static_cast<Format>(format);
+  if (regs != REGS) {
+    cout << "'" << _filename << "' has " << regs << " registers per record instead of " << REGS << endl;
+    return false;
+  }
+  if ((format != FIXED) && (((format != DELTA) && (format != DEFLATE)) || _swap)) {
+    cout << "'" << _filename << "' has an unknown trace format (" << format << ")" << endl;
+    return false;
+  }
+  return true;
+}
+
+void Reader::error(const string &_message) const {
+  if (!quiet_) {
+    cout << _message << endl;
+  }
+}
+
+uint64_t Reader::skip(uint64_t _records) {
+  Record record;
+  uint64_t skipped = 0;
+  while ((skipped < _records) && next(record)) {
+    skipped++;
+  }
+  return skipped;
+}
+
+// Parses the memory-mapped trace in place into the caller's record. The fields
+// written by the harnesses (' xx=%08x') take the fixed-width fast path and
+// anything else, e.g., longer labels or narrower values, the general one.
+class MappedTextReader : public Reader {
+ public:
+  MappedTextReader(shared_ptr<const Mapping> _mapping, size_t _offset, bool _itrace)
+      : mapping_(_mapping),
+        position_(reinterpret_cast<const char *>(_mapping->data) + _offset),
+        end_(reinterpret_cast<const char *>(_mapping->data) + _mapping->size),
+        itrace_(_itrace) {}
+
+  bool next(Record &_record) override {
+    if (position_ >= end_) {
+      return false;
+    }
+    const char *line = position_;
+    const char *eol = static_cast<const char *>(memchr(line, '\n', end_ - line));
+    if (eol == nullptr) {
+      eol = end_;
+    }
+    position_ = eol + 1;
+    if ((eol > line) && (eol[-1] == '\r')) {
+      eol--;
+    }
+    if (!((itrace_) ? parseItraceLine(line, eol, _record) : parseLine(line, eol, _record))) {
+      error("Could not parse line '" + string(line, eol) + "'");
+      return false;
+    }
+    return true;
+  }
+
+  uint64_t skip(uint64_t _records) override {
+    uint64_t skipped = 0;
+    while ((skipped < _records) && (position_ < end_)) {
+      const char *eol = static_cast<const char *>(memchr(position_, '\n', end_ - position_));
+      position_ = (eol == nullptr) ? end_ : (eol + 1);
+      skipped++;
+    }
+    return skipped;
+  }
+
+ private:
+  // The time is optional: 'mips_test.v' can also write only the PCs
+  static bool parseItraceLine(const char *_src, const char *_end, Record &_record) {
+    if ((_end - _src < 8) || !decodeHex8(_src, _record.pc)) {
+      return false;
+    }
+    _src += 8;
+    while ((_src < _end) && (*_src == ' ')) {
+      _src++;
+    }
+    uint64_t time = 0;
+    if ((_src < _end) && (*_src == '(')) {
+      const char *start = ++_src;
+      while ((_src < _end) && (*_src >= '0') && (*_src <= '9')) {
+        time = (time * 10) + (*_src++ - '0');
+      }
+      if ((_src == start) || (_src == _end) || (*_src++ != ')')) {
+        return false;
+      }
+    }
+    _record.time = time;
+    return _src == _end;
+  }
+
+  static bool parseLine(const char *_src, const char *_end, Record &_record) {
+    uint64_t time = 0;
+    const char *start = _src;
+    while ((_src < _end) && (*_src >= '0') && (*_src <= '9')) {
+      time = (time * 10) + (*_src++ - '0');
+    }
+    if (_src == start) {
+      return false;
+    }
+    _record.time = time;
+    _record.pc = 0;
+    for (int i = 0; i < REGS; i++) {
+      if ((_end - _src >= 12) && (_src[0] == ' ') && (_src[3] == '=') && ((_end - _src == 12) || (_src[12] == ' '))) {
+        if (!decodeHex8(_src + 4, _record.regs[i])) {
+          return false;
+        }
+        _src += 12;
+        continue;
+      }
+      if ((_src == _end) || (*_src != ' ')) {
+        return false;
+      }
+      const char *equals = static_cast<const char *>(memchr(_src, '=', _end - _src));
+      if (equals == nullptr) {
+        return false;
+      }
+      _src = equals + 1;
+      if (!decodeHex(_src, _end, _record.regs[i])) {
+        return false;
+      }
+    }
+    return _src == _end;
+  }
+
+  shared_ptr<const Mapping> mapping_;
+  const char *position_;
+  const char *end_;
+  bool itrace_;
+};
+
+class FixedReader : public Reader {
+ public:
+  FixedReader(shared_ptr<const Mapping> _mapping, size_t _offset, bool _swap)
+      : mapping_(_mapping), position_(_offset), swap_(_swap) {}
+
+  bool next(Record &_record) override {
+    if (position_ + FIXED_RECORD_BYTES > mapping_->size) {
+      if (position_ < mapping_->size) {
+        error("Truncated record at the end of the trace");
+        position_ = mapping_->size;
+      }
+      return false;
+    }
+    const uint8_t *record = mapping_->data + position_;
+    _record.time = word(record);
+    _record.pc = 0;
+    for (int i = 0; i < REGS; i++) {
+      _record.regs[i] = word(record + 4 + (i * 4));
+    }
+    position_ += FIXED_RECORD_BYTES;
+    return true;
+  }
+
+  uint64_t skip(uint64_t _records) override {
+    uint64_t skipped = std::min<uint64_t>(_records, (mapping_->size - std::min(position_, mapping_->size)) / FIXED_RECORD_BYTES);
+    position_ += skipped * FIXED_RECORD_BYTES;
+    return skipped;
+  }
+
+ private:
+  uint32_t word(const uint8_t *_src) const {
+    return (swap_) ? byteSwap(getWord(_src)) : getWord(_src);
+  }
+
+  shared_ptr<const Mapping> mapping_;
+  size_t position_;
+  bool swap_;
+};
+
+// Reads the blocks from the given offset on. Uncompressed blocks are decoded from the map directly.
+class DeltaReader : public Reader {
+ public:
+  DeltaReader(shared_ptr<const Mapping> _mapping, size_t _offset, bool _compressed)
+      : mapping_(_mapping), compressed_(_compressed), offset_(_offset), block_(nullptr),
+        block_size_(0), records_(0), position_(0), time_(0), regs_() {}
+
+  bool next(Record &_record) override {
+    if ((records_ == 0) && !readBlock()) {
+      return false;
+    }
+    uint64_t delta, mask;
+    if (!getVarint(delta) || !getVarint(mask) || (position_ + (4 * popcount(mask)) > block_size_)) {
+      error("Corrupt record in the trace");
+      records_ = 0;
+      offset_ = mapping_->size;
+      return false;
+    }
+    for (int i = 0; i < REGS; i++) {
+      if (mask & (1ull << i)) {
+        regs_[i] = getWord(block_ + position_);
+        position_ += 4;
+      }
+    }
+    time_ += delta;
+    _record.time = time_;
+    _record.pc = 0;
+    std::copy(regs_, regs_ + REGS, _record.regs);
+    records_--;
+    return true;
+  }
+
+ private:
+  bool readBlock() {
+    if (offset_ + BLOCK_HEADER_BYTES > mapping_->size) {
+      if (offset_ < mapping_->size) {
+        error("Truncated block at the end of the trace");
+        offset_ = mapping_->size;
+      }
+      return false;
+    }
+    const uint8_t *header = mapping_->data + offset_;
+    uint32_t records = getWord(header);
+    uLongf raw = getWord(header + 4);
+    uint32_t stored = getWord(header + 8);
+    const uint8_t *payload = header + BLOCK_HEADER_BYTES;
+    offset_ += BLOCK_HEADER_BYTES + static_cast<size_t>(stored);
+    if (offset_ > mapping_->size) {
+      error("Truncated block at the end of the trace");
+      offset_ = mapping_->size;
+      return false;
+    }
+    if (compressed_) {
+      buffer_.resize(raw);
+      if ((uncompress(buffer_.data(), &raw, payload, stored) != Z_OK) || (raw != buffer_.size())) {
+        error("Corrupt block in the trace");
+        offset_ = mapping_->size;
+        return false;
+      }
+      payload = buffer_.data();
+    } else if (stored != raw) {
+      error("Corrupt block in the trace");
+      offset_ = mapping_->size;
+      return false;
+    }
+    block_ = payload;
+    block_size_ = raw;
+    records_ = records;
+    position_ = 0;
+    time_ = 0;
+    std::fill(regs_, regs_ + REGS, 0);
+    return (records_ > 0) || readBlock();
+  }
+
+  bool getVarint(uint64_t &_value) {
+    _value = 0;
+    for (int shift = 0; (shift < 64) && (position_ < block_size_); shift += 7) {
+      uint8_t byte = block_[position_++];
+      _value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static int popcount(uint64_t _mask) {
+    return __builtin_popcountll(_mask);
+  }
+
+  shared_ptr<const Mapping> mapping_;
+  bool compressed_;
+  size_t offset_;            // File offset of the next block
+  const uint8_t *block_;     // Payload of the current block
+  size_t block_size_;
+  uint32_t records_;         // Records left in the current block
+  size_t position_;          // Read position in the current block
+  uint64_t time_;
+  uint32_t regs_[REGS];
+  std::vector<uint8_t> buffer_;
+};
+
+static unique_ptr<Reader> makeReader(shared_ptr<const Mapping> _mapping, Format _format, bool _swap, size_t _offset) {
+  switch (_format) {
+    case TEXT:
+    case ITRACE:
+      return unique_ptr<Reader>(new MappedTextReader(_mapping, _offset, _format == ITRACE));
+    case FIXED:
+      return unique_ptr<Reader>(new FixedReader(_mapping, _offset, _swap));
+    default:
+      return unique_ptr<Reader>(new DeltaReader(_mapping, _offset, _format == DEFLATE));
+  }
+}
+
+unique_ptr<Reader> Reader::open(const string &_filename, bool _map_text) {
+  shared_ptr<const Mapping> mapping = mapFile(_filename);
+  Format format;
+  bool swap;
+  if (!mapping || !readHeader(*mapping, _filename, format, swap)) {
+    return nullptr;
+  }
+  if (format == ITRACE) {
+    cout << "'" << _filename << "' is an instruction trace, not a register trace" << endl;
+    return nullptr;
+  }
+  if ((format == TEXT) && !_map_text) {
+    return unique_ptr<Reader>(new StreamTextReader(_filename));
+  }
+  return makeReader(mapping, format, swap, (format == TEXT) ? 0 : HEADER_BYTES);
+}
+
+// Index the lines in [_begin, _end), which starts at a line. For instruction
+// traces, also count the executions of each PC between two checkpoints.
+static void indexLines(const Mapping &_mapping, size_t _begin, size_t _end, uint64_t _interval, bool _itrace,
+                       vector<Trace::Checkpoint> &_checkpoints, vector<Trace::PcCount> &_pc_counts,
+                       uint64_t &_lines) {
+  const char *data = reinterpret_cast<const char *>(_mapping.data);
+  std::unordered_map<uint32_t, uint32_t> counts;
+  auto flushCounts = [&]() {
+    size_t first = _pc_counts.size();
+    for (const auto &count : counts) {
+      _pc_counts.push_back({count.first, count.second});
+    }
+    std::sort(_pc_counts.begin() + first, _pc_counts.end(),
+              [](const Trace::PcCount &_a, const Trace::PcCount &_b) { return _a.pc < _b.pc; });
+    counts.clear();
+  };
+  uint64_t lines = 0;
+  size_t position = _begin;
+  while (position < _end) {
+    if ((lines % _interval) == 0) {
+      flushCounts();
+      _checkpoints.push_back({lines, position, 0, _pc_counts.size()});
+    }
+    uint32_t pc;
+    if (_itrace && (_end - position >= 8) && decodeHex8(data + position, pc)) {
+      counts[pc]++;
+    }
+    const char *eol = static_cast<const char *>(memchr(data + position, '\n', _end - position));
+    position = (eol == nullptr) ? _end : (eol - data + 1);
+    lines++;
+  }
+  flushCounts();
+  _lines = lines;
+}
+
+// Split the file among the threads at line boundaries and merge their indexes
+static void indexText(const Mapping &_mapping, int _threads, uint64_t _interval, bool _itrace,
+                      vector<Trace::Checkpoint> &_checkpoints, vector<Trace::PcCount> &_pc_counts,
+                      uint64_t &_records) {
+  const char *data = reinterpret_cast<const char *>(_mapping.data);
+  vector<size_t> bounds(_threads + 1, _mapping.size);
+  bounds[0] = 0;
+  for (int t = 1; t < _threads; t++) {
+    size_t split = std::max(bounds[t - 1], (_mapping.size / _threads) * t);
+    const void *eol = (split > 0) ? memchr(data + split - 1, '\n', _mapping.size - split + 1) : data;
+    bounds[t] = (eol == nullptr) ? _mapping.size : (static_cast<const char *>(eol) - data + ((split > 0) ? 1 : 0));
+  }
+  vector<vector<Trace::Checkpoint>> checkpoints(_threads);
+  vector<vector<Trace::PcCount>> pc_counts(_threads);
+  vector<uint64_t> lines(_threads, 0);
+  vector<std::thread> workers;
+  for (int t = 1; t < _threads; t++) {
+    workers.emplace_back(indexLines, std::cref(_mapping), bounds[t], bounds[t + 1], _interval, _itrace,
+                         std::ref(checkpoints[t]), std::ref(pc_counts[t]), std::ref(lines[t]));
+  }
+  indexLines(_mapping, bounds[0], bounds[1], _interval, _itrace, checkpoints[0], pc_counts[0], lines[0]);
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  _records = 0;
+  for (int t = 0; t < _threads; t++) {
+    for (const Trace::Checkpoint &checkpoint : checkpoints[t]) {
+      _checkpoints.push_back({_records + checkpoint.record, checkpoint.offset, 0, _pc_counts.size() + checkpoint.pcs});
+    }
+    _pc_counts.insert(_pc_counts.end(), pc_counts[t].begin(), pc_counts[t].end());
+    _records += lines[t];
+  }
+}
+
+void Trace::buildIndex(int _threads, uint64_t _interval) {
+  const Mapping &mapping = *mapping_;
+  records_ = 0;
+  switch (format_) {
+    case TEXT:
+    case ITRACE:
+      indexText(mapping, _threads, _interval, format_ == ITRACE, checkpoints_, pc_counts_, records_);
+      break;
+    case FIXED:
+      records_ = (mapping.size - HEADER_BYTES) / FIXED_RECORD_BYTES;
+      for (uint64_t record = 0; record < std::max<uint64_t>(records_, 1); record += _interval) {
+        checkpoints_.push_back({record, HEADER_BYTES + (record * FIXED_RECORD_BYTES), 0, 0});
+      }
+      break;
+    default:
+      // Every block can be decoded on its own: Index them all
+      for (size_t offset = HEADER_BYTES; offset + BLOCK_HEADER_BYTES <= mapping.size;) {
+        checkpoints_.push_back({records_, offset, 0, 0});
+        records_ += getWord(mapping.data + offset);
+        offset += BLOCK_HEADER_BYTES + static_cast<size_t>(getWord(mapping.data + offset + 8));
+      }
+      break;
+  }
+
+  // The time of each checkpoint is that of its first record
+  Record record;
+  for (Checkpoint &checkpoint : checkpoints_) {
+    unique_ptr<Reader> reader = makeReader(mapping_, format_, swap_, checkpoint.offset);
+    reader->setQuiet(true);
+    checkpoint.time = (reader->next(record)) ? record.time : UINT64_MAX;
+  }
+}
+
+static constexpr uint32_t INDEX_MAGIC = 0x49524d4f;  // "OMRI" in file order
+static constexpr uint32_t INDEX_VERSION = 1;
+static constexpr size_t INDEX_HEADER_BYTES = 56;
+
+static void putDouble(uint8_t *_dest, uint64_t _value) {
+  putWord(_dest, static_cast<uint32_t>(_value));
+  putWord(_dest + 4, static_cast<uint32_t>(_value >> 32));
+}
+
+static uint64_t getDouble(const uint8_t *_src) {
+  return getWord(_src) | (static_cast<uint64_t>(getWord(_src + 4)) << 32);
+}
+
+// The index file holds a header (magic, version, trace size, trace modification
+// time, records, checkpoints, PC counts) and then the checkpoints and PC counts,
+// all little-endian. It is only used if the trace has the same size and time.
+bool Trace::loadIndex(const string &_filename) {
+  FILE *handle = fopen(_filename.c_str(), "rb");
+  if (handle == nullptr) {
+    return false;
+  }
+  uint8_t header[INDEX_HEADER_BYTES];
+  bool valid = (fread(header, 1, INDEX_HEADER_BYTES, handle) == INDEX_HEADER_BYTES) &&
+               (getWord(header) == INDEX_MAGIC) && (getWord(header + 4) == INDEX_VERSION) &&
+               (getDouble(header + 8) == mapping_->size) && (getDouble(header + 16) == mapping_->mtime);
+  uint64_t checkpoints = (valid) ? getDouble(header + 32) : 0;
+  uint64_t pc_counts = (valid) ? getDouble(header + 40) : 0;
+  vector<uint8_t> data((checkpoints * 32) + (pc_counts * 8));
+  valid = valid && (checkpoints > 0) && (fread(data.data(), 1, data.size(), handle) == data.size());
+  fclose(handle);
+  if (!valid) {
+    return false;
+  }
+  records_ = getDouble(header + 24);
+  checkpoints_.resize(checkpoints);
+  for (uint64_t i = 0; i < checkpoints; i++) {
+    const uint8_t *src = data.data() + (i * 32);
+    checkpoints_[i] = {getDouble(src), getDouble(src + 8), getDouble(src + 16), getDouble(src + 24)};
+  }
+  pc_counts_.resize(pc_counts);
+  for (uint64_t i = 0; i < pc_counts; i++) {
+    const uint8_t *src = data.data() + (checkpoints * 32) + (i * 8);
+    pc_counts_[i] = {getWord(src), getWord(src + 4)};
+  }
+  return true;
+}
+
+// Saving is best effort: Traces may be in read-only directories
+void Trace::saveIndex(const string &_filename) const {
+  vector<uint8_t> data(INDEX_HEADER_BYTES + (checkpoints_.size() * 32) + (pc_counts_.size() * 8));
+  putWord(data.data(), INDEX_MAGIC);
+  putWord(data.data() + 4, INDEX_VERSION);
+  putDouble(data.data() + 8, mapping_->size);
+  putDouble(data.data() + 16, mapping_->mtime);
+  putDouble(data.data() + 24, records_);
+  putDouble(data.data() + 32, checkpoints_.size());
+  putDouble(data.data() + 40, pc_counts_.size());
+  putDouble(data.data() + 48, 0);
+  uint8_t *dest = data.data() + INDEX_HEADER_BYTES;
+  for (const Checkpoint &checkpoint : checkpoints_) {
+    putDouble(dest, checkpoint.record);
+    putDouble(dest + 8, checkpoint.offset);
+    putDouble(dest + 16, checkpoint.time);
+    putDouble(dest + 24, checkpoint.pcs);
+    dest += 32;
+  }
+  for (const PcCount &count : pc_counts_) {
+    putWord(dest, count.pc);
+    putWord(dest + 4, count.count);
+    dest += 8;
+  }
+  // Write a temporary file and rename it so that concurrent users never see a partial index
+  string temporary = _filename + ".tmp" + std::to_string(getpid());
+  FILE *handle = fopen(temporary.c_str(), "wb");
+  if (handle == nullptr) {
+    return;
+  }
+  bool written = (fwrite(data.data(), 1, data.size(), handle) == data.size());
+  written = (fclose(handle) == 0) && written;
+  if (!written || (rename(temporary.c_str(), _filename.c_str()) != 0)) {
+    unlink(temporary.c_str());
+  }
+}
+
+unique_ptr<Trace> Trace::open(const string &_filename, int _threads, uint64_t _interval) {
+  unique_ptr<Trace> trace(new Trace);
+  trace->mapping_ = mapFile(_filename);
+  if (!trace->mapping_ || !readHeader(*trace->mapping_, _filename, trace->format_, trace->swap_)) {
+    return nullptr;
+  }
+  string index_filename = _filename + ".idx";
+  if (!trace->loadIndex(index_filename)) {
+    trace->checkpoints_.clear();
+    trace->pc_counts_.clear();
+    trace->buildIndex(std::max(1, _threads), std::max<uint64_t>(1, _interval));
+    if (!trace->checkpoints_.empty()) {
+      trace->saveIndex(index_filename);
+    }
+  }
+  return trace;
+}
+
+unique_ptr<Reader> Trace::reader(uint64_t _first) const {
+  auto after = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), _first,
+                                [](uint64_t _record, const Checkpoint &_checkpoint) { return _record < _checkpoint.record; });
+  size_t offset = (after == checkpoints_.begin()) ? mapping_->size : (after - 1)->offset;
+  uint64_t record = (after == checkpoints_.begin()) ? 0 : (after - 1)->record;
+  unique_ptr<Reader> reader = makeReader(mapping_, format_, swap_, offset);
+  reader->skip(_first - record);
+  return reader;
+}
+
+uint64_t Trace::findTime(uint64_t _time) const {
+  // Start at the last checkpoint before the time
+  auto after = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), _time,
+                                [](uint64_t _t, const Checkpoint &_checkpoint) { return _t <= _checkpoint.time; });
+  uint64_t index = (after == checkpoints_.begin()) ? 0 : (after - 1)->record;
+  unique_ptr<Reader> reader = this->reader(index);
+  Record record;
+  while (reader->next(record) && (record.time < _time)) {
+    index++;
+  }
+  return std::min(index, records_);
+}
+
+uint64_t Trace::findPc(uint32_t _pc, uint64_t _occurrence) const {
+  if ((format_ != ITRACE) || (_occurrence == 0)) {
+    return records_;
+  }
+  // Find the interval of the occurrence from the counts, then scan it
+  for (size_t i = 0; i < checkpoints_.size(); i++) {
+    auto first = pc_counts_.begin() + checkpoints_[i].pcs;
+    auto last = (i + 1 < checkpoints_.size()) ? (pc_counts_.begin() + checkpoints_[i + 1].pcs) : pc_counts_.end();
+    auto count = std::lower_bound(first, last, _pc, [](const PcCount &_count, uint32_t _p) { return _count.pc < _p; });
+    if ((count == last) || (count->pc != _pc)) {
+      continue;
+    }
+    if (_occurrence > count->count) {
+      _occurrence -= count->count;
+      continue;
+    }
+    uint64_t index = checkpoints_[i].record;
+    unique_ptr<Reader> reader = this->reader(index);
+    Record record;
+    while (reader->next(record)) {
+      if ((record.pc == _pc) && (--_occurrence == 0)) {
+        return index;
+      }
+      index++;
+    }
+    break;
+  }
+  return records_;
+}
+
+}  // namespace rtrace
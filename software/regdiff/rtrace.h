@@ -0,0 +1,300 @@
+// rtrace.h:
+//
+// The register file trace formats of the macro test harnesses.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// A register trace holds one record per retired instruction: The time (cycle)
+// and the 33 registers at..ra, hi, lo before the instruction writes back. The
+// text format is one line per record ('<time> at=<hex> ... lo=<hex>'). The
+// binary formats start with a 16-byte header of little-endian words:
+//
+//   magic ('OMRT'), format, registers (33), reserved (0)
+//
+// 'fixed' records are 34 little-endian words: time (low 32 bits) and the
+// registers. This is what the Verilog harness can write with '%u'. A harness
+// which writes '%u' words most-significant byte first produces a byte-swapped
+// magic, which readers accept by swapping every word.
+//
+// 'delta' and 'deflate' traces are a sequence of blocks of up to BLOCK_RECORDS
+// records. A block is 3 little-endian words (records, raw bytes, stored bytes)
+// followed by its payload, which is zlib-compressed for 'deflate'. Each record
+// of the payload is the varint time difference from the previous record, the
+// varint mask of the registers that changed, and the new value of each of
+// those registers (4 bytes, little-endian). The time and registers start from
+// zero at each block, so every block can be decoded on its own.
+//
+// The writer is header-only so that the harnesses can share it without
+// building this directory. It needs to be linked with zlib ('-lz').
+//
+#ifndef REGDIFF_RTRACE_H
+#define REGDIFF_RTRACE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace rtrace {
+
+// Instruction traces ('%08x    (<time>)' per line) are read but never written here
+enum Format : uint32_t { TEXT = 0, FIXED = 1, DELTA = 2, DEFLATE = 3, ITRACE = 4 };
+
+static constexpr uint32_t MAGIC = 0x54524d4f;  // "OMRT" in file order
+static constexpr int REGS = 33;
+static constexpr uint32_t HEADER_BYTES = 16;
+static constexpr uint32_t BLOCK_HEADER_BYTES = 12;
+static constexpr uint32_t BLOCK_RECORDS = 65536;
+static constexpr uint32_t FIXED_RECORD_BYTES = (REGS + 1) * 4;
+static constexpr uint32_t MAX_RECORD_BYTES = 10 + 5 + (REGS * 4);
+
+static const char *const LABELS[REGS] = {
+  "at", "v0", "v1", "a0", "a1", "a2", "a3", "t0", "t1", "t2", "t3",
+  "t4", "t5", "t6", "t7", "s0", "s1", "s2", "s3", "s4", "s5", "s6",
+  "s7", "t8", "t9", "k0", "k1", "gp", "sp", "fp", "ra", "hi", "lo"
+};
+
+struct Record {
+  uint64_t time;
+  uint32_t pc;               // Instruction traces only
+  uint32_t regs[REGS];       // Register traces only
+};
+
+// Convert a '+regtrace_format' name, returning false if it is not known
+inline bool parseFormat(const std::string &_name, Format &_format) {
+  static const char *const names[] = {"text", "fixed", "delta", "deflate"};
+  for (uint32_t i = 0; i < 4; i++) {
+    if (_name == names[i]) {
+      _format = static_cast<Format>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void putWord(uint8_t *_dest, uint32_t _value) {
+  _dest[0] = static_cast<uint8_t>(_value);
+  _dest[1] = static_cast<uint8_t>(_value >> 8);
+  _dest[2] = static_cast<uint8_t>(_value >> 16);
+  _dest[3] = static_cast<uint8_t>(_value >> 24);
+}
+
+inline uint32_t getWord(const uint8_t *_src) {
+  return _src[0] | (_src[1] << 8) | (_src[2] << 16) | (static_cast<uint32_t>(_src[3]) << 24);
+}
+
+inline uint8_t *putVarint(uint8_t *_dest, uint64_t _value) {
+  while (_value >= 0x80) {
+    *_dest++ = static_cast<uint8_t>(_value | 0x80);
+    _value >>= 7;
+  }
+  *_dest++ = static_cast<uint8_t>(_value);
+  return _dest;
+}
+
+class Writer {
+ public:
+  // The handle stays owned by the caller, who must call 'finish' before closing it
+  Writer(FILE *_handle, Format _format)
+      : handle_(_handle), format_(_format), records_(0), time_(0), regs_() {
+    if (format_ != TEXT) {
+      uint8_t header[HEADER_BYTES];
+      putWord(header, MAGIC);
+      putWord(header + 4, format_);
+      putWord(header + 8, REGS);
+      putWord(header + 12, 0);
+      fwrite(header, 1, HEADER_BYTES, handle_);
+    }
+    if (format_ >= DELTA) {
+      block_.reserve(BLOCK_RECORDS * 16);
+    }
+  }
+
+  void write(uint64_t _time, const uint32_t *_regs) {
+    switch (format_) {
+      case TEXT: {
+        // One fwrite per line: This is several times faster than a printf per register
+        static const char digits[] = "0123456789abcdef";
+        char line[24 + (REGS * 12)];
+        char *end = line + snprintf(line, 24, "%llu", static_cast<unsigned long long>(_time));
+        for (int i = 0; i < REGS; i++) {
+          end[0] = ' ';
+          end[1] = LABELS[i][0];
+          end[2] = LABELS[i][1];
+          end[3] = '=';
+          for (int d = 0; d < 8; d++) {
+            end[4 + d] = digits[(_regs[i] >> (28 - (4 * d))) & 0xf];
+          }
+          end += 12;
+        }
+        *end++ = '\n';
+        fwrite(line, 1, end - line, handle_);
+        break;
+      }
+      case FIXED: {
+        uint8_t record[FIXED_RECORD_BYTES];
+        putWord(record, static_cast<uint32_t>(_time));
+        for (int i = 0; i < REGS; i++) {
+          putWord(record + 4 + (i * 4), _regs[i]);
+        }
+        fwrite(record, 1, FIXED_RECORD_BYTES, handle_);
+        break;
+      }
+      default:
+        writeDelta(_time, _regs);
+        break;
+    }
+  }
+
+  // Write the last partial block
+  void finish() {
+    if (records_ > 0) {
+      flushBlock();
+    }
+    fflush(handle_);
+  }
+
+ private:
+  void writeDelta(uint64_t _time, const uint32_t *_regs) {
+    uint8_t record[MAX_RECORD_BYTES];
+    uint64_t mask = 0;
+    for (int i = 0; i < REGS; i++) {
+      mask |= static_cast<uint64_t>(_regs[i] != regs_[i]) << i;
+    }
+    uint8_t *end = putVarint(record, _time - time_);
+    end = putVarint(end, mask);
+    for (int i = 0; i < REGS; i++) {
+      if (mask & (1ull << i)) {
+        putWord(end, _regs[i]);
+        end += 4;
+        regs_[i] = _regs[i];
+      }
+    }
+    time_ = _time;
+    block_.insert(block_.end(), record, end);
+    if (++records_ == BLOCK_RECORDS) {
+      flushBlock();
+    }
+  }
+
+  void flushBlock() {
+    const uint8_t *payload = block_.data();
+    uLongf stored = block_.size();
+    if (format_ == DEFLATE) {
+      stored = compressBound(block_.size());
+      compressed_.resize(stored);
+      compress2(compressed_.data(), &stored, block_.data(), block_.size(), Z_DEFAULT_COMPRESSION);
+      payload = compressed_.data();
+    }
+    uint8_t header[BLOCK_HEADER_BYTES];
+    putWord(header, records_);
+    putWord(header + 4, static_cast<uint32_t>(block_.size()));
+    putWord(header + 8, static_cast<uint32_t>(stored));
+    fwrite(header, 1, BLOCK_HEADER_BYTES, handle_);
+    fwrite(payload, 1, stored, handle_);
+    block_.clear();
+    records_ = 0;
+    time_ = 0;
+    std::fill(regs_, regs_ + REGS, 0);
+  }
+
+  FILE *handle_;
+  Format format_;
+  uint32_t records_;         // Records in the current block
+  uint64_t time_;            // Time of the previous record in the block
+  uint32_t regs_[REGS];      // Registers of the previous record in the block
+  std::vector<uint8_t> block_;
+  std::vector<uint8_t> compressed_;
+};
+
+// Sequential reader of any trace format, chosen by the file contents
+class Reader {
+ public:
+  // Return a reader for the register trace, or nullptr with a message on stdout
+  // (instruction traces are only read through a 'Trace'). Text traces are
+  // memory-mapped and parsed in place unless '_map_text' is false, which
+  // selects the original (much slower) stream parser.
+  static std::unique_ptr<Reader> open(const std::string &_filename, bool _map_text = true);
+  virtual ~Reader() {}
+
+  // Read the next record, returning false at the end of the trace or at an error
+  virtual bool next(Record &_record) = 0;
+
+  // Advance past records without decoding them if possible, returning how many were skipped
+  virtual uint64_t skip(uint64_t _records);
+
+  // Do not print format errors, e.g., when reading ahead of the first difference
+  void setQuiet(bool _quiet) { quiet_ = _quiet; }
+
+ protected:
+  void error(const std::string &_message) const;
+
+ private:
+  bool quiet_ = false;
+};
+
+struct Mapping;
+
+// A memory-mapped trace with an index of record positions, which gives readers
+// starting at any record. The index has a checkpoint (record, file offset, and
+// time) every INDEX_INTERVAL records, or at every block of delta traces, and
+// for instruction traces the number of executions of each PC between two
+// checkpoints. Building it takes one pass over the file, split among
+// '_threads' threads for text traces, after which it is saved next to the
+// trace ('<trace>.idx') and reused while the trace is unchanged. Readers of the
+// same trace may be used concurrently from different threads.
+class Trace {
+ public:
+  static constexpr uint64_t INDEX_INTERVAL = 65536;
+
+  struct Checkpoint {
+    uint64_t record;
+    uint64_t offset;
+    uint64_t time;
+    uint64_t pcs;            // First entry of the interval in the PC counts
+  };
+
+  struct PcCount {
+    uint32_t pc;
+    uint32_t count;
+  };
+
+  // Return the trace, or nullptr with a message on stdout
+  static std::unique_ptr<Trace> open(const std::string &_filename, int _threads = 1,
+                                     uint64_t _interval = INDEX_INTERVAL);
+
+  Format format() const { return format_; }
+  uint64_t records() const { return records_; }
+
+  // Return a reader of the records from '_first' on
+  std::unique_ptr<Reader> reader(uint64_t _first) const;
+
+  // Return the first record at or after a time, or records() if there is none
+  uint64_t findTime(uint64_t _time) const;
+
+  // Return the record of the n-th (from 1) execution of a PC, or records() if
+  // there is none. Only instruction traces have PCs.
+  uint64_t findPc(uint32_t _pc, uint64_t _occurrence) const;
+
+ private:
+  Trace() = default;
+  void buildIndex(int _threads, uint64_t _interval);
+  bool loadIndex(const std::string &_filename);
+  void saveIndex(const std::string &_filename) const;
+
+  std::shared_ptr<const Mapping> mapping_;
+  Format format_;
+  bool swap_;
+  uint64_t records_;
+  std::vector<Checkpoint> checkpoints_;  // Sorted by record, starting at record 0
+  std::vector<PcCount> pc_counts_;       // Sorted by PC within each interval
+};
+
+}  // namespace rtrace
+
+#endif  // REGDIFF_RTRACE_H
@@ -0,0 +1,108 @@
+`timescale 1ns / 1ps
+/*
+ * File         : CPI_Stack.v
+ * Project      : MIPS32 MUX
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A test harness monitor which charges every processor cycle to one cause,
+ *   giving a CPI stack of the test. It observes the stall and flush signals of
+ *   the pipeline (most from 'Hazard_Detection') and has no effect on the design.
+ *
+ *   A cycle in which W1 retires an instruction is a base cycle. Otherwise, W1
+ *   either holds an instruction which cannot retire (the multiply/divide unit is
+ *   busy, or it is an exception) or a bubble. Bubbles are tagged with their cause
+ *   where they enter the pipeline, and the tag moves with the bubble to W1:
+ *
+ *     I-miss       : F2 waited for the i-cache (or a branch in D2 waited for it)
+ *     D-miss       : M2 waited for the d-cache
+ *     Load-use     : D2, X1, or M1 waited for data from an instruction in a memory
+ *                    stage (mostly loads; also sc and mul)
+ *     Mult/div     : X1 waited to read HI/LO
+ *     Branch flush : A jump or branch in D2 redirected fetch
+ *     Exception    : A pipeline flush from W1 (exceptions, interrupts, eret, and
+ *                    the serialization of CP0 writes), or reset
+ *
+ *   The counters sum to the number of cycles in which 'Enable' was set, which
+ *   the harnesses drive with the run bit of the command register so that they
+ *   match the test cycles. They are reported on 'Counts' in the order
+ *   {exception, branch, mult/div, load-use, D-miss, I-miss, base}.
+ */
+module CPI_Stack(
+    input             clock,
+    input             reset,
+    input             Enable,
+    input             W1_Issued,        // W1 retires an instruction
+    input             W1_M2Issued,      // W1 holds an instruction (which may not retire)
+    input             F1_Flush,
+    input             F2_Flush,
+    input             W1_Flush,
+    input             F2_Stall,
+    input             D1_Stall,
+    input             D2_Stall,
+    input             X1_Stall,
+    input             M1_Stall,
+    input             M2_Stall,
+    input             W1_Stall,
+    input             D2_Data_Stall,
+    input             X1_Data_Stall,
+    input             W1_ALU_Stall,
+    output [223:0]    Counts
+    );
+
+    localparam [2:0] BASE=3'd0, IMISS=3'd1, DMISS=3'd2, LOADUSE=3'd3, MULDIV=3'd4, BRANCH=3'd5, EXCEPTION=3'd6;
+
+    // Cause of the bubble (if any) in each stage, and of F1 not fetching
+    reg [2:0] F1_Tag, F2_Tag, D1_Tag, D2_Tag, X1_Tag, M1_Tag, M2_Tag, W1_Tag;
+
+    // Cause of a bubble left behind by a stage which stalls on its own (i.e., the next stage does not stall)
+    wire [2:0] D2_Own = (D2_Data_Stall) ? LOADUSE : IMISS;
+    wire [2:0] X1_Own = (X1_Data_Stall) ? LOADUSE : MULDIV;
+
+    // Cause of this cycle
+    wire [2:0] Cause = (W1_Issued) ? BASE : ((W1_M2Issued) ? ((W1_ALU_Stall) ? MULDIV : EXCEPTION) : W1_Tag);
+
+    always @(posedge clock) begin
+        if (reset | W1_Flush) begin
+            F1_Tag <= EXCEPTION;
+            F2_Tag <= EXCEPTION;
+            D1_Tag <= EXCEPTION;
+            D2_Tag <= EXCEPTION;
+            X1_Tag <= EXCEPTION;
+            M1_Tag <= EXCEPTION;
+            M2_Tag <= EXCEPTION;
+            W1_Tag <= EXCEPTION;
+        end
+        else begin
+            F1_Tag <= (F1_Flush) ? BRANCH : F1_Tag;
+            F2_Tag <= (F2_Stall) ? F2_Tag : ((F1_Flush) ? BRANCH : F1_Tag);
+            D1_Tag <= (D1_Stall) ? D1_Tag : ((F2_Flush) ? BRANCH : ((F2_Stall) ? IMISS : F2_Tag));
+            D2_Tag <= (D2_Stall) ? D2_Tag : D1_Tag;
+            X1_Tag <= (X1_Stall) ? X1_Tag : ((D2_Stall) ? D2_Own : D2_Tag);
+            M1_Tag <= (M1_Stall) ? M1_Tag : ((X1_Stall) ? X1_Own : X1_Tag);
+            M2_Tag <= (M2_Stall) ? M2_Tag : ((M1_Stall) ? LOADUSE : M1_Tag);
+            W1_Tag <= (W1_Stall) ? W1_Tag : ((M2_Stall) ? DMISS : M2_Tag);
+        end
+    end
+
+    reg [31:0] Count [0:6];
+    integer i;
+
+    initial begin
+        for (i = 0; i < 7; i = i + 1) begin
+            Count[i] = 32'd0;
+        end
+    end
+
+    always @(posedge clock) begin
+        if (Enable) begin
+            Count[Cause] <= Count[Cause] + 32'd1;
+        end
+    end
+
+    assign Counts = {Count[6], Count[5], Count[4], Count[3], Count[2], Count[1], Count[0]};
+
+endmodule
@@ -0,0 +1,212 @@
+`timescale 1ns / 1ps
+/*
+ * File         : Pipe_Trace.v
+ * Project      : MIPS32 MUX
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A test harness monitor which writes a pipeline trace in the Kanata log format
+ *   of the Konata pipeline viewer (https://github.com/shioyadan/Konata). Every
+ *   fetch is an instruction of the trace, which shows the cycle it entered each
+ *   of the eight stages (F1, F2, D1, D2, X1, M1, M2, W1), the cycles in which it
+ *   was held by a stall (lane 1, 'stl'), and whether it retired or was flushed.
+ *   Instructions are labeled with their PC, and their instruction word is shown
+ *   once they reach D1.
+ *
+ *   The harness describes the pipeline each cycle with three vectors of one bit
+ *   per stage ({W1, M2, M1, X1, D2, D1, F2, F1}):
+ *
+ *     In   : The stage holds an instruction (or an exception moving to W1)
+ *     Out  : The instruction leaves the stage at the end of the cycle (for W1: it retires)
+ *     Hold : The stage is stalled and not flushed, so the instruction stays
+ *
+ *   An instruction which does neither is flushed (by a branch or exception, or
+ *   the nullified delay slot of a branch-likely). This is a monitor only, and it
+ *   is driven by tasks from the test loop of 'mips_test.v' so that the cycle
+ *   numbers match the other traces: 'open' before the test, 'sample' each cycle,
+ *   and 'close' at the end. The Verilator harness does the same in C++.
+ */
+module Pipe_Trace(
+    input  [7:0]  In,
+    input  [7:0]  Out,
+    input  [7:0]  Hold,
+    input         Reset,            // The processor is in reset: Everything is flushed
+    input  [31:0] F1_PC,            // The PC of a new fetch
+    input  [31:0] D1_Instruction    // The instruction word in D1
+    );
+
+    integer handle;
+    integer started;                // The first cycle has been written
+    reg [31:0] last_cycle;          // Cycle of the most recent line
+    reg [31:0] next_id;             // Konata id of the next fetch
+    reg [31:0] retired;             // Number of retired instructions
+
+    // The instruction in each stage (F1 is index 0)
+    reg [31:0] id      [0:7];
+    reg [7:0]  valid;
+    reg [7:0]  fresh;               // It entered the stage this cycle
+    reg [7:0]  stalled;             // Lane 1 shows a stall
+
+    // Instructions which retired (or were flushed) last cycle
+    reg [31:0] end_id  [0:7];
+    reg [7:0]  end_valid;
+    reg [7:0]  end_flush;
+
+    reg [31:0] nxt_id  [0:7];
+    reg [7:0]  nxt_valid;
+    reg [7:0]  nxt_fresh;
+
+    integer s;
+
+    function [15:0] stage_name;
+        input integer stage;
+        begin
+            case (stage)
+                0: stage_name = "F1";
+                1: stage_name = "F2";
+                2: stage_name = "D1";
+                3: stage_name = "D2";
+                4: stage_name = "X1";
+                5: stage_name = "M1";
+                6: stage_name = "M2";
+                default: stage_name = "W1";
+            endcase
+        end
+    endfunction
+
+    // Move the trace to a cycle before writing a line in it
+    task at;
+        input [31:0] cycle;
+        begin
+            if (!started) begin
+                $fwrite(handle, "C=\t%0d\n", cycle);
+                started = 1;
+            end
+            else if (cycle != last_cycle) begin
+                $fwrite(handle, "C\t%0d\n", cycle - last_cycle);
+            end
+            last_cycle = cycle;
+        end
+    endtask
+
+    task open;
+        input [1024*8:1] filename;
+        begin
+            handle = $fopen(filename, "w");
+            $fwrite(handle, "Kanata\t0004\n");
+            started   = 0;
+            last_cycle = 0;
+            next_id   = 0;
+            retired   = 0;
+            valid     = 8'h00;
+            fresh     = 8'h00;
+            stalled   = 8'h00;
+            end_valid = 8'h00;
+        end
+    endtask
+
+    task close;
+        begin
+            $fclose(handle);
+        end
+    endtask
+
+    // Record one cycle of the pipeline, which must be sampled before the clock edge
+    task sample;
+        input [31:0] cycle;
+        begin
+            // Retirements and flushes of the previous cycle
+            for (s = 7; s >= 0; s = s - 1) begin
+                if (end_valid[s]) begin
+                    at(cycle);
+                    $fwrite(handle, "R\t%0d\t%0d\t%0d\n", end_id[s], (end_flush[s]) ? 32'd0 : retired, end_flush[s]);
+                    if (!end_flush[s]) begin
+                        retired = retired + 1;
+                    end
+                end
+            end
+            end_valid = 8'h00;
+
+            // Instructions which are gone without leaving their stage (e.g., a reset)
+            for (s = 7; s >= 0; s = s - 1) begin
+                if (valid[s] && !(In[s] && !Reset)) begin
+                    at(cycle);
+                    if (stalled[s]) begin
+                        $fwrite(handle, "E\t%0d\t1\tstl\n", id[s]);
+                        stalled[s] = 1'b0;
+                    end
+                    $fwrite(handle, "R\t%0d\t0\t1\n", id[s]);
+                    valid[s] = 1'b0;
+                end
+            end
+
+            // Instructions entering a stage
+            for (s = 7; s >= 1; s = s - 1) begin
+                if (valid[s] && fresh[s]) begin
+                    at(cycle);
+                    $fwrite(handle, "S\t%0d\t0\t%0s\n", id[s], stage_name(s));
+                    if (s == 2) begin
+                        $fwrite(handle, "L\t%0d\t1\t%08h\n", id[s], D1_Instruction);
+                    end
+                end
+            end
+            if (In[0] && !Reset) begin
+                at(cycle);
+                $fwrite(handle, "I\t%0d\t%0d\t0\nL\t%0d\t0\t%08h\nS\t%0d\t0\tF1\n", next_id, next_id, next_id, F1_PC, next_id);
+                id[0]    = next_id;
+                valid[0] = 1'b1;
+                next_id  = next_id + 1;
+            end
+
+            // Stalls
+            for (s = 7; s >= 0; s = s - 1) begin
+                if (valid[s] && Hold[s] && !stalled[s]) begin
+                    at(cycle);
+                    $fwrite(handle, "S\t%0d\t1\tstl\n", id[s]);
+                    stalled[s] = 1'b1;
+                end
+                else if (stalled[s] && !Hold[s]) begin
+                    at(cycle);
+                    $fwrite(handle, "E\t%0d\t1\tstl\n", id[s]);
+                    stalled[s] = 1'b0;
+                end
+            end
+
+            // Where each instruction goes at the clock edge
+            nxt_valid = 8'h00;
+            nxt_fresh = 8'h00;
+            for (s = 7; s >= 0; s = s - 1) begin
+                if (valid[s]) begin
+                    if (Out[s] && (s == 7)) begin
+                        end_id[s]    = id[s];
+                        end_valid[s] = 1'b1;
+                        end_flush[s] = 1'b0;
+                    end
+                    else if (Out[s]) begin
+                        nxt_id[s+1]    = id[s];
+                        nxt_valid[s+1] = 1'b1;
+                        nxt_fresh[s+1] = 1'b1;
+                    end
+                    else if (Hold[s]) begin
+                        nxt_id[s]    = id[s];
+                        nxt_valid[s] = 1'b1;
+                    end
+                    else begin
+                        end_id[s]    = id[s];
+                        end_valid[s] = 1'b1;
+                        end_flush[s] = 1'b1;
+                    end
+                end
+            end
+            for (s = 0; s < 8; s = s + 1) begin
+                id[s] = nxt_id[s];
+            end
+            valid = nxt_valid;
+            fresh = nxt_fresh;
+        end
+    endtask
+
+endmodule
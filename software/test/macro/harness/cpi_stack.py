@@ -0,0 +1,51 @@
+#!/usr/bin/python
+
+# Reports the CPI stacks of a set of tests: The cycles of each test
+# broken down by cause, as written by the simulation harnesses with
+# '+stalltrace' (one 'name count' pair per line, see 'CPI_Stack.v').
+#
+# Author: Grant Ayers (ayers@cs.stanford.edu)
+
+from __future__ import print_function
+import argparse
+import os
+
+causes = ['base', 'icache_miss', 'dcache_miss', 'load_use', 'mult_div', 'branch_flush', 'exception']
+titles = ['Base', 'I-miss', 'D-miss', 'Load-use', 'Mul/div', 'Branch', 'Except']
+
+def parse_stalls(filename):
+    counts = {}
+    stalls_file = open(filename)
+    for line in stalls_file:
+        columns = line.split()
+        if len(columns) == 2:
+            try:
+                counts[columns[0]] = int(columns[1])
+            except ValueError:
+                pass
+    stalls_file.close()
+    return counts
+
+def display_stalls(filenames):
+    print('{0} {1:>10} {2:>6}  {3}'.format('Test'.ljust(20), 'Cycles', 'CPI',
+          ' '.join(t.rjust(8) for t in titles)))
+    for filename in sorted(filenames):
+        counts = parse_stalls(filename)
+        name = os.path.basename(os.path.dirname(os.path.abspath(filename)))
+        cycles = counts.get('cycles', 0)
+        instructions = counts.get('instructions', 0)
+        cpi = '{0:.3f}'.format(float(cycles) / instructions) if instructions else '-'
+        # Each cause as its share of the CPI
+        shares = [(float(counts.get(c, 0)) / instructions) if instructions else 0.0 for c in causes]
+        print('{0} {1:>10} {2:>6}  {3}'.format(name.ljust(20), cycles, cpi,
+              ' '.join('{0:8.3f}'.format(s) for s in shares)))
+
+def main():
+    desc = "MIPS test harness: Reports the CPI stacks of a set of tests."
+    cl_parser = argparse.ArgumentParser(description=desc)
+    cl_parser.add_argument('stalls', nargs='+', help='CPI stack files (test.stalls) to report')
+    cl_args = cl_parser.parse_args()
+    display_stalls(cl_args.stalls)
+
+if __name__ == '__main__':
+    main()
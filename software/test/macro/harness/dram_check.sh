@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+#
+# Given the minimum DRAM counts of a test, its simulation log, and an output file name,
+# write '0' to the output if the log has no DRAM counts or any count is less than its
+# minimum, otherwise do not modify the output file.
+#
+# The minimums are 'name=count' pairs, where the names are those of the counters of
+# 'MainMemory_DRAM' as printed at the end of a test: hits, empty, conflicts, queue,
+# and refreshes. For example, 'hits=1000 conflicts=100'.
+#
+# Author: Grant Ayers
+#
+if [ -e $1 ] ; then
+    DRAM_LINE=$(grep '^DRAM: ' $2 2>/dev/null | tail -n 1)
+    if [ -z "$DRAM_LINE" ] ; then
+        echo "Cannot find the DRAM counts in '$2'"
+        echo "0" > $3
+        exit
+    fi
+    read hits empty conflicts queue refreshes <<< $(echo "$DRAM_LINE" | grep -o '=[0-9]*' | tr -d '=' | tr '\n' ' ')
+    for MIN in $(< $1) ; do
+        NAME=${MIN%%=*}
+        if [[ "${!NAME}" -lt "${MIN#*=}" ]] ; then
+            echo "DRAM $NAME=${!NAME} is less than ${MIN#*=} in '$2'"
+            echo "0" > $3
+        fi
+    done
+fi
@@ -0,0 +1,142 @@
+#!/usr/bin/python
+
+# Writes the linker script of a test program for a vm region of a given size.
+#
+# Tests without their own linker script in 'src/app' are linked with this one
+# (see 'Makefile_MIPS'), so they use all of the vm region of the harness
+# ('VM_KB'). The program starts at virtual address 0, as in the fixed 256 KiB
+# scripts of the other tests:
+#
+#   Instructions : 0 -> text size
+#   Data / BSS   : text size -> end of the program data
+#   Heap         : (1 KiB aligned) -> stack
+#   Stack        : size - stack size -> size
+#
+# The heap takes everything between the data and the stack, and linking fails
+# if the program does not fit.
+#
+# Author: Grant Ayers (ayers@cs.stanford.edu)
+
+from __future__ import print_function
+import argparse
+import sys
+
+TEMPLATE = '''/* Linker script for MIPS32 (Single Core) using {size_kb} KiB of memory */
+/* Generated by 'harness/gen_ld.py': Do not edit */
+
+
+/* Entry Point
+ *
+ * Set it to be the label "startup" (likely in startup.asm)
+ *
+ */
+ENTRY(startup)
+
+
+/* Memory Section
+ *
+ * Configuration for {size_kb} KiB of memory:
+ *
+ * Instruction Memory starts at address 0.
+ *
+ * Data Memory ends {size_kb} KiB later, at address 0x{size:08x} (the last
+ * usable word address is 0x{last:08x}).
+ *
+ *   Instructions :    0x00000000 -> 0x{text_last:08x}    ({text_kb:5d} KiB)
+ *   Data / BSS   :    0x{text:08x} -> (program data)
+ *   Heap         :    (program data) -> 0x{heap_last:08x}
+ *   Stack        :    0x{stack:08x} -> 0x{last:08x}    ({stack_kb:5d} KiB)
+ */
+
+SECTIONS
+{{
+  . = 0 ;
+
+  .text :
+  {{
+    *(.startup)
+    *(.*text*)
+  }}
+
+  ASSERT(. <= 0x{text:08x}, "The program text does not fit in {text_kb} KiB")
+  . = 0x{text:08x} ;
+
+  .data :
+  {{
+    *(.rodata*)
+    *(.data*)
+  }}
+
+  . = ALIGN(1024);
+  _gp = .;
+
+  .got :
+  {{
+    *(.got)
+  }}
+
+  .sdata :
+  {{
+    *(.*sdata*)
+  }}
+
+  .MIPS.abiflags :
+  {{
+    *(.MIPS.abiflags)
+  }}
+
+  . = ALIGN(4);
+  _bss_start = . ;
+
+  .sbss :
+  {{
+    *(.*sbss)
+  }}
+
+  .bss :
+  {{
+    *(.*bss)
+  }}
+
+  _bss_end = . ;
+
+  . = ALIGN(1024);
+
+  _heap_start = . ;
+  _heap_end = 0x{stack:08x};
+  _sp = 0x{size:08x} ;
+
+  ASSERT(_heap_start <= _heap_end, "The program data does not fit in {size_kb} KiB with a {stack_kb} KiB stack")
+}}
+'''
+
+def power_of_two(value):
+    return (value > 0) and ((value & (value - 1)) == 0)
+
+def main():
+    parser = argparse.ArgumentParser(description='Write the linker script of a test program for a vm region')
+    parser.add_argument('output', help='Linker script file name')
+    parser.add_argument('--size', type=int, required=True, help='Size of the vm region in KiB (a power of two)')
+    parser.add_argument('--text', type=int, default=0,
+                        help='Instruction memory in KiB (default: 1/8 of the region, at least 128)')
+    parser.add_argument('--stack', type=int, default=64, help='Stack size in KiB (default: 64)')
+    args = parser.parse_args()
+
+    text_kb = args.text if args.text else max(128, args.size // 8)
+    if not power_of_two(args.size):
+        print('The vm size must be a power of two (not {0} KiB)'.format(args.size))
+        return 1
+    if text_kb + args.stack >= args.size:
+        print('The text ({0} KiB) and stack ({1} KiB) do not fit in {2} KiB'.format(text_kb, args.stack, args.size))
+        return 1
+
+    size = args.size * 1024
+    stack = size - (args.stack * 1024)
+    text = text_kb * 1024
+    with open(args.output, 'w') as f:
+        f.write(TEMPLATE.format(size_kb=args.size, size=size, last=size - 4, text=text, text_last=text - 4,
+                                text_kb=text_kb, heap_last=stack - 4, stack=stack, stack_kb=args.stack))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
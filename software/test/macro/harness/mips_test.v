@@ -16,7 +16,7 @@
  *   The three input memory images correspond to different physical memory regions:
  *     1. Kernel Low (klo)    : [0x00000000 - 0x00004000) (16 KiB)
  *     2. Kernel High (khi)   : [0x1fc00000 - 0x1fc04000) (16 KiB)
- *     3. Virtual memory (vm) : [0x80000000 - 0x80040000) (256 KiB)
+ *     3. Virtual memory (vm) : [VM_BASE - VM_BASE + VM_KB KiB) (default 0x80000000, 4 MiB)
  *
  *   The khi region contains the boot code. The processor starts at virtual address
  *   0xbfc00000 which  always maps to physical address 0x1fc00000. Hence khi begins
@@ -28,7 +28,9 @@
  *   The vm region is for user code. It is called "virtual" because the user code
  *   assumes it starts at virtual address zero which actually translates to
  *   physical address 0x80000000. It is the only memory region which is fully-mapped
- *   and cacheable.
+ *   and cacheable. Its size and base are set by the parameters 'VM_KB' (a power of two)
+ *   and 'VM_BASE' (aligned to the size and at or above 0x20000000). All physical
+ *   addresses above the base select it, so the region repeats every VM_KB KiB.
  *
  *   In addition to the three memory regions, there are five 32-bit test registers:
  *     1. Reset Register   : 0x1fffffec  (virtual 0xbfffffec)
@@ -50,11 +52,54 @@
  *       of the buffer is reached.
  *   - The test register is set to 1 (success) or 0 (failure) before the test terminates.
  *   - The scratch register may be used arbitrarily by tests.
+ *
+ *   With '+stalltrace=<file>', the cycles of the test are broken down by cause (a CPI
+ *   stack: base, I-miss, D-miss, load-use, mult/div, branch flush, exception) and
+ *   written to the file at the end of the test. See 'CPI_Stack.v'.
+ *
+ *   With the parameter 'DRAM', the vm region has the timing of a DRAM ('MainMemory_DRAM.v')
+ *   instead of a fixed latency, and its row buffer and queueing counters are printed at the
+ *   end of the test.
+ *
+ *   With '+pipetrace=<file>', the stages, stalls, and flushes of every instruction are
+ *   written in the log format of the Konata pipeline viewer. See 'Pipe_Trace.v'.
  */
-module mips_test();
+module mips_test #(
+    parameter VM_KB          = 4096,            // Size of the vm region in KiB (a power of two)
+    parameter VM_BASE        = 32'h80000000,    // Physical base address of the vm region
+    parameter DRAM           = 0,               // Time the vm region as a DRAM (see 'MainMemory_DRAM.v')
+    parameter DRAM_T_CTRL    = 10,              // DRAM timing (cycles) and geometry: The parameters of 'MainMemory_DRAM'
+    parameter DRAM_T_RCD     = 3,
+    parameter DRAM_T_CAS     = 3,
+    parameter DRAM_T_RP      = 3,
+    parameter DRAM_T_BURST   = 1,
+    parameter DRAM_BANK_BITS = 3,
+    parameter DRAM_COL_BITS  = 7,
+    parameter DRAM_T_REFI    = 780,
+    parameter DRAM_T_RFC     = 11
+    )();
 
     localparam PABITS=32;
     localparam Big_Endian = 1'b0;   // For now this must be updated manually
+    localparam Early_Restart = 1;   // Critical-word-first memory and early restart in the caches
+    localparam Prefetch = 0;        // Cache prefetchers (their counters are printed at the end of the test)
+
+    // Line (16-byte) address width of a memory region of 'kb' KiB
+    function integer line_bits;
+        input integer kb;
+        integer lines;
+        begin
+            line_bits = 0;
+            for (lines = kb * 64; lines > 1; lines = lines >> 1) begin
+                line_bits = line_bits + 1;
+            end
+        end
+    endfunction
+
+    localparam VM_ADDR_WIDTH = line_bits(VM_KB);
+    localparam [31:0] VM_BASE_ADDR = VM_BASE;
+
+    wire [159:0] dram_counts;   // {refreshes, queue cycles, row conflicts, row empty, row hits} of the vm region
 
     reg clock;
     reg reset;
@@ -73,9 +118,13 @@ module mips_test();
     integer write_test_result;
     integer write_scratch_result;
     integer write_test_cycles;
+    integer write_test_instructions;
     integer dump_vars;
     integer itrace;
     integer regtrace;
+    integer regtrace_fixed;
+    integer stalltrace;
+    integer pipetrace;
     integer stdout;
     integer itrace_handle;
     integer regtrace_handle;
@@ -88,13 +137,18 @@ module mips_test();
     reg  [1024*8:1] test_result_filename;
     reg  [1024*8:1] test_scratch_filename;
     reg  [1024*8:1] test_cycles_filename;
+    reg  [1024*8:1] test_instructions_filename;
     reg  [1024*8:1] dump_vars_filename;
     reg  [1024*8:1] itrace_filename;
     reg  [1024*8:1] regtrace_filename;
+    reg  [8*8:1]    regtrace_format;
+    reg  [1024*8:1] stalltrace_filename;
+    reg  [1024*8:1] pipetrace_filename;
     reg  [1024*8:1] stdout_filename;
 
     reg  [32:1] num_cycles = 32'hFFFFFFFF;
     reg  [32:1] cycle_count = 0;
+    reg  [32:1] instruction_count = 0;
 
     // Initialize testbench parameters.
     integer result;
@@ -106,9 +160,13 @@ module mips_test();
         write_test_result    = $value$plusargs("test_result=%s", test_result_filename);
         write_scratch_result = $value$plusargs("scratch_result=%s", test_scratch_filename);
         write_test_cycles    = $value$plusargs("test_cycles=%s", test_cycles_filename);
+        write_test_instructions = $value$plusargs("test_instructions=%s", test_instructions_filename);
         dump_vars            = $value$plusargs("dumpvars=%s", dump_vars_filename);
         itrace               = $value$plusargs("itrace=%s", itrace_filename);
         regtrace             = $value$plusargs("regtrace=%s", regtrace_filename);
+        regtrace_fixed       = $value$plusargs("regtrace_format=%s", regtrace_format) && (regtrace_format != "text");
+        stalltrace           = $value$plusargs("stalltrace=%s", stalltrace_filename);
+        pipetrace            = $value$plusargs("pipetrace=%s", pipetrace_filename);
         stdout               = $value$plusargs("stdout=%s", stdout_filename);
 
         // Fill memories
@@ -125,8 +183,8 @@ module mips_test();
             $display("No kernel low memory");
         end
         if (read_vm_mem) begin
-            $display("Virtual memory: %0s", vm_mem_filename);
-            $readmemh(vm_mem_filename, vm_mem.MainRAM.ram);
+            $display("Virtual memory: %0s (%0d KiB at 0x%h)", vm_mem_filename, VM_KB, VM_BASE_ADDR);
+            $readmemh(vm_mem_filename, vm.vm_mem.MainRAM.ram);
         end else begin
             $display("No virtual memory region");
         end
@@ -141,6 +199,16 @@ module mips_test();
             $display("Register file trace enabled: %0s", regtrace_filename);
         end
 
+        // CPI stack status
+        if (stalltrace) begin
+            $display("CPI stack enabled: %0s", stalltrace_filename);
+        end
+
+        // Pipeline trace status
+        if (pipetrace) begin
+            $display("Pipeline trace enabled: %0s", pipetrace_filename);
+        end
+
         // Stdout status
         if (stdout) begin
             $display("Stdout enabled: %0s", stdout_filename);
@@ -172,11 +240,25 @@ module mips_test();
             itrace_handle = $fopen(itrace_filename, "w");
         end
 
-        // Open the register file trace (if enabled)
-        if (regtrace) begin
+        // Open the register file trace (if enabled). The binary trace has fixed-size records of
+        // little-endian words after a header (see 'software/regdiff/rtrace.h'). The smaller
+        // delta-encoded formats are only written by the C++ harnesses.
+        if (regtrace && regtrace_fixed) begin
+            if (regtrace_format != "fixed") begin
+                $display("Register trace format '%0s' is not supported: Using 'fixed'", regtrace_format);
+            end
+            regtrace_handle = $fopen(regtrace_filename, "wb");
+            $fwrite(regtrace_handle, "%u%u%u%u", 32'h54524d4f, 32'd1, 32'd33, 32'd0);
+        end
+        else if (regtrace) begin
             regtrace_handle = $fopen(regtrace_filename, "w");
         end
 
+        // Open the pipeline trace (if enabled)
+        if (pipetrace) begin
+            PipeTrace.open(pipetrace_filename);
+        end
+
         // Open the stdout log file (if enabled)
         if (stdout) begin
             stdout_handle = $fopen(stdout_filename, "w");
@@ -195,6 +277,9 @@ module mips_test();
         while (cycle_count > 0 & ~mips_sta_reg[0]) begin
             cycle_count = cycle_count - 1;
             reset = (mips_rst_reg == 32'd1);
+            if (mips32_top.Core.W1_Issued) begin
+                instruction_count = instruction_count + 1;
+            end
 
             // Conditionally output an instruction trace element
             if (itrace && mips32_top.Core.W1_Issued) begin
@@ -208,7 +293,22 @@ module mips_test();
             end
 
             // Conditionally output a register file trace element
-            if (regtrace && mips32_top.Core.W1_Issued) begin
+            if (regtrace && regtrace_fixed && mips32_top.Core.W1_Issued) begin
+                $fwrite(regtrace_handle, "%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u",
+                  $stime, mips32_top.Core.RegisterFile.registers[1], mips32_top.Core.RegisterFile.registers[2],
+                  mips32_top.Core.RegisterFile.registers[3], mips32_top.Core.RegisterFile.registers[4], mips32_top.Core.RegisterFile.registers[5],
+                  mips32_top.Core.RegisterFile.registers[6], mips32_top.Core.RegisterFile.registers[7], mips32_top.Core.RegisterFile.registers[8],
+                  mips32_top.Core.RegisterFile.registers[9], mips32_top.Core.RegisterFile.registers[10], mips32_top.Core.RegisterFile.registers[11],
+                  mips32_top.Core.RegisterFile.registers[12], mips32_top.Core.RegisterFile.registers[13], mips32_top.Core.RegisterFile.registers[14],
+                  mips32_top.Core.RegisterFile.registers[15], mips32_top.Core.RegisterFile.registers[16], mips32_top.Core.RegisterFile.registers[17],
+                  mips32_top.Core.RegisterFile.registers[18], mips32_top.Core.RegisterFile.registers[19], mips32_top.Core.RegisterFile.registers[20],
+                  mips32_top.Core.RegisterFile.registers[21], mips32_top.Core.RegisterFile.registers[22], mips32_top.Core.RegisterFile.registers[23],
+                  mips32_top.Core.RegisterFile.registers[24], mips32_top.Core.RegisterFile.registers[25], mips32_top.Core.RegisterFile.registers[26],
+                  mips32_top.Core.RegisterFile.registers[27], mips32_top.Core.RegisterFile.registers[28], mips32_top.Core.RegisterFile.registers[29],
+                  mips32_top.Core.RegisterFile.registers[30], mips32_top.Core.RegisterFile.registers[31], mips32_top.Core.ALU.HI.Q, mips32_top.Core.ALU.LO.Q
+                );
+            end
+            else if (regtrace && mips32_top.Core.W1_Issued) begin
                 $fwrite(regtrace_handle, "%0d at=%08h v0=%08h v1=%08h a0=%08h a1=%08h a2=%08h a3=%08h t0=%08h t1=%08h t2=%08h t3=%08h t4=%08h t5=%08h t6=%08h t7=%08h s0=%08h s1=%08h s2=%08h s3=%08h s4=%08h s5=%08h s6=%08h s7=%08h t8=%08h t9=%08h k0=%08h k1=%08h gp=%08h sp=%08h fp=%08h ra=%08h hi=%08h lo=%08h\n",
                   $stime, mips32_top.Core.RegisterFile.registers[1], mips32_top.Core.RegisterFile.registers[2],
                   mips32_top.Core.RegisterFile.registers[3], mips32_top.Core.RegisterFile.registers[4], mips32_top.Core.RegisterFile.registers[5],
@@ -224,6 +324,11 @@ module mips_test();
                 );
             end
 
+            // Conditionally record the pipeline of this cycle
+            if (pipetrace) begin
+                PipeTrace.sample(num_cycles - cycle_count - 1);
+            end
+
             // Conditionally print the output buffer to the stdout file log
             // (e.g., 'printf', enabled by bit 1 of the status register)
             if (stdout && mips_sta_reg[1]) begin
@@ -254,6 +359,12 @@ module mips_test();
         if (itrace) begin
             $fclose(itrace_handle);
         end
+        if (regtrace) begin
+            $fclose(regtrace_handle);
+        end
+        if (pipetrace) begin
+            PipeTrace.close;
+        end
         if (stdout) begin
             $fclose(stdout_handle);
         end
@@ -262,6 +373,14 @@ module mips_test();
         $display("status register = %0d", mips_sta_reg);
         $display("test register = %0d", mips_tst_reg);
         $display("scratch register = %0d", mips_scr_reg);
+        if (DRAM) begin
+            $display("DRAM: row hits=%0d empty=%0d conflicts=%0d queue cycles=%0d refreshes=%0d", dram_counts[31:0],
+                dram_counts[63:32], dram_counts[95:64], dram_counts[127:96], dram_counts[159:128]);
+        end
+        if (Prefetch) begin
+            $display("I-cache prefetch: issued=%0d useful=%0d misses=%0d", mips32_top.ICache.pf_issued, mips32_top.ICache.pf_useful, mips32_top.ICache.pf_misses);
+            $display("D-cache prefetch: issued=%0d useful=%0d misses=%0d", mips32_top.DCache.pf_issued, mips32_top.DCache.pf_useful, mips32_top.DCache.pf_misses);
+        end
 
         mips_cmd_reg[0] = 1'b0;
 
@@ -286,6 +405,22 @@ module mips_test();
             $fclose(i);
         end
 
+        // Write the number of retired instructions.
+        if (write_test_instructions) begin
+            i = $fopen(test_instructions_filename, "w");
+            $fwrite(i, "%0d\n", instruction_count);
+            $fclose(i);
+        end
+
+        // Write the CPI stack: The cycles charged to each cause (see 'CPI_Stack.v')
+        if (stalltrace) begin
+            i = $fopen(stalltrace_filename, "w");
+            $fwrite(i, "cycles %0d\ninstructions %0d\nbase %0d\nicache_miss %0d\ndcache_miss %0d\nload_use %0d\nmult_div %0d\nbranch_flush %0d\nexception %0d\n",
+              num_cycles - cycle_count, CpiStack.Count[0], CpiStack.Count[0], CpiStack.Count[1], CpiStack.Count[2], CpiStack.Count[3],
+              CpiStack.Count[4], CpiStack.Count[5], CpiStack.Count[6]);
+            $fclose(i);
+        end
+
         $finish;
     end
 
@@ -326,13 +461,13 @@ module mips_test();
     wire         klow_D_ReadLine;
     wire         klow_D_ReadWord;
     wire         klow_D_Ready;
-    wire [15:0]  vm_I_Address;
+    wire [(VM_ADDR_WIDTH+1):0] vm_I_Address;
     wire [31:0]  vm_I_DataOut;
     wire         vm_I_Ready;
     wire [1:0]   vm_I_DataOutOffset;
     wire         vm_I_ReadLine;
     wire         vm_I_ReadWord;
-    wire [15:0]  vm_D_Address;
+    wire [(VM_ADDR_WIDTH+1):0] vm_D_Address;
     wire [127:0] vm_D_DataIn;
     wire         vm_D_LineInReady;
     wire         vm_D_WordInReady;
@@ -368,8 +503,8 @@ module mips_test();
     wire khigh_sel_d  = (DataMem_Address >= 30'h07f00000) && (DataMem_Address < 30'h07f01000);
     wire klow_sel_i   = (InstMem_Address < 30'h1000);
     wire klow_sel_d   = (DataMem_Address < 30'h1000);
-    wire vm_sel_i     = (InstMem_Address >= 30'h20000000);
-    wire vm_sel_d     = (DataMem_Address >= 30'h20000000);
+    wire vm_sel_i     = (InstMem_Address >= VM_BASE_ADDR[31:2]);
+    wire vm_sel_d     = (DataMem_Address >= VM_BASE_ADDR[31:2]);
     wire rst_sel_d    = (DataMem_Address == 30'h07fffffb);
     wire cmd_sel_d    = (DataMem_Address == 30'h07fffffc);
     wire status_sel_d = (DataMem_Address == 30'h07fffffd);
@@ -378,7 +513,7 @@ module mips_test();
 
     // Kernel high memory - 16 KiB [0x1fc00000 - 0x1fc04000)
     // NOTE: Currently using last 1 KiB for an output buffer [0x1fc03c00 - 0x1fc04000)
-    MainMemory #(.ADDR_WIDTH(10)) khigh_mem (
+    MainMemory #(.ADDR_WIDTH(10), .CRIT_WORD_FIRST(Early_Restart)) khigh_mem (
         .clock            (clock),
         .reset            (reset),
         .I_Address        (khigh_I_Address),
@@ -402,7 +537,7 @@ module mips_test();
     );
 
     // Kernel low memory - 16 KiB [0x00000000 - 0x00004000)
-    MainMemory #(.ADDR_WIDTH(10)) klow_mem (
+    MainMemory #(.ADDR_WIDTH(10), .CRIT_WORD_FIRST(Early_Restart)) klow_mem (
         .clock            (clock),
         .reset            (reset),
         .I_Address        (klow_I_Address),
@@ -425,32 +560,64 @@ module mips_test();
         .D_Ready          (klow_D_Ready)
     );
 
-    // Virtual memory - 256 KiB [0x80000000 - 0x80040000)
-    MainMemory #(.ADDR_WIDTH(14)) vm_mem (
-        .clock            (clock),
-        .reset            (reset),
-        .I_Address        (vm_I_Address),
-        .I_DataIn         ({128{1'b0}}),
-        .I_DataOut        (vm_I_DataOut),
-        .I_Ready          (vm_I_Ready),
-        .I_DataOutOffset  (vm_I_DataOutOffset),
-        .I_BootWrite      (1'b0),
-        .I_ReadLine       (vm_I_ReadLine),
-        .I_ReadWord       (vm_I_ReadWord),
-        .D_Address        (vm_D_Address),
-        .D_DataIn         (vm_D_DataIn),
-        .D_LineInReady    (vm_D_LineInReady),
-        .D_WordInReady    (vm_D_WordInReady),
-        .D_WordInBE       (vm_D_WordInBE),
-        .D_DataOut        (vm_D_DataOut),
-        .D_DataOutOffset  (vm_D_DataOutOffset),
-        .D_ReadLine       (vm_D_ReadLine),
-        .D_ReadWord       (vm_D_ReadWord),
-        .D_Ready          (vm_D_Ready)
-    );
+    // Virtual memory - VM_KB KiB [VM_BASE - VM_BASE + VM_KB KiB), with the timing of a DRAM if 'DRAM'
+    generate
+        if (DRAM) begin : vm
+            MainMemory_DRAM #(.ADDR_WIDTH(VM_ADDR_WIDTH), .CRIT_WORD_FIRST(Early_Restart), .T_CTRL(DRAM_T_CTRL), .T_RCD(DRAM_T_RCD),
+                .T_CAS(DRAM_T_CAS), .T_RP(DRAM_T_RP), .T_BURST(DRAM_T_BURST), .BANK_BITS(DRAM_BANK_BITS),
+                .COL_BITS(DRAM_COL_BITS), .T_REFI(DRAM_T_REFI), .T_RFC(DRAM_T_RFC)) vm_mem (
+                .clock            (clock),
+                .reset            (reset),
+                .I_Address        (vm_I_Address),
+                .I_DataIn         ({128{1'b0}}),
+                .I_DataOut        (vm_I_DataOut),
+                .I_Ready          (vm_I_Ready),
+                .I_DataOutOffset  (vm_I_DataOutOffset),
+                .I_BootWrite      (1'b0),
+                .I_ReadLine       (vm_I_ReadLine),
+                .I_ReadWord       (vm_I_ReadWord),
+                .D_Address        (vm_D_Address),
+                .D_DataIn         (vm_D_DataIn),
+                .D_LineInReady    (vm_D_LineInReady),
+                .D_WordInReady    (vm_D_WordInReady),
+                .D_WordInBE       (vm_D_WordInBE),
+                .D_DataOut        (vm_D_DataOut),
+                .D_DataOutOffset  (vm_D_DataOutOffset),
+                .D_ReadLine       (vm_D_ReadLine),
+                .D_ReadWord       (vm_D_ReadWord),
+                .D_Ready          (vm_D_Ready)
+            );
+            assign dram_counts = {vm_mem.refreshes, vm_mem.queue_cycles, vm_mem.row_conflicts, vm_mem.row_empty, vm_mem.row_hits};
+        end
+        else begin : vm
+            MainMemory #(.ADDR_WIDTH(VM_ADDR_WIDTH), .CRIT_WORD_FIRST(Early_Restart)) vm_mem (
+                .clock            (clock),
+                .reset            (reset),
+                .I_Address        (vm_I_Address),
+                .I_DataIn         ({128{1'b0}}),
+                .I_DataOut        (vm_I_DataOut),
+                .I_Ready          (vm_I_Ready),
+                .I_DataOutOffset  (vm_I_DataOutOffset),
+                .I_BootWrite      (1'b0),
+                .I_ReadLine       (vm_I_ReadLine),
+                .I_ReadWord       (vm_I_ReadWord),
+                .D_Address        (vm_D_Address),
+                .D_DataIn         (vm_D_DataIn),
+                .D_LineInReady    (vm_D_LineInReady),
+                .D_WordInReady    (vm_D_WordInReady),
+                .D_WordInBE       (vm_D_WordInBE),
+                .D_DataOut        (vm_D_DataOut),
+                .D_DataOutOffset  (vm_D_DataOutOffset),
+                .D_ReadLine       (vm_D_ReadLine),
+                .D_ReadWord       (vm_D_ReadWord),
+                .D_Ready          (vm_D_Ready)
+            );
+            assign dram_counts = {160{1'b0}};
+        end
+    endgenerate
 
     // Processor + Caches
-    MIPS32 #(.PABITS(PABITS)) mips32_top (
+    MIPS32 #(.PABITS(PABITS), .EARLY_RESTART(Early_Restart), .PREFETCH(Prefetch)) mips32_top (
         .clock                   (clock),
         .reset                   (reset),
         .Core_Reset              (reset),
@@ -474,10 +641,52 @@ module mips_test();
         .NMI                     (NMI)
     );
 
+    // Cycle accounting for the CPI stack (only reported with '+stalltrace')
+    CPI_Stack CpiStack (
+        .clock          (clock),
+        .reset          (reset),
+        .Enable         (mips_cmd_reg[0]),
+        .W1_Issued      (mips32_top.Core.W1_Issued),
+        .W1_M2Issued    (mips32_top.Core.W1_M2Issued),
+        .F1_Flush       (mips32_top.Core.F1_Flush),
+        .F2_Flush       (mips32_top.Core.F2_Flush),
+        .W1_Flush       (mips32_top.Core.W1_Flush),
+        .F2_Stall       (mips32_top.Core.F2_Stall),
+        .D1_Stall       (mips32_top.Core.D1_Stall),
+        .D2_Stall       (mips32_top.Core.D2_Stall),
+        .X1_Stall       (mips32_top.Core.X1_Stall),
+        .M1_Stall       (mips32_top.Core.M1_Stall),
+        .M2_Stall       (mips32_top.Core.M2_Stall),
+        .W1_Stall       (mips32_top.Core.W1_Stall),
+        .D2_Data_Stall  (mips32_top.Core.Hazards.D2_Data_Stall),
+        .X1_Data_Stall  (mips32_top.Core.Hazards.X1_Data_Stall),
+        .W1_ALU_Stall   (mips32_top.Core.Hazards.W1_ALU_Stall),
+        .Counts         ()
+    );
+
+    // Pipeline trace (only written with '+pipetrace'): Which stages hold, pass on, and keep an instruction
+    Pipe_Trace PipeTrace (
+        .In              ({mips32_top.Core.W1_M2Issued | mips32_top.Core.W1_M2Exception, mips32_top.Core.M2_M1Issued | mips32_top.Core.M2_M1Exception,
+                           mips32_top.Core.M1_X1Issued | mips32_top.Core.M1_X1Exception, mips32_top.Core.X1_D2Issued | mips32_top.Core.X1_D2Exception,
+                           mips32_top.Core.D2_D1Issued | mips32_top.Core.D2_D1Exception, mips32_top.Core.D1_F2Issued | mips32_top.Core.D1_F2Exception,
+                           mips32_top.Core.F2_F1Issued | mips32_top.Core.F2_F1Exception, mips32_top.Core.F1_Issued   | mips32_top.Core.F1_Exception}),
+        .Out             ({mips32_top.Core.W1_Issued,                                        mips32_top.Core.M2_Issued   | mips32_top.Core.M2_Exception,
+                           mips32_top.Core.M1_Issued   | mips32_top.Core.M1_Exception,   mips32_top.Core.X1_Issued   | mips32_top.Core.X1_Exception,
+                           mips32_top.Core.D2_Issued   | mips32_top.Core.D2_Exception,   mips32_top.Core.D1_Issued   | mips32_top.Core.D1_Exception,
+                           mips32_top.Core.F2_Issued   | mips32_top.Core.F2_Exception,   mips32_top.Core.F1_Issued   | mips32_top.Core.F1_Exception}),
+        .Hold            ({mips32_top.Core.W1_Stall & ~mips32_top.Core.W1_Flush,         mips32_top.Core.M2_Stall & ~mips32_top.Core.M2_Flush,
+                           mips32_top.Core.M1_Stall & ~mips32_top.Core.M1_Flush,         mips32_top.Core.X1_Stall & ~mips32_top.Core.X1_Flush,
+                           mips32_top.Core.D2_Stall & ~mips32_top.Core.D2_Flush,         mips32_top.Core.D1_Stall & ~mips32_top.Core.D1_Flush,
+                           mips32_top.Core.F2_Stall & ~mips32_top.Core.F2_Flush,         1'b0}),
+        .Reset           (reset),
+        .F1_PC           (mips32_top.Core.F1_PC),
+        .D1_Instruction  (mips32_top.Core.D1_Instruction)
+    );
+
     // Memory assignments
     assign khigh_I_Address     = InstMem_Address[11:0];
     assign klow_I_Address      = InstMem_Address[11:0];
-    assign vm_I_Address        = InstMem_Address[15:0];
+    assign vm_I_Address        = InstMem_Address[(VM_ADDR_WIDTH+1):0];
     assign khigh_I_ReadLine    = InstMem_ReadLine & khigh_sel_i;
     assign klow_I_ReadLine     = InstMem_ReadLine & klow_sel_i;
     assign vm_I_ReadLine       = InstMem_ReadLine & vm_sel_i;
@@ -486,7 +695,7 @@ module mips_test();
     assign vm_I_ReadWord       = InstMem_ReadWord & vm_sel_i;
     assign khigh_D_Address     = DataMem_Address[11:0];
     assign klow_D_Address      = DataMem_Address[11:0];
-    assign vm_D_Address        = DataMem_Address[15:0];
+    assign vm_D_Address        = DataMem_Address[(VM_ADDR_WIDTH+1):0];
     assign khigh_D_DataIn      = DataMem_Out;
     assign klow_D_DataIn       = DataMem_Out;
     assign vm_D_DataIn         = DataMem_Out;
@@ -0,0 +1,200 @@
+#!/usr/bin/python
+
+# Tracks the performance of the tests across commits.
+#
+# The cycles, retired instructions, and CPI of each test in a result summary
+# (see 'results.py') are compared to a baseline from a history file and then
+# appended to the history, one CSV row per test:
+#
+#   commit,date,sim,test,result,cycles,instructions,cpi
+#
+# The baseline of a test is its runs with the same simulator at the last few
+# other commits (or at one given commit). A test regressed (or improved) when
+# its cycles are outside the spread of the baseline: more than 'sigma'
+# standard deviations from the mean, and more than 'threshold' percent since
+# the simulations are deterministic. The comparison is printed and written as
+# JSON and JUnit XML for other tools, e.g., continuous integration.
+#
+# Author: Grant Ayers (ayers@cs.stanford.edu)
+
+from __future__ import print_function
+import argparse
+import csv
+import json
+import math
+import os
+import subprocess
+import sys
+import time
+from xml.sax.saxutils import quoteattr
+
+class colors:
+    RED   = '\033[31m'
+    GREEN = '\033[32m'
+    DEFAULT = '\33[39m'
+
+FIELDS = ['commit', 'date', 'sim', 'test', 'result', 'cycles', 'instructions', 'cpi']
+
+def read_int(filename):
+    try:
+        with open(filename) as f:
+            return int(f.read().split()[0])
+    except (IOError, IndexError, ValueError):
+        return None
+
+def current_commit():
+    try:
+        with open(os.devnull, 'w') as null:
+            commit = subprocess.check_output(['git', 'rev-parse', '--short', 'HEAD'], stderr=null).decode().strip()
+            dirty = subprocess.check_output(['git', 'status', '--porcelain', '--untracked-files=no'], stderr=null).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return 'unknown'
+    return commit + ('-dirty' if dirty else '')
+
+def read_runs(args):
+    runs = []
+    with open(args.results) as results_file:
+        for line in results_file:
+            columns = line.split()
+            if len(columns) < 2:
+                continue
+            test_dir = os.path.join(args.root, columns[0])
+            cycles = read_int(os.path.join(test_dir, 'test.cycles'))
+            instructions = read_int(os.path.join(test_dir, 'test.instructions'))
+            cpi = (float(cycles) / instructions) if (cycles and instructions) else None
+            runs.append({'test': columns[0], 'result': 1 if columns[1] == '1' else 0, 'cycles': cycles,
+                         'instructions': instructions, 'cpi': cpi})
+    return runs
+
+def read_history(filename):
+    if not os.path.exists(filename):
+        return []
+    with open(filename) as history_file:
+        return list(csv.DictReader(history_file))
+
+def append_history(filename, commit, sim, runs):
+    new = not os.path.exists(filename)
+    date = time.strftime('%Y-%m-%dT%H:%M:%S')
+    with open(filename, 'a') as history_file:
+        writer = csv.DictWriter(history_file, fieldnames=FIELDS, lineterminator='\n')
+        if new:
+            writer.writeheader()
+        for run in runs:
+            if run['cycles'] is None:
+                continue
+            writer.writerow({'commit': commit, 'date': date, 'sim': sim, 'test': run['test'], 'result': run['result'],
+                             'cycles': run['cycles'], 'instructions': run['instructions'] or '',
+                             'cpi': '{0:.4f}'.format(run['cpi']) if run['cpi'] else ''})
+
+# Baseline cycles of each test: All runs at the baseline commit, or at the last 'window' other commits
+def baselines(history, commit, args):
+    rows = [r for r in history if (r['sim'] == args.sim) and (r['result'] == '1') and (r['commit'] != commit)]
+    if args.baseline:
+        rows = [r for r in rows if r['commit'] == args.baseline]
+    samples = {}
+    commits = {}
+    for row in rows:
+        test_commits = commits.setdefault(row['test'], [])
+        if row['commit'] not in test_commits:
+            test_commits.append(row['commit'])
+        samples.setdefault(row['test'], []).append((row['commit'], int(row['cycles'])))
+    result = {}
+    for test, test_samples in samples.items():
+        recent = set(commits[test][-args.window:])
+        result[test] = [cycles for (c, cycles) in test_samples if c in recent]
+    return result
+
+def compare(runs, base, args):
+    for run in runs:
+        run['status'] = 'pass' if run['result'] == 1 else 'fail'
+        samples = base.get(run['test'], [])
+        if (run['result'] != 1) or (run['cycles'] is None) or not samples:
+            run['baseline'] = None
+            continue
+        mean = float(sum(samples)) / len(samples)
+        stdev = math.sqrt(sum((s - mean) ** 2 for s in samples) / (len(samples) - 1)) if len(samples) > 1 else 0.0
+        band = max(args.sigma * stdev, mean * args.threshold / 100.0)
+        change = run['cycles'] - mean
+        run['baseline'] = {'cycles': mean, 'stdev': stdev, 'samples': len(samples),
+                           'change_pct': (100.0 * change / mean) if mean else 0.0}
+        if change > band:
+            run['status'] = 'regression'
+        elif change < -band:
+            run['status'] = 'improvement'
+
+def display(runs, commit):
+    print('Performance ({0}):\n'.format(commit))
+    counts = {}
+    for run in sorted(runs, key=lambda r: r['test']):
+        counts[run['status']] = counts.get(run['status'], 0) + 1
+        if run['status'] not in ('regression', 'improvement'):
+            continue
+        color = colors.RED if run['status'] == 'regression' else colors.GREEN
+        print('{0}: {1}{2:<11}{3} {4:>10} cycles ({5:+.2f}% from {6:.0f}){7}'.format(
+            run['test'].ljust(20), color, run['status'].upper(), colors.DEFAULT, run['cycles'],
+            run['baseline']['change_pct'], run['baseline']['cycles'],
+            '' if run['cpi'] is None else ', CPI {0:.3f}'.format(run['cpi'])))
+    compared = sum(1 for r in runs if r.get('baseline'))
+    print('\n{0} tests compared to a baseline: {1} regressed, {2} improved.'.format(
+        compared, counts.get('regression', 0), counts.get('improvement', 0)))
+
+def write_json(filename, runs, commit, args):
+    report = {'commit': commit, 'sim': args.sim, 'baseline': args.baseline or 'last {0} commits'.format(args.window),
+              'threshold_pct': args.threshold, 'sigma': args.sigma, 'tests': sorted(runs, key=lambda r: r['test'])}
+    with open(filename, 'w') as f:
+        json.dump(report, f, indent=2, sort_keys=True)
+        f.write('\n')
+
+def write_junit(filename, runs, commit):
+    failures = [r for r in runs if r['status'] in ('fail', 'regression')]
+    with open(filename, 'w') as f:
+        f.write('<?xml version="1.0" encoding="UTF-8"?>\n')
+        f.write('<testsuite name="macro" tests="{0}" failures="{1}" errors="0">\n'.format(len(runs), len(failures)))
+        f.write('  <properties><property name="commit" value={0}/></properties>\n'.format(quoteattr(commit)))
+        for run in sorted(runs, key=lambda r: r['test']):
+            f.write('  <testcase classname="macro" name={0}>\n'.format(quoteattr(run['test'])))
+            if run['status'] == 'fail':
+                f.write('    <failure message="Test failed"/>\n')
+            elif run['status'] == 'regression':
+                message = 'Cycles regressed: {0} ({1:+.2f}% from {2:.0f})'.format(
+                    run['cycles'], run['baseline']['change_pct'], run['baseline']['cycles'])
+                f.write('    <failure type="performance" message={0}/>\n'.format(quoteattr(message)))
+            if run['cycles'] is not None:
+                f.write('    <system-out>cycles={0} instructions={1} cpi={2}</system-out>\n'.format(
+                    run['cycles'], run['instructions'], '{0:.4f}'.format(run['cpi']) if run['cpi'] else ''))
+            f.write('  </testcase>\n')
+        f.write('</testsuite>\n')
+
+def main():
+    desc = "MIPS test harness: Tracks the cycles of a set of tests across commits."
+    cl_parser = argparse.ArgumentParser(description=desc)
+    cl_parser.add_argument('-r', '--results', required=True, help='Test result summary to record', metavar='')
+    cl_parser.add_argument('--root', default='tests', help='Directory of the tests (tests)', metavar='')
+    cl_parser.add_argument('--history', default='perf_history.csv', help='History file (perf_history.csv)', metavar='')
+    cl_parser.add_argument('--sim', default='isim', help='Simulator of the results (isim)', metavar='')
+    cl_parser.add_argument('--commit', help='Commit of the results (default: from git)', metavar='')
+    cl_parser.add_argument('--baseline', help='Compare to this commit (default: the last few)', metavar='')
+    cl_parser.add_argument('--window', type=int, default=5, help='Number of commits in the default baseline (5)', metavar='')
+    cl_parser.add_argument('--threshold', type=float, default=1.0, help='Minimum change in percent (1.0)', metavar='')
+    cl_parser.add_argument('--sigma', type=float, default=3.0, help='Minimum change in baseline deviations (3.0)', metavar='')
+    cl_parser.add_argument('--json', help='Write a JSON report', metavar='')
+    cl_parser.add_argument('--junit', help='Write a JUnit XML report', metavar='')
+    cl_parser.add_argument('--gate', action='store_true', help='Exit with an error if any test regressed')
+    cl_parser.add_argument('--no-record', action='store_true', help='Compare only; do not add the results to the history')
+    args = cl_parser.parse_args()
+
+    commit = args.commit or current_commit()
+    runs = read_runs(args)
+    compare(runs, baselines(read_history(args.history), commit, args), args)
+    display(runs, commit)
+    if args.json:
+        write_json(args.json, runs, commit, args)
+    if args.junit:
+        write_junit(args.junit, runs, commit)
+    if not args.no_record:
+        append_history(args.history, commit, args.sim, runs)
+    regressed = any(r['status'] == 'regression' for r in runs)
+    return 1 if (args.gate and regressed) else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
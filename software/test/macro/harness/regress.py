@@ -0,0 +1,130 @@
+#!/usr/bin/python
+
+# Runs the macro tests in parallel with one shared simulation executable.
+#
+# The simulation executable and all test programs are built first, then
+# the tests are run by a pool of workers (each one is 'make <test>/test.result',
+# so the options of the Makefile such as SIM apply). The longest tests start
+# first, going by the cycles of the previous run ('test.cycles') or else by
+# the cycle limit of 'test.conf'. A test which runs longer than its cycle limit
+# allows (at a minimum simulation rate) is stopped and fails. The results are
+# written to the summary file all at once when every test is done, in the
+# format of 'results.py'.
+#
+# Author: Grant Ayers (ayers@cs.stanford.edu)
+
+from __future__ import print_function
+import argparse
+import multiprocessing
+import os
+import re
+import signal
+import subprocess
+import sys
+import threading
+import time
+
+def read_int(filename, pattern):
+    try:
+        with open(filename) as f:
+            match = re.search(pattern, f.read())
+    except IOError:
+        return None
+    return int(match.group(1)) if match else None
+
+class Test:
+    def __init__(self, root, name):
+        self.name   = name
+        self.dir    = os.path.join(root, name)
+        self.limit  = read_int(os.path.join(self.dir, 'test.conf'), r'cycles=(\d+)')
+        self.cycles = read_int(os.path.join(self.dir, 'test.cycles'), r'(\d+)')
+        self.result = 0
+        self.status = 'FAIL'
+
+    # Scheduling estimate: The previous run, or else the cycle limit
+    def estimate(self):
+        if self.cycles is not None:
+            return self.cycles
+        return self.limit if self.limit is not None else 0
+
+    def timeout(self, args):
+        if self.limit is None:
+            return None
+        return args.min_timeout + (float(self.limit) / args.rate)
+
+def run_test(test, args):
+    result_file = os.path.join(test.dir, 'test.result')
+    command = args.make + ['-s', result_file]
+    start = time.time()
+    process = subprocess.Popen(command, preexec_fn=os.setsid)
+    timeout = test.timeout(args)
+    while process.poll() is None:
+        if (timeout is not None) and (time.time() - start > timeout):
+            os.killpg(process.pid, signal.SIGKILL)
+            process.wait()
+            test.status = 'TIMEOUT'
+            # Don't leave a result which would make the next run skip the test
+            if os.path.exists(result_file):
+                os.remove(result_file)
+            return
+        time.sleep(0.05)
+    test.result = read_int(result_file, r'(\d+)') or 0
+    test.status = 'PASS' if ((process.returncode == 0) and (test.result == 1)) else 'FAIL'
+
+def worker(queue, lock, args):
+    while True:
+        with lock:
+            if not queue:
+                return
+            test = queue.pop(0)
+        run_test(test, args)
+        if test.status == 'TIMEOUT':
+            with lock:
+                print('[Timeout]     {0} (limit {1} cycles, {2:.0f} s)'.format(test.dir, test.limit, test.timeout(args)))
+
+def write_summary(tests, filename):
+    temp = '{0}.{1}'.format(filename, os.getpid())
+    with open(temp, 'w') as f:
+        for test in sorted(tests, key=lambda t: t.name):
+            f.write('{0} {1}\n'.format(test.name, test.result))
+    os.rename(temp, filename)
+
+def main():
+    desc = "MIPS test harness: Runs a set of tests in parallel."
+    cl_parser = argparse.ArgumentParser(description=desc)
+    cl_parser.add_argument('tests', nargs='*', help='Tests to run (default: all)')
+    cl_parser.add_argument('-j', '--jobs', type=int, default=multiprocessing.cpu_count(), help='Number of tests to run at once', metavar='')
+    cl_parser.add_argument('-r', '--results', required=True, help='Summary file to write', metavar='')
+    cl_parser.add_argument('--root', default='tests', help='Directory of the tests (tests)', metavar='')
+    cl_parser.add_argument('--make', default='make', help='Make command (make)', metavar='')
+    cl_parser.add_argument('--rate', type=float, default=500.0, help='Minimum simulation rate in cycles/s for the timeouts (500)', metavar='')
+    cl_parser.add_argument('--min-timeout', type=float, default=60.0, help='Seconds added to every timeout (60)', metavar='')
+    args = cl_parser.parse_args()
+    args.make = args.make.split()
+
+    names = args.tests or sorted(d for d in os.listdir(args.root) if os.path.isdir(os.path.join(args.root, d)))
+    tests = [Test(args.root, name) for name in names]
+    missing = [t.name for t in tests if not os.path.isdir(t.dir)]
+    if missing:
+        print('Unknown test(s): {0}'.format(' '.join(missing)))
+        return 1
+
+    # One build of the simulator and the test programs for all workers
+    if subprocess.call(args.make + ['-s', '-j', str(args.jobs), 'sim', 'build_tests']) != 0:
+        print('Failed to build the simulator or the tests')
+        return 1
+
+    queue = sorted(tests, key=lambda t: t.estimate(), reverse=True)
+    lock = threading.Lock()
+    workers = [threading.Thread(target=worker, args=(queue, lock, args)) for i in range(max(1, min(args.jobs, len(tests))))]
+    start = time.time()
+    for w in workers:
+        w.start()
+    for w in workers:
+        w.join()
+    write_summary(tests, args.results)
+    print('Ran {0} tests with {1} workers in {2:.1f} s'.format(len(tests), len(workers), time.time() - start))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,51 @@
+`timescale 1ns / 1ps
+/*
+ * File         : BRAM_32x1024_SDP.v
+ * Project      : MIPS32 MUX
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A behavioral simulation model of the Xilinx coregen core of the same
+ *   name (see 'BRAM_32x1024_SDP.xcp'), for simulators which cannot use the
+ *   generated core (e.g., Verilator).
+ *
+ *   SDP-> Simple dual-port (one write port, one read port), read-first.
+ *
+ *   Read data is available at the next clock edge.
+ *   Reset will zero the read output on the next clock edge.
+ */
+module BRAM_32x1024_SDP(
+    input             clka,
+    input             wea,
+    input      [9:0]  addra,
+    input      [31:0] dina,
+    input             clkb,
+    input             rstb,
+    input      [9:0]  addrb,
+    output reg [31:0] doutb
+    );
+
+    reg [31:0] ram [0:1023];
+
+    integer i;
+    initial begin
+        for (i = 0; i < 1024; i = i + 1) begin
+            ram[i] = {32{1'b0}};
+        end
+    end
+
+    always @(posedge clka) begin
+        if (wea) begin
+            ram[addra] <= dina;
+        end
+    end
+
+    always @(posedge clkb) begin
+        doutb <= (rstb) ? {32{1'b0}} : ram[addrb];
+    end
+
+endmodule
+
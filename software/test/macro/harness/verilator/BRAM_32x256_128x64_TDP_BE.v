@@ -0,0 +1,81 @@
+`timescale 1ns / 1ps
+/*
+ * File         : BRAM_32x256_128x64_TDP_BE.v
+ * Project      : MIPS32 MUX
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A behavioral simulation model of the Xilinx coregen core of the same
+ *   name (see 'BRAM_32x256_128x64_TDP_BE.xcp'), for simulators which cannot
+ *   use the generated core (e.g., Verilator).
+ *
+ *   TDP-> True dual-port with byte write enables, write-first.
+ *
+ *   Port A is 32 bits wide and port B is 128 bits wide. As with a Xilinx BRAM
+ *   of mixed port widths, the mapping is little-endian: 32-bit word 'addra'
+ *   occupies bits [(addra[1:0]*32)+31 : addra[1:0]*32] of 128-bit line 'addra[7:2]'.
+ *
+ *   Read data is available at the next clock edge.
+ *   Reset will zero the outputs on the next clock edge.
+ */
+module BRAM_32x256_128x64_TDP_BE(
+    input              clka,
+    input              rsta,
+    input      [3:0]   wea,
+    input      [7:0]   addra,
+    input      [31:0]  dina,
+    output reg [31:0]  douta,
+    input              clkb,
+    input              rstb,
+    input      [15:0]  web,
+    input      [5:0]   addrb,
+    input      [127:0] dinb,
+    output reg [127:0] doutb
+    );
+
+    reg [7:0] ram [0:1023];     // Byte array; byte n of line l is at (l*16)+n
+
+    wire [9:0] base_a = {addra, 2'b00};
+    wire [9:0] base_b = {addrb, 4'b0000};
+
+    integer i;
+    initial begin
+        for (i = 0; i < 1024; i = i + 1) begin
+            ram[i] = 8'h00;
+        end
+    end
+
+    // Both ports are always driven by the same clock in this design, so one
+    // process models both (and avoids two processes writing the same array).
+    always @(posedge clka) begin
+        for (i = 0; i < 4; i = i + 1) begin
+            if (wea[i]) begin
+                ram[base_a + i] <= dina[(i*8)+:8];
+                douta[(i*8)+:8] <= dina[(i*8)+:8];
+            end
+            else begin
+                douta[(i*8)+:8] <= ram[base_a + i];
+            end
+        end
+        for (i = 0; i < 16; i = i + 1) begin
+            if (web[i]) begin
+                ram[base_b + i] <= dinb[(i*8)+:8];
+                doutb[(i*8)+:8] <= dinb[(i*8)+:8];
+            end
+            else begin
+                doutb[(i*8)+:8] <= ram[base_b + i];
+            end
+        end
+        if (rsta) begin
+            douta <= {32{1'b0}};
+        end
+        if (rstb) begin
+            doutb <= {128{1'b0}};
+        end
+    end
+
+endmodule
+
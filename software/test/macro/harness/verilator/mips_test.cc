@@ -0,0 +1,614 @@
+// mips_test.cc:
+//
+// The C++ testbench for the Verilator build of the MIPS32r1 test harness.
+// Written in C++14 for Unix.
+//
+// Copyright 2018 by Grant Ayers.
+// Licensed under LGPL v3 (http://gnu.org/licenses/lgpl-3.0.en.html)
+//
+// This is the counterpart of 'harness/mips_test.v' for the natively-compiled
+// (Verilator) simulation model 'mips_test_vl.v'. It accepts the same plusargs
+// and produces the same output files in the same formats, so traces and
+// results from both simulators can be compared directly (e.g., with regdiff):
+//
+//   +khigh_mem=<file>       Kernel high memory image (loaded by the model)
+//   +klow_mem=<file>        Kernel low memory image (loaded by the model)
+//   +vm_mem=<file>          Virtual memory image (loaded by the model)
+//   +test_result=<file>     Test register value at the end of the test
+//   +scratch_result=<file>  Scratch register value at the end of the test
+//   +test_cycles=<file>     Number of cycles the test ran
+//   +test_instructions=<file>  Number of instructions the test retired
+//   +cycles=<n>             Maximum number of cycles to run
+//   +itrace=<file>          Instruction trace
+//   +regtrace=<file>        Register file trace
+//   +regtrace_format=<fmt>  Register file trace format: text (default), fixed,
+//                           delta, or deflate (see 'software/regdiff/rtrace.h')
+//   +stalltrace=<file>      Cycles of the test by cause (a CPI stack)
+//   +pipetrace=<file>       Pipeline trace for the Konata viewer (see 'harness/Pipe_Trace.v')
+//   +stdout=<file>          Stdout buffer log
+//   +dumpvars=<file>        VCD waveform (only if built with VL_TRACE=yes)
+//   +cosim                  Check each retired instruction against the reference model
+//   +cosim_context=<n>      Number of retired instructions to show at a mismatch (8)
+//
+// Simulation time follows the 10 ns clock of 'mips_test.v': The processor
+// leaves reset at 20 ns and the first cycle of the test is sampled at 30 ns.
+//
+// Co-simulation runs the instruction-set model of 'software/iss' in lockstep
+// with the processor: The model executes one instruction for each 'W1_Issued'
+// and the PC, GPRs, and HI/LO are compared in-process. The run stops at the
+// first difference, which is reported with the last few retired instructions,
+// and the test fails. Events which depend on timing follow the processor: The
+// model takes an interrupt when the processor does, resets with it, and uses
+// the processor's value for reads of Count, Cause, Random, and PerfCnt.
+//
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cpu.h"
+#include "memory.h"
+#include "rtrace.h"
+#include "verilated.h"
+#include "Vmips_test_vl.h"
+#if VM_TRACE
+#include "verilated_vcd_c.h"
+#endif
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+// For now this must match 'Big_Endian' in MIPS_Defines.v and mips_test_vl.v
+static constexpr bool BIG_ENDIAN_MODE = false;
+static constexpr uint64_t CLOCK_PERIOD = 10;
+static constexpr int STDOUT_BYTES = 1024;
+
+static uint64_t sim_time = 0;
+
+// Called by Verilator for '$time'
+double sc_time_stamp() {
+  return static_cast<double>(sim_time);
+}
+
+// Return the value of a '+name=value' plusarg, or an empty string if it was not given.
+static string plusarg(const char *_name) {
+  string match = string(_name) + "=";
+  const char *arg = Verilated::commandArgsPlusMatch(match.c_str());
+  if ((arg == nullptr) || (arg[0] == '\0')) {
+    return string();
+  }
+  return string(arg + match.size() + 1);  // Skip the leading '+'
+}
+
+static bool plusflag(const char *_name) {
+  const char *arg = Verilated::commandArgsPlusMatch(_name);
+  return (arg != nullptr) && (string(arg) == (string("+") + _name));
+}
+
+static FILE *openOutput(const string &_filename) {
+  if (_filename.empty()) {
+    return nullptr;
+  }
+  FILE *handle = fopen(_filename.c_str(), "w");
+  if (handle == nullptr) {
+    fprintf(stderr, "Could not open '%s' for writing\n", _filename.c_str());
+    exit(1);
+  }
+  return handle;
+}
+
+static void writeResult(const string &_filename, const char *_format, uint32_t _value) {
+  FILE *handle = openOutput(_filename);
+  if (handle != nullptr) {
+    fprintf(handle, _format, _value);
+    fclose(handle);
+  }
+}
+
+class Harness {
+ public:
+  Harness() : top_(new Vmips_test_vl) {}
+
+  void openTrace(const string &_filename) {
+#if VM_TRACE
+    if (!_filename.empty()) {
+      Verilated::traceEverOn(true);
+      vcd_.reset(new VerilatedVcdC);
+      top_->trace(vcd_.get(), 99);
+      vcd_->open(_filename.c_str());
+    }
+#else
+    if (!_filename.empty()) {
+      printf("Waveform dumps require a build with VL_TRACE=yes\n");
+    }
+#endif
+  }
+
+  // One full clock cycle: Rising edge at +5 ns and falling edge at +10 ns.
+  void tick() {
+    top_->clock = 1;
+    eval(sim_time + (CLOCK_PERIOD / 2));
+    top_->clock = 0;
+    eval(sim_time + CLOCK_PERIOD);
+    sim_time += CLOCK_PERIOD;
+  }
+
+  void eval(uint64_t _time) {
+    top_->eval();
+#if VM_TRACE
+    if (vcd_) {
+      vcd_->dump(_time);
+    }
+#else
+    (void)_time;
+#endif
+  }
+
+  void itrace(FILE *_handle) {
+    // NOTE: 'W1_Issued' does not currently capture an instruction
+    // that is an exception (e.g., syscall), thus the trace will
+    // miss any such instructions.
+    fprintf(_handle, "%08x    (%llu)\n", top_->W1_RestartPC, static_cast<unsigned long long>(sim_time));
+  }
+
+  void regtrace(rtrace::Writer &_writer) {
+    uint32_t regs[rtrace::REGS];
+    for (int i = 0; i < rtrace::REGS; i++) {
+      regs[i] = top_->RegState[i];
+    }
+    _writer.write(sim_time, regs);
+  }
+
+  // Print the 1 KiB buffer, ending if NULL is found
+  void printStdout(FILE *_handle) {
+    for (int i = 0; i < STDOUT_BYTES; i++) {
+      if ((i % 16) == 0) {
+        top_->StdoutIndex = i / 16;
+        top_->eval();
+      }
+      int bit = (BIG_ENDIAN_MODE) ? ((i % 16) * 8) : ((15 - (i % 16)) * 8);
+      char byte = static_cast<char>((top_->StdoutLine[bit / 32] >> (bit % 32)) & 0xff);
+      if (byte == '\0') {
+        break;
+      }
+      fputc(byte, _handle);
+    }
+    fflush(_handle);
+  }
+
+  unique_ptr<Vmips_test_vl> top_;
+#if VM_TRACE
+  unique_ptr<VerilatedVcdC> vcd_;
+#endif
+};
+
+// The pipeline trace of 'harness/Pipe_Trace.v': Each fetch is an instruction
+// in Konata's log format, with the cycles it entered each stage, the cycles it
+// was held by a stall (lane 1), and whether it retired or was flushed.
+class PipeTrace {
+ public:
+  explicit PipeTrace(FILE *_handle) : handle_(_handle) { fprintf(handle_, "Kanata\t0004\n"); }
+
+  // Record one cycle of the pipeline, which must be sampled before the clock edge
+  void sample(uint32_t _cycle, const Vmips_test_vl *_top) {
+    static const char *const names[STAGES] = {"F1", "F2", "D1", "D2", "X1", "M1", "M2", "W1"};
+    uint32_t in = (_top->CoreReset) ? 0 : (_top->PipeState & 0xff);
+    uint32_t out = (_top->PipeState >> 8) & 0xff;
+    uint32_t hold = (_top->PipeState >> 16) & 0xff;
+
+    // Retirements and flushes of the previous cycle
+    for (const End &end : ends_) {
+      at(_cycle);
+      fprintf(handle_, "R\t%llu\t%llu\t%d\n", end.id, (end.flush) ? 0 : retired_++, end.flush);
+    }
+    ends_.clear();
+
+    // Instructions which are gone without leaving their stage (e.g., a reset)
+    for (int s = STAGES - 1; s >= 0; s--) {
+      if (stages_[s].valid && !(in & (1 << s))) {
+        at(_cycle);
+        if (stages_[s].stalled) {
+          fprintf(handle_, "E\t%llu\t1\tstl\n", stages_[s].id);
+        }
+        fprintf(handle_, "R\t%llu\t0\t1\n", stages_[s].id);
+        stages_[s] = Stage();
+      }
+    }
+
+    // Instructions entering a stage
+    for (int s = STAGES - 1; s >= 1; s--) {
+      if (stages_[s].valid && stages_[s].fresh) {
+        at(_cycle);
+        fprintf(handle_, "S\t%llu\t0\t%s\n", stages_[s].id, names[s]);
+        if (s == 2) {
+          fprintf(handle_, "L\t%llu\t1\t%08x\n", stages_[s].id, _top->D1_Instruction);
+        }
+      }
+    }
+    if (in & 0x1) {
+      at(_cycle);
+      fprintf(handle_, "I\t%llu\t%llu\t0\nL\t%llu\t0\t%08x\nS\t%llu\t0\tF1\n", next_id_, next_id_, next_id_,
+              _top->F1_PC, next_id_);
+      stages_[0].id = next_id_++;
+      stages_[0].valid = true;
+    }
+
+    // Stalls
+    for (int s = STAGES - 1; s >= 0; s--) {
+      bool held = hold & (1 << s);
+      if (stages_[s].valid && held && !stages_[s].stalled) {
+        at(_cycle);
+        fprintf(handle_, "S\t%llu\t1\tstl\n", stages_[s].id);
+        stages_[s].stalled = true;
+      } else if (stages_[s].stalled && !held) {
+        at(_cycle);
+        fprintf(handle_, "E\t%llu\t1\tstl\n", stages_[s].id);
+        stages_[s].stalled = false;
+      }
+    }
+
+    // Where each instruction goes at the clock edge
+    for (int s = STAGES - 1; s >= 0; s--) {
+      Stage &stage = stages_[s];
+      if (!stage.valid) {
+        continue;
+      }
+      if ((out & (1 << s)) && (s == STAGES - 1)) {
+        ends_.push_back({stage.id, false});
+        stage = Stage();
+      } else if (out & (1 << s)) {
+        stages_[s + 1] = {stage.id, true, true, false};
+        stage = Stage();
+      } else if (hold & (1 << s)) {
+        stage.fresh = false;
+      } else {
+        ends_.push_back({stage.id, true});
+        stage = Stage();
+      }
+    }
+  }
+
+ private:
+  static constexpr int STAGES = 8;
+
+  struct Stage {
+    unsigned long long id = 0;
+    bool valid = false;
+    bool fresh = false;    // It entered the stage this cycle
+    bool stalled = false;  // Lane 1 shows a stall
+  };
+
+  struct End {
+    unsigned long long id;
+    bool flush;
+  };
+
+  // Move the trace to a cycle before writing a line in it
+  void at(uint32_t _cycle) {
+    if (!started_) {
+      fprintf(handle_, "C=\t%u\n", _cycle);
+      started_ = true;
+    } else if (_cycle != last_cycle_) {
+      fprintf(handle_, "C\t%u\n", _cycle - last_cycle_);
+    }
+    last_cycle_ = _cycle;
+  }
+
+  FILE *handle_;
+  bool started_ = false;
+  uint32_t last_cycle_ = 0;
+  unsigned long long next_id_ = 0;
+  unsigned long long retired_ = 0;
+  Stage stages_[STAGES];
+  vector<End> ends_;
+};
+
+// Lockstep comparison of the processor against the instruction-set model
+class Cosim {
+ public:
+  Cosim(const CpuConfig &_config, int _context, uint32_t _vm_base, uint32_t _vm_size)
+      : memory_(BIG_ENDIAN_MODE, _vm_base, _vm_size), cpu_(memory_, _config), context_(_context), history_(_context), retired_(0),
+        volatile_reg_(0) {}
+
+  bool load(const string &_khigh, const string &_klow, const string &_vm) {
+    return (_khigh.empty() || memory_.load(_khigh, Memory::KHI_BASE)) &&
+           (_klow.empty() || memory_.load(_klow, Memory::KLO_BASE)) &&
+           (_vm.empty() || memory_.load(_vm, Memory::VM_BASE));
+  }
+
+  // Follow one processor cycle. Returns false at the first difference.
+  bool check(const Vmips_test_vl *_top) {
+    if (_top->CoreReset) {
+      memory_.resetRegisters();
+      cpu_.reset();
+      volatile_reg_ = 0;
+      return true;
+    }
+    if (_top->W1_Interrupt) {
+      cpu_.requestInterrupt();
+      if (cpu_.step()) {
+        printf("Co-simulation mismatch at %llu: The processor took an interrupt but the model executed %08x\n",
+               static_cast<unsigned long long>(sim_time), cpu_.restartPC());
+        report();
+        return false;
+      }
+      return true;
+    }
+    if (!_top->W1_Issued) {
+      return true;
+    }
+
+    // The processor shows the state before the retiring instruction writes back
+    if (volatile_reg_ != 0) {
+      cpu_.setGpr(volatile_reg_, _top->RegState[volatile_reg_ - 1]);
+    }
+    bool match = compareRegisters(_top);
+
+    // Exceptions of the model are taken on the way to its next retired instruction
+    int steps = 0;
+    while (match && !cpu_.step()) {
+      if (++steps == MAX_EXCEPTION_STEPS) {
+        break;
+      }
+    }
+    if (match && (cpu_.restartPC() != _top->W1_RestartPC)) {
+      printf("Co-simulation mismatch at %llu: PC rtl=%08x model=%08x\n",
+             static_cast<unsigned long long>(sim_time), _top->W1_RestartPC, cpu_.restartPC());
+      match = false;
+    }
+    if (!match) {
+      report();
+      return false;
+    }
+    volatile_reg_ = cpu_.volatileRegister();
+    history_[retired_ % context_] = {_top->W1_RestartPC, sim_time};
+    retired_++;
+    return true;
+  }
+
+  uint64_t retired() const { return retired_; }
+
+ private:
+  static constexpr int MAX_EXCEPTION_STEPS = 16;
+
+  struct Retired {
+    uint32_t pc;
+    uint64_t time;
+  };
+
+  bool compareRegisters(const Vmips_test_vl *_top) {
+    bool match = true;
+    for (int i = 0; i < rtrace::REGS; i++) {
+      uint32_t model = (i < 31) ? cpu_.gpr(i + 1) : ((i == 31) ? cpu_.hi() : cpu_.lo());
+      if (model != _top->RegState[i]) {
+        if (match) {
+          printf("Co-simulation mismatch at %llu before the instruction at %08x:\n",
+                 static_cast<unsigned long long>(sim_time), _top->W1_RestartPC);
+        }
+        printf("  %s: rtl=%08x model=%08x\n", rtrace::LABELS[i], _top->RegState[i], model);
+        match = false;
+      }
+    }
+    return match;
+  }
+
+  void report() {
+    printf("Last %d of %llu matching instructions:\n", static_cast<int>(std::min<uint64_t>(retired_, context_)),
+           static_cast<unsigned long long>(retired_));
+    for (uint64_t i = (retired_ > context_) ? (retired_ - context_) : 0; i < retired_; i++) {
+      const Retired &r = history_[i % context_];
+      printf("  %08x    (%llu)\n", r.pc, static_cast<unsigned long long>(r.time));
+    }
+  }
+
+  Memory memory_;
+  Cpu cpu_;
+  uint64_t context_;
+  vector<Retired> history_;  // The last 'context_' retired instructions
+  uint64_t retired_;
+  int volatile_reg_;         // Register to take from the processor at the next retirement
+};
+
+int main(int argc, char **argv) {
+  Verilated::commandArgs(argc, argv);
+
+  string test_result_filename = plusarg("test_result");
+  string test_scratch_filename = plusarg("scratch_result");
+  string test_cycles_filename = plusarg("test_cycles");
+  string test_instructions_filename = plusarg("test_instructions");
+  string itrace_filename = plusarg("itrace");
+  string regtrace_filename = plusarg("regtrace");
+  string stalltrace_filename = plusarg("stalltrace");
+  string pipetrace_filename = plusarg("pipetrace");
+  string stdout_filename = plusarg("stdout");
+  string cycles_arg = plusarg("cycles");
+  string regtrace_format_arg = plusarg("regtrace_format");
+  uint32_t num_cycles = 0xffffffff;
+  rtrace::Format regtrace_format = rtrace::TEXT;
+  if (!regtrace_format_arg.empty() && !rtrace::parseFormat(regtrace_format_arg, regtrace_format)) {
+    fprintf(stderr, "Unknown register trace format '%s'\n", regtrace_format_arg.c_str());
+    return 1;
+  }
+
+  // The memory images are loaded by the model itself during construction
+  Harness harness;
+  Vmips_test_vl *top = harness.top_.get();
+  harness.openTrace(plusarg("dumpvars"));
+
+  // The reference model uses the cache geometry and memory map of the processor
+  unique_ptr<Cosim> cosim;
+  if (plusflag("cosim")) {
+    CpuConfig config;
+    config.big_endian = BIG_ENDIAN_MODE;
+    config.icache_index_bits = (top->CacheGeometry >> 12) & 0xf;
+    config.icache_ways = (top->CacheGeometry >> 8) & 0xf;
+    config.dcache_index_bits = (top->CacheGeometry >> 4) & 0xf;
+    config.dcache_ways = top->CacheGeometry & 0xf;
+    config.external_interrupts = true;
+    string context_arg = plusarg("cosim_context");
+    int context = (context_arg.empty()) ? 8 : std::max(1, std::atoi(context_arg.c_str()));
+    uint32_t vm_base = static_cast<uint32_t>(top->VmRegion >> 32);
+    uint32_t vm_size = static_cast<uint32_t>(top->VmRegion);
+    cosim.reset(new Cosim(config, context, vm_base, vm_size));
+    if (!cosim->load(plusarg("khigh_mem"), plusarg("klow_mem"), plusarg("vm_mem"))) {
+      return 1;
+    }
+    printf("Co-simulation enabled\n");
+  }
+
+  if (!itrace_filename.empty()) {
+    printf("Instruction trace enabled: %s\n", itrace_filename.c_str());
+  }
+  if (!regtrace_filename.empty()) {
+    printf("Register file trace enabled: %s\n", regtrace_filename.c_str());
+  }
+  if (!pipetrace_filename.empty()) {
+    printf("Pipeline trace enabled: %s\n", pipetrace_filename.c_str());
+  }
+  if (!stalltrace_filename.empty()) {
+    printf("CPI stack enabled: %s\n", stalltrace_filename.c_str());
+  }
+  if (!stdout_filename.empty()) {
+    printf("Stdout enabled: %s\n", stdout_filename.c_str());
+  }
+  if (!cycles_arg.empty()) {
+    num_cycles = static_cast<uint32_t>(std::strtoul(cycles_arg.c_str(), nullptr, 10));
+  }
+  printf("Running userlogic for maximum of %u cycles\n", num_cycles);
+
+  FILE *itrace_handle = openOutput(itrace_filename);
+  FILE *regtrace_handle = openOutput(regtrace_filename);
+  FILE *pipetrace_handle = openOutput(pipetrace_filename);
+  FILE *stdout_handle = openOutput(stdout_filename);
+  unique_ptr<rtrace::Writer> regtrace_writer;
+  if (regtrace_handle) {
+    regtrace_writer.reset(new rtrace::Writer(regtrace_handle, regtrace_format));
+  }
+  unique_ptr<PipeTrace> pipetrace;
+  if (pipetrace_handle) {
+    pipetrace.reset(new PipeTrace(pipetrace_handle));
+  }
+
+  // Initialize testbench signals
+  top->clock = 0;
+  top->reset = 1;
+  top->CommandReg = 0;
+  top->StdoutAck = 0;
+  top->StdoutIndex = 0;
+  harness.eval(sim_time);
+
+  // Turn off reset after a few cycles
+  harness.tick();
+  harness.tick();
+  top->reset = 0;
+  harness.tick();
+
+  // Run
+  top->CommandReg = 1;
+  uint32_t cycle_count = num_cycles;
+  uint32_t instruction_count = 0;
+  bool diverged = false;
+  while ((cycle_count > 0) && !(top->StatusReg & 0x1) && !Verilated::gotFinish()) {
+    cycle_count--;
+    top->eval();
+
+    // Stop at the first difference from the reference model
+    if (cosim && !cosim->check(top)) {
+      diverged = true;
+      break;
+    }
+
+    if (top->W1_Issued) {
+      instruction_count++;
+    }
+
+    // Conditionally output an instruction trace element
+    if (itrace_handle && top->W1_Issued) {
+      harness.itrace(itrace_handle);
+    }
+
+    // Conditionally output a register file trace element
+    if (regtrace_writer && top->W1_Issued) {
+      harness.regtrace(*regtrace_writer);
+    }
+
+    // Conditionally record the pipeline of this cycle
+    if (pipetrace) {
+      pipetrace->sample(num_cycles - cycle_count - 1, top);
+    }
+
+    // Conditionally print the output buffer to the stdout file log
+    // (e.g., 'printf', enabled by bit 1 of the status register)
+    top->StdoutAck = 0;
+    if (stdout_handle && (top->StatusReg & 0x2)) {
+      harness.printStdout(stdout_handle);
+      top->StdoutAck = 1;
+    }
+    harness.tick();
+  }
+  top->StdoutAck = 0;
+
+  // Close output files
+  if (itrace_handle) {
+    fclose(itrace_handle);
+  }
+  if (regtrace_handle) {
+    regtrace_writer->finish();
+    fclose(regtrace_handle);
+  }
+  if (pipetrace_handle) {
+    fclose(pipetrace_handle);
+  }
+  if (stdout_handle) {
+    fclose(stdout_handle);
+  }
+
+  printf("Test ran for %u cycles\n", num_cycles - cycle_count);
+  printf("status register = %u\n", top->StatusReg);
+  printf("test register = %u\n", top->TestReg);
+  printf("scratch register = %u\n", top->ScratchReg);
+  if (cosim) {
+    printf("Co-simulation %s after %llu instructions\n", (diverged) ? "failed" : "matched",
+           static_cast<unsigned long long>(cosim->retired()));
+  }
+
+  // Prefetcher counters (all zero unless the model was built with PREFETCH)
+  if (top->PrefetchCounts[0] || top->PrefetchCounts[3]) {
+    printf("I-cache prefetch: issued=%u useful=%u misses=%u\n",
+           top->PrefetchCounts[0], top->PrefetchCounts[1], top->PrefetchCounts[2]);
+    printf("D-cache prefetch: issued=%u useful=%u misses=%u\n",
+           top->PrefetchCounts[3], top->PrefetchCounts[4], top->PrefetchCounts[5]);
+  }
+
+  // DRAM counters of the vm region (all zero unless the model was built with DRAM)
+  if (top->DramCounts[0] || top->DramCounts[1] || top->DramCounts[2]) {
+    printf("DRAM: row hits=%u empty=%u conflicts=%u queue cycles=%u refreshes=%u\n", top->DramCounts[0],
+           top->DramCounts[1], top->DramCounts[2], top->DramCounts[3], top->DramCounts[4]);
+  }
+
+  top->CommandReg = 0;
+
+  // Write the test result, scratch result, and number of test cycles and instructions
+  writeResult(test_result_filename, "%u\n", (diverged) ? 0 : top->TestReg);
+  writeResult(test_scratch_filename, "0x%x\n", top->ScratchReg);
+  writeResult(test_cycles_filename, "%u\n", num_cycles - cycle_count);
+  writeResult(test_instructions_filename, "%u\n", instruction_count);
+
+  // Write the CPI stack: The cycles charged to each cause (see 'harness/CPI_Stack.v')
+  FILE *stalltrace_handle = openOutput(stalltrace_filename);
+  if (stalltrace_handle) {
+    static const char *const causes[] = {"base", "icache_miss", "dcache_miss", "load_use",
+                                         "mult_div", "branch_flush", "exception"};
+    fprintf(stalltrace_handle, "cycles %u\ninstructions %u\n", num_cycles - cycle_count, top->StallCounts[0]);
+    for (int i = 0; i < 7; i++) {
+      fprintf(stalltrace_handle, "%s %u\n", causes[i], top->StallCounts[i]);
+    }
+    fclose(stalltrace_handle);
+  }
+
+  top->final();
+  return 0;
+}
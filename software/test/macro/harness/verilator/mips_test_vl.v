@@ -0,0 +1,534 @@
+`timescale 1ns / 1ps
+/*
+ * File         : mips_test_vl.v
+ * Project      : MIPS32 MUX
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A synthesizable variant of the MIPS32r1 (processor + caches) test harness
+ *   for Verilator. It is functionally identical to 'mips_test.v' but it has no
+ *   delays or file I/O beyond loading the memory images. Instead, the clock,
+ *   reset, and run command are driven by the C++ testbench ('mips_test.cc'),
+ *   which also implements the cycle limit, instruction and register traces,
+ *   the stdout buffer, and the test result files.
+ *
+ *   The memory map and the five test registers are the same as in 'mips_test.v':
+ *     1. Kernel Low (klo)    : [0x00000000 - 0x00004000) (16 KiB)
+ *     2. Kernel High (khi)   : [0x1fc00000 - 0x1fc04000) (16 KiB)
+ *     3. Virtual memory (vm) : [VM_BASE - VM_BASE + VM_KB KiB) (default 0x80000000, 4 MiB)
+ *     4. Reset Register      : 0x1fffffec
+ *     5. Command Register    : 0x1ffffff0
+ *     6. Status Register     : 0x1ffffff4
+ *     7. Test Register       : 0x1ffffff8
+ *     8. Scratch Register    : 0x1ffffffc
+ *
+ *   The memory images are loaded from the '+khigh_mem', '+klow_mem', and '+vm_mem'
+ *   plusargs at time zero.
+ *
+ *   Processor options are top-level parameters so that they can be set when the
+ *   model is built (e.g., 'verilator -GBRANCH_PREDICT=1'). 'EARLY_RESTART' is on by
+ *   default, as in mips_test.v, and also makes the memories return the requested word
+ *   of a line first. 'PREFETCH' enables the cache prefetchers, whose counters are
+ *   reported on 'PrefetchCounts'.
+ *
+ *   'DRAM' gives the vm region the timing of a DRAM ('MainMemory_DRAM.v', with the
+ *   'DRAM_*' parameters), whose counters are reported on 'DramCounts'.
+ *
+ *   'StallCounts' gives the cycles of the test by cause (a CPI stack, see 'CPI_Stack.v')
+ *   for '+stalltrace'.
+ *
+ *   'PipeState', 'F1_PC', and 'D1_Instruction' describe the pipeline for '+pipetrace'
+ *   (see 'Pipe_Trace.v', which 'mips_test.v' uses for the same trace).
+ *
+ *   'W1_Interrupt', 'CoreReset', 'CacheGeometry', and 'VmRegion' let the testbench
+ *   keep a reference model in lockstep with the processor ('+cosim').
+ *
+ *   'VM_KB' (a power of two) and 'VM_BASE' (aligned to the size) place the vm region,
+ *   as in 'mips_test.v'.
+ */
+module mips_test_vl #(parameter BRANCH_PREDICT=0, parameter RAS_BITS=3, parameter DCACHE_BG_FILL=0,
+                      parameter ICACHE_INDEX_BITS=8, parameter ICACHE_WAYS=2, parameter DCACHE_INDEX_BITS=6, parameter DCACHE_WAYS=2,
+                      parameter EARLY_RESTART=1, parameter PREFETCH=0, parameter VM_KB=4096, parameter VM_BASE=32'h80000000,
+                      parameter DRAM=0, parameter DRAM_T_CTRL=10, parameter DRAM_T_RCD=3, parameter DRAM_T_CAS=3, parameter DRAM_T_RP=3,
+                      parameter DRAM_T_BURST=1, parameter DRAM_BANK_BITS=3, parameter DRAM_COL_BITS=7, parameter DRAM_T_REFI=780,
+                      parameter DRAM_T_RFC=11) (
+    input            clock,
+    input            reset,
+    input  [31:0]    CommandReg,   // Value of the command register (driven by the testbench)
+    input            StdoutAck,    // Clear status bit 1 (the stdout buffer has been consumed)
+    input  [5:0]     StdoutIndex,  // Cacheline index into the 1 KiB stdout buffer
+    output [127:0]   StdoutLine,   // Cacheline of the stdout buffer at 'StdoutIndex'
+    output [31:0]    StatusReg,
+    output [31:0]    TestReg,
+    output [31:0]    ScratchReg,
+    output           W1_Issued,    // An instruction retired this cycle
+    output [31:0]    W1_RestartPC, // The PC of the retiring instruction
+    output [1055:0]  RegState,     // {lo, hi, r31, ..., r1} as seen by retiring instructions
+    output [191:0]   PrefetchCounts, // {D misses, D useful, D issued, I misses, I useful, I issued} (see the caches)
+    output [223:0]   StallCounts,  // {exception, branch, mult/div, load-use, D-miss, I-miss, base} cycles
+    output [23:0]    PipeState,    // {Hold, Out, In} of the stages {W1, M2, M1, X1, D2, D1, F2, F1}
+    output [31:0]    F1_PC,        // The PC of a new fetch
+    output [31:0]    D1_Instruction, // The instruction word in D1
+    output           W1_Interrupt, // An interrupt was taken in place of the W1 instruction this cycle
+    output           CoreReset,    // The processor is in reset (including by the reset register)
+    output [15:0]    CacheGeometry, // {I index bits, I ways, D index bits, D ways}
+    output [63:0]    VmRegion,     // {vm base address, vm size in bytes}
+    output [159:0]   DramCounts    // {refreshes, queue cycles, row conflicts, row empty, row hits} (zero unless 'DRAM')
+    );
+
+    localparam PABITS=32;
+    localparam Big_Endian = 1'b0;   // For now this must be updated manually
+
+    // Line (16-byte) address width of a memory region of 'kb' KiB
+    function integer line_bits;
+        input integer kb;
+        integer lines;
+        begin
+            line_bits = 0;
+            for (lines = kb * 64; lines > 1; lines = lines >> 1) begin
+                line_bits = line_bits + 1;
+            end
+        end
+    endfunction
+
+    localparam VM_ADDR_WIDTH = line_bits(VM_KB);
+    localparam [31:0] VM_BASE_ADDR = VM_BASE;
+    localparam [31:0] VM_BYTES = VM_KB * 1024;
+
+    // Processor command, status, and test registers.
+    reg  [31:0] mips_rst_reg;    // Byte address 0x1fffffec
+    wire [31:0] mips_cmd_reg;    // Byte address 0x1ffffff0
+    reg  [31:0] mips_sta_reg;    // Byte address 0x1ffffff4
+    reg  [31:0] mips_tst_reg;    // Byte address 0x1ffffff8
+    reg  [31:0] mips_scr_reg;    // Byte address 0x1ffffffc
+
+    // The reset register resets the processor and memories when it counts down to 1.
+    wire mips_reset = reset | (mips_rst_reg == 32'd1);
+
+    // Memory images
+    reg  [1024*8:1] khigh_mem_filename;
+    reg  [1024*8:1] klow_mem_filename;
+    reg  [1024*8:1] vm_mem_filename;
+    initial begin
+        if ($value$plusargs("khigh_mem=%s", khigh_mem_filename)) begin
+            $display("Kernel High Memory: %0s", khigh_mem_filename);
+            $readmemh(khigh_mem_filename, khigh_mem.MainRAM.ram);
+        end else begin
+            $display("No kernel high memory");
+        end
+        if ($value$plusargs("klow_mem=%s", klow_mem_filename)) begin
+            $display("Kernel Low Memory: %0s", klow_mem_filename);
+            $readmemh(klow_mem_filename, klow_mem.MainRAM.ram);
+        end else begin
+            $display("No kernel low memory");
+        end
+        if ($value$plusargs("vm_mem=%s", vm_mem_filename)) begin
+            $display("Virtual memory: %0s (%0d KiB at 0x%h)", vm_mem_filename, VM_KB, VM_BASE_ADDR);
+            $readmemh(vm_mem_filename, vm.vm_mem.MainRAM.ram);
+        end else begin
+            $display("No virtual memory region");
+        end
+    end
+
+    // Testbench observation signals
+    wire [159:0] dram_counts;   // Of the vm region
+    // NOTE: Currently using the last 1 KiB of kernel high memory for the output buffer [0x1fc03c00 - 0x1fc04000)
+    assign mips_cmd_reg = CommandReg;
+    assign StdoutLine   = khigh_mem.MainRAM.ram[{4'b1111, StdoutIndex}];
+    assign StatusReg    = mips_sta_reg;
+    assign TestReg      = mips_tst_reg;
+    assign ScratchReg   = mips_scr_reg;
+    assign W1_Issued    = mips32_top.Core.W1_Issued;
+    assign W1_RestartPC = mips32_top.Core.W1_RestartPC;
+    genvar r;
+    generate
+        for (r = 1; r < 32; r = r + 1) begin : rtrace
+            assign RegState[((r-1)*32)+:32] = mips32_top.Core.RegisterFile.registers[r];
+        end
+    endgenerate
+    assign RegState[1023:992]  = mips32_top.Core.ALU.HI.Q;
+    assign RegState[1055:1024] = mips32_top.Core.ALU.LO.Q;
+    assign PrefetchCounts      = {mips32_top.DCache.pf_misses, mips32_top.DCache.pf_useful, mips32_top.DCache.pf_issued,
+                                  mips32_top.ICache.pf_misses, mips32_top.ICache.pf_useful, mips32_top.ICache.pf_issued};
+    assign W1_Interrupt  = mips32_top.Core.W1_ExcActive & mips32_top.Core.Enabled_Int;
+    assign CoreReset     = mips_reset;
+    assign PipeState     = {mips32_top.Core.W1_Stall & ~mips32_top.Core.W1_Flush,         mips32_top.Core.M2_Stall & ~mips32_top.Core.M2_Flush,
+                            mips32_top.Core.M1_Stall & ~mips32_top.Core.M1_Flush,         mips32_top.Core.X1_Stall & ~mips32_top.Core.X1_Flush,
+                            mips32_top.Core.D2_Stall & ~mips32_top.Core.D2_Flush,         mips32_top.Core.D1_Stall & ~mips32_top.Core.D1_Flush,
+                            mips32_top.Core.F2_Stall & ~mips32_top.Core.F2_Flush,         1'b0,
+                            mips32_top.Core.W1_Issued,                                        mips32_top.Core.M2_Issued   | mips32_top.Core.M2_Exception,
+                            mips32_top.Core.M1_Issued   | mips32_top.Core.M1_Exception,   mips32_top.Core.X1_Issued   | mips32_top.Core.X1_Exception,
+                            mips32_top.Core.D2_Issued   | mips32_top.Core.D2_Exception,   mips32_top.Core.D1_Issued   | mips32_top.Core.D1_Exception,
+                            mips32_top.Core.F2_Issued   | mips32_top.Core.F2_Exception,   mips32_top.Core.F1_Issued   | mips32_top.Core.F1_Exception,
+                            mips32_top.Core.W1_M2Issued | mips32_top.Core.W1_M2Exception, mips32_top.Core.M2_M1Issued | mips32_top.Core.M2_M1Exception,
+                            mips32_top.Core.M1_X1Issued | mips32_top.Core.M1_X1Exception, mips32_top.Core.X1_D2Issued | mips32_top.Core.X1_D2Exception,
+                            mips32_top.Core.D2_D1Issued | mips32_top.Core.D2_D1Exception, mips32_top.Core.D1_F2Issued | mips32_top.Core.D1_F2Exception,
+                            mips32_top.Core.F2_F1Issued | mips32_top.Core.F2_F1Exception, mips32_top.Core.F1_Issued   | mips32_top.Core.F1_Exception};
+    assign F1_PC          = mips32_top.Core.F1_PC;
+    assign D1_Instruction = mips32_top.Core.D1_Instruction;
+    assign CacheGeometry = {ICACHE_INDEX_BITS[3:0], ICACHE_WAYS[3:0], DCACHE_INDEX_BITS[3:0], DCACHE_WAYS[3:0]};
+    assign VmRegion      = {VM_BASE_ADDR, VM_BYTES};
+    assign DramCounts    = dram_counts;
+
+    // Memory signals
+    wire [11:0]  khigh_I_Address;
+    wire [31:0]  khigh_I_DataOut;
+    wire         khigh_I_Ready;
+    wire [1:0]   khigh_I_DataOutOffset;
+    wire         khigh_I_ReadLine;
+    wire         khigh_I_ReadWord;
+    wire [11:0]  khigh_D_Address;
+    wire [127:0] khigh_D_DataIn;
+    wire         khigh_D_LineInReady;
+    wire         khigh_D_WordInReady;
+    wire [3:0]   khigh_D_WordInBE;
+    wire [31:0]  khigh_D_DataOut;
+    wire [1:0]   khigh_D_DataOutOffset;
+    wire         khigh_D_ReadLine;
+    wire         khigh_D_ReadWord;
+    wire         khigh_D_Ready;
+    wire [11:0]  klow_I_Address;
+    wire [31:0]  klow_I_DataOut;
+    wire         klow_I_Ready;
+    wire [1:0]   klow_I_DataOutOffset;
+    wire         klow_I_ReadLine;
+    wire         klow_I_ReadWord;
+    wire [11:0]  klow_D_Address;
+    wire [127:0] klow_D_DataIn;
+    wire         klow_D_LineInReady;
+    wire         klow_D_WordInReady;
+    wire [3:0]   klow_D_WordInBE;
+    wire [31:0]  klow_D_DataOut;
+    wire [1:0]   klow_D_DataOutOffset;
+    wire         klow_D_ReadLine;
+    wire         klow_D_ReadWord;
+    wire         klow_D_Ready;
+    wire [(VM_ADDR_WIDTH+1):0] vm_I_Address;
+    wire [31:0]  vm_I_DataOut;
+    wire         vm_I_Ready;
+    wire [1:0]   vm_I_DataOutOffset;
+    wire         vm_I_ReadLine;
+    wire         vm_I_ReadWord;
+    wire [(VM_ADDR_WIDTH+1):0] vm_D_Address;
+    wire [127:0] vm_D_DataIn;
+    wire         vm_D_LineInReady;
+    wire         vm_D_WordInReady;
+    wire [3:0]   vm_D_WordInBE;
+    wire [31:0]  vm_D_DataOut;
+    wire [1:0]   vm_D_DataOutOffset;
+    wire         vm_D_ReadLine;
+    wire         vm_D_ReadWord;
+    wire         vm_D_Ready;
+
+    // Processor signals
+    wire [(PABITS-3):0] InstMem_Address;
+    wire                InstMem_ReadLine;
+    wire                InstMem_ReadWord;
+    wire                InstMem_Ready;
+    wire [31:0]         InstMem_In;
+    wire [1:0]          InstMem_Offset;
+    wire [(PABITS-3):0] DataMem_Address;
+    wire                DataMem_ReadLine;
+    wire                DataMem_ReadWord;
+    reg  [31:0]         DataMem_In;
+    wire                DataMem_Ready;
+    wire [1:0]          DataMem_Offset;
+    wire                DataMem_WriteLineReady;
+    wire                DataMem_WriteWordReady;
+    wire [3:0]          DataMem_WriteWordBE;
+    wire [127:0]        DataMem_Out;
+    wire [4:0]          Interrupts = {5{1'b0}};
+    wire                NMI = 1'b0;
+
+    // Selection signals (word addresses)
+    wire khigh_sel_i  = (InstMem_Address >= 30'h07f00000) && (InstMem_Address < 30'h07f01000);
+    wire khigh_sel_d  = (DataMem_Address >= 30'h07f00000) && (DataMem_Address < 30'h07f01000);
+    wire klow_sel_i   = (InstMem_Address < 30'h1000);
+    wire klow_sel_d   = (DataMem_Address < 30'h1000);
+    wire vm_sel_i     = (InstMem_Address >= VM_BASE_ADDR[31:2]);
+    wire vm_sel_d     = (DataMem_Address >= VM_BASE_ADDR[31:2]);
+    wire rst_sel_d    = (DataMem_Address == 30'h07fffffb);
+    wire cmd_sel_d    = (DataMem_Address == 30'h07fffffc);
+    wire status_sel_d = (DataMem_Address == 30'h07fffffd);
+    wire test_sel_d   = (DataMem_Address == 30'h07fffffe);
+    wire scr_sel_d    = (DataMem_Address == 30'h07ffffff);
+
+    // Kernel high memory - 16 KiB [0x1fc00000 - 0x1fc04000)
+    // NOTE: Currently using last 1 KiB for an output buffer [0x1fc03c00 - 0x1fc04000)
+    MainMemory #(.ADDR_WIDTH(10), .CRIT_WORD_FIRST(EARLY_RESTART)) khigh_mem (
+        .clock            (clock),
+        .reset            (mips_reset),
+        .I_Address        (khigh_I_Address),
+        .I_DataIn         ({128{1'b0}}),
+        .I_DataOut        (khigh_I_DataOut),
+        .I_Ready          (khigh_I_Ready),
+        .I_DataOutOffset  (khigh_I_DataOutOffset),
+        .I_BootWrite      (1'b0),
+        .I_ReadLine       (khigh_I_ReadLine),
+        .I_ReadWord       (khigh_I_ReadWord),
+        .D_Address        (khigh_D_Address),
+        .D_DataIn         (khigh_D_DataIn),
+        .D_LineInReady    (khigh_D_LineInReady),
+        .D_WordInReady    (khigh_D_WordInReady),
+        .D_WordInBE       (khigh_D_WordInBE),
+        .D_DataOut        (khigh_D_DataOut),
+        .D_DataOutOffset  (khigh_D_DataOutOffset),
+        .D_ReadLine       (khigh_D_ReadLine),
+        .D_ReadWord       (khigh_D_ReadWord),
+        .D_Ready          (khigh_D_Ready)
+    );
+
+    // Kernel low memory - 16 KiB [0x00000000 - 0x00004000)
+    MainMemory #(.ADDR_WIDTH(10), .CRIT_WORD_FIRST(EARLY_RESTART)) klow_mem (
+        .clock            (clock),
+        .reset            (mips_reset),
+        .I_Address        (klow_I_Address),
+        .I_DataIn         ({128{1'b0}}),
+        .I_DataOut        (klow_I_DataOut),
+        .I_Ready          (klow_I_Ready),
+        .I_DataOutOffset  (klow_I_DataOutOffset),
+        .I_BootWrite      (1'b0),
+        .I_ReadLine       (klow_I_ReadLine),
+        .I_ReadWord       (klow_I_ReadWord),
+        .D_Address        (klow_D_Address),
+        .D_DataIn         (klow_D_DataIn),
+        .D_LineInReady    (klow_D_LineInReady),
+        .D_WordInReady    (klow_D_WordInReady),
+        .D_WordInBE       (klow_D_WordInBE),
+        .D_DataOut        (klow_D_DataOut),
+        .D_DataOutOffset  (klow_D_DataOutOffset),
+        .D_ReadLine       (klow_D_ReadLine),
+        .D_ReadWord       (klow_D_ReadWord),
+        .D_Ready          (klow_D_Ready)
+    );
+
+    // Virtual memory - VM_KB KiB [VM_BASE - VM_BASE + VM_KB KiB), with the timing of a DRAM if 'DRAM'
+    generate
+        if (DRAM) begin : vm
+            MainMemory_DRAM #(.ADDR_WIDTH(VM_ADDR_WIDTH), .CRIT_WORD_FIRST(EARLY_RESTART), .T_CTRL(DRAM_T_CTRL), .T_RCD(DRAM_T_RCD),
+                .T_CAS(DRAM_T_CAS), .T_RP(DRAM_T_RP), .T_BURST(DRAM_T_BURST), .BANK_BITS(DRAM_BANK_BITS),
+                .COL_BITS(DRAM_COL_BITS), .T_REFI(DRAM_T_REFI), .T_RFC(DRAM_T_RFC)) vm_mem (
+                .clock            (clock),
+                .reset            (reset),
+                .I_Address        (vm_I_Address),
+                .I_DataIn         ({128{1'b0}}),
+                .I_DataOut        (vm_I_DataOut),
+                .I_Ready          (vm_I_Ready),
+                .I_DataOutOffset  (vm_I_DataOutOffset),
+                .I_BootWrite      (1'b0),
+                .I_ReadLine       (vm_I_ReadLine),
+                .I_ReadWord       (vm_I_ReadWord),
+                .D_Address        (vm_D_Address),
+                .D_DataIn         (vm_D_DataIn),
+                .D_LineInReady    (vm_D_LineInReady),
+                .D_WordInReady    (vm_D_WordInReady),
+                .D_WordInBE       (vm_D_WordInBE),
+                .D_DataOut        (vm_D_DataOut),
+                .D_DataOutOffset  (vm_D_DataOutOffset),
+                .D_ReadLine       (vm_D_ReadLine),
+                .D_ReadWord       (vm_D_ReadWord),
+                .D_Ready          (vm_D_Ready)
+            );
+            assign dram_counts = {vm_mem.refreshes, vm_mem.queue_cycles, vm_mem.row_conflicts, vm_mem.row_empty, vm_mem.row_hits};
+        end
+        else begin : vm
+            MainMemory #(.ADDR_WIDTH(VM_ADDR_WIDTH), .CRIT_WORD_FIRST(EARLY_RESTART)) vm_mem (
+                .clock            (clock),
+                .reset            (reset),
+                .I_Address        (vm_I_Address),
+                .I_DataIn         ({128{1'b0}}),
+                .I_DataOut        (vm_I_DataOut),
+                .I_Ready          (vm_I_Ready),
+                .I_DataOutOffset  (vm_I_DataOutOffset),
+                .I_BootWrite      (1'b0),
+                .I_ReadLine       (vm_I_ReadLine),
+                .I_ReadWord       (vm_I_ReadWord),
+                .D_Address        (vm_D_Address),
+                .D_DataIn         (vm_D_DataIn),
+                .D_LineInReady    (vm_D_LineInReady),
+                .D_WordInReady    (vm_D_WordInReady),
+                .D_WordInBE       (vm_D_WordInBE),
+                .D_DataOut        (vm_D_DataOut),
+                .D_DataOutOffset  (vm_D_DataOutOffset),
+                .D_ReadLine       (vm_D_ReadLine),
+                .D_ReadWord       (vm_D_ReadWord),
+                .D_Ready          (vm_D_Ready)
+            );
+            assign dram_counts = {160{1'b0}};
+        end
+    endgenerate
+
+    // Processor + Caches
+    MIPS32 #(.PABITS(PABITS), .MULT_DSP(0), .BRANCH_PREDICT(BRANCH_PREDICT), .RAS_BITS(RAS_BITS), .DCACHE_BG_FILL(DCACHE_BG_FILL),
+             .ICACHE_INDEX_BITS(ICACHE_INDEX_BITS), .ICACHE_WAYS(ICACHE_WAYS), .DCACHE_INDEX_BITS(DCACHE_INDEX_BITS), .DCACHE_WAYS(DCACHE_WAYS),
+             .EARLY_RESTART(EARLY_RESTART), .PREFETCH(PREFETCH)) mips32_top (
+        .clock                   (clock),
+        .reset                   (mips_reset),
+        .Core_Reset              (mips_reset),
+        .InstMem_Address         (InstMem_Address),
+        .InstMem_ReadLine        (InstMem_ReadLine),
+        .InstMem_ReadWord        (InstMem_ReadWord),
+        .InstMem_Ready           (InstMem_Ready),
+        .InstMem_In              (InstMem_In),
+        .InstMem_Offset          (InstMem_Offset),
+        .DataMem_Address         (DataMem_Address),
+        .DataMem_ReadLine        (DataMem_ReadLine),
+        .DataMem_ReadWord        (DataMem_ReadWord),
+        .DataMem_In              (DataMem_In),
+        .DataMem_Ready           (DataMem_Ready),
+        .DataMem_Offset          (DataMem_Offset),
+        .DataMem_WriteLineReady  (DataMem_WriteLineReady),
+        .DataMem_WriteWordReady  (DataMem_WriteWordReady),
+        .DataMem_WriteWordBE     (DataMem_WriteWordBE),
+        .DataMem_Out             (DataMem_Out),
+        .Interrupts              (Interrupts),
+        .NMI                     (NMI)
+    );
+
+    // Cycle accounting for the CPI stack
+    CPI_Stack CpiStack (
+        .clock          (clock),
+        .reset          (mips_reset),
+        .Enable         (mips_cmd_reg[0]),
+        .W1_Issued      (mips32_top.Core.W1_Issued),
+        .W1_M2Issued    (mips32_top.Core.W1_M2Issued),
+        .F1_Flush       (mips32_top.Core.F1_Flush),
+        .F2_Flush       (mips32_top.Core.F2_Flush),
+        .W1_Flush       (mips32_top.Core.W1_Flush),
+        .F2_Stall       (mips32_top.Core.F2_Stall),
+        .D1_Stall       (mips32_top.Core.D1_Stall),
+        .D2_Stall       (mips32_top.Core.D2_Stall),
+        .X1_Stall       (mips32_top.Core.X1_Stall),
+        .M1_Stall       (mips32_top.Core.M1_Stall),
+        .M2_Stall       (mips32_top.Core.M2_Stall),
+        .W1_Stall       (mips32_top.Core.W1_Stall),
+        .D2_Data_Stall  (mips32_top.Core.Hazards.D2_Data_Stall),
+        .X1_Data_Stall  (mips32_top.Core.Hazards.X1_Data_Stall),
+        .W1_ALU_Stall   (mips32_top.Core.Hazards.W1_ALU_Stall),
+        .Counts         (StallCounts)
+    );
+
+    // Memory assignments
+    assign khigh_I_Address     = InstMem_Address[11:0];
+    assign klow_I_Address      = InstMem_Address[11:0];
+    assign vm_I_Address        = InstMem_Address[(VM_ADDR_WIDTH+1):0];
+    assign khigh_I_ReadLine    = InstMem_ReadLine & khigh_sel_i;
+    assign klow_I_ReadLine     = InstMem_ReadLine & klow_sel_i;
+    assign vm_I_ReadLine       = InstMem_ReadLine & vm_sel_i;
+    assign khigh_I_ReadWord    = InstMem_ReadWord & khigh_sel_i;
+    assign klow_I_ReadWord     = InstMem_ReadWord & klow_sel_i;
+    assign vm_I_ReadWord       = InstMem_ReadWord & vm_sel_i;
+    assign khigh_D_Address     = DataMem_Address[11:0];
+    assign klow_D_Address      = DataMem_Address[11:0];
+    assign vm_D_Address        = DataMem_Address[(VM_ADDR_WIDTH+1):0];
+    assign khigh_D_DataIn      = DataMem_Out;
+    assign klow_D_DataIn       = DataMem_Out;
+    assign vm_D_DataIn         = DataMem_Out;
+    assign khigh_D_LineInReady = DataMem_WriteLineReady & khigh_sel_d;
+    assign klow_D_LineInReady  = DataMem_WriteLineReady & klow_sel_d;
+    assign vm_D_LineInReady    = DataMem_WriteLineReady & vm_sel_d;
+    assign khigh_D_WordInReady = DataMem_WriteWordReady & khigh_sel_d;
+    assign klow_D_WordInReady  = DataMem_WriteWordReady & klow_sel_d;
+    assign vm_D_WordInReady    = DataMem_WriteWordReady & vm_sel_d;
+    assign khigh_D_WordInBE    = DataMem_WriteWordBE;
+    assign klow_D_WordInBE     = DataMem_WriteWordBE;
+    assign vm_D_WordInBE       = DataMem_WriteWordBE;
+    assign khigh_D_ReadLine    = DataMem_ReadLine & khigh_sel_d;
+    assign klow_D_ReadLine     = DataMem_ReadLine & klow_sel_d;
+    assign vm_D_ReadLine       = DataMem_ReadLine & vm_sel_d;
+    assign khigh_D_ReadWord    = DataMem_ReadWord & khigh_sel_d;
+    assign klow_D_ReadWord     = DataMem_ReadWord & klow_sel_d;
+    assign vm_D_ReadWord       = DataMem_ReadWord & vm_sel_d;
+
+    // Processor assignments
+    // Restrictions: The cmd/status/test/scr registers cannot be read by instruction memory. They can only be written as a full word.
+    assign InstMem_Ready  = (khigh_I_Ready & khigh_sel_i) | (klow_I_Ready & klow_sel_i) | (vm_I_Ready & vm_sel_i);
+    assign InstMem_In     = (khigh_sel_i) ? khigh_I_DataOut : ((klow_sel_i) ? klow_I_DataOut : vm_I_DataOut);
+    assign InstMem_Offset = (khigh_sel_i) ? khigh_I_DataOutOffset : ((klow_sel_i) ? klow_I_DataOutOffset : vm_I_DataOutOffset);
+
+    // Allow reading from the test registers by signaling 'Ready' one cycle after the read command
+    reg DataMem_ReadWord_r;
+    always @(posedge clock) begin
+        DataMem_ReadWord_r <= DataMem_ReadWord;
+    end
+
+    assign DataMem_Ready  = (khigh_D_Ready & khigh_sel_d) | (klow_D_Ready & klow_sel_d) | (vm_D_Ready & vm_sel_d) |
+                            ((DataMem_WriteWordReady | DataMem_ReadWord_r) & |{rst_sel_d, cmd_sel_d, status_sel_d, test_sel_d, scr_sel_d});
+    assign DataMem_Offset = (khigh_sel_d) ? khigh_D_DataOutOffset : ((klow_sel_d) ? klow_D_DataOutOffset : vm_D_DataOutOffset);
+
+    // If little-endian, swap the bytes of the test registers so they are consistent
+    // (These registers are not byte-addressable anyway)
+    wire [31:0] DataMem_Out_Endian;
+    wire [31:0] mips_rst_endian;
+    wire [31:0] mips_cmd_endian;
+    wire [31:0] mips_sta_endian;
+    wire [31:0] mips_tst_endian;
+    wire [31:0] mips_scr_endian;
+    generate
+        if (Big_Endian == 1'b1) begin
+            assign DataMem_Out_Endian = DataMem_Out;
+            assign mips_rst_endian = mips_rst_reg;
+            assign mips_cmd_endian = mips_cmd_reg;
+            assign mips_sta_endian = mips_sta_reg;
+            assign mips_tst_endian = mips_tst_reg;
+            assign mips_scr_endian = mips_scr_reg;
+        end
+        else begin
+            assign DataMem_Out_Endian = {DataMem_Out[7:0], DataMem_Out[15:8], DataMem_Out[23:16], DataMem_Out[31:24]};
+            assign mips_rst_endian = {mips_rst_reg[7:0], mips_rst_reg[15:8], mips_rst_reg[23:16], mips_rst_reg[31:24]};
+            assign mips_cmd_endian = {mips_cmd_reg[7:0], mips_cmd_reg[15:8], mips_cmd_reg[23:16], mips_cmd_reg[31:24]};
+            assign mips_sta_endian = {mips_sta_reg[7:0], mips_sta_reg[15:8], mips_sta_reg[23:16], mips_sta_reg[31:24]};
+            assign mips_tst_endian = {mips_tst_reg[7:0], mips_tst_reg[15:8], mips_tst_reg[23:16], mips_tst_reg[31:24]};
+            assign mips_scr_endian = {mips_scr_reg[7:0], mips_scr_reg[15:8], mips_scr_reg[23:16], mips_scr_reg[31:24]};
+        end
+    endgenerate
+
+    always @(*) begin
+        DataMem_In = {32{1'b0}};
+        if (khigh_sel_d) begin
+            DataMem_In = khigh_D_DataOut;
+        end
+        if (klow_sel_d) begin
+            DataMem_In = klow_D_DataOut;
+        end
+        if (vm_sel_d) begin
+            DataMem_In = vm_D_DataOut;
+        end
+        if (rst_sel_d) begin
+            DataMem_In = mips_rst_endian;
+        end
+        if (cmd_sel_d) begin
+            DataMem_In = mips_cmd_endian;
+        end
+        if (status_sel_d) begin
+            DataMem_In = mips_sta_endian;
+        end
+        if (test_sel_d) begin
+            DataMem_In = mips_tst_endian;
+        end
+        if (scr_sel_d) begin
+            DataMem_In = mips_scr_endian;
+        end
+    end
+
+    // Special register assignments
+    always @(posedge clock) begin
+        if (mips_reset) begin
+            mips_rst_reg <= {32{1'b0}};
+            mips_sta_reg <= {32{1'b0}};
+            mips_tst_reg <= {32{1'b0}};
+            mips_scr_reg <= {32{1'b0}};
+        end
+        else begin
+            mips_rst_reg <= (rst_sel_d    & DataMem_WriteWordReady) ? DataMem_Out_Endian[31:0] : ((mips_rst_reg > 32'd0) ? mips_rst_reg - 1 : mips_rst_reg);
+            mips_sta_reg <= (status_sel_d & DataMem_WriteWordReady) ? DataMem_Out_Endian[31:0] : ((StdoutAck) ? (mips_sta_reg & ~32'h2) : mips_sta_reg);
+            mips_tst_reg <= (test_sel_d   & DataMem_WriteWordReady) ? DataMem_Out_Endian[31:0] : mips_tst_reg;
+            mips_scr_reg <= (scr_sel_d    & DataMem_WriteWordReady) ? DataMem_Out_Endian[31:0] : mips_scr_reg;
+        end
+    end
+
+endmodule
+
@@ -39,6 +39,44 @@ unsigned int get_scratch(void) {
   return syscall_2(SYS_SCRATCH, SCRATCH_GET);
 }
 
+void perf_start(int counter, int event) {
+  // Clear the count, then count 'event' in every mode
+  unsigned int ctl = (event << 5) | PERF_COUNT_ALL;
+  if (counter == 0) {
+    asm volatile(
+        "mtc0 $0, $25, 1\n\t"
+        "mtc0 %[ctl], $25, 0\n\t"
+        :
+        : [ctl] "r" (ctl)
+       );
+  } else {
+    asm volatile(
+        "mtc0 $0, $25, 3\n\t"
+        "mtc0 %[ctl], $25, 2\n\t"
+        :
+        : [ctl] "r" (ctl)
+       );
+  }
+}
+
+void perf_stop(int counter) {
+  if (counter == 0) {
+    asm volatile("mtc0 $0, $25, 0\n\t");
+  } else {
+    asm volatile("mtc0 $0, $25, 2\n\t");
+  }
+}
+
+unsigned int perf_read(int counter) {
+  unsigned int res;
+  if (counter == 0) {
+    asm volatile("mfc0 %[res], $25, 1\n\t" : [res] "=r" (res));
+  } else {
+    asm volatile("mfc0 %[res], $25, 3\n\t" : [res] "=r" (res));
+  }
+  return res;
+}
+
 unsigned int syscall_1(int arg0) {
   register unsigned int res asm ("v0");
   asm volatile(
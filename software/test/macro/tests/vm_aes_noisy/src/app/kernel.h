@@ -29,6 +29,23 @@
 #define SCRATCH_SET 0
 #define SCRATCH_GET 1
 
+// Performance counters (CP0 register 25): two counters, each counting one event
+#define PERF_CYCLES 0
+#define PERF_INSTRUCTIONS 1
+#define PERF_BRANCHES 2
+#define PERF_BRANCH_FLUSHES 3
+#define PERF_ICACHE_MISSES 4
+#define PERF_ICACHE_STALLS 5
+#define PERF_DCACHE_MISSES 6
+#define PERF_DCACHE_STALLS 7
+#define PERF_ISSUE_STALLS 8
+#define PERF_ITLB_MISSES 9
+#define PERF_DTLB_MISSES 10
+#define PERF_COUNT_EXL 0x1
+#define PERF_COUNT_KERNEL 0x2
+#define PERF_COUNT_USER 0x8
+#define PERF_COUNT_ALL (PERF_COUNT_EXL | PERF_COUNT_KERNEL | PERF_COUNT_USER)
+
 // System call wrappers
 void kernel_mode(void);
 void user_mode(void);
@@ -40,6 +57,11 @@ unsigned int get_timer_bells(void);
 void set_scratch(unsigned int val);
 unsigned int get_scratch(void);
 
+// Performance counter access (mfc0/mtc0; requires kernel mode or Cp0 usable)
+void perf_start(int counter, int event);
+void perf_stop(int counter);
+unsigned int perf_read(int counter);
+
 // System call interface
 unsigned int syscall_1(int arg0);
 unsigned int syscall_2(int arg0, int arg1);
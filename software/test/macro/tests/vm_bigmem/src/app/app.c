@@ -0,0 +1,68 @@
+/*
+ * File         : app.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Use all of a multi-megabyte main memory. There is no linker script in
+ *   this test, so it is linked for the whole vm region of the harness (VM_KB,
+ *   see 'harness/gen_ld.py'), and the boot code maps all of the region with
+ *   large pages. The test writes a tag to every KiB of the heap, which spans
+ *   nearly all of the memory, and checks that none of them alias. Then it
+ *   copies the bottom quarter of the heap to the top quarter. The scratch
+ *   register holds the KiB of heap which were checked. The test passes if
+ *   all of the tags and the copy are correct for any VM_KB.
+ */
+#include <stdint.h>
+#include <string.h>
+#include "kernel.h"
+
+#define FAIL 0
+#define PASS 1
+
+#define STRIDE 1024
+
+extern char _heap_start[];
+extern char _heap_end[];
+
+static uint32_t tag(uintptr_t addr) {
+  return (addr * 2654435761u) ^ 0x5a5a5a5a;
+}
+
+int main(void) {
+  uintptr_t start = (uintptr_t)_heap_start;
+  uintptr_t end = (uintptr_t)_heap_end;
+  uint32_t block_words = (end - start) / (4 * sizeof(uint32_t));
+  uint32_t *src = (uint32_t *)start;
+  uint32_t *dst = (uint32_t *)(end - (block_words * sizeof(uint32_t)));
+  uintptr_t addr;
+  int result = PASS;
+  uint32_t i;
+
+  // Tag every KiB of the heap, then check them all
+  for (addr = start; addr < end; addr += STRIDE) {
+    *(volatile uint32_t *)addr = tag(addr);
+  }
+  for (addr = start; addr < end; addr += STRIDE) {
+    if (*(volatile uint32_t *)addr != tag(addr)) {
+      result = FAIL;
+    }
+  }
+
+  // Stream a quarter of the heap across the memory
+  for (i = 0; i < block_words; i++) {
+    src[i] = tag((uintptr_t)&src[i]);
+  }
+  memcpy(dst, src, block_words * sizeof(uint32_t));
+  for (i = 0; i < block_words; i++) {
+    if (dst[i] != tag((uintptr_t)&src[i])) {
+      result = FAIL;
+    }
+  }
+
+  set_scratch((end - start) / 1024);
+  return result;
+}
@@ -0,0 +1,106 @@
+###############################################################################
+# File         : boot.asm
+# Project      : MIPS32 Release 1
+# Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+# Date         : 1 June 2015
+#
+# Standards/Formatting:
+#   MIPS gas, soft tab, 80 column
+#
+# Description:
+#   Sets initial state of the processor on powerup.
+#
+###############################################################################
+
+# Large pages map all of the vm region: 0x0-(vm_kb KiB) virtual -> vm_base-(vm_base + vm_kb KiB) physical
+# ('vm_base' and 'vm_kb' are the physical base and size of the vm region, defined by the Makefile)
+#
+# The page size is the largest one that is at most half of the region, so one
+# or two TLB entries (two pages each) cover it. 'vm_base' must be aligned to
+# the page size, and the region must be at least 32 KiB.
+
+    .if (vm_kb >= 512 * 1024)
+    .set    page_kb, (256 * 1024)
+    .elseif (vm_kb >= 32 * 1024)
+    .set    page_kb, (16 * 1024)
+    .elseif (vm_kb >= 8 * 1024)
+    .set    page_kb, (4 * 1024)
+    .elseif (vm_kb >= 2 * 1024)
+    .set    page_kb, 1024
+    .elseif (vm_kb >= 512)
+    .set    page_kb, 256
+    .elseif (vm_kb >= 128)
+    .set    page_kb, 64
+    .else
+    .set    page_kb, 16
+    .endif
+    .set    page_mask, (((page_kb * 1024) - 1) << 1) & 0x1ffe000
+    .set    tlb_entries, (vm_kb / (2 * page_kb))
+
+    .section .boot, "wx"
+    .balign 4
+    .global boot
+    .ent    boot
+    .set    noreorder
+boot:
+    # First executed instruction at 0xbfc00000 (virt) / 0x1fc00000 (phys)
+    #
+    # General setup
+    mfc0    $k0, $12, 0         # Allow Cp0, no RE, no BEV, interrupts on but masked, kernel mode
+    lui     $k1, 0x1dbf
+    ori     $k1, 0x00ee
+    and     $k0, $k0, $k1
+    lui     $k1, 0x1000
+    ori     $k1, 0x1
+    or      $k0, $k0, $k1
+    mtc0    $k0, $12, 0
+    lui     $k1, 0x0080         # Use the special interrupt vector (0x200 offset)
+    mfc0    $k0, $13, 0
+    or      $k0, $k0, $k1
+    mtc0    $k0, $13, 0
+
+    # Virtual memory: Map the vm region via pairs of large pages in 'tlb_entries' TLB entries
+    # The translation adds the vm base, e.g., 0x0 (virt) -> 0x80000000 (phys)
+    ori     $t0, $0, tlb_entries    # Reserve (wire) the TLB entries
+    mtc0    $t0, $6, 0
+    li      $k1, page_mask      # Set the page size
+    mtc0    $k1, $5, 0
+    move    $t1, $0             # TLB index
+    li      $t2, ((vm_base >> 6) | 0x3f)    # PFN_n,0 of entry 0: vm_base + c/d/v/g
+    ori     $t3, $0, 1          # VPN2_n of entry 0: 0x00000000 with ASID 1
+    li      $t4, (page_kb << 4) # One page in EntryLo (PFN) units
+    li      $t5, (page_kb << 11)    # Two pages in bytes
+
+$map_entry:
+    mtc0    $t1, $0, 0          # Set the TLB index to n
+    mtc0    $t2, $2, 0          # Set PFN_n,0 to vm_base + (2n pages) + c/d/v/g
+    addu    $k0, $t2, $t4       # Set PFN_n,1 to vm_base + (2n+1 pages) + c/d/v/g
+    mtc0    $k0, $3, 0
+    mtc0    $t3, $10, 0         # Set VPN2_n to (2n pages) with ASID 1
+    tlbwi                       # Commit the two pages of entry n
+    addiu   $t1, $t1, 1
+    addu    $t2, $k0, $t4
+    bne     $t1, $t0, $map_entry
+    addu    $t3, $t3, $t5
+
+    # Return from reset exception
+    la      $k0, $run           # Set the ErrorEPC address to $run
+    mtc0    $k0, $30, 0
+    eret
+
+$run:
+    jalr    $0                  # Jump to virtual address 0x0 (user startup code)
+    nop
+
+$write_result:
+    lui     $t0, 0xbfff         # Load the special register base address 0xbffffff0
+    ori     $t0, 0xfff0
+    ori     $t1, $0, 1          # Set the done value
+    sw      $v0, 8($t0)         # Set the return value from main() as the test result
+    sw      $t1, 4($t0)         # Set 'done'
+
+$done:
+    j       $done               # Loop forever doing nothing
+    nop
+
+    .end boot
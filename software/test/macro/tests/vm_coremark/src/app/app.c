@@ -0,0 +1,54 @@
+/*
+ * File         : app.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Run a CoreMark-style benchmark (see coremark.h) and report its score in
+ *   iterations per million cycles (i.e., CoreMark/MHz for this workload) to
+ *   the stdout buffer. The scratch register holds the score in thousandths.
+ *   The test passes if the CRC of all iterations is correct.
+ *
+ *   The score is comparable between simulations of this test, not to published
+ *   CoreMark results: The data set is smaller than that of CoreMark.
+ */
+#include "bench.h"
+#include "coremark.h"
+#include "kernel.h"
+
+#define FAIL 0
+#define PASS 1
+
+#define ITERATIONS 2
+
+// Seeds (as in a CoreMark validation run, with fewer finds for the smaller list)
+#define SEED_1 0x3415
+#define SEED_2 0x3415
+#define SEED_3 8
+
+// CRC of all iterations (computed on a reference machine)
+#define EXPECTED_CRC 0x5ae3
+
+int main(void) {
+  uint16_t crc = 0;
+  unsigned int score;
+  int i;
+
+  cm_init(SEED_1, SEED_2, SEED_3);
+  bench_start();
+  for (i = 0; i < ITERATIONS; i++) {
+    crc = cm_iterate(crc);
+  }
+  bench_stop();
+
+  score = bench_result("CoreMark", ITERATIONS);
+  bench_puts("CRC: ");
+  bench_putu(crc);
+  bench_puts((crc == EXPECTED_CRC) ? " (correct)\n" : " (INCORRECT)\n");
+  bench_flush();
+  set_scratch(score);
+  return (crc == EXPECTED_CRC) ? PASS : FAIL;
+}
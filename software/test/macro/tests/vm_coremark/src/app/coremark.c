@@ -0,0 +1,608 @@
+/*
+ * File         : coremark.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A CoreMark-style workload (see coremark.h). The structure follows CoreMark:
+ *   each iteration processes the list twice (finding items by index and by
+ *   value), and sorting the list by a "complex" comparison runs the matrix and
+ *   state machine kernels on the data of the list items, caching the results.
+ *   Everything is accumulated into a CRC16.
+ */
+#include "coremark.h"
+
+//---------- CRC ----------//
+
+static uint16_t crcu8(uint8_t data, uint16_t crc) {
+  uint8_t i, x16, carry;
+  for (i = 0; i < 8; i++) {
+    x16 = (uint8_t)((data & 1) ^ ((uint8_t)crc & 1));
+    data >>= 1;
+    if (x16 == 1) {
+      crc ^= 0x4002;
+      carry = 1;
+    } else {
+      carry = 0;
+    }
+    crc >>= 1;
+    if (carry) {
+      crc |= 0x8000;
+    } else {
+      crc &= 0x7fff;
+    }
+  }
+  return crc;
+}
+
+static uint16_t crcu16(uint16_t value, uint16_t crc) {
+  crc = crcu8((uint8_t)value, crc);
+  return crcu8((uint8_t)(value >> 8), crc);
+}
+
+uint16_t cm_crcu32(uint32_t value, uint16_t crc) {
+  crc = crcu16((uint16_t)value, crc);
+  return crcu16((uint16_t)(value >> 16), crc);
+}
+
+uint16_t cm_crc16(int16_t value, uint16_t crc) {
+  return crcu16((uint16_t)value, crc);
+}
+
+//---------- Data set ----------//
+
+typedef struct {
+  int16_t data16;
+  int16_t idx;
+} list_data;
+
+typedef struct list_head_s {
+  struct list_head_s *next;
+  list_data *info;
+} list_head;
+
+typedef int32_t (*list_cmp)(list_data *a, list_data *b);
+
+static list_head list_pool[CM_LIST_ITEMS];
+static list_data data_pool[CM_LIST_ITEMS];
+static list_head *list;
+
+static int16_t mat_a[CM_MATRIX_N * CM_MATRIX_N];
+static int16_t mat_b[CM_MATRIX_N * CM_MATRIX_N];
+static int32_t mat_c[CM_MATRIX_N * CM_MATRIX_N];
+
+static uint8_t state_input[CM_STATE_BYTES];
+
+static int16_t seed_1, seed_2, seed_3;
+static uint16_t crc_all;
+
+//---------- Matrix ----------//
+
+static void matrix_add_const(int16_t *a, int16_t val) {
+  int i;
+  for (i = 0; i < CM_MATRIX_N * CM_MATRIX_N; i++) {
+    a[i] += val;
+  }
+}
+
+static void matrix_mul_const(int32_t *c, const int16_t *a, int16_t val) {
+  int i;
+  for (i = 0; i < CM_MATRIX_N * CM_MATRIX_N; i++) {
+    c[i] = (int32_t)a[i] * (int32_t)val;
+  }
+}
+
+static void matrix_mul_vect(int32_t *c, const int16_t *a, const int16_t *b) {
+  int i, j;
+  for (i = 0; i < CM_MATRIX_N; i++) {
+    c[i] = 0;
+    for (j = 0; j < CM_MATRIX_N; j++) {
+      c[i] += (int32_t)a[i * CM_MATRIX_N + j] * (int32_t)b[j];
+    }
+  }
+}
+
+static void matrix_mul_matrix(int32_t *c, const int16_t *a, const int16_t *b) {
+  int i, j, k;
+  for (i = 0; i < CM_MATRIX_N; i++) {
+    for (j = 0; j < CM_MATRIX_N; j++) {
+      c[i * CM_MATRIX_N + j] = 0;
+      for (k = 0; k < CM_MATRIX_N; k++) {
+        c[i * CM_MATRIX_N + j] += (int32_t)a[i * CM_MATRIX_N + k] * (int32_t)b[k * CM_MATRIX_N + j];
+      }
+    }
+  }
+}
+
+static void matrix_mul_matrix_bitextract(int32_t *c, const int16_t *a, const int16_t *b) {
+  int i, j, k;
+  for (i = 0; i < CM_MATRIX_N; i++) {
+    for (j = 0; j < CM_MATRIX_N; j++) {
+      c[i * CM_MATRIX_N + j] = 0;
+      for (k = 0; k < CM_MATRIX_N; k++) {
+        int32_t tmp = (int32_t)a[i * CM_MATRIX_N + k] * (int32_t)b[k * CM_MATRIX_N + j];
+        c[i * CM_MATRIX_N + j] += ((tmp >> 2) & 0xf) * ((tmp >> 5) & 0x7f);
+      }
+    }
+  }
+}
+
+// Reduce the result matrix to a number which depends on all of its values
+static int16_t matrix_sum(const int32_t *c, int32_t clipval) {
+  int32_t tmp = 0, prev = 0, cur;
+  int16_t ret = 0;
+  int i;
+  for (i = 0; i < CM_MATRIX_N * CM_MATRIX_N; i++) {
+    cur = c[i];
+    tmp += cur;
+    if (tmp > clipval) {
+      ret += 10;
+      tmp = 0;
+    } else {
+      ret += (cur > prev) ? 1 : 0;
+    }
+    prev = cur;
+  }
+  return ret;
+}
+
+static uint16_t bench_matrix(int16_t val, uint16_t crc) {
+  int32_t clipval = 0xf000 | val;
+  matrix_add_const(mat_a, val);
+  matrix_mul_const(mat_c, mat_a, val);
+  crc = cm_crc16(matrix_sum(mat_c, clipval), crc);
+  matrix_mul_vect(mat_c, mat_a, mat_b);
+  crc = cm_crc16(matrix_sum(mat_c, clipval), crc);
+  matrix_mul_matrix(mat_c, mat_a, mat_b);
+  crc = cm_crc16(matrix_sum(mat_c, clipval), crc);
+  matrix_mul_matrix_bitextract(mat_c, mat_a, mat_b);
+  crc = cm_crc16(matrix_sum(mat_c, clipval), crc);
+  matrix_add_const(mat_a, -val);
+  return crc;
+}
+
+static void init_matrix(int16_t seed) {
+  int32_t s = seed & 0xffff;
+  int32_t order = 1;
+  int i;
+  if (s == 0) {
+    s = 1;
+  }
+  for (i = 0; i < CM_MATRIX_N * CM_MATRIX_N; i++) {
+    s = (order * s) % 65536;
+    mat_b[i] = (int16_t)((s + order) & 0xff);
+    mat_a[i] = (int16_t)((s + 2 * order) & 0xff);
+    order++;
+  }
+}
+
+//---------- State machine ----------//
+
+enum state {
+  ST_START, ST_INVALID, ST_S1, ST_S2, ST_INT, ST_FLOAT, ST_EXPONENT, ST_SCIENTIFIC, ST_NUM
+};
+
+static int is_digit(uint8_t c) {
+  return (c >= '0') && (c <= '9');
+}
+
+// Scan one comma-separated token for a number (integer, float, or scientific)
+static enum state state_transition(uint8_t **instr, uint32_t *count) {
+  uint8_t *str = *instr;
+  enum state state = ST_START;
+  for (; *str && (state != ST_INVALID); str++) {
+    uint8_t c = *str;
+    if (c == ',') {
+      str++;
+      break;
+    }
+    switch (state) {
+      case ST_START:
+        if (is_digit(c)) {
+          state = ST_INT;
+        } else if ((c == '+') || (c == '-')) {
+          state = ST_S1;
+        } else if (c == '.') {
+          state = ST_FLOAT;
+        } else {
+          state = ST_INVALID;
+          count[ST_INVALID]++;
+        }
+        count[ST_START]++;
+        break;
+      case ST_S1:
+        if (is_digit(c)) {
+          state = ST_INT;
+        } else if (c == '.') {
+          state = ST_FLOAT;
+        } else {
+          state = ST_INVALID;
+        }
+        count[ST_S1]++;
+        break;
+      case ST_INT:
+        if (c == '.') {
+          state = ST_FLOAT;
+          count[ST_INT]++;
+        } else if (!is_digit(c)) {
+          state = ST_INVALID;
+          count[ST_INT]++;
+        }
+        break;
+      case ST_FLOAT:
+        if ((c == 'E') || (c == 'e')) {
+          state = ST_S2;
+          count[ST_FLOAT]++;
+        } else if (!is_digit(c)) {
+          state = ST_INVALID;
+          count[ST_FLOAT]++;
+        }
+        break;
+      case ST_S2:
+        state = ((c == '+') || (c == '-')) ? ST_EXPONENT : ST_INVALID;
+        count[ST_S2]++;
+        break;
+      case ST_EXPONENT:
+        state = (is_digit(c)) ? ST_SCIENTIFIC : ST_INVALID;
+        count[ST_EXPONENT]++;
+        break;
+      case ST_SCIENTIFIC:
+        if (!is_digit(c)) {
+          state = ST_INVALID;
+          count[ST_INVALID]++;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  *instr = str;
+  return state;
+}
+
+// Scan the input, corrupt it, scan it again, and restore it (if the seeds are equal)
+static uint16_t bench_state(int16_t step, uint16_t crc) {
+  uint32_t final_counts[ST_NUM];
+  uint32_t track_counts[ST_NUM];
+  uint8_t *p;
+  int i;
+
+  for (i = 0; i < ST_NUM; i++) {
+    final_counts[i] = 0;
+    track_counts[i] = 0;
+  }
+  p = state_input;
+  while (*p) {
+    final_counts[state_transition(&p, track_counts)]++;
+  }
+  for (i = 0; i < CM_STATE_BYTES; i += step) {
+    if (state_input[i] != ',') {
+      state_input[i] ^= (uint8_t)seed_1;
+    }
+  }
+  p = state_input;
+  while (*p) {
+    final_counts[state_transition(&p, track_counts)]++;
+  }
+  for (i = 0; i < CM_STATE_BYTES; i += step) {
+    if (state_input[i] != ',') {
+      state_input[i] ^= (uint8_t)seed_2;
+    }
+  }
+  for (i = 0; i < ST_NUM; i++) {
+    crc = cm_crcu32(final_counts[i], crc);
+    crc = cm_crcu32(track_counts[i], crc);
+  }
+  return crc;
+}
+
+// Fill the input with comma-separated numbers of each kind (and some invalid ones)
+static void init_state(int16_t seed) {
+  static const char *int_pat[4] = { "5012", "1234", "-874", "+122" };
+  static const char *float_pat[4] = { "35.54400", ".1234500", "-110.700", "+0.64400" };
+  static const char *sci_pat[4] = { "5.500e+3", "-.123e-2", "-87e+832", "+0.6e-12" };
+  static const char *err_pat[4] = { "T0.3e-1F", "-T.T++Tq", "1T3.4e4z", "34.0e-T^" };
+  const char *buf = 0;
+  uint32_t s = (uint16_t)seed;
+  uint32_t total = 0, next = 0, i;
+
+  while ((total + next + 1) < (CM_STATE_BYTES - 1)) {
+    if (next > 0) {
+      for (i = 0; i < next; i++) {
+        state_input[total + i] = (uint8_t)buf[i];
+      }
+      state_input[total + i] = ',';
+      total += next + 1;
+    }
+    s++;
+    switch (s & 0x7) {
+      case 0:
+      case 1:
+      case 2:
+        buf = int_pat[(s >> 3) & 0x3];
+        next = 4;
+        break;
+      case 3:
+      case 4:
+        buf = float_pat[(s >> 3) & 0x3];
+        next = 8;
+        break;
+      case 5:
+      case 6:
+        buf = sci_pat[(s >> 3) & 0x3];
+        next = 8;
+        break;
+      default:
+        buf = err_pat[(s >> 3) & 0x3];
+        next = 8;
+        break;
+    }
+  }
+  while (total < CM_STATE_BYTES) {
+    state_input[total++] = 0;
+  }
+}
+
+//---------- List ----------//
+
+// The sort key of an item: a matrix or state result (cached in the low byte), or the data itself
+static int16_t calc_func(int16_t *pdata) {
+  int16_t data = *pdata;
+  int16_t retval, flag, dtype;
+
+  if ((data >> 7) & 1) {
+    return data & 0x007f;
+  }
+  flag = data & 0x7;
+  dtype = (data >> 3) & 0xf;
+  dtype |= dtype << 4;
+  switch (flag) {
+    case 0:
+      if (dtype < 0x22) {
+        dtype = 0x22;
+      }
+      retval = (int16_t)bench_state(dtype, crc_all);
+      break;
+    case 1:
+      retval = (int16_t)bench_matrix(dtype, crc_all);
+      break;
+    default:
+      retval = data;
+      break;
+  }
+  crc_all = crcu16((uint16_t)retval, crc_all);
+  retval &= 0x007f;
+  *pdata = (int16_t)((data & 0xff00) | 0x0080 | retval);
+  return retval;
+}
+
+static int32_t cmp_complex(list_data *a, list_data *b) {
+  int16_t val1 = calc_func(&a->data16);
+  int16_t val2 = calc_func(&b->data16);
+  return val1 - val2;
+}
+
+// Order by index, and clear the cached sort keys
+static int32_t cmp_idx(list_data *a, list_data *b) {
+  a->data16 = (int16_t)((a->data16 & 0xff00) | (0x00ff & (a->data16 >> 8)));
+  b->data16 = (int16_t)((b->data16 & 0xff00) | (0x00ff & (b->data16 >> 8)));
+  return a->idx - b->idx;
+}
+
+static list_head *list_find(list_head *l, const list_data *info) {
+  if (info->idx >= 0) {
+    while (l && (l->info->idx != info->idx)) {
+      l = l->next;
+    }
+  } else {
+    while (l && ((l->info->data16 & 0xff) != info->data16)) {
+      l = l->next;
+    }
+  }
+  return l;
+}
+
+static list_head *list_reverse(list_head *l) {
+  list_head *next = 0, *tmp;
+  while (l) {
+    tmp = l->next;
+    l->next = next;
+    next = l;
+    l = tmp;
+  }
+  return next;
+}
+
+// Remove the item after 'item' (by swapping data with it)
+static list_head *list_remove(list_head *item) {
+  list_data *tmp;
+  list_head *ret = item->next;
+  tmp = item->info;
+  item->info = ret->info;
+  ret->info = tmp;
+  item->next = item->next->next;
+  ret->next = 0;
+  return ret;
+}
+
+static list_head *list_undo_remove(list_head *removed, list_head *modified) {
+  list_data *tmp = removed->info;
+  removed->info = modified->info;
+  modified->info = tmp;
+  removed->next = modified->next;
+  modified->next = removed;
+  return removed;
+}
+
+// Bottom-up merge sort, which is stable and needs no recursion or extra memory
+static list_head *list_mergesort(list_head *l, list_cmp cmp) {
+  list_head *p, *q, *e, *tail;
+  int32_t insize = 1, nmerges, psize, qsize, i;
+
+  while (1) {
+    p = l;
+    l = 0;
+    tail = 0;
+    nmerges = 0;
+    while (p) {
+      nmerges++;
+      q = p;
+      psize = 0;
+      for (i = 0; i < insize; i++) {
+        psize++;
+        q = q->next;
+        if (!q) {
+          break;
+        }
+      }
+      qsize = insize;
+      while ((psize > 0) || ((qsize > 0) && q)) {
+        if (psize == 0) {
+          e = q;
+          q = q->next;
+          qsize--;
+        } else if ((qsize == 0) || !q) {
+          e = p;
+          p = p->next;
+          psize--;
+        } else if (cmp(p->info, q->info) <= 0) {
+          e = p;
+          p = p->next;
+          psize--;
+        } else {
+          e = q;
+          q = q->next;
+          qsize--;
+        }
+        if (tail) {
+          tail->next = e;
+        } else {
+          l = e;
+        }
+        tail = e;
+      }
+      p = q;
+    }
+    tail->next = 0;
+    if (nmerges <= 1) {
+      return l;
+    }
+    insize *= 2;
+  }
+}
+
+static void init_list(int16_t seed) {
+  list_head *finder;
+  int i;
+
+  // The head is never moved by a sort (its key is cached and minimal)
+  list = &list_pool[0];
+  list->next = 0;
+  list->info = &data_pool[0];
+  list->info->data16 = (int16_t)0x8080;
+  list->info->idx = 0x0000;
+  for (i = 1; i < CM_LIST_ITEMS; i++) {
+    uint16_t datpat = ((uint16_t)(seed ^ i) & 0xf);
+    uint16_t dat = (datpat << 3) | (i & 0x7);
+    list_pool[i].info = &data_pool[i];
+    data_pool[i].data16 = (int16_t)((dat << 8) | dat);
+    data_pool[i].idx = 0x7fff;
+    list_pool[i].next = list->next;
+    list->next = &list_pool[i];
+  }
+
+  // Some of the items are in order, the rest are scrambled
+  for (i = 0, finder = list->next; finder; finder = finder->next) {
+    if (i < CM_LIST_ITEMS / 5) {
+      finder->info->idx = (int16_t)i++;
+    } else {
+      uint16_t pat = (uint16_t)(i++ ^ seed);
+      finder->info->idx = (int16_t)(0x3fff & (((i & 0x07) << 8) | pat));
+    }
+  }
+  list = list_mergesort(list, cmp_idx);
+}
+
+static uint16_t bench_list(int16_t finder_idx) {
+  uint16_t retval = 0;
+  uint16_t found = 0, missed = 0;
+  list_head *this_find, *finder, *remover;
+  list_data info = { 0, 0 };
+  int16_t i;
+
+  info.idx = finder_idx;
+  for (i = 0; i < seed_3; i++) {
+    info.data16 = (i & 0xff);
+    this_find = list_find(list, &info);
+    list = list_reverse(list);
+    if (this_find == 0) {
+      missed++;
+      retval += (list->next->info->data16 >> 8) & 1;
+    } else {
+      found++;
+      if (this_find->info->data16 & 0x1) {
+        retval += (this_find->info->data16 >> 9) & 1;
+      }
+      // Move the next item to the front of the list
+      if (this_find->next != 0) {
+        finder = this_find->next;
+        this_find->next = finder->next;
+        finder->next = list->next;
+        list->next = finder;
+      }
+    }
+    if (info.idx >= 0) {
+      info.idx++;
+    }
+  }
+  retval += found * 4 - missed;
+
+  // Sort by the complex key, and walk the list with one item removed
+  if (seed_3 > 0) {
+    list = list_mergesort(list, cmp_complex);
+  }
+  remover = list_remove(list->next);
+  finder = list_find(list, &info);
+  if (!finder) {
+    finder = list->next;
+  }
+  while (finder) {
+    retval = cm_crc16(list->info->data16, retval);
+    finder = finder->next;
+  }
+  list_undo_remove(remover, list->next);
+
+  // Back to the original order
+  list = list_mergesort(list, cmp_idx);
+  for (finder = list->next; finder; finder = finder->next) {
+    retval = cm_crc16(finder->info->data16, retval);
+  }
+  return retval;
+}
+
+//---------- Benchmark ----------//
+
+void cm_init(int16_t seed1, int16_t seed2, int16_t seed3) {
+  seed_1 = seed1;
+  seed_2 = seed2;
+  seed_3 = seed3;
+  crc_all = 0;
+  init_list(seed1);
+  init_matrix(seed1);
+  init_state(seed1);
+}
+
+uint16_t cm_iterate(uint16_t crc) {
+  uint16_t result;
+
+  // (The list benchmarks also update 'crc_all', so read it after each one)
+  crc_all = crc;
+  result = bench_list(1);
+  crc_all = crcu16(result, crc_all);
+  result = bench_list(-1);
+  crc_all = crcu16(result, crc_all);
+  return crc_all;
+}
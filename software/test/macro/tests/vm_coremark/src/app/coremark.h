@@ -0,0 +1,34 @@
+#ifndef COREMARK_H
+#define COREMARK_H
+
+/*
+ * File         : coremark.h
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A CoreMark-style workload: linked-list processing, matrix arithmetic, a
+ *   state machine over a text buffer, and CRC16 of all of the results, in the
+ *   proportions of CoreMark but with a smaller data set (2 KiB) so that it
+ *   runs in reasonable simulation time.
+ */
+#include <stdint.h>
+
+// Data set: list pool, three matrices, and the state machine input
+#define CM_LIST_ITEMS 48
+#define CM_MATRIX_N 8
+#define CM_STATE_BYTES 256
+
+uint16_t cm_crc16(int16_t value, uint16_t crc);
+uint16_t cm_crcu32(uint32_t value, uint16_t crc);
+
+// Initialize the data set from the seeds
+void cm_init(int16_t seed1, int16_t seed2, int16_t seed3);
+
+// One iteration over the whole data set, which returns its CRC
+uint16_t cm_iterate(uint16_t crc);
+
+#endif  // COREMARK_H
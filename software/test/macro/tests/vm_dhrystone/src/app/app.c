@@ -0,0 +1,38 @@
+/*
+ * File         : app.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Run Dhrystone 2.1 (see dhry.h) and report its score in iterations per
+ *   million cycles and in DMIPS/MHz (iterations per second per MHz divided by
+ *   1757, the score of the VAX 11/780) to the stdout buffer. The scratch
+ *   register holds the iterations per million cycles in thousandths. The test
+ *   passes if the final values of the benchmark are correct.
+ */
+#include "bench.h"
+#include "dhry.h"
+#include "kernel.h"
+
+#define FAIL 0
+#define PASS 1
+
+#define RUNS 1000
+#define VAX_DHRYSTONES 1757
+
+int main(void) {
+  unsigned int score;
+  int correct;
+
+  correct = dhry_run(RUNS);
+  score = bench_result("Dhrystone", RUNS);
+  bench_puts("DMIPS/MHz: ");
+  bench_putk(score / VAX_DHRYSTONES);
+  bench_puts((correct) ? " (correct)\n" : " (INCORRECT)\n");
+  bench_flush();
+  set_scratch(score);
+  return (correct) ? PASS : FAIL;
+}
@@ -0,0 +1,107 @@
+/*
+ * File         : bench.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Timing and reporting for the benchmark tests (see bench.h).
+ */
+#include "bench.h"
+#include "kernel.h"
+
+// Test harness stdout buffer (1 KiB, kernel-mode only) and status register
+#define STDOUT_BUFFER ((volatile char *)0xbfc03c00)
+#define STDOUT_SIZE 1024
+#define STATUS_REG ((volatile unsigned int *)0xbffffff4)
+#define STATUS_STDOUT 0x2
+
+static char text[STDOUT_SIZE];
+static unsigned int text_len;
+static unsigned int cycles;
+static unsigned int instructions;
+
+void bench_start(void) {
+  perf_start(0, PERF_CYCLES);
+  perf_start(1, PERF_INSTRUCTIONS);
+}
+
+void bench_stop(void) {
+  perf_stop(0);
+  perf_stop(1);
+  cycles = perf_read(0);
+  instructions = perf_read(1);
+}
+
+unsigned int bench_cycles(void) {
+  return cycles;
+}
+
+unsigned int bench_instructions(void) {
+  return instructions;
+}
+
+unsigned int bench_result(const char *name, unsigned int iterations) {
+  unsigned int score = (cycles) ? (unsigned int)((unsigned long long)iterations * 1000000000ULL / cycles) : 0;
+  unsigned int cpi = (instructions) ? (unsigned int)((unsigned long long)cycles * 1000ULL / instructions) : 0;
+
+  bench_puts(name);
+  bench_puts(": ");
+  bench_putu(iterations);
+  bench_puts(" iterations, ");
+  bench_putu(cycles);
+  bench_puts(" cycles, ");
+  bench_putu(instructions);
+  bench_puts(" instructions, ");
+  bench_putk(score);
+  bench_puts(" iterations/Mcycle, CPI ");
+  bench_putk(cpi);
+  bench_puts("\n");
+  return score;
+}
+
+void bench_puts(const char *s) {
+  // Keep the last byte for the terminating NULL
+  while (*s && (text_len < STDOUT_SIZE - 1)) {
+    text[text_len++] = *s++;
+  }
+}
+
+void bench_putu(unsigned int value) {
+  char digits[11];
+  int i = 10;
+  digits[i] = '\0';
+  do {
+    digits[--i] = '0' + (value % 10);
+    value /= 10;
+  } while (value);
+  bench_puts(&digits[i]);
+}
+
+void bench_putk(unsigned int thousandths) {
+  char frac[5];
+  unsigned int f = thousandths % 1000;
+  bench_putu(thousandths / 1000);
+  frac[0] = '.';
+  frac[1] = '0' + (f / 100);
+  frac[2] = '0' + ((f / 10) % 10);
+  frac[3] = '0' + (f % 10);
+  frac[4] = '\0';
+  bench_puts(frac);
+}
+
+void bench_flush(void) {
+  unsigned int i;
+
+  // The buffer and the status register are only accessible in kernel mode
+  kernel_mode();
+  for (i = 0; i < text_len; i++) {
+    STDOUT_BUFFER[i] = text[i];
+  }
+  STDOUT_BUFFER[text_len] = '\0';
+  *STATUS_REG = STATUS_STDOUT;
+  user_mode();
+  text_len = 0;
+}
@@ -0,0 +1,78 @@
+#ifndef DHRY_H
+#define DHRY_H
+
+/*
+ * File         : dhry.h
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   A Dhrystone 2.1 workload (after Reinhold P. Weicker's benchmark). The
+ *   procedures are split across two files as in the original so that the
+ *   calls between them are not inlined. The records are static instead of
+ *   allocated. The measurement is of the main loop only.
+ */
+
+typedef enum { Ident_1, Ident_2, Ident_3, Ident_4, Ident_5 } Enumeration;
+
+typedef int One_Thirty;
+typedef int One_Fifty;
+typedef char Capital_Letter;
+typedef int Boolean;
+typedef char Str_30[31];
+typedef int Arr_1_Dim[50];
+typedef int Arr_2_Dim[50][50];
+
+typedef struct record {
+  struct record *Ptr_Comp;
+  Enumeration Discr;
+  union {
+    struct {
+      Enumeration Enum_Comp;
+      int Int_Comp;
+      char Str_Comp[31];
+    } var_1;
+    struct {
+      Enumeration E_Comp_2;
+      char Str_2_Comp[31];
+    } var_2;
+    struct {
+      char Ch_1_Comp;
+      char Ch_2_Comp;
+    } var_3;
+  } variant;
+} Rec_Type, *Rec_Pointer;
+
+// Global state (dhry_1.c)
+extern Rec_Pointer Ptr_Glob;
+extern Rec_Pointer Next_Ptr_Glob;
+extern int Int_Glob;
+extern Boolean Bool_Glob;
+extern char Ch_1_Glob;
+extern char Ch_2_Glob;
+extern int Arr_1_Glob[50];
+extern int Arr_2_Glob[50][50];
+
+// Set up the records, run the main loop 'runs' times (timed with bench.h),
+// and return whether every variable has the value that Dhrystone expects
+int dhry_run(int runs);
+
+// dhry_1.c
+void Proc_1(Rec_Pointer Ptr_Val_Par);
+void Proc_2(One_Fifty *Int_Par_Ref);
+void Proc_3(Rec_Pointer *Ptr_Ref_Par);
+void Proc_4(void);
+void Proc_5(void);
+
+// dhry_2.c
+void Proc_6(Enumeration Enum_Val_Par, Enumeration *Enum_Ref_Par);
+void Proc_7(One_Fifty Int_1_Par_Val, One_Fifty Int_2_Par_Val, One_Fifty *Int_Par_Ref);
+void Proc_8(Arr_1_Dim Arr_1_Par_Ref, Arr_2_Dim Arr_2_Par_Ref, int Int_1_Par_Val, int Int_2_Par_Val);
+Enumeration Func_1(Capital_Letter Ch_1_Par_Val, Capital_Letter Ch_2_Par_Val);
+Boolean Func_2(Str_30 Str_1_Par_Ref, Str_30 Str_2_Par_Ref);
+Boolean Func_3(Enumeration Enum_Par_Val);
+
+#endif  // DHRY_H
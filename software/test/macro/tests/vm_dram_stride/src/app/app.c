@@ -0,0 +1,57 @@
+/*
+ * File         : app.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Access the second 64-KiB page of the vm region (physical 0x80010000-
+ *   0x8001ffff, see 'boot.asm') in two patterns for the DRAM model of the
+ *   harness ('MainMemory_DRAM.v', 'make dram'). With its default geometry a
+ *   row is 2 KiB and the 8 banks repeat every 16 KiB:
+ *
+ *     1. Tag one word of every 16-byte line in order. The line misses of a
+ *        2-KiB run go to the open row of one bank (row hits).
+ *     2. Check the tags with a 16-KiB stride, which visits four rows of the
+ *        same bank in turn (row conflicts). The four lines share one set of
+ *        the data cache, so each of them misses.
+ *
+ *   'dram.conf' gives the minimum counts of the DRAM model. The test passes
+ *   if all of the tags are correct.
+ */
+#include <stdint.h>
+
+#define FAIL 0
+#define PASS 1
+
+#define REGION_BASE 0x00010000
+#define REGION_SIZE 0x00010000
+#define LINE        16
+#define ROW_STRIDE  0x4000
+
+static uint32_t tag(uintptr_t addr) {
+    return (addr * 2654435761u) ^ 0x5a5a5a5a;
+}
+
+int main(void) {
+    uintptr_t addr, col;
+    int result = PASS;
+
+    // Sequential: row hits
+    for (addr = REGION_BASE; addr < REGION_BASE + REGION_SIZE; addr += LINE) {
+        *(volatile uint32_t *)addr = tag(addr);
+    }
+
+    // Strided by whole row sets: row conflicts
+    for (col = 0; col < ROW_STRIDE; col += LINE) {
+        for (addr = REGION_BASE + col; addr < REGION_BASE + REGION_SIZE; addr += ROW_STRIDE) {
+            if (*(volatile uint32_t *)addr != tag(addr)) {
+                result = FAIL;
+            }
+        }
+    }
+
+    return result;
+}
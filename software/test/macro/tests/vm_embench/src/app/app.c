@@ -0,0 +1,64 @@
+/*
+ * File         : app.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Run the Embench-style kernels (see embench.h) one after another and report
+ *   the score of each in iterations per million cycles to the stdout buffer.
+ *   The scratch register holds the total cycles of the kernels. The test passes
+ *   if the checksum of every kernel is correct.
+ */
+#include "bench.h"
+#include "embench.h"
+#include "kernel.h"
+
+#define FAIL 0
+#define PASS 1
+
+typedef struct {
+  const char *name;
+  void (*init)(void);
+  uint32_t (*run)(int iterations);
+  int iterations;
+  uint32_t expected;    // Checksum (computed on a reference machine)
+} kernel;
+
+static const kernel kernels[] = {
+  { "crc32",       eb_crc32_init,   eb_crc32,      16, 0xbdbc7f93 },
+  { "matmult-int", eb_matmult_init, eb_matmult,     4, 0x3960790c },
+  { "edn",         eb_edn_init,     eb_edn,         2, 0x15ed1a10 },
+  { "ud",          0,               eb_ud,         16, 0x000000b0 },
+  { "primecount",  0,               eb_primecount,  8, 0x000011a0 },
+};
+
+int main(void) {
+  unsigned int total_cycles = 0;
+  int result = PASS;
+  unsigned int i;
+
+  for (i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+    const kernel *k = &kernels[i];
+    uint32_t check;
+
+    if (k->init) {
+      k->init();
+    }
+    bench_start();
+    check = k->run(k->iterations);
+    bench_stop();
+    bench_result(k->name, k->iterations);
+    total_cycles += bench_cycles();
+    if (check != k->expected) {
+      bench_puts(k->name);
+      bench_puts(": INCORRECT checksum\n");
+      result = FAIL;
+    }
+  }
+  bench_flush();
+  set_scratch(total_cycles);
+  return result;
+}
@@ -0,0 +1,43 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/*
+ * File         : bench.h
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Timing and reporting for the benchmark tests. A measurement counts cycles
+ *   and retired instructions with the CP0 performance counters. The results are
+ *   collected as text and written to the stdout buffer of the test harness at
+ *   once (the harness copies the buffer to 'test.stdout' when it is enabled).
+ *
+ *   Scores are iterations per million cycles, i.e., per MHz, in thousandths.
+ */
+
+// Count cycles and instructions from here
+void bench_start(void);
+
+// Stop counting
+void bench_stop(void);
+
+unsigned int bench_cycles(void);
+unsigned int bench_instructions(void);
+
+// Append a result line for the last measurement, e.g.,
+//   "CoreMark: 10 iterations, 123456 cycles, 98765 instructions, 81.002 iterations/Mcycle, CPI 1.250"
+// and return the score in thousandths of iterations per million cycles
+unsigned int bench_result(const char *name, unsigned int iterations);
+
+// Append text, an unsigned number, or a number in thousandths (e.g., "81.002")
+void bench_puts(const char *text);
+void bench_putu(unsigned int value);
+void bench_putk(unsigned int thousandths);
+
+// Write the text to the stdout buffer (once, at the end of the test)
+void bench_flush(void);
+
+#endif  // BENCH_H
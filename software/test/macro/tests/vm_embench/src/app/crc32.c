@@ -0,0 +1,52 @@
+/*
+ * File         : crc32.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   crc32: The CRC-32 (IEEE 802.3) of a buffer of random bytes, with a
+ *   table of 256 entries.
+ */
+#include "embench.h"
+
+#define CRC32_BYTES 1024
+
+static uint32_t crc32_table[256];
+static uint8_t crc32_data[CRC32_BYTES];
+
+void eb_crc32_init(void) {
+  uint32_t i, j, c;
+  for (i = 0; i < 256; i++) {
+    c = i;
+    for (j = 0; j < 8; j++) {
+      c = (c & 1) ? (0xedb88320u ^ (c >> 1)) : (c >> 1);
+    }
+    crc32_table[i] = c;
+  }
+  eb_srand(0);
+  for (i = 0; i < CRC32_BYTES; i++) {
+    crc32_data[i] = (uint8_t)eb_rand();
+  }
+}
+
+static uint32_t crc32(const uint8_t *buf, int len) {
+  uint32_t crc = 0xffffffffu;
+  int i;
+  for (i = 0; i < len; i++) {
+    crc = crc32_table[(crc ^ buf[i]) & 0xff] ^ (crc >> 8);
+  }
+  return crc ^ 0xffffffffu;
+}
+
+uint32_t eb_crc32(int iterations) {
+  uint32_t check = 0;
+  int i;
+  for (i = 0; i < iterations; i++) {
+    check ^= crc32(crc32_data, CRC32_BYTES);
+    crc32_data[i % CRC32_BYTES]++;
+  }
+  return check;
+}
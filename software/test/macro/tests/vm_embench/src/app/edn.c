@@ -0,0 +1,121 @@
+/*
+ * File         : edn.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   edn: Signal processing on 16-bit data (vector multiply, multiply-accumulate,
+ *   FIR filter, lattice synthesis, and a cascade of IIR biquads). The work
+ *   arrays are restored from the input each iteration so that the values stay
+ *   in range.
+ */
+#include "embench.h"
+
+#define EDN_N 128
+#define EDN_ORDER 32
+#define EDN_SECTIONS 32
+
+static int16_t edn_input[EDN_N];
+static int16_t edn_coef[EDN_N];
+static int16_t edn_a[EDN_N];
+static int16_t edn_b[EDN_N];
+static int32_t edn_out[EDN_N];
+static int32_t edn_state[2 * EDN_SECTIONS];
+
+// Samples and coefficients in [-2048, 2047]
+static int16_t sample(void) {
+  return (int16_t)((int32_t)(eb_rand() & 0xfff) - 0x800);
+}
+
+void eb_edn_init(void) {
+  int i;
+  eb_srand(1);
+  for (i = 0; i < EDN_N; i++) {
+    edn_input[i] = sample();
+    edn_coef[i] = sample();
+  }
+}
+
+static void vec_mpy1(int16_t *y, const int16_t *x, int16_t scaler) {
+  int i;
+  for (i = 0; i < EDN_N; i++) {
+    y[i] += (int16_t)(((int32_t)scaler * x[i]) >> 15);
+  }
+}
+
+static int32_t mac(const int16_t *a, const int16_t *b, int32_t *sqr) {
+  int32_t sum = 0;
+  int i;
+  *sqr = 0;
+  for (i = 0; i < EDN_N; i++) {
+    sum += (int32_t)a[i] * b[i];
+    *sqr += (int32_t)b[i] * b[i];
+  }
+  return sum;
+}
+
+static void fir(const int16_t *in, int32_t *out, const int16_t *coef) {
+  int i, j;
+  for (j = 0; j < EDN_N - EDN_ORDER; j++) {
+    int32_t sum = 0;
+    for (i = 0; i < EDN_ORDER; i++) {
+      sum += (int32_t)in[j + i] * coef[i];
+    }
+    out[j] = sum >> 15;
+  }
+}
+
+static int32_t latsynth(int16_t *b, const int16_t *k, int32_t f) {
+  int i;
+  f -= (int32_t)b[EDN_ORDER - 1] * k[EDN_ORDER - 1];
+  for (i = EDN_ORDER - 2; i >= 0; i--) {
+    f -= (int32_t)b[i] * k[i];
+    b[i + 1] = (int16_t)(b[i] + (((int32_t)k[i] * (f >> 16)) >> 16));
+  }
+  b[0] = (int16_t)(f >> 16);
+  return f;
+}
+
+static int32_t iir1(const int16_t *coefs, int32_t x, int32_t *state) {
+  int32_t t;
+  int n;
+  for (n = 0; n < EDN_SECTIONS; n++) {
+    t = x + ((coefs[2] * state[0] + coefs[3] * state[1]) >> 15);
+    x = t + ((coefs[0] * state[0] + coefs[1] * state[1]) >> 15);
+    state[1] = state[0];
+    state[0] = t;
+    coefs += 4;
+    state += 2;
+  }
+  return x;
+}
+
+uint32_t eb_edn(int iterations) {
+  uint32_t check = 0;
+  int32_t sqr;
+  int i, n;
+  for (n = 0; n < iterations; n++) {
+    for (i = 0; i < EDN_N; i++) {
+      edn_a[i] = edn_input[i];
+      edn_b[i] = edn_coef[i];
+    }
+    for (i = 0; i < 2 * EDN_SECTIONS; i++) {
+      edn_state[i] = 0;
+    }
+    vec_mpy1(edn_a, edn_b, 0x1234);
+    check += (uint32_t)mac(edn_a, edn_b, &sqr);
+    check += (uint32_t)sqr;
+    fir(edn_a, edn_out, edn_b);
+    for (i = 0; i < EDN_N - EDN_ORDER; i++) {
+      check += (uint32_t)edn_out[i];
+    }
+    check += (uint32_t)latsynth(edn_a, edn_b, 0x10000);
+    for (i = 0; i < EDN_N; i++) {
+      check += (uint32_t)iir1(edn_b, edn_a[i], edn_state);
+    }
+  }
+  return check;
+}
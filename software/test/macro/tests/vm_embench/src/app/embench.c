@@ -0,0 +1,24 @@
+/*
+ * File         : embench.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Pseudo-random numbers for the Embench-style kernels (see embench.h).
+ */
+#include "embench.h"
+
+static uint32_t rand_seed;
+
+void eb_srand(uint32_t seed) {
+  rand_seed = seed;
+}
+
+// The generator of the suite: 15-bit values
+uint32_t eb_rand(void) {
+  rand_seed = (rand_seed * 1103515245u) + 12345u;
+  return (rand_seed >> 16) & 0x7fff;
+}
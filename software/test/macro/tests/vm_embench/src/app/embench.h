@@ -0,0 +1,37 @@
+#ifndef EMBENCH_H
+#define EMBENCH_H
+
+/*
+ * File         : embench.h
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Integer kernels in the style of the Embench suite (crc32, matmult-int,
+ *   edn, ud, and primecount), with data sets sized for simulation. Each kernel
+ *   has a benchmark function which runs it a number of times and returns a
+ *   checksum of the results, and those with input data have an untimed setup.
+ */
+#include <stdint.h>
+
+// The pseudo-random numbers of the suite (a 32-bit LCG)
+void eb_srand(uint32_t seed);
+uint32_t eb_rand(void);
+
+void eb_crc32_init(void);
+uint32_t eb_crc32(int iterations);
+
+void eb_matmult_init(void);
+uint32_t eb_matmult(int iterations);
+
+void eb_edn_init(void);
+uint32_t eb_edn(int iterations);
+
+uint32_t eb_ud(int iterations);
+
+uint32_t eb_primecount(int iterations);
+
+#endif  // EMBENCH_H
@@ -0,0 +1,65 @@
+/*
+ * File         : matmult.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   matmult-int: Multiplication of two 16x16 integer matrices.
+ */
+#include "embench.h"
+
+#define MATMULT_N 16
+
+static int32_t mat_a[MATMULT_N][MATMULT_N];
+static int32_t mat_b[MATMULT_N][MATMULT_N];
+static int32_t mat_res[MATMULT_N][MATMULT_N];
+
+// The generator of the original benchmark
+static int32_t random_integer(int32_t *seed) {
+  *seed = ((*seed * 133) + 81) % 8095;
+  return *seed;
+}
+
+void eb_matmult_init(void) {
+  int32_t seed = 0;
+  int i, j;
+  for (i = 0; i < MATMULT_N; i++) {
+    for (j = 0; j < MATMULT_N; j++) {
+      mat_a[i][j] = random_integer(&seed);
+    }
+  }
+  for (i = 0; i < MATMULT_N; i++) {
+    for (j = 0; j < MATMULT_N; j++) {
+      mat_b[i][j] = random_integer(&seed);
+    }
+  }
+}
+
+static void multiply(void) {
+  int i, j, k;
+  for (i = 0; i < MATMULT_N; i++) {
+    for (j = 0; j < MATMULT_N; j++) {
+      mat_res[i][j] = 0;
+      for (k = 0; k < MATMULT_N; k++) {
+        mat_res[i][j] += mat_a[i][k] * mat_b[k][j];
+      }
+    }
+  }
+}
+
+uint32_t eb_matmult(int iterations) {
+  uint32_t check = 0;
+  int i, j, n;
+  for (n = 0; n < iterations; n++) {
+    multiply();
+    for (i = 0; i < MATMULT_N; i++) {
+      for (j = 0; j < MATMULT_N; j++) {
+        check += (uint32_t)mat_res[i][j];
+      }
+    }
+  }
+  return check;
+}
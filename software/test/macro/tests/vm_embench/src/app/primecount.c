@@ -0,0 +1,43 @@
+/*
+ * File         : primecount.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   primecount: The number of primes below a bound, by a sieve of Eratosthenes.
+ */
+#include "embench.h"
+
+#define PRIME_LIMIT 4096
+
+static uint8_t composite[PRIME_LIMIT];
+
+static uint32_t count_primes(void) {
+  uint32_t count = 0;
+  int i, j;
+  for (i = 0; i < PRIME_LIMIT; i++) {
+    composite[i] = 0;
+  }
+  for (i = 2; i < PRIME_LIMIT; i++) {
+    if (composite[i]) {
+      continue;
+    }
+    count++;
+    for (j = i * i; j < PRIME_LIMIT; j += i) {
+      composite[j] = 1;
+    }
+  }
+  return count;
+}
+
+uint32_t eb_primecount(int iterations) {
+  uint32_t check = 0;
+  int n;
+  for (n = 0; n < iterations; n++) {
+    check += count_primes();
+  }
+  return check;
+}
@@ -0,0 +1,87 @@
+/*
+ * File         : ud.c
+ * Project      : MIPS32r1
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   C99, 4 soft tab, wide column.
+ *
+ * Description:
+ *   ud: The solution of a system of linear equations by LU decomposition in
+ *   integer arithmetic (with the division of the original).
+ */
+#include "embench.h"
+
+#define UD_N 10
+
+static int32_t ud_a[UD_N + 1][UD_N + 1];
+static int32_t ud_b[UD_N + 1];
+static int32_t ud_x[UD_N + 1];
+
+// A diagonally dominant system, whose right-hand side is the sum of each row
+static void setup(void) {
+  int i, j;
+  int32_t w;
+  for (i = 0; i <= UD_N; i++) {
+    w = 0;
+    for (j = 0; j <= UD_N; j++) {
+      ud_a[i][j] = (i + 1) + (j + 1);
+      if (i == j) {
+        ud_a[i][j] *= 10;
+      }
+      w += ud_a[i][j];
+    }
+    ud_b[i] = w;
+  }
+}
+
+static void ludcmp(void) {
+  int32_t w, y[UD_N + 1];
+  int i, j, k;
+
+  for (i = 0; i < UD_N; i++) {
+    for (j = i + 1; j <= UD_N; j++) {
+      w = ud_a[j][i];
+      for (k = 0; k < i; k++) {
+        w -= ud_a[j][k] * ud_a[k][i];
+      }
+      ud_a[j][i] = w / ud_a[i][i];
+    }
+    for (j = i + 1; j <= UD_N; j++) {
+      w = ud_a[i + 1][j];
+      for (k = 0; k <= i; k++) {
+        w -= ud_a[i + 1][k] * ud_a[k][j];
+      }
+      ud_a[i + 1][j] = w;
+    }
+  }
+  y[0] = ud_b[0];
+  for (i = 1; i <= UD_N; i++) {
+    w = ud_b[i];
+    for (j = 0; j < i; j++) {
+      w -= ud_a[i][j] * y[j];
+    }
+    y[i] = w;
+  }
+  ud_x[UD_N] = y[UD_N] / ud_a[UD_N][UD_N];
+  for (i = UD_N - 1; i >= 0; i--) {
+    w = y[i];
+    for (j = i + 1; j <= UD_N; j++) {
+      w -= ud_a[i][j] * ud_x[j];
+    }
+    ud_x[i] = w / ud_a[i][i];
+  }
+}
+
+uint32_t eb_ud(int iterations) {
+  uint32_t check = 0;
+  int i, n;
+  for (n = 0; n < iterations; n++) {
+    setup();
+    ludcmp();
+    for (i = 0; i <= UD_N; i++) {
+      check += (uint32_t)ud_x[i];
+    }
+  }
+  return check;
+}
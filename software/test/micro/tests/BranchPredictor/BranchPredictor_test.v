@@ -0,0 +1,376 @@
+`timescale 1ns / 1ps
+/*
+ * File         : BranchPredictor_test.v
+ * Project      : XUM MIPS32
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Test module for the branch predictor.
+ *
+ *   The test builds the trace of a small program (the PCs of every executed
+ *   instruction in order) and runs it through a model of the fetch and decode
+ *   stages (F1, F2, D1, D2) without stalls. Branches resolve in D2 from the
+ *   trace: Fetch is redirected when the prediction was wrong, which flushes F1
+ *   and F2 (two bubbles) and keeps the delay slot in D1. Every instruction
+ *   which reaches D2 must be the next one of the trace.
+ *
+ *   The program has three parts, and every branch/jump in it has its own BTB
+ *   entry:
+ *     1. Loops: An outer loop (4x) around an inner loop (8x).
+ *     2. Calls: A loop (4x) which calls one function from three call sites.
+ *     3. Recursion: A loop (5x) which calls g(d) for d = 4, 4, 12, 12, 4, and
+ *        g(d) calls r(d), which calls itself until d is 0. With d = 12 the
+ *        call depth is 14, which overflows the 8-entry return address stack.
+ *
+ *   The program runs with three configurations of the predictor: The default
+ *   one (8-entry RAS), one without a RAS (returns use the BTB target), and
+ *   one which never predicts (every taken branch is redirected from D2). The
+ *   test checks the number of redirects of the interesting branches, e.g.,
+ *   that the returns of the recursion only miss when it is cold (1) and when
+ *   it overflows the RAS (1 per deep call), and the total number of cycles.
+ */
+module BranchPredictor_test;
+    // Inputs
+    reg clock;
+    reg reset;
+
+    integer res;
+    integer i;
+
+    // Program trace
+    reg  [31:0] trace [0:1023];
+    integer trace_len;
+
+    // Kinds of instructions
+    localparam [2:0] PLAIN=3'd0, BRANCH=3'd1, CALL=3'd2, RETURN=3'd3, JUMP=3'd4;
+
+    // Addresses of the branches and jumps of the program (distinct BTB indices, i.e., PC[6:2])
+    localparam [31:0] LOOP_INNER = 32'h00001010;    // bne (inner loop)
+    localparam [31:0] LOOP_OUTER = 32'h0000101c;    // bne (outer loop)
+    localparam [31:0] CALL_F_0   = 32'h00001030;    // jal f
+    localparam [31:0] CALL_F_1   = 32'h00001040;    // jal f
+    localparam [31:0] CALL_F_2   = 32'h00001050;    // jal f
+    localparam [31:0] LOOP_CALLS = 32'h00001064;    // bne (call loop)
+    localparam [31:0] CALL_G     = 32'h00001070;    // jal g
+    localparam [31:0] LOOP_REC   = 32'h0000107c;    // bne (recursion loop)
+    localparam [31:0] DONE       = 32'h00001084;    // j DONE
+    localparam [31:0] RET_F      = 32'h0000120c;    // jr $ra
+    localparam [31:0] CALL_R_G   = 32'h00001324;    // jal r (from g)
+    localparam [31:0] RET_G      = 32'h00001334;    // jr $ra
+    localparam [31:0] BASE_R     = 32'h00001444;    // beq (base case of r)
+    localparam [31:0] CALL_R_R   = 32'h0000144c;    // jal r (from r)
+    localparam [31:0] RET_R      = 32'h00001458;    // jr $ra
+
+    function [2:0] kind;
+    input [31:0] pc;
+    begin
+        case (pc)
+            LOOP_INNER, LOOP_OUTER, LOOP_CALLS, LOOP_REC, BASE_R : kind = BRANCH;
+            CALL_F_0, CALL_F_1, CALL_F_2, CALL_G, CALL_R_G, CALL_R_R : kind = CALL;
+            RET_F, RET_G, RET_R : kind = RETURN;
+            DONE : kind = JUMP;
+            default : kind = PLAIN;
+        endcase
+    end
+    endfunction
+
+    // Configurations: 0: Default (8-entry RAS), 1: No RAS, 2: No prediction
+    localparam CONFIGS = 3;
+    wire [(CONFIGS-1):0] done;
+
+    genvar g;
+    generate
+        for (g = 0; g < CONFIGS; g = g + 1) begin : cfg
+            // Predictor
+            wire        F1_PredTaken;
+            wire [31:0] F1_PredTarget;
+            wire        F1_PredNext;
+            wire [31:0] F1_PredNextPC;
+            wire [3:0]  F1_RasPtr;
+
+            // Pipeline
+            reg  [31:0] f1_pc;
+            reg         f2_valid, d1_valid, d2_valid;
+            reg  [31:0] f2_pc, d1_pc, d2_pc;
+            reg         f2_pt, d1_pt, d2_pt;
+            reg  [31:0] f2_ptgt, d1_ptgt, d2_ptgt;
+            reg  [3:0]  f2_ras, d1_ras, d2_ras;
+            integer     d2_idx;         // Position of the instruction in D2 in the trace
+            integer     issued;         // Instructions which moved to D2
+            reg         finished;
+
+            // Counters
+            integer cycles;
+            integer redirects;
+            integer loop_inner, loop_outer, ret_f, ret_g, ret_r;
+
+            // Branch resolution in D2
+            wire [2:0]  d2_kind     = kind(d2_pc);
+            wire        d2_branch   = d2_valid & (d2_kind != PLAIN);
+            wire [31:0] d2_next     = trace[d2_idx + 2];    // After the delay slot
+            wire        d2_taken    = d2_branch & (d2_next != (d2_pc + 32'd8));
+            wire        d2_redirect = d2_valid & ((d2_taken ^ d2_pt) | (d2_taken & (d2_next != d2_ptgt)));
+            wire [31:0] next_pc     = (d2_redirect) ? ((d2_taken) ? d2_next : (d2_pc + 32'd8)) :
+                                      ((F1_PredNext) ? F1_PredNextPC : (f1_pc + 32'd4));
+
+            BranchPredictor #(
+                .RAS_BITS  ((g == 1) ? 0 : 3))
+                uut (
+                .clock          (clock),
+                .reset          (reset),
+                .F1_PC          (f1_pc),
+                .F1_Lookup      (g != 2),
+                .F1_Stall       (1'b0),
+                .F1_Flush       (d2_redirect),
+                .F1_PredTaken   (F1_PredTaken),
+                .F1_PredTarget  (F1_PredTarget),
+                .F1_PredNext    (F1_PredNext),
+                .F1_PredNextPC  (F1_PredNextPC),
+                .F1_RasPtr      (F1_RasPtr),
+                .D2_Update      (d2_branch),
+                .D2_Invalidate  (d2_valid & d2_pt & ~d2_branch),
+                .D2_PC          (d2_pc),
+                .D2_Taken       (d2_taken),
+                .D2_Target      (d2_next),
+                .D2_Call        (d2_kind == CALL),
+                .D2_Return      (d2_kind == RETURN),
+                .D2_LinkPC      (d2_pc + 32'd8),
+                .D2_RasPtr      (d2_ras),
+                .D2_Redirect    (d2_redirect),
+                .W1_Flush       (1'b0),
+                .W1_RasPtr      (4'd0)
+            );
+
+            assign done[g] = finished;
+
+            always @(posedge clock) begin
+                if (reset) begin
+                    f1_pc      <= trace[0];
+                    f2_valid   <= 1'b0;
+                    d1_valid   <= 1'b0;
+                    d2_valid   <= 1'b0;
+                    d2_idx     <= 0;
+                    issued     <= 0;
+                    finished   <= 1'b0;
+                    cycles     <= 0;
+                    redirects  <= 0;
+                    loop_inner <= 0;
+                    loop_outer <= 0;
+                    ret_f      <= 0;
+                    ret_g      <= 0;
+                    ret_r      <= 0;
+                end
+                else begin
+                    // A redirect flushes F1 and F2 and the prediction of the delay slot in D1
+                    f1_pc    <= next_pc;
+                    f2_valid <= ~d2_redirect;
+                    f2_pc    <= f1_pc;
+                    f2_pt    <= F1_PredTaken;
+                    f2_ptgt  <= F1_PredTarget;
+                    f2_ras   <= F1_RasPtr;
+                    d1_valid <= f2_valid & ~d2_redirect;
+                    d1_pc    <= f2_pc;
+                    d1_pt    <= f2_pt;
+                    d1_ptgt  <= f2_ptgt;
+                    d1_ras   <= f2_ras;
+                    d2_valid <= d1_valid;
+                    d2_pc    <= d1_pc;
+                    d2_pt    <= d1_pt & ~d2_redirect;
+                    d2_ptgt  <= d1_ptgt;
+                    d2_ras   <= d1_ras;
+                    if (d1_valid) begin
+                        d2_idx <= issued;
+                        issued <= issued + 1;
+                    end
+
+                    // Check and count until the end of the trace is in D2
+                    if (~finished & d2_valid) begin
+                        if (d2_pc != trace[d2_idx]) begin
+                            $display("Fail: Config %0d: Instruction %0d is %h (%h expected).", g, d2_idx, d2_pc, trace[d2_idx]);
+                            fail();
+                        end
+                        if (d2_redirect) begin
+                            redirects <= redirects + 1;
+                            case (d2_pc)
+                                LOOP_INNER : loop_inner <= loop_inner + 1;
+                                LOOP_OUTER : loop_outer <= loop_outer + 1;
+                                RET_F      : ret_f      <= ret_f + 1;
+                                RET_G      : ret_g      <= ret_g + 1;
+                                RET_R      : ret_r      <= ret_r + 1;
+                            endcase
+                        end
+                    end
+                    if (~finished) begin
+                        if (d2_valid & (d2_idx == (trace_len - 3))) begin
+                            finished <= 1'b1;
+                        end
+                        else begin
+                            cycles <= cycles + 1;
+                        end
+                    end
+                end
+            end
+        end
+    endgenerate
+
+    // Always run the clock (100MHz)
+    initial forever begin
+        #5 clock <= ~clock;
+    end
+
+    initial begin
+        // Initialize Inputs
+        clock = 0;
+        reset = 1;
+
+        // Build the program trace
+        trace_len = 0;
+        loops(4, 8);
+        calls(4);
+        recursion(4);
+        recursion(4);
+        recursion(12);
+        recursion(12);
+        recursion(4);
+        for (i = 0; i < 4; i = i + 1) begin
+            seq(DONE, 2);               // j DONE, ds
+        end
+
+        // Wait 100 ns for global reset to finish
+        #100;
+
+        // Add stimulus here
+        res = $fopen("result.out");
+        do_reset();
+        wait (&done);
+        @(negedge clock);
+
+        // Config, cycles, redirects, inner loop, outer loop, returns of f, g, and r
+        check(0, cfg[0].cycles, cfg[0].redirects, cfg[0].loop_inner, cfg[0].loop_outer, cfg[0].ret_f, cfg[0].ret_g, cfg[0].ret_r,
+            723, 30, 5, 2, 1, 3, 3);
+        check(1, cfg[1].cycles, cfg[1].redirects, cfg[1].loop_inner, cfg[1].loop_outer, cfg[1].ret_f, cfg[1].ret_g, cfg[1].ret_r,
+            755, 46, 5, 2, 12, 1, 10);
+        check(2, cfg[2].cycles, cfg[2].redirects, cfg[2].loop_inner, cfg[2].loop_outer, cfg[2].ret_f, cfg[2].ret_g, cfg[2].ret_r,
+            985, 162, 28, 3, 12, 5, 41);
+        $display("%0d instructions: %0d cycles (%0d redirects), %0d without a RAS (%0d), %0d without prediction (%0d)",
+            trace_len, cfg[0].cycles, cfg[0].redirects, cfg[1].cycles, cfg[1].redirects, cfg[2].cycles, cfg[2].redirects);
+
+        // Success
+        $fwrite(res, "1");
+        $fclose(res);
+        $finish;
+    end
+
+    // Task append one instruction to the trace
+    task emit;
+    input [31:0] pc;
+    begin
+        trace[trace_len] = pc;
+        trace_len = trace_len + 1;
+    end
+    endtask
+
+    // Task append 'n' sequential instructions to the trace
+    task seq;
+    input [31:0] pc;
+    input integer n;
+    integer k;
+    begin
+        for (k = 0; k < n; k = k + 1) begin
+            emit(pc + (k * 4));
+        end
+    end
+    endtask
+
+    // Task part 1: An outer loop around an inner loop
+    task loops;
+    input integer outer;
+    input integer inner;
+    integer o, n;
+    begin
+        for (o = 0; o < outer; o = o + 1) begin
+            seq(32'h00001000, 2);
+            for (n = 0; n < inner; n = n + 1) begin
+                seq(32'h00001008, 4);   // 2 instructions, bne LOOP_INNER, ds
+            end
+            seq(32'h00001018, 3);       // 1 instruction, bne LOOP_OUTER, ds
+        end
+        seq(32'h00001024, 1);
+    end
+    endtask
+
+    // Task part 2: A loop which calls f() from three call sites
+    task calls;
+    input integer n;
+    integer k;
+    begin
+        for (k = 0; k < n; k = k + 1) begin
+            seq(32'h00001028, 4);       // 2 instructions, jal f, ds
+            seq(32'h00001200, 5);       // f(): 3 instructions, jr $ra, ds
+            seq(32'h00001038, 4);
+            seq(32'h00001200, 5);
+            seq(32'h00001048, 4);
+            seq(32'h00001200, 5);
+            seq(32'h00001058, 5);       // 3 instructions, bne LOOP_CALLS, ds
+        end
+    end
+    endtask
+
+    // Task part 3: One iteration of the loop which calls g(d), which calls r(d)
+    task recursion;
+    input integer d;
+    integer k;
+    begin
+        seq(32'h0000106c, 3);           // 1 instruction, jal g, ds
+        seq(32'h00001320, 3);           // g(): 1 instruction, jal r, ds
+        for (k = 0; k < d; k = k + 1) begin
+            seq(32'h00001440, 5);       // r(): 1 instruction, beq BASE_R (not taken), ds, jal r, ds
+        end
+        seq(32'h00001440, 3);           // r(0): 1 instruction, beq BASE_R (taken), ds
+        seq(32'h00001458, 2);           // jr $ra, ds
+        for (k = 0; k < d; k = k + 1) begin
+            seq(32'h00001454, 3);       // r() after the call: 1 instruction, jr $ra, ds
+        end
+        seq(32'h0000132c, 4);           // g() after the call: 2 instructions, jr $ra, ds
+        seq(32'h00001078, 3);           // 1 instruction, bne LOOP_REC, ds
+    end
+    endtask
+
+    // Task check the counters of one configuration
+    task check;
+    input integer cfg_num;
+    input integer cycles, redirects, loop_inner, loop_outer, ret_f, ret_g, ret_r;
+    input integer exp_cycles, exp_redirects, exp_loop_inner, exp_loop_outer, exp_ret_f, exp_ret_g, exp_ret_r;
+    begin
+        if ((cycles != exp_cycles) | (redirects != exp_redirects) | (loop_inner != exp_loop_inner) |
+            (loop_outer != exp_loop_outer) | (ret_f != exp_ret_f) | (ret_g != exp_ret_g) | (ret_r != exp_ret_r)) begin
+            $display("Fail: Config %0d: %0d cycles, %0d redirects (loops %0d %0d, returns %0d %0d %0d).",
+                cfg_num, cycles, redirects, loop_inner, loop_outer, ret_f, ret_g, ret_r);
+            $display("      Expected: %0d cycles, %0d redirects (loops %0d %0d, returns %0d %0d %0d).",
+                exp_cycles, exp_redirects, exp_loop_inner, exp_loop_outer, exp_ret_f, exp_ret_g, exp_ret_r);
+            fail();
+        end
+    end
+    endtask
+
+    // Task reset
+    task do_reset;
+    begin
+        @(posedge clock) reset <= 1'b1;
+        @(posedge clock) reset <= 1'b0;
+    end
+    endtask
+
+    // Task terminate on failure
+    task fail;
+    begin
+        $fwrite(res, "0");
+        $fclose(res);
+        $finish;
+    end
+    endtask
+
+endmodule
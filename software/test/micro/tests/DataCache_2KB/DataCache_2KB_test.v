@@ -9,6 +9,18 @@
  *
  * Description:
  *   Test module.
+ *
+ *   The base cache and a cache with each optional mode (background fill,
+ *   early restart with a memory which returns the requested word first, and
+ *   the prefetcher), each with its own memory, receive the requests in turn
+ *   ('sel'). The functional sequence runs on each cache and checks the load
+ *   data; hits and misses are checked on the base cache only, as the modes
+ *   change when a line becomes valid. Then each mode runs a sequence of its
+ *   own on the base cache and on the cache with the mode, which checks the
+ *   load data and the stall cycles of each access until 'Ready_C': Accesses
+ *   which the mode speeds up must stall for fewer cycles than on the base
+ *   cache (or not at all), and the whole sequence must stall for fewer
+ *   cycles. The stall cycles of each mode are printed.
  */
 module DataCache_2KB_test;
 
@@ -33,13 +45,25 @@ module DataCache_2KB_test;
     reg DoCacheOp_C;
     reg [2:0] CacheOp_C;
     reg [27:0] CacheOpData_C;
+    reg [31:0] PC_C;
     wire [31:0] DataIn_M;
     wire [1:0] DataInOffset_M;
     wire Ready_M;
 
-    // Outputs
+    // Outputs (of the selected cache)
     wire [31:0] DataOut_C;
     wire Ready_C;
+
+    // The caches: The base cache (uut) and one with each optional mode (dc[BG..PF])
+    localparam BASE = 0, BG = 1, ER = 2, PF = 3, CACHES = 4;
+    reg [1:0] sel;              // The cache which receives the requests
+    wire [((CACHES*32)-1):0] DataOut;
+    wire [(CACHES-1):0] Ready;
+
+    assign DataOut_C = DataOut[(sel*32)+:32];
+    assign Ready_C   = Ready[sel];
+
+    // Memory interface of the base cache
     wire [33:0] Address_M;
     wire ReadLine_M;
     wire ReadWord_M;
@@ -49,7 +73,7 @@ module DataCache_2KB_test;
     wire [127:0] DataOut_M;
 
     // Instantiate the Unit Under Test (UUT)
-    DataCache_2KB #(.PABITS(PABITS)) uut (
+    DataCache #(.PABITS(PABITS)) uut (
         .clock            (clock),
         .reset            (reset),
         .VAddressIn_C     (VAddressIn_C),
@@ -58,13 +82,15 @@ module DataCache_2KB_test;
         .CacheAttr_C      (CacheAttr_C),
         .Stall_C          (Stall_C),
         .DataIn_C         (DataIn_C),
-        .Read_C           (Read_C),
-        .Write_C          (Write_C),
-        .DataOut_C        (DataOut_C),
-        .Ready_C          (Ready_C),
-        .DoCacheOp_C      (DoCacheOp_C),
+        .Read_C           (Read_C & (sel == BASE)),
+        .Write_C          (Write_C & {4{(sel == BASE)}}),
+        .DataOut_C        (DataOut[31:0]),
+        .Ready_C          (Ready[BASE]),
+        .Miss_C           (),
+        .DoCacheOp_C      (DoCacheOp_C & (sel == BASE)),
         .CacheOp_C        (CacheOp_C),
         .CacheOpData_C    (CacheOpData_C),
+        .PC_C             (PC_C),
         .Address_M        (Address_M),
         .ReadLine_M       (ReadLine_M),
         .ReadWord_M       (ReadWord_M),
@@ -100,8 +126,89 @@ module DataCache_2KB_test;
         .D_ReadWord       (ReadWord_M),
         .D_Ready          (Ready_M)
     );
+
+    // The caches with the optional modes, each with its own memory
+    genvar g;
+    generate
+        for (g = BG; g <= PF; g = g + 1) begin : dc
+            wire [31:0] DataIn_M;
+            wire [1:0] DataInOffset_M;
+            wire Ready_M;
+            wire [33:0] Address_M;
+            wire ReadLine_M;
+            wire ReadWord_M;
+            wire LineOutReady_M;
+            wire WordOutReady_M;
+            wire [3:0] WordOutBE_M;
+            wire [127:0] DataOut_M;
+
+            DataCache #(
+                .PABITS         (PABITS),
+                .BG_FILL        (g == BG),
+                .EARLY_RESTART  (g == ER),
+                .PREFETCH       (g == PF))
+                uut (
+                .clock            (clock),
+                .reset            (reset),
+                .VAddressIn_C     (VAddressIn_C),
+                .PAddressIn_C     (PAddressIn_C),
+                .PAddressValid_C  (PAddressValid_C),
+                .CacheAttr_C      (CacheAttr_C),
+                .Stall_C          (Stall_C),
+                .DataIn_C         (DataIn_C),
+                .Read_C           (Read_C & (sel == g)),
+                .Write_C          (Write_C & {4{(sel == g)}}),
+                .DataOut_C        (DataOut[(g*32)+:32]),
+                .Ready_C          (Ready[g]),
+                .Miss_C           (),
+                .DoCacheOp_C      (DoCacheOp_C & (sel == g)),
+                .CacheOp_C        (CacheOp_C),
+                .CacheOpData_C    (CacheOpData_C),
+                .PC_C             (PC_C),
+                .Address_M        (Address_M),
+                .ReadLine_M       (ReadLine_M),
+                .ReadWord_M       (ReadWord_M),
+                .DataIn_M         (DataIn_M),
+                .DataInOffset_M   (DataInOffset_M),
+                .LineOutReady_M   (LineOutReady_M),
+                .WordOutReady_M   (WordOutReady_M),
+                .WordOutBE_M      (WordOutBE_M),
+                .DataOut_M        (DataOut_M),
+                .Ready_M          (Ready_M)
+            );
+
+            // The memory returns the requested word first for early restart
+            MainMemory #(.ADDR_WIDTH(16), .CRIT_WORD_FIRST(g == ER)) mem (
+                .clock            (clock),
+                .reset            (reset),
+                .I_Address        ({18{1'b0}}),
+                .I_DataIn         ({128{1'b0}}),
+                .I_DataOut        (),
+                .I_Ready          (),
+                .I_DataOutOffset  (),
+                .I_BootWrite      (1'b0),
+                .I_ReadLine       (1'b0),
+                .I_ReadWord       (1'b0),
+                .D_Address        (Address_M[17:0]),
+                .D_DataIn         (DataOut_M),
+                .D_LineInReady    (LineOutReady_M),
+                .D_WordInReady    (WordOutReady_M),
+                .D_WordInBE       (WordOutBE_M),
+                .D_DataOut        (DataIn_M),
+                .D_DataOutOffset  (DataInOffset_M),
+                .D_ReadLine       (ReadLine_M),
+                .D_ReadWord       (ReadWord_M),
+                .D_Ready          (Ready_M)
+            );
+        end
+    endgenerate
+
     integer res;
-    integer i, j;
+    integer i, j, k, n;
+    integer lat;                // Stall cycles of the last access
+    integer stall;              // Stall cycles of a mode sequence
+    integer stall_base;         // Stall cycles of a mode sequence on the base cache
+    integer base_lat [0:15];    // Stall cycles of numbered accesses on the base cache
 
     // Task parameters
     localparam [0:0] cache = 1'b1;          // Set address cacheable
@@ -141,6 +248,28 @@ module DataCache_2KB_test;
     localparam [31:0] Data2w3 = 32'h77777777;
     localparam [31:0] BadData = 32'hdeafbeef;
 
+    // Lines of the mode sequences (24-bit physical tag, 12-bit offset), initialized with 'mem_line'
+    // Background fill: Each line at a different index
+    localparam [23:0] PTagA = 24'h000011;   localparam [11:0] VAddrA = 12'h100;
+    localparam [23:0] PTagB = 24'h000012;   localparam [11:0] VAddrB = 12'h200;
+    localparam [23:0] PTagC = 24'h000013;   localparam [11:0] VAddrC = 12'h300;
+    localparam [23:0] PTagD = 24'h000014;   localparam [11:0] VAddrD = 12'h140;
+    localparam [23:0] PTagE = 24'h000015;   localparam [11:0] VAddrE = 12'h240;
+    // Early restart: Lines 0-7 at {PTagR + n, VAddrR + (n * 'h110)}, each at a different index
+    localparam [23:0] PTagR = 24'h000021;   localparam [11:0] VAddrR = 12'h100;
+    // Prefetcher: Hits between the misses (W) and three streams of lines (S, Y, Z)
+    localparam [23:0] PTagW = 24'h000031;   localparam [11:0] VAddrW = 12'h7f0;
+    localparam [23:0] PTagS = 24'h000032;   localparam [11:0] VAddrS = 12'h000;
+    localparam [23:0] PTagY = 24'h000033;   localparam [11:0] VAddrY = 12'h100;
+    localparam [23:0] PTagZ = 24'h000034;   localparam [11:0] VAddrZ = 12'h200;
+
+    // PCs of the prefetcher sequence (each at a different prefetcher table entry)
+    localparam [31:0] PC_W = 32'h00400200;
+    localparam [31:0] PC_S = 32'h00400104;
+    localparam [31:0] PC_Y = 32'h00400108;
+    localparam [31:0] PC_Z = 32'h0040010c;
+    localparam [31:0] PC_U = 32'h00400110;  // Uncacheable stores
+
     initial begin
         // Initialize Inputs
         clock = 0;
@@ -156,6 +285,22 @@ module DataCache_2KB_test;
         DoCacheOp_C = 0;
         CacheOp_C = 0;
         CacheOpData_C = 0;
+        PC_C = 0;
+        sel = BASE;
+
+        // Fill the lines of the mode sequences in each memory (the rest is left uninitialized)
+        mem_init(PTagA, VAddrA, 1);
+        mem_init(PTagB, VAddrB, 1);
+        mem_init(PTagC, VAddrC, 1);
+        mem_init(PTagD, VAddrD, 1);
+        mem_init(PTagE, VAddrE, 1);
+        for (k = 0; k < 8; k = k + 1) begin
+            mem_init(PTagR + k, VAddrR + (k * 12'h110), 1);
+        end
+        mem_init(PTagW, VAddrW, 1);
+        mem_init(PTagS, VAddrS, 8);
+        mem_init(PTagY, VAddrY, 4);
+        mem_init(PTagZ, VAddrZ, 4);
 
         // Wait 100 ns for global reset to finish
         #100;
@@ -163,9 +308,28 @@ module DataCache_2KB_test;
         // Add stimulus here
         res = $fopen("result.out");
         do_reset();
-        cache_reset();
 
+        // The functional sequence on each cache
+        for (k = 0; k < CACHES; k = k + 1) begin
+            sel = k;
+            cache_reset();
+            run_basic();
+        end
+
+        // The mode sequences
+        run_mode(BG);
+        run_mode(ER);
+        run_mode(PF);
 
+        // Success
+        $fwrite(res, "1");
+        $fclose(res);
+        $finish;
+    end
+
+    // Task run the functional sequence on the selected cache
+    task run_basic;
+    begin
         // This first test checks LRU and writeback addresses
         // Tag 1, Addr 100
         write(12'h400, 24'h000, cache, valid, miss, Data0w0, 4'hf);
@@ -306,12 +470,163 @@ module DataCache_2KB_test;
         cache_idxwbinv(6'd0, 1'b1);
         read (VAddr1w0, PTag1, cache, valid, miss, 32'h111); // verify invalidate and writeback
         read (VAddr1w3, PTag1, cache, valid, hit,  32'h444);
+    end
+    endtask
 
-        // Success
-        $fwrite(res, "1");
-        $fclose(res);
-        $finish;
+    // Task run the sequence of a mode on the base cache and then on the cache with the mode
+    task run_mode;
+    input [1:0] mode;
+    begin
+        sel = BASE;
+        cache_reset();
+        run_mode_seq(mode);
+        stall_base = stall;
+        sel = mode;
+        cache_reset();
+        run_mode_seq(mode);
+        $display("Mode %0d: %0d stall cycles (%0d in the base cache)", mode, stall, stall_base);
+        if (stall >= stall_base) begin
+            $display("Fail: Mode %0d: %0d stall cycles (%0d in the base cache).", mode, stall, stall_base);
+            fail();
+        end
+    end
+    endtask
+
+    task run_mode_seq;
+    input [1:0] mode;
+    begin
+        stall = 0;
+        case (mode)
+            BG: run_bg();
+            ER: run_er();
+            PF: run_pf();
+        endcase
+    end
+    endtask
+
+    // Task background fill sequence: Store misses complete like store hits, a later store to the line is
+    // merged, and hits proceed while the lines are filled. A load miss behind a store miss waits for its
+    // own fill.
+    task run_bg;
+    begin
+        read (VAddrC,         PTagC, cache, valid, miss, mem_word(PTagC, VAddrC));
+        write(VAddrA,         PTagA, cache, valid, miss, 32'h11110000, 4'hf);  check_faster(0);
+        write(VAddrA + 12'hc, PTagA, cache, valid, hit,  32'h11113333, 4'hf);  check_not_slower(1);
+        write(VAddrB + 12'h4, PTagB, cache, valid, miss, 32'h22221111, 4'hf);  check_faster(2);
+        for (n = 0; n < 4; n = n + 1) begin
+            read (VAddrC + (n * 4), PTagC, cache, valid, hit, mem_word(PTagC, VAddrC + (n * 4)));
+            check_not_slower(3 + n);
+        end
+
+        // Lines A and B hold the merged stores and the memory data
+        read (VAddrA,         PTagA, cache, valid, hit, 32'h11110000);
+        read (VAddrA + 12'h4, PTagA, cache, valid, hit, mem_word(PTagA, VAddrA + 12'h4));
+        read (VAddrA + 12'h8, PTagA, cache, valid, hit, mem_word(PTagA, VAddrA + 12'h8));
+        read (VAddrA + 12'hc, PTagA, cache, valid, hit, 32'h11113333);
+        read (VAddrB,         PTagB, cache, valid, hit, mem_word(PTagB, VAddrB));
+        read (VAddrB + 12'h4, PTagB, cache, valid, hit, 32'h22221111);
+
+        // A load miss (E) while the fill of a store miss (D) is outstanding
+        write(VAddrD + 12'h8, PTagD, cache, valid, miss, 32'h44442222, 4'hf);  check_faster(7);
+        read (VAddrE + 12'h4, PTagE, cache, valid, miss, mem_word(PTagE, VAddrE + 12'h4));
+        read (VAddrD + 12'h8, PTagD, cache, valid, hit,  32'h44442222);
+        read (VAddrD,         PTagD, cache, valid, hit,  mem_word(PTagD, VAddrD));
+    end
+    endtask
+
+    // Task early restart sequence: A load miss completes when its word arrives, which is first. Requests
+    // which arrive during the rest of the fill (a load or store of the same line, or a miss to another
+    // line) complete after it.
+    task run_er;
+    begin
+        // A load miss to each word of a line
+        for (n = 0; n < 4; n = n + 1) begin
+            read (VAddrR + (n * 12'h114), PTagR + n, cache, valid, miss, mem_word(PTagR + n, VAddrR + (n * 12'h114)));
+            check_faster(n);
+        end
+
+        // A load of the line being filled
+        read (VAddrR + 12'h448, PTagR + 4, cache, valid, miss, mem_word(PTagR + 4, VAddrR + 12'h448));  check_faster(4);
+        read (VAddrR + 12'h444, PTagR + 4, cache, valid, hit,  mem_word(PTagR + 4, VAddrR + 12'h444));
+        read (VAddrR + 12'h44c, PTagR + 4, cache, valid, hit,  mem_word(PTagR + 4, VAddrR + 12'h44c));
+
+        // A store to the line being filled
+        read (VAddrR + 12'h55c, PTagR + 5, cache, valid, miss, mem_word(PTagR + 5, VAddrR + 12'h55c));  check_faster(5);
+        write(VAddrR + 12'h550, PTagR + 5, cache, valid, hit,  32'h55550000, 4'hf);
+        read (VAddrR + 12'h550, PTagR + 5, cache, valid, hit,  32'h55550000);
+        read (VAddrR + 12'h554, PTagR + 5, cache, valid, hit,  mem_word(PTagR + 5, VAddrR + 12'h554));
+
+        // A load miss to another line during the fill
+        read (VAddrR + 12'h664, PTagR + 6, cache, valid, miss, mem_word(PTagR + 6, VAddrR + 12'h664));  check_faster(6);
+        read (VAddrR + 12'h778, PTagR + 7, cache, valid, miss, mem_word(PTagR + 7, VAddrR + 12'h778));
+        read (VAddrR + 12'h66c, PTagR + 6, cache, valid, hit,  mem_word(PTagR + 6, VAddrR + 12'h66c));
+        read (VAddrR + 12'h770, PTagR + 7, cache, valid, hit,  mem_word(PTagR + 7, VAddrR + 12'h770));
+    end
+    endtask
+
+    // Task prefetcher sequence: Three streams of load misses with a stride of one line (one PC each):
+    //   1. From the third miss on the next line is prefetched, so the last five misses are faster.
+    //   2. The prefetched line is written (uncacheable) while it is fetched: The load sees the new data.
+    //   3. The prefetched line is written after it was fetched: The load sees the new data.
+    task run_pf;
+    begin
+        set_pc(PC_W);
+        read (VAddrW, PTagW, cache, valid, miss, mem_word(PTagW, VAddrW));
+
+        // Stream 1
+        for (n = 0; n < 8; n = n + 1) begin
+            set_pc(PC_S);
+            read (VAddrS + (n * 16), PTagS, cache, valid, miss, mem_word(PTagS, VAddrS + (n * 16)));
+            if (n >= 3) begin
+                check_faster(n);
+            end
+            pf_work();
+        end
+
+        // Stream 2
+        for (n = 0; n < 3; n = n + 1) begin
+            set_pc(PC_Y);
+            read (VAddrY + (n * 16), PTagY, cache, valid, miss, mem_word(PTagY, VAddrY + (n * 16)));
+        end
+        set_pc(PC_U);
+        write(VAddrY + 12'h34, PTagY, nocache, valid, 1'bx, 32'h33331111, 4'hf);
+        set_pc(PC_Y);
+        read (VAddrY + 12'h34, PTagY, cache, valid, miss, 32'h33331111);
+
+        // Stream 3
+        for (n = 0; n < 3; n = n + 1) begin
+            set_pc(PC_Z);
+            read (VAddrZ + (n * 16), PTagZ, cache, valid, miss, mem_word(PTagZ, VAddrZ + (n * 16)));
+            pf_work();
+        end
+        set_pc(PC_U);
+        write(VAddrZ + 12'h38, PTagZ, nocache, valid, 1'bx, 32'h44442222, 4'hf);
+        set_pc(PC_Z);
+        read (VAddrZ + 12'h38, PTagZ, cache, valid, miss, 32'h44442222);
+        set_pc(0);
     end
+    endtask
+
+    // Task change the PC after the current access leaves the tag check, as the
+    // memory stage of the processor would
+    task set_pc;
+    input [31:0] pc_in;
+    begin
+        @(posedge clock) begin
+            PC_C <= pc_in;
+        end
+    end
+    endtask
+
+    // Task hits to another line (time for a prefetch to complete)
+    task pf_work;
+    begin
+        set_pc(PC_W);
+        for (j = 0; j < 6; j = j + 1) begin
+            read (VAddrW + (j[1:0] * 4), PTagW, cache, valid, hit, mem_word(PTagW, VAddrW + (j[1:0] * 4)));
+        end
+    end
+    endtask
 
     // DCache ops: Idx_WbInv, Idx_STag, Adr_HWbInv, Adr_HWb
 
@@ -510,7 +825,7 @@ module DataCache_2KB_test;
     input exp_hit;
     begin
         @(negedge clock);
-        if (uut.s_hit_e != exp_hit) begin
+        if ((sel == BASE) && (uut.s_hit_e != exp_hit)) begin
             $display("Fail: s_hit_e: %b (%b expected).", uut.s_hit_e, exp_hit);
             fail();
         end
@@ -523,13 +838,13 @@ module DataCache_2KB_test;
     begin
         // Don't fail if the expected value is all Xs
         if ((exp_data !== {32{1'bx}}) && (DataOut_C !== exp_data)) begin
-            $display("Fail: DataOut_C: %h (%h expected).", DataOut_C, exp_data);
+            $display("Fail: Cache %0d: DataOut_C: %h (%h expected).", sel, DataOut_C, exp_data);
             fail();
         end
     end
     endtask
 
-    // Task wait for Ready_C (up to 10,000 cycles)
+    // Task wait for Ready_C (up to 10,000 cycles), counting the stall cycles
     task wait_ready;
     begin
         i = 0;
@@ -538,12 +853,81 @@ module DataCache_2KB_test;
             i = i + 1;
         end
         if (i == 10000) begin
-            $display("Fail: Wait timeout");
+            $display("Fail: Cache %0d: Wait timeout", sel);
+            fail();
+        end
+        lat = i;
+        stall = stall + lat;
+    end
+    endtask
+
+    // Task check that the last access stalled for no more cycles than access 'acc' on the base cache
+    task check_not_slower;
+    input [3:0] acc;
+    begin
+        if (sel == BASE) begin
+            base_lat[acc] = lat;
+        end
+        else if (lat > base_lat[acc]) begin
+            $display("Fail: Cache %0d: Access %0d: %0d stall cycles (%0d in the base cache).", sel, acc, lat, base_lat[acc]);
             fail();
         end
     end
     endtask
 
+    // Task check that the last access stalled for fewer cycles than access 'acc' on the base cache
+    task check_faster;
+    input [3:0] acc;
+    begin
+        if (sel == BASE) begin
+            base_lat[acc] = lat;
+        end
+        else if (lat >= base_lat[acc]) begin
+            $display("Fail: Cache %0d: Access %0d: %0d stall cycles (%0d in the base cache).", sel, acc, lat, base_lat[acc]);
+            fail();
+        end
+    end
+    endtask
+
+    // Task initialize 'lines' lines from {paddr_in, vaddr_in} with 'mem_line' in each memory
+    task mem_init;
+    input [23:0] paddr_in;
+    input [11:0] vaddr_in;
+    input [3:0]  lines;
+    begin
+        for (i = 0; i < lines; i = i + 1) begin
+            mem.MainRAM.ram[{paddr_in[7:0], vaddr_in[11:4]} + i]       = mem_line({paddr_in[7:0], vaddr_in[11:4]} + i);
+            dc[BG].mem.MainRAM.ram[{paddr_in[7:0], vaddr_in[11:4]} + i] = mem_line({paddr_in[7:0], vaddr_in[11:4]} + i);
+            dc[ER].mem.MainRAM.ram[{paddr_in[7:0], vaddr_in[11:4]} + i] = mem_line({paddr_in[7:0], vaddr_in[11:4]} + i);
+            dc[PF].mem.MainRAM.ram[{paddr_in[7:0], vaddr_in[11:4]} + i] = mem_line({paddr_in[7:0], vaddr_in[11:4]} + i);
+        end
+    end
+    endtask
+
+    // Memory pattern: Each word holds its memory word address
+    function [31:0] pattern;
+    input [17:0] word_address;
+    begin
+        pattern = {14'h2b5a, word_address};
+    end
+    endfunction
+
+    function [127:0] mem_line;
+    input [15:0] line_address;
+    begin
+        mem_line = {pattern({line_address, 2'd0}), pattern({line_address, 2'd1}), pattern({line_address, 2'd2}),
+                    pattern({line_address, 2'd3})};
+    end
+    endfunction
+
+    function [31:0] mem_word;
+    input [23:0] paddr_in;
+    input [11:0] vaddr_in;
+    begin
+        mem_word = pattern({paddr_in[7:0], vaddr_in[11:2]});
+    end
+    endfunction
+
     // Task cycle
     task cycle;
     begin
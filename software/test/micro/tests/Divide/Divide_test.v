@@ -0,0 +1,294 @@
+`timescale 1ns / 1ps
+/*
+ * File         : Divide_test.v
+ * Project      : XUM MIPS32
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Test module for the radix-4 early-out divider.
+ *
+ *   Each divide checks the quotient, the remainder (which takes the sign of
+ *   the dividend), and the number of cycles that 'Stall' is high: 1 if the
+ *   dividend has fewer significant bits than the divisor, otherwise 17 minus
+ *   half of the (even) number of leading quotient bits skipped in the first
+ *   cycle. The divides cover signed and unsigned operands, the boundary values,
+ *   divide by zero, an aborted divide, and every skip amount from 0 to 30.
+ *   The cycles are printed at the end (32 for every divide before radix-4).
+ */
+module Divide_test;
+    // Inputs
+    reg clock;
+    reg reset;
+    reg OP_div;
+    reg OP_divu;
+    reg [31:0] Dividend;
+    reg [31:0] Divisor;
+
+    // Outputs
+    wire [31:0] Quotient;
+    wire [31:0] Remainder;
+    wire Stall;
+
+    // Instantiate the Unit Under Test (UUT)
+    Divide uut (
+        .clock      (clock),
+        .reset      (reset),
+        .OP_div     (OP_div),
+        .OP_divu    (OP_divu),
+        .Dividend   (Dividend),
+        .Divisor    (Divisor),
+        .Quotient   (Quotient),
+        .Remainder  (Remainder),
+        .Stall      (Stall)
+    );
+
+    integer res;
+    integer cycles;
+    integer divides;
+    integer total_cycles;
+    integer histogram [1:17];   // Number of divides taking each number of cycles
+    integer i;
+
+    localparam SIGNED=1'b1, UNSIGNED=1'b0;
+
+    // Always run the clock (100MHz)
+    initial forever begin
+        #5 clock <= ~clock;
+    end
+
+    initial begin
+        // Initialize Inputs
+        clock = 0;
+        reset = 0;
+        OP_div = 0;
+        OP_divu = 0;
+        Dividend = 0;
+        Divisor = 0;
+        divides = 0;
+        total_cycles = 0;
+        for (i = 1; i <= 17; i = i + 1) begin
+            histogram[i] = 0;
+        end
+
+        // Wait 100 ns for global reset to finish
+        #100;
+
+        // Add stimulus here
+        res = $fopen("result.out");
+        do_reset();
+        @(negedge clock);
+
+        // Signs of the quotient and remainder
+        div(SIGNED,   32'h00000007, 32'hfffffffe, 32'hfffffffd, 32'h00000001,  2);
+        div(SIGNED,   32'hfffffff9, 32'h00000002, 32'hfffffffd, 32'hffffffff,  2);
+        div(SIGNED,   32'hfffffff9, 32'hfffffffe, 32'h00000003, 32'hffffffff,  2);
+        div(SIGNED,   32'h00000007, 32'h00000002, 32'h00000003, 32'h00000001,  2);
+        div(UNSIGNED, 32'h00000007, 32'hfffffffe, 32'h00000000, 32'h00000007,  1);
+        div(UNSIGNED, 32'hfffffff9, 32'h00000002, 32'h7ffffffc, 32'h00000001, 17);
+        div(SIGNED,   32'hffffff9c, 32'h00000007, 32'hfffffff2, 32'hfffffffe,  4);
+        div(SIGNED,   32'h00000064, 32'hfffffff9, 32'hfffffff2, 32'h00000002,  4);
+
+        // Boundary values
+        div(SIGNED,   32'h80000000, 32'hffffffff, 32'h80000000, 32'h00000000, 17);
+        div(SIGNED,   32'h80000000, 32'h00000001, 32'h80000000, 32'h00000000, 17);
+        div(SIGNED,   32'h80000000, 32'h80000000, 32'h00000001, 32'h00000000,  2);
+        div(UNSIGNED, 32'h80000000, 32'hffffffff, 32'h00000000, 32'h80000000,  2);
+        div(SIGNED,   32'h7fffffff, 32'h80000000, 32'h00000000, 32'h7fffffff,  1);
+        div(SIGNED,   32'h80000000, 32'h7fffffff, 32'hffffffff, 32'hffffffff,  2);
+        div(UNSIGNED, 32'hffffffff, 32'h00000001, 32'hffffffff, 32'h00000000, 17);
+        div(SIGNED,   32'hffffffff, 32'h00000001, 32'hffffffff, 32'h00000000,  2);
+        div(UNSIGNED, 32'hffffffff, 32'hffffffff, 32'h00000001, 32'h00000000,  2);
+        div(UNSIGNED, 32'hffffffff, 32'h80000000, 32'h00000001, 32'h7fffffff,  2);
+        div(SIGNED,   32'h7fffffff, 32'h00000001, 32'h7fffffff, 32'h00000000, 17);
+        div(UNSIGNED, 32'hfffffffe, 32'hffffffff, 32'h00000000, 32'hfffffffe,  2);
+
+        // Early-out: The dividend has fewer significant bits than the divisor (1 cycle)
+        div(UNSIGNED, 32'h00000000, 32'h00000001, 32'h00000000, 32'h00000000,  1);
+        div(SIGNED,   32'h00000000, 32'hfffffffb, 32'h00000000, 32'h00000000,  1);
+        div(UNSIGNED, 32'h7fffffff, 32'h80000000, 32'h00000000, 32'h7fffffff,  1);
+        div(SIGNED,   32'h00000003, 32'hffff0000, 32'h00000000, 32'h00000003,  1);
+
+        // Early-out: Each skip amount (17 - skip/2 cycles)
+        div(UNSIGNED, 32'hb1162427, 32'h00000002, 32'h588b1213, 32'h00000001, 17);
+        div(SIGNED,   32'h9d42dcad, 32'h00000001, 32'h9d42dcad, 32'h00000000, 17);
+        div(UNSIGNED, 32'h238264b8, 32'h00000002, 32'h11c1325c, 32'h00000000, 16);
+        div(SIGNED,   32'he5eef658, 32'hffffffff, 32'h1a1109a8, 32'h00000000, 16);
+        div(UNSIGNED, 32'h80e4a64e, 32'h00000014, 32'h0671d51d, 32'h0000000a, 15);
+        div(SIGNED,   32'h26f3c8e2, 32'h00000007, 32'h05908a69, 32'h00000003, 15);
+        div(UNSIGNED, 32'h071c00df, 32'h00000002, 32'h038e006f, 32'h00000001, 14);
+        div(SIGNED,   32'hfda51580, 32'h00000003, 32'hff37072b, 32'hffffffff, 14);
+        div(UNSIGNED, 32'h01bc2534, 32'h00000006, 32'h004a0633, 32'h00000002, 13);
+        div(SIGNED,   32'hed55ee19, 32'hffffff8b, 32'h0028d694, 32'hffffffbd, 13);
+        div(UNSIGNED, 32'h07dea90f, 32'h0000003a, 32'h0022bc4b, 32'h00000011, 12);
+        div(SIGNED,   32'hffd7471d, 32'hfffffffe, 32'h00145c71, 32'hffffffff, 12);
+        div(UNSIGNED, 32'h74e3c28a, 32'h00000cbb, 32'h00092e8f, 32'h00000c15, 11);
+        div(SIGNED,   32'hf91dc1b8, 32'hffffff54, 32'h000a3edf, 32'hffffff8c, 11);
+        div(UNSIGNED, 32'h000438df, 32'h00000003, 32'h0001684a, 32'h00000001, 10);
+        div(SIGNED,   32'hfffba21c, 32'hfffffffd, 32'h000174a1, 32'hffffffff, 10);
+        div(UNSIGNED, 32'hc11171b4, 32'h00016f4b, 32'h00008691, 32'h00002639,  9);
+        div(SIGNED,   32'h44b48948, 32'hffff5015, 32'hffff9c05, 32'h00002cdf,  9);
+        div(UNSIGNED, 32'h0db4e241, 32'h0000893f, 32'h00001990, 32'h000087d1,  8);
+        div(SIGNED,   32'hffff787b, 32'hfffffff8, 32'h000010f0, 32'hfffffffb,  8);
+        div(UNSIGNED, 32'h00000fd6, 32'h00000001, 32'h00000fd6, 32'h00000000,  7);
+        div(SIGNED,   32'h00027a09, 32'hffffff98, 32'hfffff9e8, 32'h00000049,  7);
+        div(UNSIGNED, 32'h0000300f, 32'h0000001e, 32'h0000019a, 32'h00000003,  6);
+        div(SIGNED,   32'hfffe7805, 32'h00000197, 32'hffffff0a, 32'hffffff1f,  6);
+        div(UNSIGNED, 32'h0003689c, 32'h000007f3, 32'h0000006d, 32'h00000625,  5);
+        div(SIGNED,   32'h0deeb653, 32'h0015bb39, 32'h000000a4, 32'h0002c5cf,  5);
+        div(UNSIGNED, 32'h3537c93b, 32'h01486384, 32'h00000029, 32'h009fd917,  4);
+        div(SIGNED,   32'hfffffc2c, 32'h0000002b, 32'hffffffea, 32'hffffffde,  4);
+        div(UNSIGNED, 32'h722847b3, 32'h0ae658af, 32'h0000000a, 32'h0528d0dd,  3);
+        div(SIGNED,   32'hffffe756, 32'h00000310, 32'hfffffff8, 32'hffffffd6,  3);
+        div(UNSIGNED, 32'h2fd21064, 32'h315c74bb, 32'h00000000, 32'h2fd21064,  2);
+        div(SIGNED,   32'h000003ca, 32'h0000039d, 32'h00000001, 32'h0000002d,  2);
+
+        // Divide by zero (the result is unpredictable, but it must finish)
+        div_zero(UNSIGNED, 32'h12345678, 17);
+        div_zero(SIGNED,   32'h87654321, 17);
+
+        // Abort a running divide with a new one
+        div_aborted(UNSIGNED, 32'hffffffff, 32'h00000001, 32'hffffffff, 32'h00000003, 32'h55555555, 32'h00000000, 17);
+        div_aborted(SIGNED,   32'h80000000, 32'h00000001, 32'h80000000, 32'h7fffffff, 32'hffffffff, 32'hffffffff, 2);
+
+        // Report the cycles
+        $display("%0d divides in %0d cycles (%0d with the radix-2 divider)", divides, total_cycles, divides * 32);
+        for (i = 1; i <= 17; i = i + 1) begin
+            if (histogram[i] != 0) begin
+                $display("%2d cycles: %0d divides", i, histogram[i]);
+            end
+        end
+
+        // Success
+        $fwrite(res, "1");
+        $fclose(res);
+        $finish;
+    end
+
+    // Task Divide: Check the quotient, remainder, and cycles
+    task div;
+    input s;
+    input [31:0] dividend;
+    input [31:0] divisor;
+    input [31:0] exp_q;
+    input [31:0] exp_r;
+    input integer exp_cycles;
+    begin
+        start(s, dividend, divisor);
+        wait_free();
+        check_cycles(exp_cycles);
+        check_result(exp_q, exp_r);
+    end
+    endtask
+
+    // Task Divide by zero: Check only the cycles
+    task div_zero;
+    input s;
+    input [31:0] dividend;
+    input integer exp_cycles;
+    begin
+        start(s, dividend, 32'h00000000);
+        wait_free();
+        check_cycles(exp_cycles);
+    end
+    endtask
+
+    // Task aborted Divide: A second divide starts two cycles into the first
+    task div_aborted;
+    input s;
+    input [31:0] dividend1;
+    input [31:0] divisor1;
+    input [31:0] dividend2;
+    input [31:0] divisor2;
+    input [31:0] exp_q;
+    input [31:0] exp_r;
+    input integer exp_cycles;
+    begin
+        start(s, dividend1, divisor1);
+        @(negedge clock);
+        if (~Stall) begin
+            $display("Fail: Need to adjust 'div_aborted' to abort while busy.");
+            fail();
+        end
+        start(s, dividend2, divisor2);
+        wait_free();
+        check_cycles(exp_cycles);
+        check_result(exp_q, exp_r);
+    end
+    endtask
+
+    // Task start a divide (called on a falling edge, returns on the next one)
+    task start;
+    input s;
+    input [31:0] dividend;
+    input [31:0] divisor;
+    begin
+        Dividend = dividend;
+        Divisor = divisor;
+        OP_div = s;
+        OP_divu = ~s;
+        @(negedge clock);
+        OP_div = 1'b0;
+        OP_divu = 1'b0;
+    end
+    endtask
+
+    // Task wait for free (not stalled) (up to 40 cycles) and count the stall cycles
+    task wait_free;
+    begin
+        cycles = 0;
+        while (Stall & (cycles < 40)) begin
+            @(negedge clock);
+            cycles = cycles + 1;
+        end
+    end
+    endtask
+
+    // Task check the stall cycles
+    task check_cycles;
+    input integer exp_cycles;
+    begin
+        if (cycles != exp_cycles) begin
+            $display("Fail: %h / %h: %0d cycles (%0d expected).", Dividend, Divisor, cycles, exp_cycles);
+            fail();
+        end
+        divides = divides + 1;
+        total_cycles = total_cycles + cycles;
+        histogram[cycles] = histogram[cycles] + 1;
+    end
+    endtask
+
+    // Task check result
+    task check_result;
+    input [31:0] exp_q;
+    input [31:0] exp_r;
+    begin
+        if ((Quotient != exp_q) || (Remainder != exp_r)) begin
+            $display("Fail: %h / %h: Q: %h R: %h (%h, %h expected).", Dividend, Divisor, Quotient, Remainder,
+                exp_q, exp_r);
+            fail();
+        end
+    end
+    endtask
+
+    // Task reset
+    task do_reset;
+    begin
+        @(posedge clock) reset <= 1'b1;
+        @(posedge clock) reset <= 1'b0;
+    end
+    endtask
+
+    // Task terminate on failure
+    task fail;
+    begin
+        $fwrite(res, "0");
+        $fclose(res);
+        $finish;
+    end
+    endtask
+
+endmodule
+
@@ -25,7 +25,7 @@ module InstructionCache_8KB_test;
     reg Read_C;
     reg DoCacheOp_C;
     reg [2:0] CacheOp_C;
-    reg [25:0] CacheOpData_C;
+    reg [27:0] CacheOpData_C;
     wire [31:0] DataIn_M;
     wire [1:0] DataInOffset_M;
     wire Ready_M;
@@ -45,7 +45,7 @@ module InstructionCache_8KB_test;
     wire MemWrite_Ready;
 
     // Instantiate the Unit Under Test (UUT)
-    InstructionCache_8KB #(.PABITS(PABITS)) uut (
+    InstructionCache #(.PABITS(PABITS)) uut (
         .clock            (clock),
         .reset            (reset),
         .VAddressIn_C     (VAddressIn_C),
@@ -57,6 +57,7 @@ module InstructionCache_8KB_test;
         .DataOut_C        (DataOut_C),
         .Ready_C          (Ready_C),
         .Blocked_C        (Blocked_C),
+        .Miss_C           (),
         .DoCacheOp_C      (DoCacheOp_C),
         .CacheOp_C        (CacheOp_C),
         .CacheOpData_C    (CacheOpData_C),
@@ -225,13 +226,13 @@ module InstructionCache_8KB_test;
         read(VAddr2w0, PTag2, nocache, valid, 1'bx, MLine2Word0);
 
         // CacheOp: Store Tag
-        cache_idxstag(8'hff, 1'b1, {26{1'b1}}); // Store tag 1s to index 1s
+        cache_idxstag(8'hff, 1'b1, {28{1'b1}}); // Store tag 1s to index 1s
         read({10{1'b1}}, {24{1'b1}}, cache, valid, hit, {32{1'bx}}); // The stored tag should be a hit
-        cache_idxstag(8'hff, 1'b1, {{24{1'b1}}, 2'b00}); // now invalid
+        cache_idxstag(8'hff, 1'b1, {{26{1'b1}}, 2'b00}); // now invalid
         read({10{1'b1}}, {24{1'b1}}, cache, valid, miss, {32{1'bx}}); // Miss due to invalidity
 
         // CacheOp: Index invalidate
-        cache_idxstag(8'hff, 1'b0, {13{2'b10}});
+        cache_idxstag(8'hff, 1'b0, {{12{2'b10}}, 2'b00, 2'b10});
         read({10{1'b1}}, {12{2'b10}}, cache, valid, hit, {32{1'bx}});
         cache_idxinv({10{1'b1}}, 1'b0);
         read({10{1'b1}}, {12{2'b10}}, cache, valid, miss, {32{1'bx}});
@@ -278,8 +279,8 @@ module InstructionCache_8KB_test;
     task cache_reset;
     begin
         for (j = 0; j < 256; j = j + 1) begin
-            cache_idxstag(j[7:0], 1'b0, {26{1'b0}});
-            cache_idxstag(j[7:0], 1'b1, {26{1'b0}});
+            cache_idxstag(j[7:0], 1'b0, {28{1'b0}});
+            cache_idxstag(j[7:0], 1'b1, {28{1'b0}});
         end
     end
     endtask
@@ -328,7 +329,7 @@ module InstructionCache_8KB_test;
     task cache_idxstag;
     input [7:0] idx_in;
     input setAsel_in;
-    input [25:0] data_in;
+    input [27:0] data_in;
     begin
         @(posedge clock) begin
             VAddressIn_C <= {idx_in, 2'b00};
@@ -0,0 +1,394 @@
+`timescale 1ns / 1ps
+/*
+ * File         : MAddSub_32x32x64_test.v
+ * Project      : XUM MIPS32
+ * Creator(s)   : Grant Ayers (ayers@cs.stanford.edu)
+ *
+ * Standards/Formatting:
+ *   Verilog 2001, 4 soft tab, wide column.
+ *
+ * Description:
+ *   Test module for the portable multiply/fused multiply-add unit.
+ *
+ *   Every operation goes to eight units with 1-4 pipeline stages ('STAGES'),
+ *   each without and with the early-out for small operands ('EARLY_OUT'). All
+ *   of them must produce the result (bits 63:0; bit 64 is unused) exactly
+ *   when 'busy' falls, after STAGES cycles, or (STAGES+1)/2 cycles for an
+ *   operand which fits in 16 bits with the early-out, plus one cycle for a
+ *   fused multiply/add or multiply/subtract. The cycles of each kind of
+ *   operation are printed for every unit at the end.
+ */
+module MAddSub_32x32x64_test;
+    localparam UNITS = 8;   // Unit u: STAGES = 1 + (u / 2), EARLY_OUT = u % 2
+
+    // Inputs
+    reg clock;
+    reg reset;
+    reg [31:0] A;
+    reg [31:0] B;
+    reg [63:0] C;
+    reg sign;
+    reg fused;
+    reg subtract;
+    reg start;
+
+    // Outputs
+    wire [(UNITS-1):0]    busy;
+    wire [(UNITS*65-1):0] D;
+
+    // Instantiate the Units Under Test (UUT)
+    genvar g;
+    generate
+        for (g = 0; g < UNITS; g = g + 1) begin : mult_unit
+            MAddSub_32x32x64 #(
+                .STAGES    (1 + (g / 2)),
+                .EARLY_OUT (g % 2))
+                uut (
+                .clock     (clock),
+                .reset     (reset),
+                .A         (A),
+                .B         (B),
+                .C         (C),
+                .sign      (sign),
+                .fused     (fused),
+                .subtract  (subtract),
+                .start     (start),
+                .busy      (busy[g]),
+                .D         (D[(g*65) +: 65])
+            );
+        end
+    endgenerate
+
+    integer res;
+    integer u;
+    integer cycles;
+    reg [(UNITS-1):0] done;
+    integer lat_full  [0:(UNITS-1)];    // Cycles of a full-width multiply
+    integer lat_short [0:(UNITS-1)];    // Cycles of a multiply with a 16-bit operand
+    integer lat_fused [0:(UNITS-1)];    // Cycles of a full-width multiply/add or multiply/subtract
+
+    localparam SIGNED=1'b1, UNSIGNED=1'b0;
+
+    // Always run the clock (100MHz)
+    initial forever begin
+        #5 clock <= ~clock;
+    end
+
+    initial begin
+        // Initialize Inputs
+        clock = 0;
+        reset = 0;
+        A = 0;
+        B = 0;
+        C = 0;
+        sign = 0;
+        fused = 0;
+        subtract = 0;
+        start = 0;
+        for (u = 0; u < UNITS; u = u + 1) begin
+            lat_full[u]  = 0;
+            lat_short[u] = 0;
+            lat_fused[u] = 0;
+        end
+
+        // Wait 100 ns for global reset to finish
+        #100;
+
+        // Add stimulus here
+        res = $fopen("result.out");
+        do_reset();
+        @(negedge clock);
+
+        // Multiply unsigned
+        mult(UNSIGNED, 32'h00001234, 32'h00000007, 64'h0000000000007f6c);
+        mult(UNSIGNED, 32'h12345678, 32'hffffffff, 64'h12345677edcba988);
+        mult(UNSIGNED, 32'hffffffff, 32'h12345678, 64'h12345677edcba988);
+        mult(UNSIGNED, 32'hffffffff, 32'hffffffff, 64'hfffffffe00000001);
+        mult(UNSIGNED, 32'h00000000, 32'hdeadbeef, 64'h0000000000000000);
+        mult(UNSIGNED, 32'h80000000, 32'h80000000, 64'h4000000000000000);
+        mult(UNSIGNED, 32'h80000000, 32'hffffffff, 64'h7fffffff80000000);
+        mult(UNSIGNED, 32'h7fffffff, 32'hcccccccc, 64'h6666666533333334);
+
+        // Multiply signed
+        mult(SIGNED,   32'h00001234, 32'h00000007, 64'h0000000000007f6c);
+        mult(SIGNED,   32'h00001234, 32'hfffffff9, 64'hffffffffffff8094);
+        mult(SIGNED,   32'hffffedcc, 32'hfffffff9, 64'h0000000000007f6c);
+        mult(SIGNED,   32'h12345678, 32'hffffffff, 64'hffffffffedcba988);
+        mult(SIGNED,   32'hffffffff, 32'h12345678, 64'hffffffffedcba988);
+        mult(SIGNED,   32'hffffffff, 32'hffffffff, 64'h0000000000000001);
+        mult(SIGNED,   32'hdeadbeef, 32'h00000000, 64'h0000000000000000);
+        mult(SIGNED,   32'h80000000, 32'h80000000, 64'h4000000000000000);
+        mult(SIGNED,   32'h80000000, 32'hffffffff, 64'h0000000080000000);
+        mult(SIGNED,   32'h7fffffff, 32'h7fffffff, 64'h3fffffff00000001);
+        mult(SIGNED,   32'h7fffffff, 32'h80000000, 64'hc000000080000000);
+
+        // Multiply at the early-out limits (16-bit operands, signed or unsigned)
+        mult(SIGNED,   32'h00007fff, 32'h12345678, 64'h0000091a1907a988);
+        mult(SIGNED,   32'h12345678, 32'hffff8000, 64'hfffff6e5d4c40000);
+        mult(SIGNED,   32'hffff7fff, 32'h00007fff, 64'hffffffffc0000001);
+        mult(SIGNED,   32'hffff8000, 32'hffff8000, 64'h0000000040000000);
+        mult(SIGNED,   32'h00008000, 32'h12345678, 64'h0000091a2b3c0000);
+        mult(UNSIGNED, 32'h00008000, 32'h12345678, 64'h0000091a2b3c0000);
+        mult(UNSIGNED, 32'h12345678, 32'h0000ffff, 64'h000012344443a988);
+        mult(SIGNED,   32'h12345678, 32'h0000ffff, 64'h000012344443a988);
+        mult(UNSIGNED, 32'h0000ffff, 32'h0000ffff, 64'h00000000fffe0001);
+        mult(UNSIGNED, 32'hffff8000, 32'hffff8000, 64'hffff000040000000);
+
+        // Fused Multiply/Add
+        madd(UNSIGNED, 32'h00000005, 32'h00000007, 64'h0000000000000050, 64'h0000000000000073);
+        madd(UNSIGNED, 32'h0000deaf, 32'h0000beef, 64'h0edcba9876543210, 64'h0edcba991c69f971);
+        madd(SIGNED,   32'hffffffff, 32'hffffffff, 64'hffffffffffffffff, 64'h0000000000000000);
+        madd(UNSIGNED, 32'h00000001, 32'h00000001, 64'hffffffffffffffff, 64'h0000000000000000);
+        madd(UNSIGNED, 32'hffffffff, 32'hffffffff, 64'h00000001fffffffe, 64'hffffffffffffffff);
+        madd(UNSIGNED, 32'hffffffff, 32'hffffffff, 64'hffffffffffffffff, 64'hfffffffe00000000);
+        madd(SIGNED,   32'h01000000, 32'h000186a0, 64'hfffffe2e56b5e000, 64'hffffffb4f6b5e000);
+        madd(SIGNED,   32'h80000000, 32'h7fffffff, 64'h0000000100000000, 64'hc000000180000000);
+        madd(SIGNED,   32'h80000000, 32'h80000000, 64'hc000000000000000, 64'h0000000000000000);
+        madd(SIGNED,   32'h00007fff, 32'hffff8000, 64'h0000000000000000, 64'hffffffffc0008000);
+        madd(UNSIGNED, 32'h0000ffff, 32'h12345678, 64'hffffffffffffffff, 64'h000012344443a987);
+
+        // Fused Multiply/Sub
+        msub(UNSIGNED, 32'h00000005, 32'h00000007, 64'h0000000000000050, 64'h000000000000002d);
+        msub(UNSIGNED, 32'h0000deaf, 32'h0000beef, 64'h0edcba9876543210, 64'h0edcba97d03e6aaf);
+        msub(SIGNED,   32'hffffffff, 32'hffffffff, 64'hffffffffffffffff, 64'hfffffffffffffffe);
+        msub(UNSIGNED, 32'h00000001, 32'h00000001, 64'hffffffffffffffff, 64'hfffffffffffffffe);
+        msub(UNSIGNED, 32'hffffffff, 32'hffffffff, 64'h00000001fffffffe, 64'h00000003fffffffd);
+        msub(UNSIGNED, 32'hffffffff, 32'hffffffff, 64'hffffffffffffffff, 64'h00000001fffffffe);
+        msub(SIGNED,   32'h01000000, 32'h000186a0, 64'hfffffe2e56b5e000, 64'hfffffca7b6b5e000);
+        msub(SIGNED,   32'h80000000, 32'h7fffffff, 64'h0000000100000000, 64'h4000000080000000);
+        msub(SIGNED,   32'h80000000, 32'h80000000, 64'hc000000000000000, 64'h8000000000000000);
+        msub(SIGNED,   32'h00007fff, 32'hffff8000, 64'h0000000000000000, 64'h000000003fff8000);
+        msub(UNSIGNED, 32'h0000ffff, 32'h12345678, 64'hffffffffffffffff, 64'hffffedcbbbbc5677);
+
+        // Interrupted operation (full-width and small operands)
+        mult_interrupted(UNSIGNED, 32'h12345678, 32'hffffffff, 32'h1234, 32'h7, 64'h7f6c);
+        mult_interrupted(SIGNED,   32'h1234, 32'h7, 32'h80000000, 32'h7fffffff, 64'hc000000080000000);
+
+        // Retain the result
+        msub_retain(SIGNED, 32'd16777216, 32'd100000, -64'd2000000000000, 64'hfffffca7b6b5e000);
+
+        // Report the cycles of each unit
+        for (u = 0; u < UNITS; u = u + 1) begin
+            $display("STAGES=%0d EARLY_OUT=%0d: mult %0d, small mult %0d, madd/msub %0d cycles",
+                stages(u), u % 2, lat_full[u], lat_short[u], lat_fused[u]);
+        end
+
+        // Success
+        $fwrite(res, "1");
+        $fclose(res);
+        $finish;
+    end
+
+    // Pipeline stages of unit u
+    function integer stages;
+    input integer unit;
+    begin
+        stages = 1 + (unit / 2);
+    end
+    endfunction
+
+    // An operand which the early-out handles (fits in 16 bits)
+    function small;
+    input s;
+    input [31:0] x;
+    begin
+        small = (s) ? (($signed(x) >= -32768) && ($signed(x) <= 32767)) : (x <= 32'h0000ffff);
+    end
+    endfunction
+
+    // Expected cycles from 'start' until the result of unit u
+    function integer latency;
+    input integer unit;
+    input s;
+    input f;
+    input [31:0] a;
+    input [31:0] b;
+    begin
+        if ((unit % 2) && (small(s, a) || small(s, b))) begin
+            latency = ((stages(unit) + 1) / 2) + f;
+        end
+        else begin
+            latency = stages(unit) + f;
+        end
+    end
+    endfunction
+
+    // Task Multiply
+    task mult;
+    input s;
+    input [31:0] a;
+    input [31:0] b;
+    input [63:0] exp_d;
+    begin
+        issue(s, 1'b0, 1'b0, a, b, 64'h0);
+        finish(s, 1'b0, a, b, exp_d);
+    end
+    endtask
+
+    // Task Fused Multiply/Add
+    task madd;
+    input s;
+    input [31:0] a;
+    input [31:0] b;
+    input [63:0] c;
+    input [63:0] exp_d;
+    begin
+        issue(s, 1'b1, 1'b0, a, b, c);
+        finish(s, 1'b1, a, b, exp_d);
+    end
+    endtask
+
+    // Task Fused Multiply/Subtract
+    task msub;
+    input s;
+    input [31:0] a;
+    input [31:0] b;
+    input [63:0] c;
+    input [63:0] exp_d;
+    begin
+        issue(s, 1'b1, 1'b1, a, b, c);
+        finish(s, 1'b1, a, b, exp_d);
+    end
+    endtask
+
+    // Task interrupted Multiply: The second operation starts while the first is in progress
+    task mult_interrupted;
+    input s;
+    input [31:0] a1;
+    input [31:0] b1;
+    input [31:0] a2;
+    input [31:0] b2;
+    input [63:0] exp_d;
+    begin
+        issue(s, 1'b0, 1'b0, a1, b1, 64'h0);
+        @(negedge clock);
+        if (busy[UNITS-1] == 1'b0) begin
+            $display("Fail: Need to adjust 'mult_interrupted' to interrupt while busy.");
+            fail();
+        end
+        issue(s, 1'b0, 1'b0, a2, b2, 64'h0);
+        finish(s, 1'b0, a2, b2, exp_d);
+    end
+    endtask
+
+    // Task retain result
+    task msub_retain;
+    input s;
+    input [31:0] a;
+    input [31:0] b;
+    input [63:0] c;
+    input [63:0] exp_d;
+    begin
+        msub(s, a, b, c, exp_d);
+        repeat (4) @(negedge clock);
+        for (u = 0; u < UNITS; u = u + 1) begin
+            check_result(u, exp_d);
+        end
+    end
+    endtask
+
+    // Task start an operation on all units (called on a falling edge)
+    task issue;
+    input s;
+    input f;
+    input sub;
+    input [31:0] a;
+    input [31:0] b;
+    input [63:0] c;
+    begin
+        A = a;
+        B = b;
+        C = c;
+        sign = s;
+        fused = f;
+        subtract = sub;
+        start = 1'b1;
+        @(negedge clock);
+        start = 1'b0;
+    end
+    endtask
+
+    // Task wait for every unit to finish (up to 40 cycles) and check its result and latency
+    task finish;
+    input s;
+    input f;
+    input [31:0] a;
+    input [31:0] b;
+    input [63:0] exp_d;
+    begin
+        done = {UNITS{1'b0}};
+        cycles = 0;
+        while ((done != {UNITS{1'b1}}) && (cycles < 40)) begin
+            for (u = 0; u < UNITS; u = u + 1) begin
+                if (~done[u] & ~busy[u]) begin
+                    done[u] = 1'b1;
+                    check_result(u, exp_d);
+                    check_latency(u, latency(u, s, f, a, b));
+                    if (small(s, a) || small(s, b)) begin
+                        lat_short[u] = (~f & (cycles > lat_short[u])) ? cycles : lat_short[u];
+                    end
+                    else if (f) begin
+                        lat_fused[u] = (cycles > lat_fused[u]) ? cycles : lat_fused[u];
+                    end
+                    else begin
+                        lat_full[u] = (cycles > lat_full[u]) ? cycles : lat_full[u];
+                    end
+                end
+            end
+            if (done != {UNITS{1'b1}}) begin
+                @(negedge clock);
+                cycles = cycles + 1;
+            end
+        end
+        if (done != {UNITS{1'b1}}) begin
+            $display("Fail: Busy for too long (done: %b).", done);
+            fail();
+        end
+    end
+    endtask
+
+    // Task check the result of a unit (bits 63:0)
+    task check_result;
+    input integer unit;
+    input [63:0] exp_result;
+    begin
+        if (D[(unit*65) +: 64] != exp_result) begin
+            $display("Fail: STAGES=%0d EARLY_OUT=%0d: D: %h (%h expected).", stages(unit), unit % 2,
+                D[(unit*65) +: 64], exp_result);
+            fail();
+        end
+    end
+    endtask
+
+    // Task check the cycles from 'start' until a unit was no longer busy
+    task check_latency;
+    input integer unit;
+    input integer exp_cycles;
+    begin
+        if (cycles != exp_cycles) begin
+            $display("Fail: STAGES=%0d EARLY_OUT=%0d: %0d cycles (%0d expected).", stages(unit), unit % 2,
+                cycles, exp_cycles);
+            fail();
+        end
+    end
+    endtask
+
+    // Task reset
+    task do_reset;
+    begin
+        @(posedge clock) reset <= 1'b1;
+        @(posedge clock) reset <= 1'b0;
+    end
+    endtask
+
+    // Task terminate on failure
+    task fail;
+    begin
+        $fwrite(res, "0");
+        $fclose(res);
+        $finish;
+    end
+    endtask
+
+endmodule
+
@@ -37,7 +37,7 @@ module Set_RO_128x256_test;
 	wire Valid;
 
 	// Instantiate the Unit Under Test (UUT)
-	Set_RO_128x256 #(
+	Set_RO #(
         .PABITS(36))
         uut (
 		.clock(clock),
@@ -30,7 +30,7 @@ module TagFlagRam_RO_256_test;
     wire MatchValid;
 
 	// Instantiate the Unit Under Test (UUT)
-	TagFlagRam_RO_256 #(
+	TagFlagRam_RO #(
         .PABITS(36))
         uut (
         .clock(clock),